@@ -22,6 +22,7 @@
 #include <sys/stat.h>
 
 #include <raid/raid.h>
+#include <sodium/core.h>
 
 #include "cmds.h"
 
@@ -92,6 +93,8 @@ void bcachefs_usage(void)
 	     "  dump                     Dump filesystem metadata to a qcow2 image\n"
 	     "  list                     List filesystem metadata in textual form\n"
 	     "  list_journal             List contents of journal\n"
+	     "  bench                    Microbenchmarks for the userspace implementation\n"
+	     "  trace                    Read traces of bcachefs events\n"
 	     "\n"
 #ifdef BCACHEFS_FUSE
 	     "FUSE:\n"
@@ -122,6 +125,13 @@ int main(int argc, char *argv[])
 {
 	raid_init();
 
+	/*
+	 * Until this is called libsodium uses its portable chacha20 and
+	 * poly1305 implementations, not the SIMD ones for this CPU:
+	 */
+	if (sodium_init() < 0)
+		die("error initializing libsodium");
+
 	setvbuf(stdout, NULL, _IOLBF, 0);
 
 	char *full_cmd = argv[0];
@@ -199,6 +209,10 @@ int main(int argc, char *argv[])
 		return cmd_list(argc, argv);
 	if (!strcmp(cmd, "list_journal"))
 		return cmd_list_journal(argc, argv);
+	if (!strcmp(cmd, "bench"))
+		return bench_cmds(argc, argv);
+	if (!strcmp(cmd, "trace"))
+		return trace_cmds(argc, argv);
 
 	if (!strcmp(cmd, "setattr"))
 		return cmd_setattr(argc, argv);
@@ -0,0 +1,1786 @@
+#include <getopt.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#include <linux/bio.h>
+#include <linux/blkdev.h>
+#include <linux/completion.h>
+#include <linux/crc32c.h>
+#include <linux/crc64.h>
+#include <linux/jiffies.h>
+#include <linux/kthread.h>
+#include <linux/prandom.h>
+#include <linux/random.h>
+#include <linux/slab.h>
+#include <linux/sort.h>
+
+#include "cmds.h"
+#include "libbcachefs.h"
+
+#include "libbcachefs/bkey.h"
+#include "libbcachefs/bset.h"
+#include "libbcachefs/checksum.h"
+#include "libbcachefs/compress.h"
+#include "libbcachefs/btree_journal_iter.h"
+#include "libbcachefs/darray.h"
+#include "libbcachefs/six.h"
+#include "libbcachefs/util.h"
+
+static void bench_print_result(const char *name, u64 ops, u64 bytes, u64 ns)
+{
+	struct printbuf buf = PRINTBUF;
+
+	prt_printf(&buf, "%-20s %10llu ops in ", name, ops);
+	bch2_pr_time_units(&buf, ns);
+	prt_printf(&buf, ": %llu ops/sec", div64_u64(ops * NSEC_PER_SEC, max(ns, 1ULL)));
+
+	if (bytes) {
+		prt_str(&buf, ", ");
+		prt_human_readable_u64(&buf, div64_u64(bytes * NSEC_PER_SEC, max(ns, 1ULL)));
+		prt_str(&buf, "/sec");
+	}
+
+	printf("%s\n", buf.buf);
+	printbuf_exit(&buf);
+}
+
+/* Something like text: random words from a vocabulary of 256 */
+static void bench_fill_text(u8 *buf, size_t size, struct rnd_state *rand)
+{
+	char words[256][9];
+
+	for (unsigned i = 0; i < ARRAY_SIZE(words); i++) {
+		/* 2 to 7 letters, then a space and the nul: */
+		unsigned len = 2 + prandom_u64_state(rand) % (sizeof(words[i]) - 3);
+
+		for (unsigned j = 0; j < len; j++)
+			words[i][j] = 'a' + prandom_u64_state(rand) % 26;
+		words[i][len] = ' ';
+		words[i][len + 1] = '\0';
+	}
+
+	for (size_t i = 0; i < size;) {
+		const char *w = words[prandom_u64_state(rand) % ARRAY_SIZE(words)];
+		unsigned len = min_t(size_t, strlen(w), size - i);
+
+		memcpy(buf + i, w, len);
+		i += len;
+	}
+}
+
+/* bench io: */
+
+static void bench_io_usage(void)
+{
+	puts("bcachefs bench io - benchmark the userspace block IO backends\n"
+	     "Usage: bcachefs bench io [OPTION]... <device>\n"
+	     "\n"
+	     "Options:\n"
+	     "  -b, --backend=backend            IO backend: uring, aio, sync or ram\n"
+	     "                                   (default: $BCACHEFS_IO_BACKEND, or best available)\n"
+	     "  -w, --write                      Issue writes instead of reads (destroys data!)\n"
+	     "  -r, --random                     Random instead of sequential offsets\n"
+	     "  -s, --blocksize=size             IO size (default 4k)\n"
+	     "  -q, --queue-depth=nr             IOs in flight (default 32)\n"
+	     "  -n, --nr=nr                      Number of IOs (default 100000)\n"
+	     "      --buffered                   Don't use O_DIRECT\n"
+	     "  -h, --help                       Display this help and exit\n"
+	     "Report bugs to <linux-bcachefs@vger.kernel.org>");
+}
+
+struct bench_io {
+	struct block_device	*bdev;
+	blk_opf_t		opf;
+	unsigned		bs;
+	u64			nr_sectors;
+	bool			random;
+	struct rnd_state	rand;
+	u64			next_sector;
+
+	atomic_t		in_flight;
+	wait_queue_head_t	wait;
+};
+
+struct bench_io_slot {
+	struct bench_io		*b;
+	void			*buf;
+};
+
+static void bench_io_endio(struct bio *bio)
+{
+	struct bench_io_slot *s = bio->bi_private;
+	struct bench_io *b = s->b;
+
+	if (bio->bi_status)
+		die("IO error: %s", blk_status_to_str(bio->bi_status));
+
+	bio_put(bio);
+	atomic_dec(&b->in_flight);
+	wake_up(&b->wait);
+}
+
+static void bench_io_submit(struct bench_io *b, struct bench_io_slot *s)
+{
+	struct bio *bio = bio_alloc(b->bdev, DIV_ROUND_UP(b->bs, PAGE_SIZE) + 1,
+				    b->opf, GFP_KERNEL);
+	u64 sector;
+
+	if (b->random) {
+		sector = prandom_u64_state(&b->rand) % b->nr_sectors;
+	} else {
+		sector = b->next_sector;
+		b->next_sector += b->bs >> 9;
+		if (b->next_sector >= b->nr_sectors)
+			b->next_sector = 0;
+	}
+
+	bio->bi_iter.bi_sector	= round_down(sector, b->bs >> 9);
+	bio->bi_end_io		= bench_io_endio;
+	bio->bi_private		= s;
+	bch2_bio_map(bio, s->buf, b->bs);
+
+	atomic_inc(&b->in_flight);
+	submit_bio(bio);
+}
+
+static int cmd_bench_io(int argc, char *argv[])
+{
+	static const struct option longopts[] = {
+		{ "backend",		required_argument,	NULL, 'b' },
+		{ "write",		no_argument,		NULL, 'w' },
+		{ "random",		no_argument,		NULL, 'r' },
+		{ "blocksize",		required_argument,	NULL, 's' },
+		{ "queue-depth",	required_argument,	NULL, 'q' },
+		{ "nr",			required_argument,	NULL, 'n' },
+		{ "buffered",		no_argument,		NULL, 'B' },
+		{ "help",		no_argument,		NULL, 'h' },
+		{ NULL }
+	};
+	struct bench_io b = { .bs = 4096 };
+	blk_mode_t mode = BLK_OPEN_READ;
+	unsigned qd = 32;
+	u64 nr = 100000, v;
+	int opt;
+
+	b.opf = REQ_OP_READ;
+
+	while ((opt = getopt_long(argc, argv, "b:wrs:q:n:h",
+				  longopts, NULL)) != -1)
+		switch (opt) {
+		case 'b':
+			if (blkdev_set_backend(optarg))
+				die("invalid backend %s", optarg);
+			break;
+		case 'w':
+			b.opf = REQ_OP_WRITE;
+			mode |= BLK_OPEN_WRITE;
+			break;
+		case 'r':
+			b.random = true;
+			break;
+		case 's':
+			if (bch2_strtoull_h(optarg, &v) ||
+			    !v || v & 511 || v > (BIO_MAX_VECS - 1) * PAGE_SIZE)
+				die("invalid blocksize %s", optarg);
+			b.bs = v;
+			break;
+		case 'q':
+			if (kstrtouint(optarg, 10, &qd) || !qd)
+				die("invalid queue depth %s", optarg);
+			break;
+		case 'n':
+			if (bch2_strtoull_h(optarg, &nr))
+				die("invalid nr %s", optarg);
+			break;
+		case 'B':
+			mode |= BLK_OPEN_BUFFERED;
+			break;
+		case 'h':
+			bench_io_usage();
+			exit(EXIT_SUCCESS);
+		}
+	args_shift(optind);
+
+	char *dev = arg_pop();
+	if (!dev)
+		die("Please supply a device");
+	if (argc)
+		die("too many arguments");
+
+	struct file *file = bdev_file_open_by_path(dev, mode, NULL, NULL);
+	if (IS_ERR(file))
+		die("error opening %s: %s", dev, strerror(-PTR_ERR(file)));
+
+	b.bdev		= file_bdev(file);
+	b.nr_sectors	= get_capacity(b.bdev->bd_disk);
+	prandom_seed_state(&b.rand, get_random_u64());
+	init_waitqueue_head(&b.wait);
+
+	if (b.nr_sectors < b.bs >> 9)
+		die("%s too small", dev);
+
+	struct bench_io_slot *slots = calloc(qd, sizeof(*slots));
+	for (unsigned i = 0; i < qd; i++) {
+		slots[i].b = &b;
+		if (posix_memalign(&slots[i].buf, PAGE_SIZE, b.bs))
+			die("posix_memalign error");
+		memset(slots[i].buf, 0, b.bs);
+	}
+
+	struct blk_plug plug;
+	u64 start = ktime_get_mono_fast_ns();
+
+	/*
+	 * Slots are handed out round robin: with writes, buffer contents don't
+	 * matter, and with reads we never look at what we read.
+	 *
+	 * We stay plugged, so the backend can batch submissions until we block
+	 * waiting for a free slot:
+	 */
+	blk_start_plug(&plug);
+	for (u64 i = 0; i < nr; i++) {
+		wait_event(b.wait, atomic_read(&b.in_flight) < qd);
+		bench_io_submit(&b, &slots[i % qd]);
+	}
+	blk_finish_plug(&plug);
+	wait_event(b.wait, !atomic_read(&b.in_flight));
+
+	u64 ns = ktime_get_mono_fast_ns() - start;
+
+	char *name = mprintf("%s %s%s", blkdev_backend_name(),
+			     b.random ? "rand" : "seq",
+			     b.opf == REQ_OP_WRITE ? "write" : "read");
+	bench_print_result(name, nr, nr * b.bs, ns);
+	free(name);
+
+	struct blk_plug_stats stats;
+	blk_plug_stats(&stats);
+	printf("%llu bios plugged, %llu merged\n", stats.plugged, stats.merged);
+
+	for (unsigned i = 0; i < qd; i++)
+		free(slots[i].buf);
+	free(slots);
+	bdev_fput(file);
+	return 0;
+}
+
+/* bench replay: */
+
+static void bench_replay_usage(void)
+{
+	puts("bcachefs bench replay - replay an IO trace recorded with BCACHEFS_IO_TRACE\n"
+	     "Usage: bcachefs bench replay [OPTION]... <trace> <device>...\n"
+	     "\n"
+	     "Devices are given in the order they were opened when the trace was recorded;\n"
+	     "IO to devices not given is skipped.\n"
+	     "\n"
+	     "Options:\n"
+	     "  -b, --backend=backend            IO backend: uring, aio, sync or ram\n"
+	     "  -f, --fast                       Ignore recorded timing, replay as fast as possible\n"
+	     "  -q, --queue-depth=nr             IOs in flight with --fast (default 64)\n"
+	     "  -w, --writes                     Replay writes and discards too (destroys data!)\n"
+	     "  -h, --help                       Display this help and exit\n"
+	     "Report bugs to <linux-bcachefs@vger.kernel.org>");
+}
+
+enum bench_replay_class {
+	REPLAY_READ,
+	REPLAY_WRITE,
+	REPLAY_FLUSH,
+	REPLAY_DISCARD,
+	REPLAY_NR,
+};
+
+static const char * const bench_replay_class_names[] = {
+	"read", "write", "flush", "discard",
+};
+
+struct bench_replay_stats {
+	u64			nr;
+	u64			bytes;
+	u64			recorded_ns;
+	atomic64_t		replayed_ns;
+};
+
+struct bench_replay {
+	struct bench_replay_stats stats[REPLAY_NR];
+	atomic_t		in_flight;
+	wait_queue_head_t	wait;
+	void			*buf;
+};
+
+struct bench_replay_io {
+	struct bench_replay	*r;
+	enum bench_replay_class	class;
+	u64			submit_ns;
+};
+
+static enum bench_replay_class bench_replay_class(u32 opf)
+{
+	switch (opf & REQ_OP_MASK) {
+	case REQ_OP_READ:
+		return REPLAY_READ;
+	case REQ_OP_WRITE:
+		return REPLAY_WRITE;
+	case REQ_OP_FLUSH:
+		return REPLAY_FLUSH;
+	default:
+		return REPLAY_DISCARD;
+	}
+}
+
+static int bench_replay_rec_cmp(const void *_l, const void *_r)
+{
+	const struct blk_trace_rec *l = _l, *r = _r;
+
+	return cmp_int(l->submit_ns, r->submit_ns);
+}
+
+static void bench_replay_endio(struct bio *bio)
+{
+	struct bench_replay_io *io = bio->bi_private;
+	struct bench_replay *r = io->r;
+
+	atomic64_add(ktime_get_mono_fast_ns() - io->submit_ns, &r->stats[io->class].replayed_ns);
+
+	kfree(io);
+	bio_put(bio);
+	atomic_dec(&r->in_flight);
+	wake_up(&r->wait);
+}
+
+static int cmd_bench_replay(int argc, char *argv[])
+{
+	static const struct option longopts[] = {
+		{ "backend",		required_argument,	NULL, 'b' },
+		{ "fast",		no_argument,		NULL, 'f' },
+		{ "queue-depth",	required_argument,	NULL, 'q' },
+		{ "writes",		no_argument,		NULL, 'w' },
+		{ "help",		no_argument,		NULL, 'h' },
+		{ NULL }
+	};
+	DARRAY(struct blk_trace_rec) recs = {};
+	DARRAY(struct file *) files = {};
+	struct bench_replay r = {};
+	blk_mode_t mode = BLK_OPEN_READ;
+	bool fast = false, writes = false;
+	unsigned qd = 64, max_bytes = 0;
+	u64 skipped = 0;
+	int opt;
+
+	while ((opt = getopt_long(argc, argv, "b:fq:wh",
+				  longopts, NULL)) != -1)
+		switch (opt) {
+		case 'b':
+			if (blkdev_set_backend(optarg))
+				die("invalid backend %s", optarg);
+			break;
+		case 'f':
+			fast = true;
+			break;
+		case 'q':
+			if (kstrtouint(optarg, 10, &qd) || !qd)
+				die("invalid queue depth %s", optarg);
+			break;
+		case 'w':
+			writes = true;
+			mode |= BLK_OPEN_WRITE;
+			break;
+		case 'h':
+			bench_replay_usage();
+			exit(EXIT_SUCCESS);
+		}
+	args_shift(optind);
+
+	char *trace = arg_pop();
+	if (!trace)
+		die("Please supply a trace file");
+
+	FILE *f = fopen(trace, "r");
+	if (!f)
+		die("error opening %s: %m", trace);
+
+	struct blk_trace_header h;
+	if (fread(&h, sizeof(h), 1, f) != 1 ||
+	    h.magic != BLK_TRACE_MAGIC)
+		die("%s: not an IO trace", trace);
+	if (h.version != BLK_TRACE_VERSION ||
+	    h.rec_size != sizeof(struct blk_trace_rec))
+		die("%s: unsupported trace version %u", trace, h.version);
+
+	struct blk_trace_rec rec;
+	while (fread(&rec, sizeof(rec), 1, f) == 1) {
+		if (rec.type == BLK_TRACE_DEV) {
+			char *path = malloc(rec.bytes);
+
+			if (!rec.bytes ||
+			    fread(path, rec.bytes, 1, f) != 1)
+				die("%s: truncated", trace);
+			path[rec.bytes - 1] = '\0';
+			printf("trace device %u: %s\n", rec.dev, path);
+			free(path);
+			continue;
+		}
+
+		if (rec.type != BLK_TRACE_IO)
+			die("%s: unknown record type %u", trace, rec.type);
+
+		if (darray_push(&recs, rec))
+			die("%s", strerror(ENOMEM));
+	}
+	fclose(f);
+
+	while (argc) {
+		char *dev = arg_pop();
+		struct file *file = bdev_file_open_by_path(dev, mode, NULL, NULL);
+
+		if (IS_ERR(file))
+			die("error opening %s: %s", dev, strerror(-PTR_ERR(file)));
+		if (darray_push(&files, file))
+			die("%s", strerror(ENOMEM));
+	}
+	if (!files.nr)
+		die("Please supply a device");
+
+	/* Records were written in completion order: */
+	sort(recs.data, recs.nr, sizeof(recs.data[0]), bench_replay_rec_cmp, NULL);
+
+	darray_for_each(recs, i)
+		max_bytes = max(max_bytes, i->bytes);
+	if (posix_memalign(&r.buf, PAGE_SIZE, round_up(max(max_bytes, 1U), PAGE_SIZE)))
+		die("posix_memalign error");
+	memset(r.buf, 0, max_bytes);
+	init_waitqueue_head(&r.wait);
+
+	u64 start = ktime_get_mono_fast_ns();
+	u64 trace_start = recs.nr ? recs.data[0].submit_ns : 0;
+
+	darray_for_each(recs, i) {
+		enum bench_replay_class class = bench_replay_class(i->opf);
+
+		if (i->dev >= files.nr ||
+		    (!writes && class != REPLAY_READ) ||
+		    DIV_ROUND_UP(i->bytes, PAGE_SIZE) > BIO_MAX_VECS - 1) {
+			skipped++;
+			continue;
+		}
+
+		if (fast) {
+			wait_event(r.wait, atomic_read(&r.in_flight) < qd);
+		} else {
+			u64 t = start + i->submit_ns - trace_start;
+			struct timespec ts = {
+				.tv_sec		= t / NSEC_PER_SEC,
+				.tv_nsec	= t % NSEC_PER_SEC,
+			};
+
+			while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+				;
+		}
+
+		struct bench_replay_io *io = kmalloc(sizeof(*io), GFP_KERNEL|__GFP_NOFAIL);
+		io->r		= &r;
+		io->class	= class;
+
+		unsigned nr_vecs = class == REPLAY_READ || class == REPLAY_WRITE
+			? DIV_ROUND_UP(i->bytes, PAGE_SIZE) + 1
+			: 0;
+		struct bio *bio = bio_alloc(file_bdev(files.data[i->dev]), nr_vecs, i->opf, GFP_KERNEL);
+
+		bio->bi_iter.bi_sector	= i->sector;
+		bio->bi_end_io		= bench_replay_endio;
+		bio->bi_private		= io;
+		if (nr_vecs)
+			bch2_bio_map(bio, r.buf, i->bytes);
+		else
+			bio->bi_iter.bi_size = i->bytes;
+
+		r.stats[class].nr++;
+		r.stats[class].bytes		+= i->bytes;
+		r.stats[class].recorded_ns	+= i->complete_ns - i->submit_ns;
+
+		atomic_inc(&r.in_flight);
+		io->submit_ns = ktime_get_mono_fast_ns();
+		submit_bio(bio);
+	}
+	wait_event(r.wait, !atomic_read(&r.in_flight));
+
+	u64 ns = ktime_get_mono_fast_ns() - start;
+
+	struct printbuf buf = PRINTBUF;
+	prt_printf(&buf, "replayed %llu IOs (%llu skipped) in ", (u64) recs.nr - skipped, skipped);
+	bch2_pr_time_units(&buf, ns);
+	if (recs.nr) {
+		prt_str(&buf, ", recorded ");
+		bch2_pr_time_units(&buf, darray_last(recs).submit_ns - trace_start);
+	}
+	printf("%s\n", buf.buf);
+
+	for (unsigned i = 0; i < REPLAY_NR; i++) {
+		struct bench_replay_stats *s = &r.stats[i];
+
+		if (!s->nr)
+			continue;
+
+		printbuf_reset(&buf);
+		prt_printf(&buf, "%-8s %10llu ", bench_replay_class_names[i], s->nr);
+		prt_human_readable_u64(&buf, s->bytes);
+		prt_str(&buf, ", mean latency recorded ");
+		bch2_pr_time_units(&buf, div64_u64(s->recorded_ns, s->nr));
+		prt_str(&buf, " replayed ");
+		bch2_pr_time_units(&buf, div64_u64(atomic64_read(&s->replayed_ns), s->nr));
+		printf("%s\n", buf.buf);
+	}
+	printbuf_exit(&buf);
+
+	darray_for_each(files, i)
+		bdev_fput(*i);
+	darray_exit(&files);
+	darray_exit(&recs);
+	free(r.buf);
+	return 0;
+}
+
+/* bench slab: */
+
+static void bench_slab_usage(void)
+{
+	puts("bcachefs bench slab - benchmark kmem_cache against malloc\n"
+	     "Usage: bcachefs bench slab [OPTION]...\n"
+	     "\n"
+	     "Each thread repeatedly allocates a batch of objects, then frees them.\n"
+	     "\n"
+	     "Options:\n"
+	     "  -s, --size=size                  Object size (default 256)\n"
+	     "  -l, --live=nr                    Objects allocated at a time (default 128)\n"
+	     "  -n, --nr=nr                      Allocations per thread (default 10M)\n"
+	     "  -t, --threads=nr                 Number of threads (default 1)\n"
+	     "  -h, --help                       Display this help and exit\n"
+	     "Report bugs to <linux-bcachefs@vger.kernel.org>");
+}
+
+struct bench_slab {
+	struct kmem_cache	*cache;	/* NULL: malloc */
+	size_t			size;
+	unsigned		live;
+	u64			nr;
+};
+
+static void *bench_slab_thread(void *arg)
+{
+	struct bench_slab *b = arg;
+	void **objs = calloc(b->live, sizeof(objs[0]));
+
+	for (u64 i = 0; i < b->nr; i += b->live) {
+		for (unsigned j = 0; j < b->live; j++) {
+			objs[j] = b->cache
+				? kmem_cache_alloc(b->cache, GFP_KERNEL)
+				: malloc(b->size);
+			/* touch it, as a real user would: */
+			*((volatile u64 *) objs[j]) = i;
+		}
+
+		for (unsigned j = 0; j < b->live; j++)
+			if (b->cache)
+				kmem_cache_free(b->cache, objs[j]);
+			else
+				free(objs[j]);
+	}
+
+	free(objs);
+	return NULL;
+}
+
+static u64 bench_slab_run(struct bench_slab *b, unsigned nr_threads)
+{
+	pthread_t *threads = calloc(nr_threads, sizeof(threads[0]));
+	u64 start = ktime_get_mono_fast_ns();
+
+	for (unsigned i = 0; i < nr_threads; i++)
+		if (pthread_create(&threads[i], NULL, bench_slab_thread, b))
+			die("pthread_create error");
+	for (unsigned i = 0; i < nr_threads; i++)
+		pthread_join(threads[i], NULL);
+
+	free(threads);
+	return ktime_get_mono_fast_ns() - start;
+}
+
+static int cmd_bench_slab(int argc, char *argv[])
+{
+	static const struct option longopts[] = {
+		{ "size",		required_argument,	NULL, 's' },
+		{ "live",		required_argument,	NULL, 'l' },
+		{ "nr",			required_argument,	NULL, 'n' },
+		{ "threads",		required_argument,	NULL, 't' },
+		{ "help",		no_argument,		NULL, 'h' },
+		{ NULL }
+	};
+	struct bench_slab b = { .size = 256, .live = 128, .nr = 10000000 };
+	unsigned nr_threads = 1;
+	u64 v;
+	int opt;
+
+	while ((opt = getopt_long(argc, argv, "s:l:n:t:h",
+				  longopts, NULL)) != -1)
+		switch (opt) {
+		case 's':
+			if (bch2_strtoull_h(optarg, &v) || v < sizeof(u64) || v > UINT_MAX)
+				die("invalid size %s", optarg);
+			b.size = v;
+			break;
+		case 'l':
+			if (kstrtouint(optarg, 10, &b.live) || !b.live)
+				die("invalid nr live %s", optarg);
+			break;
+		case 'n':
+			if (bch2_strtoull_h(optarg, &b.nr))
+				die("invalid nr %s", optarg);
+			break;
+		case 't':
+			if (kstrtouint(optarg, 10, &nr_threads) || !nr_threads)
+				die("invalid nr threads %s", optarg);
+			break;
+		case 'h':
+			bench_slab_usage();
+			exit(EXIT_SUCCESS);
+		}
+	args_shift(optind);
+
+	if (argc)
+		die("too many arguments");
+
+	b.nr = round_up(b.nr, b.live);
+	u64 ops = b.nr * nr_threads;
+
+	bench_print_result("malloc", ops, 0, bench_slab_run(&b, nr_threads));
+
+	b.cache = kmem_cache_create("bench", b.size, 0, 0, NULL);
+	if (!b.cache)
+		die("error creating kmem_cache");
+
+	bench_print_result("kmem_cache", ops, 0, bench_slab_run(&b, nr_threads));
+
+	struct kmem_cache_stats s;
+	kmem_cache_stats(b.cache, &s);
+	printf("%llu active objects, %llu total, %llu pages; magazine alloc hits %llu misses %llu, free hits %llu misses %llu\n",
+	       s.active_objs, s.total_objs, s.pages,
+	       s.alloc_hits, s.alloc_misses, s.free_hits, s.free_misses);
+
+	kmem_cache_destroy(b.cache);
+	return 0;
+}
+
+/* bench six: */
+
+static void bench_six_usage(void)
+{
+	puts("bcachefs bench six - benchmark contended six locks, with and without spinning\n"
+	     "Usage: bcachefs bench six [OPTION]...\n"
+	     "\n"
+	     "Each thread repeatedly takes a random lock, holds it for a while, and\n"
+	     "drops it.\n"
+	     "\n"
+	     "Options:\n"
+	     "  -l, --locks=nr                   Number of locks (default 1)\n"
+	     "  -H, --hold=ns                    Time each lock is held for (default 1000)\n"
+	     "  -r, --read=percent               Percentage of read locks; the rest are intent\n"
+	     "  -w, --write=percent              Percentage of intent locks also taken for write\n"
+	     "  -n, --nr=nr                      Locks taken per thread (default 100k)\n"
+	     "  -t, --threads=nr                 Number of threads (default 4)\n"
+	     "  -h, --help                       Display this help and exit\n"
+	     "Report bugs to <linux-bcachefs@vger.kernel.org>");
+}
+
+struct bench_six {
+	struct six_lock		*locks;
+	unsigned		nr_locks;
+	u64			hold_ns;
+	unsigned		read_percent;
+	unsigned		write_percent;
+	u64			nr;
+	atomic_t		running;
+	struct completion	done;
+};
+
+static int bench_six_thread(void *arg)
+{
+	struct bench_six *b = arg;
+	struct rnd_state rand;
+
+	prandom_seed_state(&rand, (unsigned long) current);
+
+	for (u64 i = 0; i < b->nr; i++) {
+		struct six_lock *lock = &b->locks[prandom_u64_state(&rand) % b->nr_locks];
+		unsigned r = prandom_u64_state(&rand) % 100;
+		enum six_lock_type type = r < b->read_percent
+			? SIX_LOCK_read
+			: SIX_LOCK_intent;
+		bool write = type == SIX_LOCK_intent &&
+			prandom_u64_state(&rand) % 100 < b->write_percent;
+
+		six_lock_type(lock, type, NULL, NULL);
+		if (write)
+			six_lock_type(lock, SIX_LOCK_write, NULL, NULL);
+
+		u64 end = ktime_get_mono_fast_ns() + b->hold_ns;
+		while (ktime_get_mono_fast_ns() < end)
+			cpu_relax();
+
+		if (write)
+			six_unlock_type(lock, SIX_LOCK_write);
+		six_unlock_type(lock, type);
+	}
+
+	if (atomic_dec_and_test(&b->running))
+		complete(&b->done);
+	return 0;
+}
+
+static void bench_six_run(struct bench_six *b, unsigned nr_threads, const char *name)
+{
+	struct task_struct **threads = calloc(nr_threads, sizeof(threads[0]));
+	struct rusage start_usage, end_usage;
+
+	atomic_set(&b->running, nr_threads);
+	init_completion(&b->done);
+
+	for (unsigned i = 0; i < nr_threads; i++) {
+		threads[i] = kthread_create(bench_six_thread, b, "bench_six/%u", i);
+		if (IS_ERR(threads[i]))
+			die("error creating thread: %s", strerror(-PTR_ERR(threads[i])));
+		/* Threads exit when done, before we stop them: */
+		get_task_struct(threads[i]);
+	}
+
+	getrusage(RUSAGE_SELF, &start_usage);
+	u64 start = ktime_get_mono_fast_ns();
+
+	for (unsigned i = 0; i < nr_threads; i++)
+		wake_up_process(threads[i]);
+	wait_for_completion(&b->done);
+
+	u64 ns = ktime_get_mono_fast_ns() - start;
+	getrusage(RUSAGE_SELF, &end_usage);
+
+	for (unsigned i = 0; i < nr_threads; i++) {
+		kthread_stop(threads[i]);
+		put_task_struct(threads[i]);
+	}
+	free(threads);
+
+	bench_print_result(name, b->nr * nr_threads, 0, ns);
+	printf("%20s %10li context switches (voluntary), %li involuntary\n", "",
+	       end_usage.ru_nvcsw - start_usage.ru_nvcsw,
+	       end_usage.ru_nivcsw - start_usage.ru_nivcsw);
+}
+
+static int cmd_bench_six(int argc, char *argv[])
+{
+	static const struct option longopts[] = {
+		{ "locks",		required_argument,	NULL, 'l' },
+		{ "hold",		required_argument,	NULL, 'H' },
+		{ "read",		required_argument,	NULL, 'r' },
+		{ "write",		required_argument,	NULL, 'w' },
+		{ "nr",			required_argument,	NULL, 'n' },
+		{ "threads",		required_argument,	NULL, 't' },
+		{ "help",		no_argument,		NULL, 'h' },
+		{ NULL }
+	};
+	struct bench_six b = { .nr_locks = 1, .hold_ns = 1000, .nr = 100000 };
+	unsigned nr_threads = 4;
+	int opt;
+
+	while ((opt = getopt_long(argc, argv, "l:H:r:w:n:t:h",
+				  longopts, NULL)) != -1)
+		switch (opt) {
+		case 'l':
+			if (kstrtouint(optarg, 10, &b.nr_locks) || !b.nr_locks)
+				die("invalid nr locks %s", optarg);
+			break;
+		case 'H':
+			if (kstrtou64(optarg, 10, &b.hold_ns))
+				die("invalid hold time %s", optarg);
+			break;
+		case 'r':
+			if (kstrtouint(optarg, 10, &b.read_percent) || b.read_percent > 100)
+				die("invalid read percentage %s", optarg);
+			break;
+		case 'w':
+			if (kstrtouint(optarg, 10, &b.write_percent) || b.write_percent > 100)
+				die("invalid write percentage %s", optarg);
+			break;
+		case 'n':
+			if (bch2_strtoull_h(optarg, &b.nr))
+				die("invalid nr %s", optarg);
+			break;
+		case 't':
+			if (kstrtouint(optarg, 10, &nr_threads) || !nr_threads)
+				die("invalid nr threads %s", optarg);
+			break;
+		case 'h':
+			bench_six_usage();
+			exit(EXIT_SUCCESS);
+		}
+	args_shift(optind);
+
+	if (argc)
+		die("too many arguments");
+
+	b.locks = calloc(b.nr_locks, sizeof(b.locks[0]));
+	if (!b.locks)
+		die("%s", strerror(ENOMEM));
+	for (unsigned i = 0; i < b.nr_locks; i++)
+		six_lock_init(&b.locks[i], 0, GFP_KERNEL);
+
+	six_lock_spin = false;
+	bench_six_run(&b, nr_threads, "six (sleep)");
+
+	six_lock_spin = true;
+	bench_six_run(&b, nr_threads, "six (spin)");
+
+	for (unsigned i = 0; i < b.nr_locks; i++)
+		six_lock_exit(&b.locks[i]);
+	free(b.locks);
+	return 0;
+}
+
+/* bench checksum: */
+
+static void bench_checksum_usage(void)
+{
+	puts("bcachefs bench checksum - benchmark checksum implementations\n"
+	     "Usage: bcachefs bench checksum [OPTION]...\n"
+	     "\n"
+	     "Self tests each crc64 implementation this CPU supports, then checksums a\n"
+	     "buffer repeatedly with each, and with crc32c.\n"
+	     "\n"
+	     "Options:\n"
+	     "  -s, --size=size                  Buffer size (default 64k)\n"
+	     "  -n, --nr=nr                      Checksums per implementation (default 16k)\n"
+	     "  -h, --help                       Display this help and exit\n"
+	     "Report bugs to <linux-bcachefs@vger.kernel.org>");
+}
+
+static int cmd_bench_checksum(int argc, char *argv[])
+{
+	static const struct option longopts[] = {
+		{ "size",		required_argument,	NULL, 's' },
+		{ "nr",			required_argument,	NULL, 'n' },
+		{ "help",		no_argument,		NULL, 'h' },
+		{ NULL }
+	};
+	struct rnd_state rand;
+	u64 size = 1 << 16, nr = 1 << 14, start;
+	int opt;
+
+	while ((opt = getopt_long(argc, argv, "s:n:h",
+				  longopts, NULL)) != -1)
+		switch (opt) {
+		case 's':
+			if (bch2_strtoull_h(optarg, &size) || !size)
+				die("invalid size %s", optarg);
+			break;
+		case 'n':
+			if (bch2_strtoull_h(optarg, &nr) || !nr)
+				die("invalid nr %s", optarg);
+			break;
+		case 'h':
+			bench_checksum_usage();
+			exit(EXIT_SUCCESS);
+		}
+	args_shift(optind);
+
+	if (argc)
+		die("too many arguments");
+
+	int ret = crc64_selftest();
+	if (ret)
+		die("crc64 self test failed");
+
+	u64 *buf = xmalloc(round_up(size, sizeof(u64)));
+	prandom_seed_state(&rand, 1);
+	for (u64 i = 0; i < DIV_ROUND_UP(size, sizeof(u64)); i++)
+		buf[i] = prandom_u64_state(&rand);
+
+	for (const struct crc64_impl *i = crc64_impls; i->name; i++) {
+		char name[32];
+		u64 crc = 0;
+
+		if (!crc64_impl_supported(i))
+			continue;
+
+		start = ktime_get_mono_fast_ns();
+		for (u64 j = 0; j < nr; j++)
+			crc = i->fn(crc, buf, size);
+		*((volatile u64 *) &crc) = crc;
+
+		snprintf(name, sizeof(name), "crc64 (%s)", i->name);
+		bench_print_result(name, nr, nr * size, ktime_get_mono_fast_ns() - start);
+	}
+
+	u32 crc = 0;
+	start = ktime_get_mono_fast_ns();
+	for (u64 j = 0; j < nr; j++)
+		crc = crc32c(crc, buf, size);
+	*((volatile u32 *) &crc) = crc;
+	bench_print_result("crc32c", nr, nr * size, ktime_get_mono_fast_ns() - start);
+
+	free(buf);
+	return 0;
+}
+
+/* bench encrypt: */
+
+static void bench_encrypt_usage(void)
+{
+	puts("bcachefs bench encrypt - benchmark fused encrypt+MAC against two passes\n"
+	     "Usage: bcachefs bench encrypt [OPTION]...\n"
+	     "\n"
+	     "Encrypts and checksums a bio with chacha20/poly1305, as the write path does,\n"
+	     "then checksums and decrypts it, as the read path does: in two passes over\n"
+	     "the data, and fused into one. Checks first that both give the same result.\n"
+	     "\n"
+	     "Options:\n"
+	     "  -s, --size=size                  Bio size (default 1M)\n"
+	     "  -n, --nr=nr                      Passes per benchmark (default 1k)\n"
+	     "  -h, --help                       Display this help and exit\n"
+	     "Report bugs to <linux-bcachefs@vger.kernel.org>");
+}
+
+static struct bio *bench_encrypt_bio(void *buf, size_t size)
+{
+	struct bio *bio = bio_alloc(NULL, DIV_ROUND_UP(size, PAGE_SIZE) + 1,
+				    0, GFP_KERNEL);
+
+	bch2_bio_map(bio, buf, size);
+	return bio;
+}
+
+static int cmd_bench_encrypt(int argc, char *argv[])
+{
+	static const struct option longopts[] = {
+		{ "size",		required_argument,	NULL, 's' },
+		{ "nr",			required_argument,	NULL, 'n' },
+		{ "help",		no_argument,		NULL, 'h' },
+		{ NULL }
+	};
+	unsigned type = BCH_CSUM_chacha20_poly1305_128;
+	u64 size = 1 << 20, nr = 1 << 10, start;
+	struct rnd_state rand;
+	struct bch_csum csum, csum2;
+	struct nonce nonce;
+	int opt;
+
+	while ((opt = getopt_long(argc, argv, "s:n:h",
+				  longopts, NULL)) != -1)
+		switch (opt) {
+		case 's':
+			if (bch2_strtoull_h(optarg, &size) ||
+			    !size || size > U32_MAX ||
+			    !IS_ALIGNED(size, CHACHA_BLOCK_SIZE))
+				die("invalid size %s (must be a multiple of %u)",
+				    optarg, CHACHA_BLOCK_SIZE);
+			break;
+		case 'n':
+			if (bch2_strtoull_h(optarg, &nr) || !nr)
+				die("invalid nr %s", optarg);
+			break;
+		case 'h':
+			bench_encrypt_usage();
+			exit(EXIT_SUCCESS);
+		}
+	args_shift(optind);
+
+	if (argc)
+		die("too many arguments");
+
+	/* Just enough of a filesystem for the encryption key: */
+	struct bch_fs *c = xcalloc(1, sizeof(*c));
+	get_random_bytes(&c->chacha20_key, sizeof(c->chacha20_key));
+	c->chacha20_key_set = true;
+	get_random_bytes(&nonce, sizeof(nonce));
+
+	u64 *buf	= aligned_alloc(PAGE_SIZE, round_up(size, PAGE_SIZE));
+	u64 *buf2	= aligned_alloc(PAGE_SIZE, round_up(size, PAGE_SIZE));
+	if (!buf || !buf2)
+		die("error allocating memory");
+
+	prandom_seed_state(&rand, 1);
+	for (u64 i = 0; i < size / sizeof(u64); i++)
+		buf[i] = prandom_u64_state(&rand);
+	memcpy(buf2, buf, size);
+
+	struct bio *bio		= bench_encrypt_bio(buf, size);
+	struct bio *bio2	= bench_encrypt_bio(buf2, size);
+
+	if (bch2_encrypt_bio(c, type, nonce, bio))
+		die("error encrypting");
+	csum = bch2_checksum_bio(c, type, nonce, bio);
+
+	if (bch2_encrypt_checksum_bio(c, type, nonce, bio2, &csum2))
+		die("error encrypting");
+	if (bch2_crc_cmp(csum, csum2) || memcmp(buf, buf2, size))
+		die("fused encrypt+checksum gave a different result");
+
+	if (bch2_checksum_decrypt_bio(c, type, nonce, bio2, &csum2))
+		die("error decrypting");
+	if (bch2_crc_cmp(csum, csum2) ||
+	    bch2_encrypt_bio(c, type, nonce, bio) ||
+	    memcmp(buf, buf2, size))
+		die("fused checksum+decrypt gave a different result");
+
+	start = ktime_get_mono_fast_ns();
+	for (u64 i = 0; i < nr; i++) {
+		bch2_encrypt_bio(c, type, nonce, bio);
+		csum = bch2_checksum_bio(c, type, nonce, bio);
+	}
+	bench_print_result("encrypt, two pass", nr, nr * size, ktime_get_mono_fast_ns() - start);
+
+	start = ktime_get_mono_fast_ns();
+	for (u64 i = 0; i < nr; i++)
+		bch2_encrypt_checksum_bio(c, type, nonce, bio, &csum);
+	bench_print_result("encrypt, fused", nr, nr * size, ktime_get_mono_fast_ns() - start);
+
+	start = ktime_get_mono_fast_ns();
+	for (u64 i = 0; i < nr; i++) {
+		csum = bch2_checksum_bio(c, type, nonce, bio);
+		bch2_encrypt_bio(c, type, nonce, bio);
+	}
+	bench_print_result("decrypt, two pass", nr, nr * size, ktime_get_mono_fast_ns() - start);
+
+	start = ktime_get_mono_fast_ns();
+	for (u64 i = 0; i < nr; i++)
+		bch2_checksum_decrypt_bio(c, type, nonce, bio, &csum);
+	bench_print_result("decrypt, fused", nr, nr * size, ktime_get_mono_fast_ns() - start);
+
+	*((volatile struct bch_csum *) &csum) = csum;
+
+	bio_put(bio2);
+	bio_put(bio);
+	free(buf2);
+	free(buf);
+	free(c);
+	return 0;
+}
+
+/* bench compress: */
+
+static void bench_compress_usage(void)
+{
+	puts("bcachefs bench compress - benchmark compression context caching\n"
+	     "Usage: bcachefs bench compress [OPTION]...\n"
+	     "\n"
+	     "Compresses and decompresses extents from 4k to 128k as the IO paths do:\n"
+	     "with compression contexts cached between calls, and with the cache dropped\n"
+	     "before each call, so every call sets up a new context. Checks first that\n"
+	     "extents round trip.\n"
+	     "\n"
+	     "Options:\n"
+	     "  -c, --compression=type[:level]   Compression type (default zstd)\n"
+	     "  -s, --size=size                  Only this extent size, 4k to 1M\n"
+	     "  -n, --nr=nr                      Extents per benchmark (default 1k)\n"
+	     "  -h, --help                       Display this help and exit\n"
+	     "Report bugs to <linux-bcachefs@vger.kernel.org>");
+}
+
+struct bench_compress {
+	struct bch_fs			*c;
+	unsigned			compression_opt;
+	size_t				size;
+	struct bio			*src;
+	struct bio			*dst;
+	struct bio			*out;
+	struct bch_extent_crc_unpacked	crc;
+	u64				nr;
+	u64				*lat;
+};
+
+static int bench_lat_cmp(const void *_l, const void *_r)
+{
+	const u64 *l = _l, *r = _r;
+
+	return cmp_int(*l, *r);
+}
+
+static void bench_compress_drop_ctxs(struct bch_fs *c)
+{
+	struct shrinker *shrink = c->compress_ctx_shrink;
+	struct shrink_control sc = {
+		.gfp_mask	= GFP_KERNEL,
+		.nr_to_scan	= ULONG_MAX,
+	};
+
+	shrink->scan_objects(shrink, &sc);
+}
+
+static void bench_compress_one(struct bench_compress *b)
+{
+	size_t dst_len, src_len;
+
+	b->dst->bi_iter.bi_size = b->size;
+
+	unsigned type = bch2_bio_compress(b->c, NULL, b->dst, &dst_len,
+					  b->src, &src_len, b->compression_opt);
+	if (type == BCH_COMPRESSION_TYPE_incompressible || !type ||
+	    src_len != b->size)
+		die("error compressing");
+
+	b->crc = (struct bch_extent_crc_unpacked) {
+		.compression_type	= type,
+		.compressed_size	= dst_len >> 9,
+		.uncompressed_size	= src_len >> 9,
+		.live_size		= src_len >> 9,
+	};
+	b->dst->bi_iter.bi_size = dst_len;
+}
+
+static void bench_decompress_one(struct bench_compress *b)
+{
+	if (bch2_bio_uncompress(b->c, b->dst, b->out, b->out->bi_iter, b->crc))
+		die("error decompressing");
+}
+
+static void bench_compress_run(struct bench_compress *b, const char *op, bool cached,
+			       void (*fn)(struct bench_compress *))
+{
+	struct printbuf buf = PRINTBUF;
+	u64 total = 0;
+
+	for (u64 i = 0; i < b->nr; i++) {
+		if (!cached)
+			bench_compress_drop_ctxs(b->c);
+
+		u64 start = ktime_get_mono_fast_ns();
+		fn(b);
+		b->lat[i] = ktime_get_mono_fast_ns() - start;
+		total += b->lat[i];
+	}
+
+	prt_printf(&buf, "%s ", op);
+	if (IS_ALIGNED(b->size, 1024))
+		prt_printf(&buf, "%zuk", b->size >> 10);
+	else
+		prt_printf(&buf, "%zu", b->size);
+	prt_printf(&buf, " %s", cached ? "warm" : "cold");
+	bench_print_result(buf.buf, b->nr, b->nr * b->size, total);
+
+	sort(b->lat, b->nr, sizeof(b->lat[0]), bench_lat_cmp, NULL);
+
+	printbuf_reset(&buf);
+	prt_str(&buf, "  latency mean ");
+	bch2_pr_time_units(&buf, div64_u64(total, b->nr));
+	prt_str(&buf, " p50 ");
+	bch2_pr_time_units(&buf, b->lat[b->nr / 2]);
+	prt_str(&buf, " p99 ");
+	bch2_pr_time_units(&buf, b->lat[b->nr * 99 / 100]);
+	printf("%s\n", buf.buf);
+	printbuf_exit(&buf);
+}
+
+static int cmd_bench_compress(int argc, char *argv[])
+{
+	static const struct option longopts[] = {
+		{ "compression",	required_argument,	NULL, 'c' },
+		{ "size",		required_argument,	NULL, 's' },
+		{ "nr",			required_argument,	NULL, 'n' },
+		{ "help",		no_argument,		NULL, 'h' },
+		{ NULL }
+	};
+	struct bench_compress b = { .nr = 1 << 10 };
+	u64 compression_opt = bch2_compression_encode((struct bch_compression_opt) {
+		.type = BCH_COMPRESSION_OPT_zstd,
+	});
+	u64 size = 0, min_size = 4096, max_size = 128 << 10;
+	struct rnd_state rand;
+	int opt;
+
+	while ((opt = getopt_long(argc, argv, "c:s:n:h",
+				  longopts, NULL)) != -1)
+		switch (opt) {
+		case 'c':
+			if (bch2_opt_compression_parse(NULL, optarg, &compression_opt, NULL) < 0 ||
+			    !bch2_compression_decode(compression_opt).type)
+				die("invalid compression %s", optarg);
+			break;
+		case 's':
+			/*
+			 * Smaller extents of our test data don't compress by a
+			 * whole block, and would be stored uncompressed:
+			 */
+			if (bch2_strtoull_h(optarg, &size) ||
+			    size < 4096 || size > (1U << 20) || !IS_ALIGNED(size, 512))
+				die("invalid size %s (must be a multiple of 512, from 4k to 1M)",
+				    optarg);
+			min_size = max_size = size;
+			break;
+		case 'n':
+			if (bch2_strtoull_h(optarg, &b.nr) || !b.nr)
+				die("invalid nr %s", optarg);
+			break;
+		case 'h':
+			bench_compress_usage();
+			exit(EXIT_SUCCESS);
+		}
+	args_shift(optind);
+
+	if (argc)
+		die("too many arguments");
+
+	/* Just enough of a filesystem for compression: */
+	struct bch_fs *c = xcalloc(1, sizeof(*c));
+	c->opts.block_size		= 512;
+	c->opts.encoded_extent_max	= max_size;
+	c->opts.compression		= compression_opt;
+	c->counters = __alloc_percpu(sizeof(u64) * BCH_COUNTER_NR, sizeof(u64));
+	if (!c->counters || bch2_fs_compress_init(c))
+		die("error initializing compression");
+
+	b.c			= c;
+	b.compression_opt	= compression_opt;
+	b.lat			= xmalloc(b.nr * sizeof(b.lat[0]));
+
+	u8 *src = aligned_alloc(PAGE_SIZE, max_size);
+	u8 *dst = aligned_alloc(PAGE_SIZE, max_size);
+	u8 *out = aligned_alloc(PAGE_SIZE, max_size);
+	if (!src || !dst || !out)
+		die("error allocating memory");
+
+	prandom_seed_state(&rand, 1);
+	bench_fill_text(src, max_size, &rand);
+
+	for (b.size = min_size; b.size <= max_size; b.size *= 2) {
+		b.src	= bench_encrypt_bio(src, b.size);
+		b.dst	= bench_encrypt_bio(dst, b.size);
+		b.out	= bench_encrypt_bio(out, b.size);
+
+		memset(out, 0, b.size);
+		bench_compress_one(&b);
+		bench_decompress_one(&b);
+		if (memcmp(src, out, b.size))
+			die("%zu byte extent didn't round trip", b.size);
+
+		bench_compress_run(&b, "compress", false, bench_compress_one);
+		bench_compress_run(&b, "compress", true, bench_compress_one);
+		bench_compress_run(&b, "decompress", false, bench_decompress_one);
+		bench_compress_run(&b, "decompress", true, bench_decompress_one);
+
+		bio_put(b.out);
+		bio_put(b.dst);
+		bio_put(b.src);
+	}
+
+	free(out);
+	free(dst);
+	free(src);
+	free(b.lat);
+	bch2_fs_compress_exit(c);
+	free_percpu(c->counters);
+	free(c);
+	return 0;
+}
+
+/* bench journal-keys: */
+
+static void bench_journal_keys_usage(void)
+{
+	puts("bcachefs bench journal-keys - benchmark sorting journal keys, as in recovery\n"
+	     "Usage: bcachefs bench journal-keys [OPTION]...\n"
+	     "\n"
+	     "Generates journal keys as if read from a journal, then sorts them with\n"
+	     "sort() and with the parallel journal key sort, and checks they agree.\n"
+	     "\n"
+	     "Options:\n"
+	     "  -n, --nr=nr                      Number of keys (default 4M)\n"
+	     "  -p, --positions=nr               Number of distinct positions per btree (default nr / 4)\n"
+	     "  -b, --btrees=nr                  Number of btrees (default 8)\n"
+	     "  -h, --help                       Display this help and exit\n"
+	     "Report bugs to <linux-bcachefs@vger.kernel.org>");
+}
+
+/* Same as journal_sort_key_cmp(), which the recovery code used to use: */
+static int bench_journal_key_cmp(const void *_l, const void *_r)
+{
+	const struct journal_key *l = _l;
+	const struct journal_key *r = _r;
+
+	return  journal_key_cmp(l, r) ?:
+		cmp_int(l->journal_seq, r->journal_seq) ?:
+		cmp_int(l->journal_offset, r->journal_offset);
+}
+
+static int cmd_bench_journal_keys(int argc, char *argv[])
+{
+	static const struct option longopts[] = {
+		{ "nr",			required_argument,	NULL, 'n' },
+		{ "positions",		required_argument,	NULL, 'p' },
+		{ "btrees",		required_argument,	NULL, 'b' },
+		{ "help",		no_argument,		NULL, 'h' },
+		{ NULL }
+	};
+	u64 nr = 1 << 22, nr_pos = 0;
+	struct rnd_state rand;
+	unsigned nr_btrees = 8;
+	int opt;
+
+	while ((opt = getopt_long(argc, argv, "n:p:b:h",
+				  longopts, NULL)) != -1)
+		switch (opt) {
+		case 'n':
+			if (bch2_strtoull_h(optarg, &nr) || !nr || nr > U32_MAX)
+				die("invalid nr %s", optarg);
+			break;
+		case 'p':
+			if (bch2_strtoull_h(optarg, &nr_pos) || !nr_pos)
+				die("invalid nr positions %s", optarg);
+			break;
+		case 'b':
+			if (kstrtouint(optarg, 10, &nr_btrees) ||
+			    !nr_btrees || nr_btrees > BTREE_ID_NR)
+				die("invalid nr btrees %s", optarg);
+			break;
+		case 'h':
+			bench_journal_keys_usage();
+			exit(EXIT_SUCCESS);
+		}
+	args_shift(optind);
+
+	if (argc)
+		die("too many arguments");
+
+	nr_pos = nr_pos ?: max(nr / 4, 1ULL);
+
+	/* 64 keys per journal entry, 1/64th of them interior node updates: */
+	struct bkey_i *k = xcalloc(nr, sizeof(*k));
+	struct journal_keys keys = {
+		.nr	= nr,
+		.size	= nr,
+		.data	= kvmalloc_array(nr, sizeof(keys.data[0]), GFP_KERNEL),
+	};
+	if (!keys.data)
+		die("%s", strerror(ENOMEM));
+
+	prandom_seed_state(&rand, 1);
+	for (u64 i = 0; i < nr; i++) {
+		u64 pos = prandom_u64_state(&rand) % nr_pos;
+
+		bkey_init(&k[i].k);
+		k[i].k.p = SPOS(4096 + (pos >> 12), (pos & 4095) << 3, U32_MAX);
+
+		keys.data[i] = (struct journal_key) {
+			.btree_id	= prandom_u64_state(&rand) % nr_btrees,
+			.level		= !(prandom_u64_state(&rand) % 64),
+			.k		= &k[i],
+			.journal_seq	= 1 + i / 64,
+			.journal_offset	= (i % 64) * BKEY_U64s,
+		};
+	}
+
+	struct journal_key *expected = xcalloc(nr, sizeof(*expected));
+	memcpy(expected, keys.data, nr * sizeof(*expected));
+
+	u64 start = ktime_get_mono_fast_ns();
+	sort_nonatomic(expected, nr, sizeof(expected[0]), bench_journal_key_cmp, NULL);
+	bench_print_result("sort", nr, 0, ktime_get_mono_fast_ns() - start);
+
+	start = ktime_get_mono_fast_ns();
+	int ret = bch2_journal_keys_sort_parallel(&keys);
+	u64 ns = ktime_get_mono_fast_ns() - start;
+	if (ret)
+		die("parallel sort error: %s", bch2_err_str(ret));
+	bench_print_result("parallel", nr, 0, ns);
+
+	if (memcmp(expected, keys.data, nr * sizeof(*expected)))
+		die("parallel sort returned a different order");
+
+	kvfree(keys.data);
+	free(expected);
+	free(k);
+	return 0;
+}
+
+/* bench write-pipeline: */
+
+static void bench_write_pipeline_usage(void)
+{
+	puts("bcachefs bench write-pipeline - benchmark transforming extents in parallel\n"
+	     "Usage: bcachefs bench write-pipeline [OPTION]...\n"
+	     "\n"
+	     "Compresses and then checksums, or encrypts and checksums, a batch of\n"
+	     "extents as the write pipeline does, with bch2_parallel_run() on from one\n"
+	     "thread up to one per CPU. Checks that every thread count gives the same\n"
+	     "result as one.\n"
+	     "\n"
+	     "Options:\n"
+	     "  -c, --compression=type[:level]   Compression type (default zstd)\n"
+	     "  -e, --encrypt                    Encrypt with chacha20/poly1305, instead of crc32c\n"
+	     "  -s, --size=size                  Extent size (default 64k)\n"
+	     "  -n, --nr=nr                      Extents per batch (default 256)\n"
+	     "  -h, --help                       Display this help and exit\n"
+	     "Report bugs to <linux-bcachefs@vger.kernel.org>");
+}
+
+struct bench_write_pipeline_extent {
+	struct bio		*src;
+	struct bio		*dst;
+	size_t			dst_len;
+	struct bch_csum		csum;
+	int			ret;
+};
+
+struct bench_write_pipeline {
+	struct bch_parallel		parallel;
+	struct bch_fs			*c;
+	unsigned			compression_opt;
+	unsigned			csum_type;
+	size_t				size;
+	struct bench_write_pipeline_extent *e;
+};
+
+/* As write_pipeline_compress() and write_pipeline_encode(), for one extent: */
+static void bench_write_pipeline_task(struct bch_parallel *parallel, unsigned i)
+{
+	struct bench_write_pipeline *b =
+		container_of(parallel, struct bench_write_pipeline, parallel);
+	struct bench_write_pipeline_extent *e = &b->e[i];
+	struct nonce nonce = { .d[0] = i };
+	size_t src_len;
+
+	e->src->bi_iter = (struct bvec_iter) { .bi_size = b->size };
+	e->dst->bi_iter = (struct bvec_iter) { .bi_size = b->size };
+	e->dst_len = b->size;
+
+	unsigned type = b->compression_opt
+		? bch2_bio_compress(b->c, NULL, e->dst, &e->dst_len,
+				    e->src, &src_len, b->compression_opt)
+		: 0;
+	if (type == BCH_COMPRESSION_TYPE_incompressible || !type) {
+		e->dst_len = b->size;
+		bio_copy_data(e->dst, e->src);
+	}
+
+	e->dst->bi_iter = (struct bvec_iter) { .bi_size = e->dst_len };
+
+	if (bch2_csum_type_is_encryption(b->csum_type))
+		e->ret = bch2_encrypt_checksum_bio(b->c, b->csum_type, nonce,
+						   e->dst, &e->csum);
+	else
+		e->csum = bch2_checksum_bio(b->c, b->csum_type, nonce, e->dst);
+}
+
+static int cmd_bench_write_pipeline(int argc, char *argv[])
+{
+	static const struct option longopts[] = {
+		{ "compression",	required_argument,	NULL, 'c' },
+		{ "encrypt",		no_argument,		NULL, 'e' },
+		{ "size",		required_argument,	NULL, 's' },
+		{ "nr",			required_argument,	NULL, 'n' },
+		{ "help",		no_argument,		NULL, 'h' },
+		{ NULL }
+	};
+	struct bench_write_pipeline b = {
+		.csum_type	= BCH_CSUM_crc32c,
+		.size		= 64 << 10,
+	};
+	u64 compression_opt = bch2_compression_encode((struct bch_compression_opt) {
+		.type = BCH_COMPRESSION_OPT_zstd,
+	});
+	u64 size = b.size, nr = 256;
+	struct rnd_state rand;
+	int opt;
+
+	while ((opt = getopt_long(argc, argv, "c:es:n:h",
+				  longopts, NULL)) != -1)
+		switch (opt) {
+		case 'c':
+			if (bch2_opt_compression_parse(NULL, optarg, &compression_opt, NULL) < 0)
+				die("invalid compression %s", optarg);
+			break;
+		case 'e':
+			b.csum_type = BCH_CSUM_chacha20_poly1305_128;
+			break;
+		case 's':
+			if (bch2_strtoull_h(optarg, &size) ||
+			    size < 4096 || size > (1U << 20) || !IS_ALIGNED(size, 512))
+				die("invalid size %s (must be a multiple of 512, from 4k to 1M)",
+				    optarg);
+			break;
+		case 'n':
+			if (bch2_strtoull_h(optarg, &nr) || !nr || nr > U32_MAX)
+				die("invalid nr %s", optarg);
+			break;
+		case 'h':
+			bench_write_pipeline_usage();
+			exit(EXIT_SUCCESS);
+		}
+	args_shift(optind);
+
+	if (argc)
+		die("too many arguments");
+
+	b.size			= size;
+	b.compression_opt	= compression_opt;
+
+	/* Just enough of a filesystem for compression and encryption: */
+	struct bch_fs *c = xcalloc(1, sizeof(*c));
+	c->opts.block_size		= 512;
+	c->opts.encoded_extent_max	= size;
+	c->opts.compression		= compression_opt;
+	c->counters = __alloc_percpu(sizeof(u64) * BCH_COUNTER_NR, sizeof(u64));
+	if (!c->counters || bch2_fs_compress_init(c))
+		die("error initializing compression");
+	get_random_bytes(&c->chacha20_key, sizeof(c->chacha20_key));
+	c->chacha20_key_set = true;
+	b.c = c;
+
+	struct workqueue_struct *wq = alloc_workqueue("bench_write_pipeline",
+						      WQ_UNBOUND|WQ_CPU_INTENSIVE, 0);
+	u8 *src = aligned_alloc(PAGE_SIZE, nr * size);
+	u8 *dst = aligned_alloc(PAGE_SIZE, nr * size);
+	u8 *expected = xmalloc(nr * size);
+	struct bench_write_pipeline_extent *first = xcalloc(nr, sizeof(*first));
+	if (!wq || !src || !dst)
+		die("error allocating memory");
+
+	prandom_seed_state(&rand, 1);
+	bench_fill_text(src, nr * size, &rand);
+
+	b.e = xcalloc(nr, sizeof(b.e[0]));
+	for (u64 i = 0; i < nr; i++) {
+		b.e[i].src = bench_encrypt_bio(src + i * size, size);
+		b.e[i].dst = bench_encrypt_bio(dst + i * size, size);
+	}
+
+	for (unsigned threads = 1;; threads = min(threads * 2, num_online_cpus())) {
+		char name[32];
+
+		if (bch2_parallel_init(&b.parallel, wq, threads - 1, GFP_KERNEL))
+			die("error allocating memory");
+
+		u64 start = ktime_get_mono_fast_ns();
+		bch2_parallel_run(&b.parallel, bench_write_pipeline_task, nr);
+		u64 ns = ktime_get_mono_fast_ns() - start;
+
+		bch2_parallel_exit(&b.parallel);
+
+		for (u64 i = 0; i < nr; i++)
+			if (b.e[i].ret)
+				die("error encrypting: %s", bch2_err_str(b.e[i].ret));
+
+		if (threads == 1) {
+			memcpy(expected, dst, nr * size);
+			for (u64 i = 0; i < nr; i++)
+				first[i] = b.e[i];
+		} else {
+			for (u64 i = 0; i < nr; i++)
+				if (b.e[i].dst_len != first[i].dst_len ||
+				    bch2_crc_cmp(b.e[i].csum, first[i].csum) ||
+				    memcmp(dst + i * size, expected + i * size, b.e[i].dst_len))
+					die("%u threads gave a different result for extent %llu",
+					    threads, i);
+		}
+
+		snprintf(name, sizeof(name), "%u thread%s", threads, threads > 1 ? "s" : "");
+		bench_print_result(name, nr, nr * size, ns);
+
+		if (threads >= num_online_cpus())
+			break;
+	}
+
+	for (u64 i = 0; i < nr; i++) {
+		bio_put(b.e[i].dst);
+		bio_put(b.e[i].src);
+	}
+	free(b.e);
+	free(first);
+	free(expected);
+	free(dst);
+	free(src);
+	destroy_workqueue(wq);
+	bch2_fs_compress_exit(c);
+	free_percpu(c->counters);
+	free(c);
+	return 0;
+}
+
+/* bench unpack: */
+
+static void bench_unpack_usage(void)
+{
+	puts("bcachefs bench unpack - benchmark compiled bkey unpack against the generic version\n"
+	     "Usage: bcachefs bench unpack [OPTION]...\n"
+	     "\n"
+	     "Packs random extent keys with a format computed from them, as a btree\n"
+	     "node would, then unpacks them all repeatedly.\n"
+	     "\n"
+	     "Options:\n"
+	     "  -n, --nr=nr                      Number of keys (default 64k)\n"
+	     "  -p, --passes=nr                  Passes over the keys (default 100)\n"
+	     "  -h, --help                       Display this help and exit\n"
+	     "Report bugs to <linux-bcachefs@vger.kernel.org>");
+}
+
+static u64 bench_unpack_run(struct btree *b, u64 *packed, u64 nr,
+			    unsigned passes, bool compiled)
+{
+	unsigned key_u64s = b->format.key_u64s;
+	u64 sum = 0, start = ktime_get_mono_fast_ns();
+
+	for (unsigned pass = 0; pass < passes; pass++)
+		for (u64 i = 0; i < nr; i++) {
+			const struct bkey_packed *k = (void *) (packed + i * key_u64s);
+			struct bkey u;
+
+			if (compiled)
+				__bkey_unpack_key_format_checked(b, &u, k);
+			else
+				u = __bch2_bkey_unpack_key(&b->format, k);
+			sum += u.p.offset + u.size;
+		}
+
+	/* don't let the compiler throw away the unpacks: */
+	*((volatile u64 *) &sum) = sum;
+	return ktime_get_mono_fast_ns() - start;
+}
+
+static int cmd_bench_unpack(int argc, char *argv[])
+{
+	static const struct option longopts[] = {
+		{ "nr",			required_argument,	NULL, 'n' },
+		{ "passes",		required_argument,	NULL, 'p' },
+		{ "help",		no_argument,		NULL, 'h' },
+		{ NULL }
+	};
+	u64 nr = 1 << 16;
+	struct rnd_state rand;
+	unsigned passes = 100;
+	int opt;
+
+	while ((opt = getopt_long(argc, argv, "n:p:h",
+				  longopts, NULL)) != -1)
+		switch (opt) {
+		case 'n':
+			if (bch2_strtoull_h(optarg, &nr) || !nr)
+				die("invalid nr %s", optarg);
+			break;
+		case 'p':
+			if (kstrtouint(optarg, 10, &passes) || !passes)
+				die("invalid nr passes %s", optarg);
+			break;
+		case 'h':
+			bench_unpack_usage();
+			exit(EXIT_SUCCESS);
+		}
+	args_shift(optind);
+
+	if (argc)
+		die("too many arguments");
+
+	struct bkey *keys = xcalloc(nr, sizeof(keys[0]));
+	struct bkey_format_state s;
+
+	bch2_bkey_format_init(&s);
+	prandom_seed_state(&rand, 1);
+	for (u64 i = 0; i < nr; i++) {
+		bkey_init(&keys[i]);
+		keys[i].type	= KEY_TYPE_extent;
+		keys[i].size	= 1 + prandom_u64_state(&rand) % 128;
+		keys[i].p	= SPOS(4096 + prandom_u64_state(&rand) % 1024,
+				       prandom_u64_state(&rand) % (1ULL << 32),
+				       U32_MAX);
+		bch2_bkey_format_add_key(&s, &keys[i]);
+	}
+
+	struct btree *b = xcalloc(1, sizeof(*b));
+	btree_node_set_format(b, bch2_bkey_format_done(&s));
+
+	unsigned key_u64s = b->format.key_u64s;
+	u64 *packed = xcalloc(nr * key_u64s, sizeof(u64));
+
+	for (u64 i = 0; i < nr; i++)
+		if (!bch2_bkey_pack_key((void *) (packed + i * key_u64s),
+					&keys[i], &b->format))
+			die("error packing key");
+
+	bench_print_result("generic", nr * passes, 0,
+			   bench_unpack_run(b, packed, nr, passes, false));
+
+	if (!b->unpack_fn) {
+		printf("compiled unpack unavailable\n");
+		goto out;
+	}
+
+	for (u64 i = 0; i < nr; i++) {
+		const struct bkey_packed *k = (void *) (packed + i * key_u64s);
+		struct bkey u1 = __bch2_bkey_unpack_key(&b->format, k), u2;
+
+		__bkey_unpack_key_format_checked(b, &u2, k);
+		if (memcmp(&u1, &u2, sizeof(u1)))
+			die("compiled unpack returned wrong result for key %llu", i);
+	}
+
+	bench_print_result("compiled", nr * passes, 0,
+			   bench_unpack_run(b, packed, nr, passes, true));
+	printf("compiled unpack fn: %u bytes\n", b->unpack_fn_len);
+out:
+	bch2_btree_node_free_unpack(b);
+	free(b);
+	free(packed);
+	free(keys);
+	return 0;
+}
+
+static int bench_usage(void)
+{
+	puts("bcachefs bench - microbenchmarks for the userspace implementation\n"
+	     "Usage: bcachefs bench <CMD> [OPTION]...\n"
+	     "\n"
+	     "Commands:\n"
+	     "  checksum                 Benchmark checksum implementations\n"
+	     "  compress                 Benchmark compression context caching\n"
+	     "  encrypt                  Benchmark fused encryption and checksumming\n"
+	     "  io                       Benchmark the block IO backends\n"
+	     "  journal-keys             Benchmark sorting journal keys\n"
+	     "  replay                   Replay a recorded IO trace\n"
+	     "  six                      Benchmark contended six locks\n"
+	     "  slab                     Benchmark kmem_cache against malloc\n"
+	     "  unpack                   Benchmark compiled bkey unpack\n"
+	     "  write-pipeline           Benchmark transforming extents in parallel\n"
+	     "\n"
+	     "Report bugs to <linux-bcachefs@vger.kernel.org>");
+	return 0;
+}
+
+int bench_cmds(int argc, char *argv[])
+{
+	char *cmd = pop_cmd(&argc, argv);
+
+	if (argc < 1)
+		return bench_usage();
+	if (!strcmp(cmd, "checksum"))
+		return cmd_bench_checksum(argc, argv);
+	if (!strcmp(cmd, "compress"))
+		return cmd_bench_compress(argc, argv);
+	if (!strcmp(cmd, "encrypt"))
+		return cmd_bench_encrypt(argc, argv);
+	if (!strcmp(cmd, "io"))
+		return cmd_bench_io(argc, argv);
+	if (!strcmp(cmd, "journal-keys"))
+		return cmd_bench_journal_keys(argc, argv);
+	if (!strcmp(cmd, "replay"))
+		return cmd_bench_replay(argc, argv);
+	if (!strcmp(cmd, "six"))
+		return cmd_bench_six(argc, argv);
+	if (!strcmp(cmd, "slab"))
+		return cmd_bench_slab(argc, argv);
+	if (!strcmp(cmd, "unpack"))
+		return cmd_bench_unpack(argc, argv);
+	if (!strcmp(cmd, "write-pipeline"))
+		return cmd_bench_write_pipeline(argc, argv);
+
+	bench_usage();
+	return -EINVAL;
+}
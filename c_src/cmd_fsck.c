@@ -3,6 +3,9 @@
 #include <getopt.h>
 #include <sys/uio.h>
 #include <unistd.h>
+
+#include <linux/mm.h>
+
 #include "cmds.h"
 #include "libbcachefs/error.h"
 #include "libbcachefs.h"
@@ -22,6 +25,7 @@ static void fsck_usage(void)
 	     "  -f                      Force checking even if filesystem is marked clean\n"
 	     "  -r, --ratelimit_errors  Don't display more than 10 errors of a given type\n"
 	     "  -k, --kernel            Use the in-kernel fsck implementation\n"
+	     "      --memory-limit=size Keep userspace fsck memory usage under size\n"
 	     "  -v                      Be verbose\n"
 	     "  -h, --help              Display this help and exit\n"
 	     "Report bugs to <linux-bcachefs@vger.kernel.org>");
@@ -205,6 +209,7 @@ int cmd_fsck(int argc, char *argv[])
 		{ "ratelimit_errors",	no_argument,		NULL, 'r' },
 		{ "kernel",		no_argument,		NULL, 'k' },
 		{ "no-kernel",		no_argument,		NULL, 'K' },
+		{ "memory-limit",	required_argument,	NULL, 'm' },
 		{ "help",		no_argument,		NULL, 'h' },
 		{ NULL }
 	};
@@ -251,6 +256,14 @@ int cmd_fsck(int argc, char *argv[])
 		case 'K':
 			kernel = false;
 			break;
+		case 'm': {
+			u64 limit;
+
+			if (bch2_strtoull_h(optarg, &limit))
+				die("invalid memory limit %s", optarg);
+			set_memory_limit(limit);
+			break;
+		}
 		case 'v':
 			append_opt(&opts_str, "verbose");
 			break;
@@ -0,0 +1,426 @@
+#include <fnmatch.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <linux/sort.h>
+#include <linux/tracepoint.h>
+
+#include "cmds.h"
+#include "libbcachefs.h"
+
+#include "libbcachefs/darray.h"
+#include "libbcachefs/util.h"
+
+/*
+ * Reading traces recorded with BCACHEFS_TRACE: records are printed with this
+ * binary's event definitions, so events whose layout has changed since the
+ * trace was recorded can only be counted.
+ */
+
+struct trace_reader {
+	const char			*path;
+	void				*data;
+	struct trace_file_header	h;
+	struct trace_file_event		*events;
+	/* This binary's definitions, by id in the trace: NULL if unknown */
+	struct trace_event		**local;
+	DARRAY(struct trace_entry *)	entries;
+};
+
+static int trace_entry_cmp(const void *_l, const void *_r)
+{
+	const struct trace_entry *l = *((struct trace_entry **) _l);
+	const struct trace_entry *r = *((struct trace_entry **) _r);
+
+	/* Ties in file order, which is per thread record order: */
+	return cmp_int(l->time, r->time) ?:
+		cmp_int((unsigned long) l, (unsigned long) r);
+}
+
+static void trace_read(struct trace_reader *r, const char *path)
+{
+	struct stat st;
+	FILE *f = fopen(path, "r");
+
+	if (!f)
+		die("error opening %s: %m", path);
+	if (fstat(fileno(f), &st))
+		die("error statting %s: %m", path);
+
+	r->path = path;
+	r->data = malloc(max(st.st_size, 1L));
+	if (!r->data)
+		die("%s", strerror(ENOMEM));
+	if (st.st_size && fread(r->data, st.st_size, 1, f) != 1)
+		die("error reading %s: %m", path);
+	fclose(f);
+
+	void *p = r->data, *end = r->data + st.st_size;
+
+	if (end - p < sizeof(r->h))
+		die("%s: not a trace", path);
+	memcpy(&r->h, p, sizeof(r->h));
+	p += sizeof(r->h);
+
+	if (r->h.magic != TRACE_FILE_MAGIC)
+		die("%s: not a trace", path);
+	if (r->h.version != TRACE_FILE_VERSION)
+		die("%s: unsupported trace version %u", path, r->h.version);
+	if (end - p < r->h.nr_events * sizeof(r->events[0]))
+		die("%s: truncated", path);
+
+	r->events = p;
+	p += r->h.nr_events * sizeof(r->events[0]);
+
+	r->local = calloc(max(r->h.nr_events, 1U), sizeof(r->local[0]));
+	if (!r->local)
+		die("%s", strerror(ENOMEM));
+
+	for (unsigned i = 0; i < r->h.nr_events; i++) {
+		struct trace_file_event *fe = &r->events[i];
+		struct trace_event *e;
+
+		fe->system[sizeof(fe->system) - 1] = '\0';
+		fe->name[sizeof(fe->name) - 1] = '\0';
+
+		if (fe->id != i)
+			die("%s: bad event table", path);
+
+		e = trace_event_lookup(fe->system, fe->name);
+		if (e && e->size == fe->size)
+			r->local[i] = e;
+	}
+
+	while (p < end) {
+		struct trace_entry *e = p;
+
+		/* The recording process may not have exited cleanly: */
+		if (end - p < sizeof(*e) ||
+		    e->size < sizeof(*e) ||
+		    e->size > end - p) {
+			fprintf(stderr, "%s: truncated record at %zu\n",
+				path, p - r->data);
+			break;
+		}
+
+		if ((e->size & 7) ||
+		    (e->id >= r->h.nr_events &&
+		     (e->id != TRACE_ID_DROPPED || e->size < sizeof(struct trace_entry_dropped))))
+			die("%s: bad record at %zu", path, p - r->data);
+
+		if (darray_push(&r->entries, e))
+			die("%s", strerror(ENOMEM));
+		p += e->size;
+	}
+
+	sort(r->entries.data, r->entries.nr, sizeof(r->entries.data[0]),
+	     trace_entry_cmp, NULL);
+
+	trace_print_set_text_base(r->h.text_base);
+}
+
+static void trace_reader_exit(struct trace_reader *r)
+{
+	darray_exit(&r->entries);
+	free(r->local);
+	free(r->data);
+}
+
+static u64 trace_start_time(struct trace_reader *r)
+{
+	return r->entries.nr ? r->entries.data[0]->time : 0;
+}
+
+/* Globs match "system:name", or just the name: */
+static bool trace_event_matches(struct trace_file_event *e, const char *glob)
+{
+	char full[sizeof(e->system) + sizeof(e->name) + 1];
+
+	snprintf(full, sizeof(full), "%s:%s", e->system, e->name);
+
+	return !strcmp(glob, "all") ||
+		!fnmatch(glob, strchr(glob, ':') ? full : e->name, 0);
+}
+
+/* trace list: */
+
+static int cmd_trace_list(int argc, char *argv[])
+{
+	struct printbuf buf = PRINTBUF;
+
+	trace_events_list(&buf);
+	fputs(buf.buf ?: "", stdout);
+	printbuf_exit(&buf);
+	return 0;
+}
+
+/* trace print: */
+
+static void trace_print_usage(void)
+{
+	puts("bcachefs trace print - print a trace recorded with BCACHEFS_TRACE\n"
+	     "Usage: bcachefs trace print [OPTION]... <trace>\n"
+	     "\n"
+	     "Options:\n"
+	     "  -e, --events=glob                Only print events matching glob, or system:glob;\n"
+	     "                                   may be given more than once\n"
+	     "  -p, --pid=tid                    Only print events from thread tid\n"
+	     "  -h, --help                       Display this help and exit\n"
+	     "Report bugs to <linux-bcachefs@vger.kernel.org>");
+}
+
+static int cmd_trace_print(int argc, char *argv[])
+{
+	static const struct option longopts[] = {
+		{ "events",		required_argument,	NULL, 'e' },
+		{ "pid",		required_argument,	NULL, 'p' },
+		{ "help",		no_argument,		NULL, 'h' },
+		{ NULL }
+	};
+	DARRAY(const char *) globs = {};
+	struct trace_reader r = {};
+	struct printbuf buf = PRINTBUF;
+	unsigned pid = 0;
+	int opt;
+
+	while ((opt = getopt_long(argc, argv, "e:p:h",
+				  longopts, NULL)) != -1)
+		switch (opt) {
+		case 'e':
+			if (darray_push(&globs, optarg))
+				die("%s", strerror(ENOMEM));
+			break;
+		case 'p':
+			if (kstrtouint(optarg, 10, &pid) || !pid)
+				die("invalid tid %s", optarg);
+			break;
+		case 'h':
+			trace_print_usage();
+			exit(EXIT_SUCCESS);
+		}
+	args_shift(optind);
+
+	char *path = arg_pop();
+	if (!path)
+		die("Please supply a trace file");
+
+	trace_read(&r, path);
+
+	bool *want = calloc(max(r.h.nr_events, 1U), sizeof(bool));
+	if (!want)
+		die("%s", strerror(ENOMEM));
+
+	for (unsigned i = 0; i < r.h.nr_events; i++) {
+		want[i] = !globs.nr;
+		darray_for_each(globs, g)
+			want[i] |= trace_event_matches(&r.events[i], *g);
+	}
+
+	u64 start = trace_start_time(&r);
+
+	darray_for_each(r.entries, i) {
+		struct trace_entry *e = *i;
+
+		if (pid && e->pid != pid)
+			continue;
+
+		if (e->id == TRACE_ID_DROPPED) {
+			if (globs.nr)
+				continue;
+		} else if (!want[e->id]) {
+			continue;
+		}
+
+		u64 t = e->time - start;
+
+		printbuf_reset(&buf);
+		prt_printf(&buf, "%6llu.%06llu %7u ",
+			   t / NSEC_PER_SEC, (t % NSEC_PER_SEC) / NSEC_PER_USEC, e->pid);
+
+		if (e->id == TRACE_ID_DROPPED) {
+			prt_printf(&buf, "dropped %llu events",
+				   ((struct trace_entry_dropped *) e)->nr);
+		} else {
+			struct trace_file_event *fe = &r.events[e->id];
+			struct trace_event *local = r.local[e->id];
+
+			prt_printf(&buf, "%s:%s: ", fe->system, fe->name);
+			if (local)
+				local->print(&buf, e);
+			else
+				prt_str(&buf, "(unknown event format)");
+		}
+
+		puts(buf.buf);
+	}
+
+	printbuf_exit(&buf);
+	free(want);
+	darray_exit(&globs);
+	trace_reader_exit(&r);
+	return 0;
+}
+
+/* trace stats: */
+
+struct trace_thread_stats {
+	u32			pid;
+	u64			nr;
+	u64			dropped;
+};
+
+struct trace_event_stats {
+	struct trace_file_event	*e;
+	u64			nr;
+};
+
+static int trace_event_stats_cmp(const void *_l, const void *_r)
+{
+	const struct trace_event_stats *l = _l, *r = _r;
+
+	return -cmp_int(l->nr, r->nr);
+}
+
+static int trace_thread_stats_cmp(const void *_l, const void *_r)
+{
+	const struct trace_thread_stats *l = _l, *r = _r;
+
+	return -cmp_int(l->nr, r->nr) ?: cmp_int(l->pid, r->pid);
+}
+
+static void trace_stats_usage(void)
+{
+	puts("bcachefs trace stats - summarize a trace recorded with BCACHEFS_TRACE\n"
+	     "Usage: bcachefs trace stats <trace>\n"
+	     "\n"
+	     "Options:\n"
+	     "  -h, --help                       Display this help and exit\n"
+	     "Report bugs to <linux-bcachefs@vger.kernel.org>");
+}
+
+static int cmd_trace_stats(int argc, char *argv[])
+{
+	static const struct option longopts[] = {
+		{ "help",		no_argument,		NULL, 'h' },
+		{ NULL }
+	};
+	DARRAY(struct trace_thread_stats) threads = {};
+	struct trace_reader r = {};
+	struct printbuf buf = PRINTBUF;
+	u64 nr = 0, dropped = 0;
+	int opt;
+
+	while ((opt = getopt_long(argc, argv, "h",
+				  longopts, NULL)) != -1)
+		switch (opt) {
+		case 'h':
+			trace_stats_usage();
+			exit(EXIT_SUCCESS);
+		}
+	args_shift(optind);
+
+	char *path = arg_pop();
+	if (!path)
+		die("Please supply a trace file");
+
+	trace_read(&r, path);
+
+	struct trace_event_stats *events = calloc(max(r.h.nr_events, 1U), sizeof(*events));
+	if (!events)
+		die("%s", strerror(ENOMEM));
+
+	for (unsigned i = 0; i < r.h.nr_events; i++)
+		events[i].e = &r.events[i];
+
+	darray_for_each(r.entries, i) {
+		struct trace_entry *e = *i;
+		struct trace_thread_stats *t;
+
+		darray_for_each(threads, t2)
+			if (t2->pid == e->pid) {
+				t = t2;
+				goto found;
+			}
+
+		if (darray_push(&threads, ((struct trace_thread_stats) { .pid = e->pid })))
+			die("%s", strerror(ENOMEM));
+		t = &darray_last(threads);
+found:
+		if (e->id == TRACE_ID_DROPPED) {
+			u64 d = ((struct trace_entry_dropped *) e)->nr;
+
+			t->dropped	+= d;
+			dropped		+= d;
+		} else {
+			events[e->id].nr++;
+			t->nr++;
+			nr++;
+		}
+	}
+
+	u64 duration = r.entries.nr
+		? darray_last(r.entries)->time - trace_start_time(&r)
+		: 0;
+
+	prt_printf(&buf, "%llu events, %llu dropped, over ", nr, dropped);
+	bch2_pr_time_units(&buf, duration);
+	puts(buf.buf);
+
+	sort(events, r.h.nr_events, sizeof(events[0]), trace_event_stats_cmp, NULL);
+
+	printf("\n%12s %12s  %s\n", "events", "per sec", "event");
+	for (unsigned i = 0; i < r.h.nr_events && events[i].nr; i++)
+		printf("%12llu %12llu  %s:%s\n",
+		       events[i].nr,
+		       div64_u64(events[i].nr * NSEC_PER_SEC, max(duration, 1ULL)),
+		       events[i].e->system, events[i].e->name);
+
+	sort(threads.data, threads.nr, sizeof(threads.data[0]), trace_thread_stats_cmp, NULL);
+
+	printf("\n%12s %12s %12s\n", "tid", "events", "dropped");
+	darray_for_each(threads, t)
+		printf("%12u %12llu %12llu\n", t->pid, t->nr, t->dropped);
+
+	printbuf_exit(&buf);
+	free(events);
+	darray_exit(&threads);
+	trace_reader_exit(&r);
+	return 0;
+}
+
+static int trace_usage(void)
+{
+	puts("bcachefs trace - read traces of bcachefs events\n"
+	     "Usage: bcachefs trace <CMD> [OPTION]...\n"
+	     "\n"
+	     "Traces are recorded by running any bcachefs command with BCACHEFS_TRACE=<file>,\n"
+	     "and optionally BCACHEFS_TRACE_EVENTS=<glob>[,<glob>...] - by default all events\n"
+	     "are recorded.\n"
+	     "\n"
+	     "Commands:\n"
+	     "  list                     List available events\n"
+	     "  print                    Print a trace, in time order\n"
+	     "  stats                    Event counts and rates, per event and per thread\n"
+	     "\n"
+	     "Report bugs to <linux-bcachefs@vger.kernel.org>");
+	return 0;
+}
+
+int trace_cmds(int argc, char *argv[])
+{
+	char *cmd = pop_cmd(&argc, argv);
+
+	if (argc < 1)
+		return trace_usage();
+	if (!strcmp(cmd, "list"))
+		return cmd_trace_list(argc, argv);
+	if (!strcmp(cmd, "print"))
+		return cmd_trace_print(argc, argv);
+	if (!strcmp(cmd, "stats"))
+		return cmd_trace_stats(argc, argv);
+
+	trace_usage();
+	return -EINVAL;
+}
@@ -33,6 +33,9 @@ int cmd_dump(int argc, char *argv[]);
 int cmd_list_journal(int argc, char *argv[]);
 int cmd_kill_btree_node(int argc, char *argv[]);
 
+int bench_cmds(int argc, char *argv[]);
+int trace_cmds(int argc, char *argv[]);
+
 int cmd_migrate(int argc, char *argv[]);
 int cmd_migrate_superblock(int argc, char *argv[]);
 
@@ -58,6 +58,13 @@ static inline void chacha20_crypt(u32 *state, u8 *dst, const u8 *src,
 						iv[0] | ((u64) iv[1] << 32),
 						(void *) key);
 	BUG_ON(ret);
+
+	/*
+	 * Like the kernel's chacha_crypt(), advance the block counter so that
+	 * the next call continues the keystream - callers encrypt a bio one
+	 * segment at a time:
+	 */
+	iv[0] += DIV_ROUND_UP(bytes, CHACHA_BLOCK_SIZE);
 }
 
 #endif
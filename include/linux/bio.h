@@ -28,6 +28,7 @@
 #include <linux/blk_types.h>
 #include <linux/workqueue.h>
 
+#define bio_dev(bio)			(bio)->bi_bdev->bd_dev
 #define bio_prio(bio)			(bio)->bi_ioprio
 #define bio_set_prio(bio, prio)		((bio)->bi_ioprio = prio)
 
@@ -12,9 +12,11 @@
 #include <linux/kobject.h>
 #include <linux/mutex.h>
 #include <linux/rwsem.h>
+#include <linux/spinlock.h>
 
 struct bio_set;
 struct bio;
+struct io_sched;
 typedef void (bio_end_io_t) (struct bio *);
 
 #define BDEVNAME_SIZE	32
@@ -44,6 +46,19 @@ struct inode {
 
 struct request_queue {
 	struct backing_dev_info *backing_dev_info;
+	void			*queuedata;	/* IO backend private */
+	struct io_sched		*sched;
+	unsigned		nr_requests;
+	unsigned		max_discard_sectors;
+
+	/*
+	 * Flush sequencing: bios waiting on the flush in flight, and bios that
+	 * arrived after it was issued and need the next one:
+	 */
+	spinlock_t		flush_lock;
+	bool			flush_in_flight;
+	struct bio		*flush_running;
+	struct bio		*flush_pending;
 };
 
 struct gendisk {
@@ -66,6 +81,8 @@ struct block_device {
 	struct gendisk *	bd_disk;
 	struct gendisk		__bd_disk;
 	int			bd_fd;
+	int			bd_fixed_fd;	/* io_uring registered file, or -1 */
+	unsigned		bd_trace_idx;
 
 	struct mutex		bd_holder_lock;
 };
@@ -243,6 +260,7 @@ enum req_flag_bits {
 #define REQ_SYNC		(1ULL << __REQ_SYNC)
 #define REQ_META		(1ULL << __REQ_META)
 #define REQ_PRIO		(1ULL << __REQ_PRIO)
+#define REQ_BACKGROUND		(1ULL << __REQ_BACKGROUND)
 
 #define REQ_NOMERGE_FLAGS	(REQ_PREFLUSH | REQ_FUA)
 
@@ -23,8 +23,13 @@ struct user_namespace;
 #define MINOR(dev)	((unsigned int) ((dev) & MINORMASK))
 #define MKDEV(ma,mi)	(((ma) << MINORBITS) | (mi))
 
+struct path {
+	struct dentry		*dentry;
+};
+
 struct file {
 	struct inode		*f_inode;
+	struct path		f_path;
 };
 
 static inline struct inode *file_inode(const struct file *f)
@@ -42,6 +47,61 @@ static inline void submit_bio(struct bio *bio)
 	generic_make_request(bio);
 }
 
+/*
+ * While plugged, submitted reads and writes are held on the plug so adjacent
+ * ones can be merged, and the IO backend may hold onto what it's been given and
+ * submit it all at once when unplugged; also flushed if we block in schedule()
+ * or on a sleeping lock:
+ */
+struct blk_plug {
+	struct bio	*bios;
+	unsigned short	nr_bios;
+	unsigned short	nr_ios;
+};
+
+void blk_start_plug(struct blk_plug *);
+void blk_flush_plug(struct blk_plug *, bool);
+void blk_finish_plug(struct blk_plug *);
+
+struct blk_plug_stats {
+	u64		plugged;	/* bios held on a plug */
+	u64		merged;		/* bios merged into an adjacent bio's request */
+};
+
+void blk_plug_stats(struct blk_plug_stats *);
+
+/*
+ * IO trace format, written with BCACHEFS_IO_TRACE=<file>: a header followed by
+ * records in completion order, in native byte order. Device records give the
+ * path of each device as it's opened, in a payload of @bytes following the
+ * record; devices are numbered in the order they were opened.
+ */
+#define BLK_TRACE_MAGIC		0x62636866737472ULL	/* "bchfstr" */
+#define BLK_TRACE_VERSION	1
+
+struct blk_trace_header {
+	u64		magic;
+	u32		version;
+	u32		rec_size;
+};
+
+enum blk_trace_type {
+	BLK_TRACE_IO,
+	BLK_TRACE_DEV,
+};
+
+struct blk_trace_rec {
+	u64		submit_ns;	/* since start of trace */
+	u64		complete_ns;
+	u64		sector;
+	u32		bytes;
+	u32		opf;
+	u32		tid;
+	u16		dev;
+	u8		status;
+	u8		type;
+};
+
 int blkdev_issue_discard(struct block_device *, sector_t, sector_t, gfp_t);
 int blkdev_issue_zeroout(struct block_device *, sector_t, sector_t, gfp_t, unsigned);
 
@@ -58,7 +118,7 @@ int blkdev_issue_zeroout(struct block_device *, sector_t, sector_t, gfp_t, unsig
 #define PAGE_SECTORS		(1 << PAGE_SECTORS_SHIFT)
 #define SECTOR_MASK		(PAGE_SECTORS - 1)
 
-#define bdev_max_discard_sectors(bdev)	((void) (bdev), 0)
+#define bdev_max_discard_sectors(bdev)	READ_ONCE(bdev_get_queue(bdev)->max_discard_sectors)
 #define blk_queue_nonrot(q)		((void) (q), 0)
 
 unsigned bdev_logical_block_size(struct block_device *bdev);
@@ -81,7 +141,14 @@ struct file *bdev_file_open_by_path(const char *, blk_mode_t, void *,
 				    const struct blk_holder_ops *);
 int lookup_bdev(const char *path, dev_t *);
 
+/* Userspace IO backend selection (uring, aio, sync): */
+int blkdev_set_backend(const char *);
+const char *blkdev_backend_name(void);
+int blkdev_register_buffer(void *, size_t);
+void blkdev_unregister_buffer(void *);
+
 struct super_block {
+	dev_t			s_dev;
 	void			*s_fs_info;
 	struct rw_semaphore	s_umount;
 };
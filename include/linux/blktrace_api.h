@@ -0,0 +1,42 @@
+#ifndef __TOOLS_LINUX_BLKTRACE_API_H
+#define __TOOLS_LINUX_BLKTRACE_API_H
+
+#include <linux/blk_types.h>
+#include <linux/blkdev.h>
+
+/* Describe a bio's op and flags for tracing - at most 5 chars + nul: */
+static inline void blk_fill_rwbs(char *rwbs, blk_opf_t opf)
+{
+	int i = 0;
+
+	if (opf & REQ_PREFLUSH)
+		rwbs[i++] = 'F';
+
+	switch (opf & REQ_OP_MASK) {
+	case REQ_OP_WRITE:
+		rwbs[i++] = 'W';
+		break;
+	case REQ_OP_DISCARD:
+	case REQ_OP_SECURE_ERASE:
+		rwbs[i++] = 'D';
+		break;
+	case REQ_OP_FLUSH:
+		rwbs[i++] = 'F';
+		break;
+	case REQ_OP_READ:
+		rwbs[i++] = 'R';
+		break;
+	default:
+		rwbs[i++] = 'N';
+	}
+
+	if (opf & REQ_FUA)
+		rwbs[i++] = 'F';
+	if (opf & REQ_SYNC)
+		rwbs[i++] = 'S';
+	if (opf & REQ_META)
+		rwbs[i++] = 'M';
+	rwbs[i] = '\0';
+}
+
+#endif /* __TOOLS_LINUX_BLKTRACE_API_H */
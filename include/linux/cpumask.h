@@ -1,23 +1,52 @@
 #ifndef __LINUX_CPUMASK_H
 #define __LINUX_CPUMASK_H
 
-#define num_online_cpus()	1U
-#define num_possible_cpus()	1U
-#define num_present_cpus()	1U
-#define num_active_cpus()	1U
-#define cpu_online(cpu)		((cpu) == 0)
-#define cpu_possible(cpu)	((cpu) == 0)
-#define cpu_present(cpu)	((cpu) == 0)
-#define cpu_active(cpu)		((cpu) == 0)
+#include <sched.h>
 
-#define raw_smp_processor_id()	0U
+#include <linux/compiler.h>
+
+/* Set up at startup by linux/percpu.c; we don't do CPU hotplug: */
+extern unsigned nr_cpu_ids;
+extern unsigned __num_online_cpus;
+
+/* CPU whose percpu data we're pinned to by preempt_disable(), or -1: */
+extern __thread int __preempt_cpu;
+
+#define num_online_cpus()	__num_online_cpus
+#define num_possible_cpus()	nr_cpu_ids
+#define num_present_cpus()	nr_cpu_ids
+#define num_active_cpus()	__num_online_cpus
+#define cpu_online(cpu)		((unsigned) (cpu) < nr_cpu_ids)
+#define cpu_possible(cpu)	((unsigned) (cpu) < nr_cpu_ids)
+#define cpu_present(cpu)	((unsigned) (cpu) < nr_cpu_ids)
+#define cpu_active(cpu)		((unsigned) (cpu) < nr_cpu_ids)
+
+/*
+ * sched_getcpu() reads the rseq area on recent glibc, so this is cheap; inside
+ * preempt_disable() we keep using the CPU we were on when it was called, even
+ * if we've since migrated:
+ */
+static inline unsigned raw_smp_processor_id(void)
+{
+	int cpu = __preempt_cpu;
+
+	if (cpu < 0) {
+		cpu = sched_getcpu();
+		if (unlikely((unsigned) cpu >= nr_cpu_ids))
+			cpu = cpu < 0 ? 0 : cpu % nr_cpu_ids;
+	}
+
+	return cpu;
+}
+
+#define smp_processor_id()	raw_smp_processor_id()
 
 #define for_each_cpu(cpu, mask)			\
-	for ((cpu) = 0; (cpu) < 1; (cpu)++, (void)mask)
+	for ((cpu) = 0; (cpu) < nr_cpu_ids; (cpu)++, (void)mask)
 #define for_each_cpu_not(cpu, mask)		\
-	for ((cpu) = 0; (cpu) < 1; (cpu)++, (void)mask)
+	for ((cpu) = 0; (cpu) < nr_cpu_ids; (cpu)++, (void)mask)
 #define for_each_cpu_and(cpu, mask, and)	\
-	for ((cpu) = 0; (cpu) < 1; (cpu)++, (void)mask, (void)and)
+	for ((cpu) = 0; (cpu) < nr_cpu_ids; (cpu)++, (void)mask, (void)and)
 
 #define for_each_possible_cpu(cpu) for_each_cpu((cpu), 1)
 #define for_each_online_cpu(cpu)   for_each_cpu((cpu), 1)
@@ -8,4 +8,24 @@
 #include <linux/types.h>
 
 u64 __pure crc64_be(u64 crc, const void *p, size_t len);
+
+/*
+ * Userspace: crc64_be() uses the fastest of these the CPU supports; they're
+ * exposed for testing and benchmarking:
+ */
+struct crc64_impl {
+	const char	*name;
+	u64		(*fn)(u64, const void *, size_t);
+	bool		(*supported)(void);
+};
+
+extern const struct crc64_impl crc64_impls[];
+
+static inline bool crc64_impl_supported(const struct crc64_impl *i)
+{
+	return !i->supported || i->supported();
+}
+
+int crc64_selftest(void);
+
 #endif /* _LINUX_CRC64_H */
@@ -7,8 +7,14 @@ struct inode;
 struct dentry {
 	struct super_block *d_sb;
 	struct inode *d_inode;
+	struct dentry *d_parent;
 };
 
+static inline struct inode *d_inode(const struct dentry *dentry)
+{
+	return dentry->d_inode;
+}
+
 static inline void shrink_dcache_sb(struct super_block *sb) {}
 
 #define QSTR_INIT(n,l) { { { .len = l } }, .name = n }
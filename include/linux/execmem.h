@@ -0,0 +1,28 @@
+#ifndef __TOOLS_LINUX_EXECMEM_H
+#define __TOOLS_LINUX_EXECMEM_H
+
+#include <linux/types.h>
+
+/*
+ * Executable memory for generated code: execmem_alloc() returns memory that's
+ * mapped read/execute only - it's written with text_poke_copy(), through a
+ * second, writable mapping of the same pages, so nothing is ever mapped both
+ * writable and executable.
+ *
+ * Allocations are up to a page; returns NULL if executable memory isn't
+ * available (e.g. memfd_create() or PROT_EXEC mappings are blocked by policy),
+ * so users must have a fallback.
+ */
+
+enum execmem_type {
+	EXECMEM_DEFAULT,
+	EXECMEM_TYPE_MAX,
+};
+
+void *execmem_alloc(enum execmem_type, size_t);
+void execmem_free(void *);
+
+/* In the kernel this is in asm/text-patching.h: */
+void *text_poke_copy(void *, const void *, size_t);
+
+#endif /* __TOOLS_LINUX_EXECMEM_H */
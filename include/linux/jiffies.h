@@ -86,6 +86,16 @@ static inline u64 ktime_get_ns(void)
 	return sched_clock();
 }
 
+/* sched_clock() is coarse; for timing short intervals: */
+static inline u64 ktime_get_mono_fast_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((s64) ts.tv_sec * NSEC_PER_SEC) + ts.tv_nsec;
+}
+
 #define jiffies			nsecs_to_jiffies(sched_clock())
 
 #endif
@@ -122,8 +122,14 @@
 
 #define might_sleep()
 
+#if defined(__x86_64__) || defined(__i386__)
+#define cpu_relax()		asm volatile("pause" ::: "memory")
+#elif defined(__aarch64__)
+#define cpu_relax()		asm volatile("yield" ::: "memory")
+#else
 #define cpu_relax()		barrier()
-#define cpu_relax_lowlatency()	barrier()
+#endif
+#define cpu_relax_lowlatency()	cpu_relax()
 
 #define panic(fmt, ...)					\
 do {							\
@@ -7,4 +7,4 @@
 
 #define LZ4_MEM_COMPRESS 0
 #define LZ4HC_MEM_COMPRESS 0
-#define LZ4HC_MIN_CLEVEL 0
+#define LZ4HC_MIN_CLEVEL 3
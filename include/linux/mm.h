@@ -24,10 +24,10 @@ struct sysinfo {
 };
 
 
+/* linux/shrinker.c: totalram and freeram reflect cgroup and explicit limits */
+void si_meminfo(struct sysinfo *);
 
-static inline void si_meminfo(struct sysinfo *val)
-{
-	BUG_ON(syscall(SYS_sysinfo, val));
-}
+/* Limit for our RSS, for the shrinkers to aim for; 0 for none */
+void set_memory_limit(u64);
 
 #endif /* _TOOLS_LINUX_MM_H */
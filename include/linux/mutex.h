@@ -10,8 +10,15 @@ struct mutex {
 #define DEFINE_MUTEX(mutexname) \
 	struct mutex mutexname = { .lock = PTHREAD_MUTEX_INITIALIZER }
 
+void __mutex_lock_slowpath(struct mutex *);
+
+static inline void mutex_lock(struct mutex *lock)
+{
+	if (pthread_mutex_trylock(&lock->lock))
+		__mutex_lock_slowpath(lock);
+}
+
 #define mutex_init(l)		pthread_mutex_init(&(l)->lock, NULL)
-#define mutex_lock(l)		pthread_mutex_lock(&(l)->lock)
 #define mutex_trylock(l)	(!pthread_mutex_trylock(&(l)->lock))
 #define mutex_unlock(l)		pthread_mutex_unlock(&(l)->lock)
 
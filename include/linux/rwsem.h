@@ -18,12 +18,25 @@ static inline void init_rwsem(struct rw_semaphore *lock)
 	pthread_rwlock_init(&lock->lock, NULL);
 }
 
-#define down_read(l)		pthread_rwlock_rdlock(&(l)->lock)
-#define down_read_killable(l)	(pthread_rwlock_rdlock(&(l)->lock), 0)
+void __down_read_slowpath(struct rw_semaphore *);
+void __down_write_slowpath(struct rw_semaphore *);
+
+static inline void down_read(struct rw_semaphore *sem)
+{
+	if (pthread_rwlock_tryrdlock(&sem->lock))
+		__down_read_slowpath(sem);
+}
+
+static inline void down_write(struct rw_semaphore *sem)
+{
+	if (pthread_rwlock_trywrlock(&sem->lock))
+		__down_write_slowpath(sem);
+}
+
+#define down_read_killable(l)	(down_read(l), 0)
 #define down_read_trylock(l)	(!pthread_rwlock_tryrdlock(&(l)->lock))
 #define up_read(l)		pthread_rwlock_unlock(&(l)->lock)
 
-#define down_write(l)		pthread_rwlock_wrlock(&(l)->lock)
 #define up_write(l)		pthread_rwlock_unlock(&(l)->lock)
 
 #endif /* __TOOLS_LINUX_RWSEM_H */
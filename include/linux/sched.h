@@ -88,11 +88,12 @@ struct task_struct {
 
 	unsigned		flags;
 
-	bool			on_cpu;
+	bool			on_cpu;	/* not blocked; see schedule() */
 	char			comm[TASK_COMM_LEN];
 	pid_t			pid;
 
 	struct bio_list		*bio_list;
+	struct blk_plug		*plug;
 
 	struct signal_struct	{
 		struct rw_semaphore exec_update_lock;
@@ -133,6 +134,16 @@ static inline void put_task_struct(struct task_struct *t)
 static inline void cond_resched(void) {}
 #define need_resched()	0
 
+/*
+ * We can't see if a thread is actually on a CPU, only whether it's blocked in
+ * schedule() or a sleeping lock - close enough for optimistic spinning:
+ */
+static inline bool owner_on_cpu(struct task_struct *owner)
+{
+	return READ_ONCE(owner->on_cpu);
+}
+
+void sched_flush_plug(void);
 void schedule(void);
 
 #define	MAX_SCHEDULE_TIMEOUT	LONG_MAX
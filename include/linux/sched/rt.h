@@ -6,4 +6,9 @@ static inline int rt_task(struct task_struct *p)
 	return 0;
 }
 
+static inline bool rt_or_dl_task(struct task_struct *p)
+{
+	return false;
+}
+
 #endif /* _SCHED_RT_H */
@@ -23,6 +23,12 @@ struct shrinker {
 	long batch;	/* reclaim batch size, 0 = default */
 	struct list_head list;
 	void	*private_data;
+
+	char	name[32];
+	/* protected by shrinker_lock: */
+	u64	nr_runs;
+	u64	nr_scanned;
+	u64	nr_freed;
 };
 
 void shrinker_free(struct shrinker *);
@@ -31,5 +37,6 @@ struct shrinker *shrinker_alloc(unsigned int, const char *, ...);
 int shrinker_register(struct shrinker *);
 
 void run_shrinkers(gfp_t gfp_mask, bool);
+void shrinkers_to_text(struct seq_buf *);
 
 #endif /* __TOOLS_LINUX_SHRINKER_H */
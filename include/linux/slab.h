@@ -23,6 +23,29 @@
 
 #define MAX_PAGE_ORDER			10
 
+/* linux/page_alloc.c: */
+extern void *page_pool_base;
+extern size_t page_pool_size;
+
+static inline bool page_pool_owns(const void *p)
+{
+	return (unsigned long) p - (unsigned long) page_pool_base < page_pool_size;
+}
+
+size_t page_pool_alloc_size(const void *);
+void page_pool_free(const void *);
+
+struct page *alloc_pages_noprof(gfp_t, unsigned int);
+void __free_pages(struct page *, unsigned int);
+
+static inline void kfree(const void *p)
+{
+	if (unlikely(page_pool_owns(p)))
+		page_pool_free(p);
+	else
+		free((void *) p);
+}
+
 static inline size_t kmalloc_size_roundup(size_t s)
 {
 	return roundup_pow_of_two(s);
@@ -69,10 +92,12 @@ static inline void *krealloc(void *old, size_t size, gfp_t flags)
 		memset(new, 0, size);
 
 	if (old) {
-		memcpy(new, old,
-		       min(malloc_usable_size(old),
-			   malloc_usable_size(new)));
-		free(old);
+		size_t old_size = page_pool_owns(old)
+			? page_pool_alloc_size(old)
+			: malloc_usable_size(old);
+
+		memcpy(new, old, min(old_size, malloc_usable_size(new)));
+		kfree(old);
 	}
 
 	return new;
@@ -101,7 +126,7 @@ static inline void *kmalloc_array(size_t n, size_t size, gfp_t flags)
 
 #define kvmalloc_array(n, size, flags)					\
 	((size) != 0 && (n) > SIZE_MAX / (size)				\
-	 ? NULL : kmalloc((n) * (size), flags))
+	 ? NULL : kvmalloc((n) * (size), flags))
 
 #define kvcalloc(n, size, flags)	kvmalloc_array(n, size, flags|__GFP_ZERO)
 
@@ -109,34 +134,30 @@ static inline void *kmalloc_array(size_t n, size_t size, gfp_t flags)
 
 #define kcalloc(n, size, flags)		kmalloc_array(n, size, flags|__GFP_ZERO)
 
-#define kfree(p)			free((void *) p)
-#define kzfree(p)			free((void *) p)
+#define kzfree(p)			kfree(p)
 
-#define kvmalloc(size, flags)		kmalloc(size, flags)
-#define kvmalloc_noprof(size, flags)	kmalloc(size, flags)
-#define kvzalloc(size, flags)		kzalloc(size, flags)
-#define kvfree(p)			kfree(p)
+/*
+ * Large allocations come from the page pool, as vmalloc() would in the kernel,
+ * when rounding up to a power of two pages doesn't waste too much:
+ */
+#define KVMALLOC_PAGE_POOL_MIN		(64UL << 10)
 
-static inline struct page *alloc_pages_noprof(gfp_t flags, unsigned int order)
+static inline void *kvmalloc_noprof(size_t size, gfp_t flags)
 {
-	size_t size = PAGE_SIZE << order;
-	unsigned i;
-	void *p;
-
-	for (i = 0; i < 10; i++) {
-		p = aligned_alloc(PAGE_SIZE, size);
-
-		if (p) {
-			if (flags & __GFP_ZERO)
-				memset(p, 0, size);
-			break;
-		}
+	if (size >= KVMALLOC_PAGE_POOL_MIN &&
+	    size <= PAGE_SIZE << MAX_PAGE_ORDER) {
+		unsigned order = get_order(size);
 
-		run_shrinkers(flags, true);
+		if (size > (PAGE_SIZE << order) / 4 * 3)
+			return alloc_pages_noprof(flags, order);
 	}
 
-	return p;
+	return kmalloc(size, flags);
 }
+#define kvmalloc			kvmalloc_noprof
+#define kvzalloc(size, flags)		kvmalloc(size, flags|__GFP_ZERO)
+#define kvfree(p)			kfree(p)
+
 #define alloc_pages			alloc_pages_noprof
 
 #define alloc_page(gfp)			alloc_pages(gfp, 0)
@@ -147,17 +168,7 @@ static inline struct page *alloc_pages_noprof(gfp_t flags, unsigned int order)
 					((unsigned long) alloc_pages(gfp, order))
 #define __get_free_page(gfp)		__get_free_pages(gfp, 0)
 
-#define __free_pages(page, order)			\
-do {							\
-	(void) order;					\
-	free(page);					\
-} while (0)
-
-#define free_pages(addr, order)				\
-do {							\
-	(void) order;					\
-	free((void *) (addr));				\
-} while (0)
+#define free_pages(addr, order)		__free_pages((struct page *) (addr), order)
 
 #define __free_page(page) __free_pages((page), 0)
 #define free_page(addr) free_pages((addr), 0)
@@ -192,41 +203,42 @@ static inline void *kmemdup(const void *src, size_t len, gfp_t gfp)
 	return p;
 }
 
-struct kmem_cache {
-	size_t		    obj_size;
-};
+/* Flags for kmem_cache_create(): */
+#define SLAB_HWCACHE_ALIGN	((slab_flags_t) 1U << 0)
+#define SLAB_RECLAIM_ACCOUNT	((slab_flags_t) 1U << 1)
+#define SLAB_ACCOUNT		((slab_flags_t) 1U << 2)
 
-static inline void *kmem_cache_alloc(struct kmem_cache *c, gfp_t gfp)
-{
-	return kmalloc(c->obj_size, gfp);
-}
-
-static inline void *kmem_cache_zalloc(struct kmem_cache *c, gfp_t gfp)
-{
-	return kzalloc(c->obj_size, gfp);
-}
+struct kmem_cache *kmem_cache_create(const char *, unsigned, unsigned,
+				     slab_flags_t, void (*)(void *));
+void kmem_cache_destroy(struct kmem_cache *);
 
-static inline void kmem_cache_free(struct kmem_cache *c, void *p)
-{
-	kfree(p);
-}
+void *kmem_cache_alloc(struct kmem_cache *, gfp_t);
+void kmem_cache_free(struct kmem_cache *, void *);
+int kmem_cache_alloc_bulk(struct kmem_cache *, gfp_t, size_t, void **);
+void kmem_cache_free_bulk(struct kmem_cache *, size_t, void **);
 
-static inline void kmem_cache_destroy(struct kmem_cache *p)
+static inline void *kmem_cache_zalloc(struct kmem_cache *c, gfp_t gfp)
 {
-	kfree(p);
+	return kmem_cache_alloc(c, gfp|__GFP_ZERO);
 }
 
-static inline struct kmem_cache *kmem_cache_create(size_t obj_size)
-{
-	struct kmem_cache *p = kmalloc(sizeof(*p), GFP_KERNEL);
-	if (!p)
-		return NULL;
-
-	p->obj_size = obj_size;
-	return p;
-}
+#define KMEM_CACHE(_struct, _flags)					\
+	kmem_cache_create(#_struct, sizeof(struct _struct),		\
+			  __alignof__(struct _struct), (_flags), NULL)
+
+struct kmem_cache_stats {
+	u64		active_objs;	/* allocated, not yet freed */
+	u64		total_objs;	/* including free objects in slabs */
+	u64		slabs;
+	u64		pages;
+	/* per thread magazine hits and misses: */
+	u64		alloc_hits;
+	u64		alloc_misses;
+	u64		free_hits;
+	u64		free_misses;
+};
 
-#define KMEM_CACHE(_struct, _flags)	kmem_cache_create(sizeof(struct _struct))
+void kmem_cache_stats(struct kmem_cache *, struct kmem_cache_stats *);
 
 #define PAGE_KERNEL		0
 #define PAGE_KERNEL_EXEC	1
@@ -2,34 +2,110 @@
 #define __TOOLS_LINUX_SPINLOCK_H
 
 #include <linux/atomic.h>
-#include <pthread.h>
+#include <linux/compiler.h>
+#include <linux/types.h>
+
+/*
+ * Spinlocks are a single u32: spin briefly, then sleep on a futex. Unlocking
+ * only makes a syscall if someone may be sleeping.
+ *
+ * With CONFIG_SPINLOCK_STATS (make BCACHEFS_LOCK_STATS=1), locks also point to
+ * a class - one per spin_lock_init() call site - that accumulates acquisitions,
+ * contention, wait and hold times; see linux/spinlock.c.
+ */
+
+enum {
+	SPIN_UNLOCKED		= 0,
+	SPIN_LOCKED		= 1,
+	SPIN_CONTENDED		= 2,	/* locked, may have sleepers */
+};
+
+struct spinlock_class;
 
 typedef struct {
-	pthread_mutex_t lock;
+	u32			v;
+#ifdef CONFIG_SPINLOCK_STATS
+	struct spinlock_class	*class;
+	u64			acquired_ns;
+#endif
 } raw_spinlock_t;
 
-#define __RAW_SPIN_LOCK_UNLOCKED(name)	(raw_spinlock_t) { .lock = PTHREAD_MUTEX_INITIALIZER  }
+#define __RAW_SPIN_LOCK_UNLOCKED(name)	(raw_spinlock_t) { .v = SPIN_UNLOCKED }
+
+void __raw_spin_lock_slowpath(raw_spinlock_t *);
+void __raw_spin_wake(raw_spinlock_t *);
+
+static inline bool __raw_spin_trylock(raw_spinlock_t *lock)
+{
+	u32 v = SPIN_UNLOCKED;
+
+	return __atomic_compare_exchange_n(&lock->v, &v, SPIN_LOCKED, false,
+					   __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+static inline void __raw_spin_unlock(raw_spinlock_t *lock)
+{
+	if (unlikely(__atomic_exchange_n(&lock->v, SPIN_UNLOCKED,
+					 __ATOMIC_RELEASE) == SPIN_CONTENDED))
+		__raw_spin_wake(lock);
+}
+
+#ifdef CONFIG_SPINLOCK_STATS
+
+struct spinlock_class {
+	const char		*name;
+	const char		*file;
+	unsigned		line;
+	bool			registered;
+	struct spinlock_class	*next;
+	u64			acquired;
+	u64			contended;
+	u64			wait_ns;
+	u64			hold_ns;
+	u64			max_hold_ns;
+};
+
+void __raw_spin_lock_init(raw_spinlock_t *, struct spinlock_class *);
+bool raw_spin_trylock(raw_spinlock_t *);
+void raw_spin_lock(raw_spinlock_t *);
+void raw_spin_unlock(raw_spinlock_t *);
+
+#define raw_spin_lock_init(lock)					\
+do {									\
+	static struct spinlock_class __class = {			\
+		.name	= #lock,					\
+		.file	= __FILE__,					\
+		.line	= __LINE__,					\
+	};								\
+									\
+	__raw_spin_lock_init(lock, &__class);				\
+} while (0)
+
+#else
 
 static inline void raw_spin_lock_init(raw_spinlock_t *lock)
 {
-	pthread_mutex_init(&lock->lock, NULL);
+	lock->v = SPIN_UNLOCKED;
 }
 
 static inline bool raw_spin_trylock(raw_spinlock_t *lock)
 {
-	return !pthread_mutex_trylock(&lock->lock);
+	return __raw_spin_trylock(lock);
 }
 
 static inline void raw_spin_lock(raw_spinlock_t *lock)
 {
-	pthread_mutex_lock(&lock->lock);
+	if (unlikely(!__raw_spin_trylock(lock)))
+		__raw_spin_lock_slowpath(lock);
 }
 
 static inline void raw_spin_unlock(raw_spinlock_t *lock)
 {
-	pthread_mutex_unlock(&lock->lock);
+	__raw_spin_unlock(lock);
 }
 
+#endif /* CONFIG_SPINLOCK_STATS */
+
 #define raw_spin_lock_irq(lock)		raw_spin_lock(lock)
 #define raw_spin_unlock_irq(lock)	raw_spin_unlock(lock)
 
@@ -1,6 +1,101 @@
 #ifndef __TOOLS_LINUX_TRACEPOINT_H
 #define __TOOLS_LINUX_TRACEPOINT_H
 
+#include <linux/compiler.h>
+#include <linux/types.h>
+
+/*
+ * Userspace trace events: TRACE_EVENT() and friends declare trace_foo(), which
+ * is a single predicted branch while the event is disabled. The events are
+ * defined, by re-reading the event header with CREATE_TRACE_POINTS defined, in
+ * include/trace/trace_events.h; they're recorded to per thread ring buffers
+ * and written to a trace file by linux/tracepoint.c.
+ */
+
+struct printbuf;
+
+struct trace_event {
+	const char		*system;
+	const char		*name;
+	unsigned		size;	/* of the fixed part of the entry */
+	void			(*print)(struct printbuf *, const void *);
+	u16			id;
+	bool			enabled;
+};
+
+/* Header of each recorded event: */
+struct trace_entry {
+	u16			id;
+	u16			size;	/* including the header, multiple of 8 */
+	u32			pid;
+	u64			time;	/* CLOCK_MONOTONIC ns */
+};
+
+void *trace_event_reserve(struct trace_event *, size_t);
+void trace_event_commit(void *);
+
+/* Enable or disable events matching a glob, "system:glob" or "all" */
+int trace_events_enable(const char *, bool);
+/* Start recording enabled events to a file: */
+int trace_start(const char *);
+void trace_stop(void);
+
+struct trace_event *trace_event_lookup(const char *, const char *);
+void trace_events_list(struct printbuf *);
+
+/*
+ * printf for TP_printk(): also handles %pS/%ps, which are symbolized relative
+ * to the text base of the process that recorded the trace:
+ */
+__printf(2, 3)
+void trace_event_printf(struct printbuf *, const char *, ...);
+void trace_print_set_text_base(u64);
+
+struct trace_print_flags {
+	unsigned long		mask;
+	const char		*name;
+};
+
+/* __print_flags() and __print_symbolic(), into the print function's scratch buffer: */
+const char *trace_print_flags_seq(char *, unsigned *, unsigned, const char *,
+				  unsigned long, const struct trace_print_flags *);
+const char *trace_print_symbols_seq(char *, unsigned *, unsigned, unsigned long,
+				    const struct trace_print_flags *);
+
+/*
+ * Trace file format: a header, the event table, then records - each a struct
+ * trace_entry followed by the event's fields. Records are written per thread
+ * in batches, so they're only ordered by time within a thread.
+ */
+#define TRACE_FILE_MAGIC	0x62636865767473ULL	/* "bchevts" */
+#define TRACE_FILE_VERSION	1
+
+struct trace_file_header {
+	u64			magic;
+	u32			version;
+	u32			nr_events;
+	u64			text_base;
+};
+
+struct trace_file_event {
+	char			system[16];
+	char			name[48];
+	u16			id;
+	u16			size;
+	u32			pad;
+};
+
+enum {
+	TRACE_ID_DROPPED	= 0xfffe,	/* struct trace_entry_dropped */
+	TRACE_ID_PAD		= 0xffff,	/* ring buffer only */
+};
+
+/* Records lost because a thread's ring buffer was full: */
+struct trace_entry_dropped {
+	struct trace_entry	ent;
+	u64			nr;
+};
+
 #define PARAMS(args...) args
 
 #define TP_PROTO(args...)	args
@@ -49,14 +144,40 @@
 			PARAMS(void *__data, proto),			\
 			PARAMS(__data, args))
 
+#define __DECLARE_EVENT(name, proto, args)				\
+	extern struct trace_event __trace_event_##name;			\
+	void __trace_##name(proto);					\
+	static inline bool						\
+	trace_##name##_enabled(void)					\
+	{								\
+		return unlikely(READ_ONCE(__trace_event_##name.enabled)); \
+	}								\
+	static inline void trace_##name(proto)				\
+	{								\
+		if (trace_##name##_enabled())				\
+			__trace_##name(args);				\
+	}								\
+	static inline void trace_##name##_rcuidle(proto)		\
+	{								\
+		trace_##name(args);					\
+	}
+
+#endif /* __TOOLS_LINUX_TRACEPOINT_H */
+
+/*
+ * Outside the include guard: define_trace.h redefines these while defining the
+ * events, and undefines them when done.
+ */
+#ifndef TRACE_EVENT
+
 #define DECLARE_EVENT_CLASS(name, proto, args, tstruct, assign, print)
 #define DEFINE_EVENT(template, name, proto, args)		\
-	DECLARE_TRACE(name, PARAMS(proto), PARAMS(args))
+	__DECLARE_EVENT(name, PARAMS(proto), PARAMS(args))
 #define DEFINE_EVENT_FN(template, name, proto, args, reg, unreg)\
-	DECLARE_TRACE(name, PARAMS(proto), PARAMS(args))
+	__DECLARE_EVENT(name, PARAMS(proto), PARAMS(args))
 #define DEFINE_EVENT_PRINT(template, name, proto, args, print)	\
-	DECLARE_TRACE(name, PARAMS(proto), PARAMS(args))
+	__DECLARE_EVENT(name, PARAMS(proto), PARAMS(args))
 #define TRACE_EVENT(name, proto, args, struct, assign, print)	\
-	DECLARE_TRACE(name, PARAMS(proto), PARAMS(args))
+	__DECLARE_EVENT(name, PARAMS(proto), PARAMS(args))
 
-#endif /* __TOOLS_LINUX_TRACEPOINT_H */
+#endif /* TRACE_EVENT */
@@ -8,9 +8,12 @@
 
 #define zlib_inflateInit2	inflateInit2
 #define zlib_inflate		inflate
+#define zlib_inflateReset	inflateReset
+#define zlib_inflateEnd		inflateEnd
 
 #define zlib_deflateInit2	deflateInit2
 #define zlib_deflate		deflate
+#define zlib_deflateReset	deflateReset
 #define zlib_deflateEnd		deflateEnd
 
 #define DEF_MEM_LEVEL 8
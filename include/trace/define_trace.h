@@ -0,0 +1,60 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Included at the end of each trace event header: if the includer defined
+ * CREATE_TRACE_POINTS, read the header again (several times) to define the
+ * events; see trace_events.h.
+ */
+#ifdef CREATE_TRACE_POINTS
+
+/* Prevent recursion */
+#undef CREATE_TRACE_POINTS
+
+#define __TRACE_STRINGIFY(x)	#x
+#define TRACE_STRINGIFY(x)	__TRACE_STRINGIFY(x)
+
+#ifndef TRACE_INCLUDE_FILE
+# define TRACE_INCLUDE_FILE TRACE_SYSTEM
+# define UNDEF_TRACE_INCLUDE_FILE
+#endif
+
+/*
+ * TRACE_INCLUDE_PATH is relative to include/trace/ in the kernel; the only
+ * event headers that live elsewhere are bcachefs's, which are in libbcachefs/
+ * here:
+ */
+#ifdef TRACE_INCLUDE_PATH
+# define TRACE_INCLUDE(file)	TRACE_STRINGIFY(libbcachefs/file.h)
+# define UNDEF_TRACE_INCLUDE_PATH
+#else
+# define TRACE_INCLUDE(file)	TRACE_STRINGIFY(trace/events/file.h)
+#endif
+
+#define TRACE_HEADER_MULTI_READ
+
+#include <trace/trace_events.h>
+
+#undef TRACE_HEADER_MULTI_READ
+
+#undef TRACE_EVENT
+#undef DECLARE_EVENT_CLASS
+#undef DEFINE_EVENT
+#undef DEFINE_EVENT_FN
+#undef DEFINE_EVENT_PRINT
+#undef TRACE_INCLUDE
+#undef TRACE_STRINGIFY
+#undef __TRACE_STRINGIFY
+
+#ifdef UNDEF_TRACE_INCLUDE_FILE
+# undef TRACE_INCLUDE_FILE
+# undef UNDEF_TRACE_INCLUDE_FILE
+#endif
+
+#ifdef UNDEF_TRACE_INCLUDE_PATH
+# undef TRACE_INCLUDE_PATH
+# undef UNDEF_TRACE_INCLUDE_PATH
+#endif
+
+/* We may be processing more files */
+#define CREATE_TRACE_POINTS
+
+#endif /* CREATE_TRACE_POINTS */
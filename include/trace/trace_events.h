@@ -0,0 +1,218 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+/*
+ * Stage macros for defining trace events, as in the kernel: the event header is
+ * read once per stage, with TRACE_EVENT() etc. defined to generate:
+ *
+ * 1. struct trace_event_raw_<class>: the recorded entry - a struct trace_entry
+ *    header, the TP_STRUCT__entry() fields, then the contents of any __string()
+ *    fields. Those are recorded as a u32 __data_loc_<item>: offset into
+ *    __data in the low 16 bits, length including the nul in the high 16.
+ *
+ * 2. struct trace_event_data_offsets_<class>, for passing __string() locations
+ *    from the sizing pass to TP_fast_assign().
+ *
+ * 3. trace_event_get_offsets_<class>(), which computes them and returns the
+ *    size of the variable length part.
+ *
+ * 4. The class's record and print functions, then for each event its
+ *    struct trace_event, its entry in the __trace_events section (so
+ *    linux/tracepoint.c can find it) and __trace_<event>().
+ */
+
+#include <string.h>
+
+#include <linux/tracepoint.h>
+
+/* Strings longer than this are truncated: */
+#define TRACE_STR_MAX		1024
+
+#undef TRACE_EVENT
+#define TRACE_EVENT(name, proto, args, tstruct, assign, print)		\
+	DECLARE_EVENT_CLASS(name,					\
+			    PARAMS(proto),				\
+			    PARAMS(args),				\
+			    PARAMS(tstruct),				\
+			    PARAMS(assign),				\
+			    PARAMS(print))				\
+	DEFINE_EVENT(name, name, PARAMS(proto), PARAMS(args))
+
+#undef DEFINE_EVENT_FN
+#define DEFINE_EVENT_FN(template, name, proto, args, reg, unreg)	\
+	DEFINE_EVENT(template, name, PARAMS(proto), PARAMS(args))
+
+/* The print override isn't supported; events print with their class's: */
+#undef DEFINE_EVENT_PRINT
+#define DEFINE_EVENT_PRINT(template, name, proto, args, print)		\
+	DEFINE_EVENT(template, name, PARAMS(proto), PARAMS(args))
+
+#undef TP_STRUCT__entry
+#define TP_STRUCT__entry(args...)	args
+
+/* Stage 1: */
+
+#undef __field
+#define __field(type, item)		type	item;
+
+#undef __array
+#define __array(type, item, len)	type	item[len];
+
+#undef __string
+#define __string(item, src)		u32	__data_loc_##item;
+
+#undef DECLARE_EVENT_CLASS
+#define DECLARE_EVENT_CLASS(name, proto, args, tstruct, assign, print)	\
+	struct trace_event_raw_##name {					\
+		struct trace_entry	ent;				\
+		tstruct							\
+		char			__data[];			\
+	};
+
+#undef DEFINE_EVENT
+#define DEFINE_EVENT(template, name, proto, args)
+
+#include TRACE_INCLUDE(TRACE_INCLUDE_FILE)
+
+/* Stage 2: */
+
+#undef __field
+#define __field(type, item)
+
+#undef __array
+#define __array(type, item, len)
+
+#undef __string
+#define __string(item, src)		u32 item; const char *item##_ptr_;
+
+#undef DECLARE_EVENT_CLASS
+#define DECLARE_EVENT_CLASS(name, proto, args, tstruct, assign, print)	\
+	struct trace_event_data_offsets_##name {			\
+		tstruct							\
+	};
+
+#include TRACE_INCLUDE(TRACE_INCLUDE_FILE)
+
+/* Stage 3: */
+
+#undef __string
+#define __string(item, src)						\
+	__data_offsets->item##_ptr_ = (src) ?: "(null)";		\
+	__item_length = min_t(size_t, TRACE_STR_MAX,			\
+			      strlen(__data_offsets->item##_ptr_) + 1);	\
+	__data_offsets->item = __data_size | (__item_length << 16);	\
+	__data_size += __item_length;
+
+#undef DECLARE_EVENT_CLASS
+#define DECLARE_EVENT_CLASS(name, proto, args, tstruct, assign, print)	\
+static inline u32 trace_event_get_offsets_##name(			\
+		struct trace_event_data_offsets_##name *__data_offsets,	\
+		proto)							\
+{									\
+	u32 __data_size = 0, __item_length __maybe_unused;		\
+									\
+	tstruct								\
+	return __data_size;						\
+}
+
+#include TRACE_INCLUDE(TRACE_INCLUDE_FILE)
+
+/* Stage 4: */
+
+#undef __string
+#define __string(item, src)
+
+#undef __get_str
+#define __get_str(item)							\
+	((char *) __entry->__data + (__entry->__data_loc_##item & 0xffff))
+
+#undef __assign_str
+#define __assign_str(dst)						\
+do {									\
+	u32 __len = __data_offsets.dst >> 16;				\
+									\
+	__entry->__data_loc_##dst = __data_offsets.dst;			\
+	memcpy(__get_str(dst), __data_offsets.dst##_ptr_, __len - 1);	\
+	__get_str(dst)[__len - 1] = '\0';				\
+} while (0)
+
+#undef __print_flags
+#define __print_flags(flag, delim, flag_array...)			\
+({									\
+	static const struct trace_print_flags __flags[] =		\
+		{ flag_array, { -1, NULL } };				\
+	trace_print_flags_seq(__tmp, &__tmp_used, sizeof(__tmp),	\
+			      delim, flag, __flags);			\
+})
+
+#undef __print_symbolic
+#define __print_symbolic(value, symbol_array...)			\
+({									\
+	static const struct trace_print_flags __symbols[] =		\
+		{ symbol_array, { -1, NULL } };				\
+	trace_print_symbols_seq(__tmp, &__tmp_used, sizeof(__tmp),	\
+				value, __symbols);			\
+})
+
+#undef TP_fast_assign
+#define TP_fast_assign(args...)		args
+
+#undef TP_printk
+#define TP_printk(fmt, args...)		fmt, ##args
+
+#undef DECLARE_EVENT_CLASS
+#define DECLARE_EVENT_CLASS(name, proto, args, tstruct, assign, print)	\
+static __maybe_unused void						\
+trace_event_raw_event_##name(struct trace_event *__event, proto)	\
+{									\
+	struct trace_event_data_offsets_##name __maybe_unused __data_offsets; \
+	struct trace_event_raw_##name *__entry;				\
+	u32 __data_size = trace_event_get_offsets_##name(&__data_offsets, args); \
+									\
+	__entry = trace_event_reserve(__event, sizeof(*__entry) + __data_size); \
+	if (!__entry)							\
+		return;							\
+									\
+	{ assign; }							\
+									\
+	trace_event_commit(__entry);					\
+}									\
+									\
+static __maybe_unused void						\
+trace_event_print_##name(struct printbuf *__out, const void *__p)	\
+{									\
+	const struct trace_event_raw_##name *__entry = __p;		\
+	char __tmp[256] __maybe_unused;					\
+	unsigned __tmp_used __maybe_unused = 0;				\
+									\
+	trace_event_printf(__out, print);				\
+}
+
+#undef DEFINE_EVENT
+#define DEFINE_EVENT(_template, _name, _proto, _args)			\
+struct trace_event __trace_event_##_name = {				\
+	.system	= TRACE_STRINGIFY(TRACE_SYSTEM),			\
+	.name	= #_name,						\
+	.size	= sizeof(struct trace_event_raw_##_template),		\
+	.print	= trace_event_print_##_template,			\
+};									\
+									\
+static struct trace_event * const __trace_event_ptr_##_name		\
+	__used __attribute__((section("__trace_events"))) =		\
+	&__trace_event_##_name;						\
+									\
+void __trace_##_name(_proto)						\
+{									\
+	trace_event_raw_event_##_template(&__trace_event_##_name, _args); \
+}
+
+#include TRACE_INCLUDE(TRACE_INCLUDE_FILE)
+
+#undef __field
+#undef __array
+#undef __string
+#undef __get_str
+#undef __assign_str
+#undef __print_flags
+#undef __print_symbolic
+#undef TP_STRUCT__entry
+#undef TP_fast_assign
+#undef TP_printk
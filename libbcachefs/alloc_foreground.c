@@ -1199,6 +1199,7 @@ restart_find_oldest:
 	wp = oldest;
 	hlist_del_rcu(&wp->node);
 	wp->write_point = write_point;
+	wp->compress_history = 0;
 	hlist_add_head_rcu(&wp->node, head);
 	mutex_unlock(&c->write_points_hash_lock);
 out:
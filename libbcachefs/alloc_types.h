@@ -99,6 +99,9 @@ struct write_point {
 		struct dev_stripe_state	stripe;
 
 		u64			sectors_allocated;
+
+		/* last 8 compression outcomes, bit set if incompressible: */
+		u8			compress_history;
 	} __aligned(SMP_CACHE_BYTES);
 
 	struct {
@@ -464,6 +464,8 @@ BCH_DEBUG_PARAMS_DEBUG()
 	x(btree_gc)				\
 	x(data_write)				\
 	x(data_read)				\
+	x(data_read_transform_wait)		\
+	x(data_read_transform)			\
 	x(data_promote)				\
 	x(journal_flush_write)			\
 	x(journal_noflush_write)		\
@@ -944,6 +946,12 @@ struct bch_fs {
 	 * draining, such as read-only transition.
 	 */
 	struct workqueue_struct *write_ref_wq;
+	/* For the write pipeline: compressing, checksumming and encrypting */
+	struct workqueue_struct *write_transform_wq;
+	spinlock_t		write_pipeline_lock;
+	struct list_head	write_pipelines_idle;
+	unsigned		write_pipelines_nr_idle;
+	struct shrinker		*write_pipeline_shrink;
 
 	/* ALLOCATION */
 	struct bch_devs_mask	online_devs;
@@ -1040,6 +1048,12 @@ struct bch_fs {
 	struct bucket_nocow_lock_table
 				nocow_locks;
 	struct rhashtable	promote_table;
+	/*
+	 * Read completions are checksummed, decrypted and decompressed on
+	 * read_transform_wq, in parallel - fragments of a read may finish out
+	 * of order, but the read only completes once its last fragment does:
+	 */
+	struct workqueue_struct	*read_transform_wq;
 
 #ifdef CONFIG_BCACHEFS_ASYNC_OBJECT_LISTS
 	struct async_obj_list	async_objs[BCH_ASYNC_OBJ_NR];
@@ -1047,6 +1061,11 @@ struct bch_fs {
 
 	mempool_t		compression_bounce[2];
 	mempool_t		compress_workspace[BCH_COMPRESSION_OPT_NR];
+	/* set up compression contexts not in use, see compress.c: */
+	spinlock_t		compress_ctx_lock;
+	struct list_head	compress_ctx_idle[BCH_COMPRESSION_OPT_NR][2];
+	unsigned		compress_ctx_nr_idle[BCH_COMPRESSION_OPT_NR][2];
+	struct shrinker		*compress_ctx_shrink;
 	size_t			zstd_workspace_size;
 
 	struct bch_key		chacha20_key;
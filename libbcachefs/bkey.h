@@ -9,17 +9,15 @@
 #include "util.h"
 #include "vstructs.h"
 
-#if 0
-
 /*
- * compiled unpack functions are disabled, pending a new interface for
- * dynamically allocating executable memory:
+ * compiled unpack functions are disabled in the kernel, pending a new interface
+ * for dynamically allocating executable memory; in userspace they're allocated
+ * with execmem_alloc():
  */
 
-#ifdef CONFIG_X86_64
+#if defined(CONFIG_X86_64) && !defined(__KERNEL__)
 #define HAVE_BCACHEFS_COMPILED_UNPACK	1
 #endif
-#endif
 
 void bch2_bkey_packed_to_binary_text(struct printbuf *,
 				     const struct bkey_format *,
@@ -394,8 +392,8 @@ __bkey_unpack_key_format_checked(const struct btree *b,
 			       struct bkey *dst,
 			       const struct bkey_packed *src)
 {
-	if (IS_ENABLED(HAVE_BCACHEFS_COMPILED_UNPACK)) {
-		compiled_unpack_fn unpack_fn = b->aux_data;
+	if (IS_ENABLED(HAVE_BCACHEFS_COMPILED_UNPACK) && likely(b->unpack_fn)) {
+		compiled_unpack_fn unpack_fn = b->unpack_fn;
 		unpack_fn(dst, src);
 
 		if (IS_ENABLED(CONFIG_BCACHEFS_DEBUG) &&
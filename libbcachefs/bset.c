@@ -15,6 +15,7 @@
 
 #include <linux/unaligned.h>
 #include <linux/console.h>
+#include <linux/execmem.h>
 #include <linux/random.h>
 #include <linux/prefetch.h>
 
@@ -336,7 +337,7 @@ static unsigned bset_aux_tree_buf_start(const struct btree *b,
 					const struct bset_tree *t)
 {
 	return t == b->set
-		? DIV_ROUND_UP(b->unpack_fn_len, 8)
+		? 0
 		: bset_aux_tree_buf_end(t - 1);
 }
 
@@ -391,6 +392,34 @@ void bch2_btree_keys_init(struct btree *b)
 	bch2_bset_set_no_aux_tree(b, b->set);
 }
 
+#ifdef HAVE_BCACHEFS_COMPILED_UNPACK
+/*
+ * The compiled unpack function lives in executable memory of its own, not in
+ * aux_data, so nothing is mapped writable and executable; if we can't get
+ * executable memory, we fall back to __bch2_bkey_unpack_key():
+ */
+void bch2_btree_node_compile_unpack(struct btree *b)
+{
+	u8 code[U8_MAX * 2];
+	int len = bch2_compile_bkey_format(&b->format, code);
+
+	BUG_ON(len < 0 || len > U8_MAX);
+	b->unpack_fn_len = len;
+
+	bch2_btree_node_free_unpack(b);
+
+	b->unpack_fn = execmem_alloc(EXECMEM_DEFAULT, len);
+	if (b->unpack_fn)
+		text_poke_copy(b->unpack_fn, code, len);
+}
+
+void bch2_btree_node_free_unpack(struct btree *b)
+{
+	execmem_free(b->unpack_fn);
+	b->unpack_fn = NULL;
+}
+#endif
+
 /* Binary tree stuff for auxiliary search trees */
 
 /*
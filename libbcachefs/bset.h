@@ -238,18 +238,21 @@ static inline void bch2_bset_set_no_aux_tree(struct btree *b,
 	}
 }
 
+#ifdef HAVE_BCACHEFS_COMPILED_UNPACK
+void bch2_btree_node_compile_unpack(struct btree *);
+void bch2_btree_node_free_unpack(struct btree *);
+#else
+static inline void bch2_btree_node_compile_unpack(struct btree *b) {}
+static inline void bch2_btree_node_free_unpack(struct btree *b) {}
+#endif
+
 static inline void btree_node_set_format(struct btree *b,
 					 struct bkey_format f)
 {
-	int len;
-
 	b->format	= f;
 	b->nr_key_bits	= bkey_format_key_bits(&f);
 
-	len = bch2_compile_bkey_format(&b->format, b->aux_data);
-	BUG_ON(len < 0 || len > U8_MAX);
-
-	b->unpack_fn_len = len;
+	bch2_btree_node_compile_unpack(b);
 
 	bch2_bset_set_no_aux_tree(b, b->set);
 }
@@ -59,6 +59,9 @@ static void btree_node_to_freedlist(struct btree_cache *bc, struct btree *b)
 {
 	BUG_ON(!list_empty(&b->list));
 
+	/* Nodes on the freed list have no memory, and no format: */
+	bch2_btree_node_free_unpack(b);
+
 	if (b->c.lock.readers)
 		list_add(&b->list, &bc->freed_pcpu);
 	else
@@ -107,11 +110,7 @@ static void __btree_node_data_free(struct btree_cache *bc, struct btree *b)
 
 	kvfree(b->data);
 	b->data = NULL;
-#ifdef __KERNEL__
 	kvfree(b->aux_data);
-#else
-	munmap(b->aux_data, btree_aux_data_bytes(b));
-#endif
 	b->aux_data = NULL;
 
 	btree_node_to_freedlist(bc, b);
@@ -151,15 +150,7 @@ static int btree_node_data_alloc(struct bch_fs *c, struct btree *b, gfp_t gfp)
 	b->data = kvmalloc(btree_buf_bytes(b), gfp);
 	if (!b->data)
 		return -BCH_ERR_ENOMEM_btree_node_mem_alloc;
-#ifdef __KERNEL__
 	b->aux_data = kvmalloc(btree_aux_data_bytes(b), gfp);
-#else
-	b->aux_data = mmap(NULL, btree_aux_data_bytes(b),
-			   PROT_READ|PROT_WRITE|PROT_EXEC,
-			   MAP_PRIVATE|MAP_ANONYMOUS, 0, 0);
-	if (b->aux_data == MAP_FAILED)
-		b->aux_data = NULL;
-#endif
 	if (!b->aux_data) {
 		kvfree(b->data);
 		b->data = NULL;
@@ -8,6 +8,8 @@
 #include "journal_io.h"
 
 #include <linux/sort.h>
+#include <linux/vmalloc.h>
+#include <linux/workqueue.h>
 
 /*
  * For managing keys we read from the journal: until journal replay works normal
@@ -652,6 +654,323 @@ static int journal_sort_key_cmp(const void *_l, const void *_r)
 		cmp_int(l->journal_offset, r->journal_offset);
 }
 
+/*
+ * Sorting journal keys is the bulk of the CPU time in recovery with a big
+ * journal, so instead of sort() with journal_sort_key_cmp() we have a parallel
+ * sort specialized for it. It produces exactly the same order, so the dedup in
+ * __journal_keys_sort() doesn't change.
+ *
+ * We sort small entries that have a copy of everything the comparison needs,
+ * so comparisons don't have to chase pointers into the journal:
+ *
+ * - The first pass is a radix partition on level and btree ID, which also
+ *   creates the entries. Each thread does the histogram for one slice of the
+ *   keys, then scatters that slice to its offsets in each bucket. This keeps
+ *   the partition stable.
+ * - Each thread merge sorts one slice of the entries.
+ * - The slices are merged pairwise. To keep every thread busy in the last
+ *   rounds, each merge is split into slice sized pieces: the binary search in
+ *   journal_keys_merge_split() finds where each piece starts in the two inputs
+ *   (the "merge path").
+ * - Finally, the keys are gathered into a new array in sorted order.
+ */
+
+#define JOURNAL_KEYS_SORT_BUCKETS	(BTREE_MAX_DEPTH << 8)
+#define JOURNAL_KEYS_SORT_MIN_SLICE	(1U << 14)
+#define JOURNAL_KEYS_SORT_MAX_THREADS	32U
+
+struct journal_key_sort_ent {
+	u16		bucket;		/* level, descending, then btree ID */
+	u32		snapshot;
+	u64		inode;
+	u64		offset;
+	u64		journal_seq;
+	u32		journal_offset;
+	u32		idx;
+};
+
+static inline int journal_key_sort_ent_cmp(const struct journal_key_sort_ent *l,
+					   const struct journal_key_sort_ent *r)
+{
+	return  cmp_int(l->bucket,		r->bucket) ?:
+		cmp_int(l->inode,		r->inode) ?:
+		cmp_int(l->offset,		r->offset) ?:
+		cmp_int(l->snapshot,		r->snapshot) ?:
+		cmp_int(l->journal_seq,		r->journal_seq) ?:
+		cmp_int(l->journal_offset,	r->journal_offset);
+}
+
+static inline unsigned journal_key_sort_bucket(const struct journal_key *k)
+{
+	return ((BTREE_MAX_DEPTH - 1 - k->level) << 8) | k->btree_id;
+}
+
+struct journal_keys_merge {
+	struct journal_key_sort_ent	*a, *b, *out;
+	size_t				na, nb;
+	/* range of the output this task produces: */
+	size_t				start, end;
+};
+
+struct journal_keys_sorter {
+	struct journal_key		*keys;
+	struct journal_key		*sorted;
+	struct journal_key_sort_ent	*ents;
+	struct journal_key_sort_ent	*tmp;
+	size_t				nr;
+	size_t				slice;
+	unsigned			nr_slices;
+	bool				bad_level;
+
+	u32				*hist;	/* [nr_slices][JOURNAL_KEYS_SORT_BUCKETS] */
+	struct journal_keys_merge	*merges;
+
+	struct bch_parallel		parallel;
+};
+
+static inline struct journal_keys_sorter *to_sorter(struct bch_parallel *p)
+{
+	return container_of(p, struct journal_keys_sorter, parallel);
+}
+
+static inline size_t journal_keys_slice_start(struct journal_keys_sorter *s, unsigned i)
+{
+	return min(s->nr, i * s->slice);
+}
+
+static void journal_keys_sort_hist(struct bch_parallel *p, unsigned i)
+{
+	struct journal_keys_sorter *s = to_sorter(p);
+	u32 *hist = s->hist + i * JOURNAL_KEYS_SORT_BUCKETS;
+
+	for (size_t j = journal_keys_slice_start(s, i); j < journal_keys_slice_start(s, i + 1); j++) {
+		if (unlikely(s->keys[j].level >= BTREE_MAX_DEPTH)) {
+			WRITE_ONCE(s->bad_level, true);
+			return;
+		}
+
+		hist[journal_key_sort_bucket(&s->keys[j])]++;
+	}
+}
+
+static void journal_keys_sort_scatter(struct bch_parallel *p, unsigned i)
+{
+	struct journal_keys_sorter *s = to_sorter(p);
+	u32 *offsets = s->hist + i * JOURNAL_KEYS_SORT_BUCKETS;
+
+	for (size_t j = journal_keys_slice_start(s, i); j < journal_keys_slice_start(s, i + 1); j++) {
+		struct journal_key *k = &s->keys[j];
+		unsigned bucket = journal_key_sort_bucket(k);
+
+		s->ents[offsets[bucket]++] = (struct journal_key_sort_ent) {
+			.bucket		= bucket,
+			.snapshot	= k->k->k.p.snapshot,
+			.inode		= k->k->k.p.inode,
+			.offset		= k->k->k.p.offset,
+			.journal_seq	= k->journal_seq,
+			.journal_offset	= k->journal_offset,
+			.idx		= j,
+		};
+	}
+}
+
+static void journal_keys_merge(struct journal_key_sort_ent *out,
+			       struct journal_key_sort_ent *a, size_t na,
+			       struct journal_key_sort_ent *b, size_t nb)
+{
+	struct journal_key_sort_ent *a_end = a + na, *b_end = b + nb;
+
+	while (a < a_end && b < b_end)
+		*out++ = journal_key_sort_ent_cmp(a, b) <= 0 ? *a++ : *b++;
+
+	memcpy(out, a, (a_end - a) * sizeof(*a));
+	out += a_end - a;
+	memcpy(out, b, (b_end - b) * sizeof(*b));
+}
+
+static void journal_keys_sort_slice(struct bch_parallel *p, unsigned i)
+{
+	struct journal_keys_sorter *s = to_sorter(p);
+	size_t start = journal_keys_slice_start(s, i), nr = journal_keys_slice_start(s, i + 1) - start;
+	struct journal_key_sort_ent *src = s->ents + start, *dst = s->tmp + start;
+	size_t j, width = 16;
+
+	/* insertion sort runs of @width, then bottom up merge sort: */
+	for (j = 0; j < nr; j += width) {
+		struct journal_key_sort_ent *run = src + j;
+		size_t run_nr = min(width, nr - j);
+
+		for (size_t k = 1; k < run_nr; k++) {
+			struct journal_key_sort_ent e = run[k];
+			size_t l = k;
+
+			for (; l && journal_key_sort_ent_cmp(&run[l - 1], &e) > 0; --l)
+				run[l] = run[l - 1];
+			run[l] = e;
+		}
+	}
+
+	for (; width < nr; width *= 2) {
+		for (j = 0; j < nr; j += 2 * width) {
+			size_t na = min(width, nr - j);
+			size_t nb = min(width, nr - j - na);
+
+			journal_keys_merge(dst + j, src + j, na, src + j + na, nb);
+		}
+
+		swap(src, dst);
+	}
+
+	if (src != s->ents + start)
+		memcpy(s->ents + start, src, nr * sizeof(*src));
+}
+
+/* Number of elements of @m->a that go before output position @diag: */
+static size_t journal_keys_merge_split(struct journal_keys_merge *m, size_t diag)
+{
+	size_t lo = diag > m->nb ? diag - m->nb : 0;
+	size_t hi = min(diag, m->na);
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if (journal_key_sort_ent_cmp(&m->a[mid], &m->b[diag - mid - 1]) <= 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+static void journal_keys_sort_merge(struct bch_parallel *p, unsigned i)
+{
+	struct journal_keys_sorter *s = to_sorter(p);
+	struct journal_keys_merge *m = &s->merges[i];
+	size_t a_start	= journal_keys_merge_split(m, m->start);
+	size_t a_end	= journal_keys_merge_split(m, m->end);
+
+	journal_keys_merge(m->out + m->start,
+			   m->a + a_start, a_end - a_start,
+			   m->b + m->start - a_start, (m->end - a_end) - (m->start - a_start));
+}
+
+static void journal_keys_sort_gather(struct bch_parallel *p, unsigned i)
+{
+	struct journal_keys_sorter *s = to_sorter(p);
+
+	for (size_t j = journal_keys_slice_start(s, i); j < journal_keys_slice_start(s, i + 1); j++)
+		s->sorted[j] = s->keys[s->ents[j].idx];
+}
+
+static void *journal_keys_sort_alloc(size_t nr, size_t size)
+{
+	size_t bytes;
+
+	if (check_mul_overflow(nr, size, &bytes))
+		return NULL;
+
+	/* kvmalloc() doesn't support > INT_MAX allocations: */
+	return bytes < INT_MAX
+		? kvmalloc(bytes, GFP_KERNEL)
+		: vmalloc(bytes);
+}
+
+/*
+ * Sort @keys in the same order as journal_sort_key_cmp(); returns an error if
+ * the caller should fall back to sort():
+ */
+int bch2_journal_keys_sort_parallel(struct journal_keys *keys)
+{
+	struct journal_keys_sorter s = { .keys = keys->data, .nr = keys->nr };
+	size_t width;
+	int ret = -ENOMEM;
+
+	if (keys->nr > U32_MAX)
+		return -EINVAL;
+
+	s.nr_slices = clamp_t(size_t, keys->nr / JOURNAL_KEYS_SORT_MIN_SLICE,
+			      1, min(num_online_cpus(), JOURNAL_KEYS_SORT_MAX_THREADS));
+	s.slice = DIV_ROUND_UP(keys->nr, s.nr_slices);
+
+	s.ents		= journal_keys_sort_alloc(keys->nr, sizeof(s.ents[0]));
+	s.tmp		= journal_keys_sort_alloc(keys->nr, sizeof(s.tmp[0]));
+	s.hist		= kvcalloc(s.nr_slices * JOURNAL_KEYS_SORT_BUCKETS,
+				   sizeof(s.hist[0]), GFP_KERNEL);
+	/* at most one piece per slice, plus one per pair of runs: */
+	s.merges	= kcalloc(s.nr_slices * 2, sizeof(s.merges[0]), GFP_KERNEL);
+	if (!s.ents || !s.tmp || !s.hist || !s.merges ||
+	    bch2_parallel_init(&s.parallel, system_unbound_wq,
+			       s.nr_slices - 1, GFP_KERNEL))
+		goto err;
+
+	bch2_parallel_run(&s.parallel, journal_keys_sort_hist, s.nr_slices);
+	if (s.bad_level) {
+		ret = -EINVAL;
+		goto err;
+	}
+
+	/* Turn the histograms into each slice's offset in each bucket: */
+	u32 pos = 0;
+	for (unsigned b = 0; b < JOURNAL_KEYS_SORT_BUCKETS; b++)
+		for (unsigned i = 0; i < s.nr_slices; i++) {
+			u32 *v = &s.hist[i * JOURNAL_KEYS_SORT_BUCKETS + b];
+			u32 nr = *v;
+
+			*v = pos;
+			pos += nr;
+		}
+
+	bch2_parallel_run(&s.parallel, journal_keys_sort_scatter, s.nr_slices);
+	bch2_parallel_run(&s.parallel, journal_keys_sort_slice, s.nr_slices);
+
+	for (width = s.slice; width < keys->nr; width *= 2) {
+		unsigned nr_merges = 0;
+
+		for (size_t start = 0; start < keys->nr; start += 2 * width) {
+			size_t na = min(width, keys->nr - start);
+			size_t nb = min(width, keys->nr - start - na);
+
+			for (size_t piece = 0; piece < na + nb; piece += s.slice) {
+				BUG_ON(nr_merges >= s.nr_slices * 2);
+
+				s.merges[nr_merges++] = (struct journal_keys_merge) {
+					.a	= s.ents + start,
+					.na	= na,
+					.b	= s.ents + start + na,
+					.nb	= nb,
+					.out	= s.tmp + start,
+					.start	= piece,
+					.end	= min(piece + s.slice, na + nb),
+				};
+			}
+		}
+
+		bch2_parallel_run(&s.parallel, journal_keys_sort_merge, nr_merges);
+		swap(s.ents, s.tmp);
+	}
+
+	kvfree(s.tmp);
+	s.tmp = NULL;
+
+	s.sorted = journal_keys_sort_alloc(keys->size, sizeof(s.sorted[0]));
+	if (!s.sorted)
+		goto err;
+
+	bch2_parallel_run(&s.parallel, journal_keys_sort_gather, s.nr_slices);
+
+	kvfree(keys->data);
+	keys->data = s.sorted;
+	ret = 0;
+err:
+	bch2_parallel_exit(&s.parallel);
+	kfree(s.merges);
+	kvfree(s.hist);
+	kvfree(s.tmp);
+	kvfree(s.ents);
+	return ret;
+}
+
 void bch2_journal_keys_put(struct bch_fs *c)
 {
 	struct journal_keys *keys = &c->journal_keys;
@@ -687,8 +1006,9 @@ void bch2_journal_keys_put(struct bch_fs *c)
 
 static void __journal_keys_sort(struct journal_keys *keys)
 {
-	sort_nonatomic(keys->data, keys->nr, sizeof(keys->data[0]),
-		       journal_sort_key_cmp, NULL);
+	if (bch2_journal_keys_sort_parallel(keys))
+		sort_nonatomic(keys->data, keys->nr, sizeof(keys->data[0]),
+			       journal_sort_key_cmp, NULL);
 
 	cond_resched();
 
@@ -100,6 +100,8 @@ struct btree {
 	u16			whiteout_u64s;
 	u8			byte_order;
 	u8			unpack_fn_len;
+	/* from bch2_btree_node_compile_unpack(), NULL if not compiled: */
+	void			*unpack_fn;
 
 	struct btree_write	writes[2];
 
@@ -287,6 +287,81 @@ int __bch2_encrypt_bio(struct bch_fs *c, unsigned type,
 	return ret;
 }
 
+/*
+ * Encrypt and checksum (or checksum and decrypt) a bio in a single pass: the
+ * two passes are each memory bandwidth bound on large bios, so we do both a
+ * page at a time, while the data is still in L1.
+ *
+ * The MAC is always over the ciphertext, and over the whole bio; only
+ * [crypt_offset, crypt_offset + crypt_len) is encrypted or decrypted, with the
+ * nonce being for the start of the bio.
+ */
+int __bch2_crypt_checksum_bio(struct bch_fs *c, unsigned type,
+			      struct nonce nonce, struct bio *bio, bool encrypt,
+			      unsigned crypt_offset, unsigned crypt_len,
+			      struct bch_csum *csum)
+{
+	struct poly1305_desc_ctx dctx;
+	u8 digest[POLY1305_DIGEST_SIZE];
+	u32 chacha_state[CHACHA_STATE_WORDS];
+	unsigned crypt_end = crypt_offset + crypt_len;
+	unsigned pos = 0;
+	struct bio_vec bv;
+	struct bvec_iter iter;
+	int ret = 0;
+
+	BUG_ON(!bch2_csum_type_is_encryption(type));
+	BUG_ON(crypt_end > bio->bi_iter.bi_size);
+
+	if (bch2_fs_inconsistent_on(!c->chacha20_key_set,
+				    c, "attempting to encrypt without encryption key"))
+		return -BCH_ERR_no_encryption_key;
+
+	bch2_poly1305_init(&dctx, c, nonce);
+	bch2_chacha20_init(chacha_state, &c->chacha20_key,
+			   nonce_add(nonce, crypt_offset));
+
+	bio_for_each_segment(bv, bio, iter) {
+		unsigned seg_start = clamp(crypt_offset, pos, pos + bv.bv_len) - pos;
+		unsigned seg_end   = clamp(crypt_end,    pos, pos + bv.bv_len) - pos;
+		unsigned done = 0;
+		u8 *p;
+
+		/* As in __bch2_encrypt_bio(): */
+		if (seg_start < seg_end &&
+		    (!IS_ALIGNED(seg_start, CHACHA_BLOCK_SIZE) ||
+		     !IS_ALIGNED(seg_end - seg_start, CHACHA_BLOCK_SIZE))) {
+			bch_err_ratelimited(c, "bio not aligned for encryption");
+			ret = -EIO;
+			break;
+		}
+
+		p = bvec_kmap_local(&bv);
+		while (done < bv.bv_len) {
+			unsigned n = min_t(unsigned, bv.bv_len - done, PAGE_SIZE);
+			unsigned c_start = clamp(seg_start, done, done + n);
+			unsigned c_end   = clamp(seg_end,   done, done + n);
+
+			if (!encrypt)
+				poly1305_update(&dctx, p + done, n);
+			if (c_start < c_end)
+				chacha20_crypt(chacha_state, p + c_start, p + c_start,
+					       c_end - c_start);
+			if (encrypt)
+				poly1305_update(&dctx, p + done, n);
+			done += n;
+		}
+		kunmap_local(p);
+		pos += bv.bv_len;
+	}
+	memzero_explicit(chacha_state, sizeof(chacha_state));
+
+	poly1305_final(&dctx, digest);
+	memset(csum, 0, sizeof(*csum));
+	memcpy(csum, digest, bch_crc_bytes[type]);
+	return ret;
+}
+
 struct bch_csum bch2_checksum_merge(unsigned type, struct bch_csum a,
 				    struct bch_csum b, size_t b_len)
 {
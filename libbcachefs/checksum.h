@@ -99,6 +99,30 @@ static inline int bch2_encrypt_bio(struct bch_fs *c, unsigned type,
 		: 0;
 }
 
+int __bch2_crypt_checksum_bio(struct bch_fs *, unsigned, struct nonce,
+			      struct bio *, bool, unsigned, unsigned,
+			      struct bch_csum *);
+
+/*
+ * Equivalent to bch2_encrypt_bio() followed by bch2_checksum_bio(), and the
+ * reverse - but in one pass over the data:
+ */
+static inline int bch2_encrypt_checksum_bio(struct bch_fs *c, unsigned type,
+					    struct nonce nonce, struct bio *bio,
+					    struct bch_csum *csum)
+{
+	return __bch2_crypt_checksum_bio(c, type, nonce, bio, true,
+					 0, bio->bi_iter.bi_size, csum);
+}
+
+static inline int bch2_checksum_decrypt_bio(struct bch_fs *c, unsigned type,
+					    struct nonce nonce, struct bio *bio,
+					    struct bch_csum *csum)
+{
+	return __bch2_crypt_checksum_bio(c, type, nonce, bio, false,
+					 0, bio->bi_iter.bi_size, csum);
+}
+
 extern const struct bch_sb_field_ops bch_sb_field_ops_crypt;
 
 int bch2_decrypt_sb_key(struct bch_fs *, struct bch_sb_field_crypt *,
@@ -9,6 +9,8 @@
 #include "super-io.h"
 
 #include <linux/lz4.h>
+#include <linux/random.h>
+#include <linux/unaligned.h>
 #include <linux/zlib.h>
 #include <linux/zstd.h>
 
@@ -170,13 +172,152 @@ static inline void zlib_set_workspace(z_stream *strm, void *workspace)
 #endif
 }
 
+/*
+ * Compression contexts:
+ *
+ * Setting up to compress or decompress - allocating a workspace, which is
+ * megabytes for zstd, then zstd_init_cctx() or zlib_deflateInit2() - can cost
+ * as much as the compression itself for a small extent. So contexts stay set up
+ * between uses, and are only reset: zstd resets its context on every call, and
+ * zlib streams get zlib_deflateReset()/zlib_inflateReset().
+ *
+ * Compression can sleep, so contexts can't be per cpu; instead, idle contexts
+ * are cached on a list per compression type and direction, up to one per cpu -
+ * enough for every thread that can be compressing at once. The shrinker frees
+ * idle contexts under memory pressure.
+ *
+ * Contexts are allocated from c->compress_workspace, whose reserve guarantees
+ * forward progress: a context is only cached if the reserve is full, so a
+ * thread waiting on the mempool will be woken by the next context freed.
+ */
+struct compress_ctx {
+	struct list_head	list;
+	enum bch_compression_opts type;
+	int			rw;
+	/* set up for @rw and, for gzip compression, @level: */
+	bool			initialized;
+	int			level;
+	union {
+		ZSTD_CCtx	*zstd_c;
+		ZSTD_DCtx	*zstd_d;
+		z_stream	strm;
+	};
+	u8			workspace[] __aligned(8);
+};
+
+static struct compress_ctx *compress_ctx_get(struct bch_fs *c,
+					     enum bch_compression_opts type, int rw)
+{
+	struct list_head *idle = &c->compress_ctx_idle[type][rw];
+	struct compress_ctx *ctx;
+
+	spin_lock(&c->compress_ctx_lock);
+	ctx = list_first_entry_or_null(idle, struct compress_ctx, list);
+	if (ctx) {
+		list_del(&ctx->list);
+		c->compress_ctx_nr_idle[type][rw]--;
+	}
+	spin_unlock(&c->compress_ctx_lock);
+
+	if (ctx)
+		return ctx;
+
+	ctx = mempool_alloc(&c->compress_workspace[type], GFP_NOFS);
+	ctx->type		= type;
+	ctx->rw			= rw;
+	ctx->initialized	= false;
+	return ctx;
+}
+
+static void compress_ctx_free(struct bch_fs *c, struct compress_ctx *ctx)
+{
+	/* userspace zlib allocates its own state: */
+	if (ctx->type == BCH_COMPRESSION_OPT_gzip && ctx->initialized) {
+		if (ctx->rw == WRITE)
+			zlib_deflateEnd(&ctx->strm);
+		else
+			zlib_inflateEnd(&ctx->strm);
+	}
+
+	mempool_free(ctx, &c->compress_workspace[ctx->type]);
+}
+
+static void compress_ctx_put(struct bch_fs *c, struct compress_ctx *ctx)
+{
+	mempool_t *pool = &c->compress_workspace[ctx->type];
+	unsigned *nr_idle = &c->compress_ctx_nr_idle[ctx->type][ctx->rw];
+	bool cached = false;
+
+	spin_lock(&c->compress_ctx_lock);
+	if (ctx->initialized &&
+	    *nr_idle < num_online_cpus() &&
+	    READ_ONCE(pool->curr_nr) >= pool->min_nr) {
+		list_add(&ctx->list, &c->compress_ctx_idle[ctx->type][ctx->rw]);
+		(*nr_idle)++;
+		cached = true;
+	}
+	spin_unlock(&c->compress_ctx_lock);
+
+	if (!cached)
+		compress_ctx_free(c, ctx);
+}
+
+static unsigned long compress_ctx_free_idle(struct bch_fs *c, unsigned long nr)
+{
+	unsigned long freed = 0;
+
+	while (freed < nr) {
+		struct compress_ctx *ctx = NULL;
+
+		spin_lock(&c->compress_ctx_lock);
+		for (unsigned i = 0; i < BCH_COMPRESSION_OPT_NR && !ctx; i++)
+			for (unsigned rw = 0; rw < 2 && !ctx; rw++) {
+				ctx = list_first_entry_or_null(&c->compress_ctx_idle[i][rw],
+							       struct compress_ctx, list);
+				if (ctx) {
+					list_del(&ctx->list);
+					c->compress_ctx_nr_idle[i][rw]--;
+				}
+			}
+		spin_unlock(&c->compress_ctx_lock);
+
+		if (!ctx)
+			break;
+
+		compress_ctx_free(c, ctx);
+		freed++;
+	}
+
+	return freed;
+}
+
+static unsigned long bch2_compress_ctx_count(struct shrinker *shrink,
+					     struct shrink_control *sc)
+{
+	struct bch_fs *c = shrink->private_data;
+	unsigned long nr = 0;
+
+	for (unsigned i = 0; i < BCH_COMPRESSION_OPT_NR; i++)
+		nr += READ_ONCE(c->compress_ctx_nr_idle[i][READ]) +
+		      READ_ONCE(c->compress_ctx_nr_idle[i][WRITE]);
+	return nr;
+}
+
+static unsigned long bch2_compress_ctx_scan(struct shrinker *shrink,
+					    struct shrink_control *sc)
+{
+	struct bch_fs *c = shrink->private_data;
+
+	return compress_ctx_free_idle(c, sc->nr_to_scan);
+}
+
 static int __bio_uncompress(struct bch_fs *c, struct bio *src,
 			    void *dst_data, struct bch_extent_crc_unpacked crc)
 {
 	struct bbuf src_data = { NULL };
 	size_t src_len = src->bi_iter.bi_size;
 	size_t dst_len = crc.uncompressed_size << 9;
-	void *workspace;
+	struct compress_ctx *ctx;
 	int ret = 0, ret2;
 
 	enum bch_compression_opts opt = bch2_compression_type_to_opt(crc.compression_type);
@@ -203,27 +344,42 @@ static int __bio_uncompress(struct bch_fs *c, struct bio *src,
 			ret = -BCH_ERR_decompress_lz4;
 		break;
 	case BCH_COMPRESSION_TYPE_gzip: {
-		z_stream strm = {
-			.next_in	= src_data.b,
-			.avail_in	= src_len,
-			.next_out	= dst_data,
-			.avail_out	= dst_len,
-		};
+		ctx = compress_ctx_get(c, opt, READ);
+
+		/* A cached stream we can't reset is replaced by a fresh one: */
+		if (ctx->initialized &&
+		    zlib_inflateReset(&ctx->strm) != Z_OK) {
+			zlib_inflateEnd(&ctx->strm);
+			ctx->initialized = false;
+		}
 
-		workspace = mempool_alloc(workspace_pool, GFP_NOFS);
+		if (!ctx->initialized) {
+			ctx->strm = (z_stream) {};
+			zlib_set_workspace(&ctx->strm, ctx->workspace);
+			ctx->initialized = zlib_inflateInit2(&ctx->strm, -MAX_WBITS) == Z_OK;
+		}
+
+		/* Not being able to set up a stream isn't a data error: */
+		if (!ctx->initialized) {
+			compress_ctx_put(c, ctx);
+			ret = -BCH_ERR_ENOMEM_compress_ctx_init;
+			break;
+		}
+
+		ctx->strm.next_in	= src_data.b;
+		ctx->strm.avail_in	= src_len;
+		ctx->strm.next_out	= dst_data;
+		ctx->strm.avail_out	= dst_len;
 
-		zlib_set_workspace(&strm, workspace);
-		zlib_inflateInit2(&strm, -MAX_WBITS);
-		ret2 = zlib_inflate(&strm, Z_FINISH);
+		ret2 = zlib_inflate(&ctx->strm, Z_FINISH);
 
-		mempool_free(workspace, workspace_pool);
+		compress_ctx_put(c, ctx);
 
 		if (ret2 != Z_STREAM_END)
 			ret = -BCH_ERR_decompress_gzip;
 		break;
 	}
 	case BCH_COMPRESSION_TYPE_zstd: {
-		ZSTD_DCtx *ctx;
 		size_t real_src_len = le32_to_cpup(src_data.b);
 
 		if (real_src_len > src_len - 4) {
@@ -231,14 +387,17 @@ static int __bio_uncompress(struct bch_fs *c, struct bio *src,
 			goto err;
 		}
 
-		workspace = mempool_alloc(workspace_pool, GFP_NOFS);
-		ctx = zstd_init_dctx(workspace, zstd_dctx_workspace_bound());
+		ctx = compress_ctx_get(c, opt, READ);
+		if (!ctx->initialized) {
+			ctx->zstd_d = zstd_init_dctx(ctx->workspace, zstd_dctx_workspace_bound());
+			ctx->initialized = true;
+		}
 
-		ret2 = zstd_decompress_dctx(ctx,
+		ret2 = zstd_decompress_dctx(ctx->zstd_d,
 				dst_data,	dst_len,
 				src_data.b + 4, real_src_len);
 
-		mempool_free(workspace, workspace_pool);
+		compress_ctx_put(c, ctx);
 
 		if (ret2 != dst_len)
 			ret = -BCH_ERR_decompress_zstd;
@@ -333,7 +492,7 @@ err:
 }
 
 static int attempt_compress(struct bch_fs *c,
-			    void *workspace,
+			    struct compress_ctx *ctx,
 			    void *dst, size_t dst_len,
 			    void *src, size_t src_len,
 			    struct bch_compression_opt compression)
@@ -343,12 +502,15 @@ static int attempt_compress(struct bch_fs *c,
 
 	switch (compression_type) {
 	case BCH_COMPRESSION_TYPE_lz4:
+		/* lz4 sets up its state in the workspace on every call: */
+		ctx->initialized = true;
+
 		if (compression.level < LZ4HC_MIN_CLEVEL) {
 			int len = src_len;
 			int ret = LZ4_compress_destSize(
 					src,		dst,
 					&len,		dst_len,
-					workspace);
+					ctx->workspace);
 			if (len < src_len)
 				return -len;
 
@@ -358,35 +520,45 @@ static int attempt_compress(struct bch_fs *c,
 					src,		dst,
 					src_len,	dst_len,
 					compression.level,
-					workspace);
+					ctx->workspace);
 
 			return ret ?: -1;
 		}
 	case BCH_COMPRESSION_TYPE_gzip: {
-		z_stream strm = {
-			.next_in	= src,
-			.avail_in	= src_len,
-			.next_out	= dst,
-			.avail_out	= dst_len,
-		};
+		int level = compression.level
+			? clamp_t(unsigned, compression.level,
+				  Z_BEST_SPEED, Z_BEST_COMPRESSION)
+			: Z_DEFAULT_COMPRESSION;
+
+		/* Reset if it's set up for this level, else start over: */
+		if (ctx->initialized &&
+		    (ctx->level != level ||
+		     zlib_deflateReset(&ctx->strm) != Z_OK)) {
+			zlib_deflateEnd(&ctx->strm);
+			ctx->initialized = false;
+		}
 
-		zlib_set_workspace(&strm, workspace);
-		if (zlib_deflateInit2(&strm,
-				  compression.level
-				  ? clamp_t(unsigned, compression.level,
-					    Z_BEST_SPEED, Z_BEST_COMPRESSION)
-				  : Z_DEFAULT_COMPRESSION,
-				  Z_DEFLATED, -MAX_WBITS, DEF_MEM_LEVEL,
-				  Z_DEFAULT_STRATEGY) != Z_OK)
-			return 0;
+		if (!ctx->initialized) {
+			ctx->strm = (z_stream) {};
+			zlib_set_workspace(&ctx->strm, ctx->workspace);
+			if (zlib_deflateInit2(&ctx->strm, level,
+					      Z_DEFLATED, -MAX_WBITS, DEF_MEM_LEVEL,
+					      Z_DEFAULT_STRATEGY) != Z_OK)
+				return 0;
 
-		if (zlib_deflate(&strm, Z_FINISH) != Z_STREAM_END)
-			return 0;
+			ctx->initialized	= true;
+			ctx->level		= level;
+		}
+
+		ctx->strm.next_in	= src;
+		ctx->strm.avail_in	= src_len;
+		ctx->strm.next_out	= dst;
+		ctx->strm.avail_out	= dst_len;
 
-		if (zlib_deflateEnd(&strm) != Z_OK)
+		if (zlib_deflate(&ctx->strm, Z_FINISH) != Z_STREAM_END)
 			return 0;
 
-		return strm.total_out;
+		return ctx->strm.total_out;
 	}
 	case BCH_COMPRESSION_TYPE_zstd: {
 		/*
@@ -395,7 +567,11 @@ static int attempt_compress(struct bch_fs *c,
 		 */
 		unsigned level = min((compression.level * 3) / 2, zstd_max_clevel());
 		ZSTD_parameters params = zstd_get_params(level, c->opts.encoded_extent_max);
-		ZSTD_CCtx *ctx = zstd_init_cctx(workspace, c->zstd_workspace_size);
+
+		if (!ctx->initialized) {
+			ctx->zstd_c = zstd_init_cctx(ctx->workspace, c->zstd_workspace_size);
+			ctx->initialized = true;
+		}
 
 		/*
 		 * ZSTD requires that when we decompress we pass in the exact
@@ -408,7 +584,7 @@ static int attempt_compress(struct bch_fs *c,
 		 * factor (7 bytes) from the dst buffer size to account for
 		 * that.
 		 */
-		size_t len = zstd_compress_cctx(ctx,
+		size_t len = zstd_compress_cctx(ctx->zstd_c,
 				dst + 4,	dst_len - 4 - 7,
 				src,		src_len,
 				&params);
@@ -423,16 +599,129 @@ static int attempt_compress(struct bch_fs *c,
 	}
 }
 
+/*
+ * Compressibility heuristic:
+ *
+ * Data that's already compressed or encrypted costs a full compression pass to
+ * find out it didn't get any smaller; we can usually tell from a sample of a
+ * few KB, since its byte histogram is flat.
+ *
+ * We sample 16 byte chunks spread evenly over the input, check for a repeating
+ * pattern (zeroes, fills), then estimate the sample's Shannon entropy - in
+ * fixed point, with log2 taken to a quarter bit as ilog2(x^4) / 4.
+ */
+#define COMPRESS_SAMPLE_MAX		4096
+#define COMPRESS_SAMPLE_CHUNK		16
+
+/* Entropy, as a percentage of 8 bits per byte: */
+#define COMPRESS_ENTROPY_LOW		75
+#define COMPRESS_ENTROPY_HIGH		90
+
+/* In between those, skip if this many of the write point's last 8 didn't compress: */
+#define COMPRESS_HISTORY_SKIP		6
+
+/* Compress one in this many skipped extents anyway, to count false negatives: */
+#define COMPRESS_SKIP_AUDIT		64
+
+enum compress_hint {
+	COMPRESS_HINT_COMPRESSIBLE,
+	COMPRESS_HINT_UNSURE,
+	COMPRESS_HINT_INCOMPRESSIBLE,
+};
+
+static inline void compress_sample_u64(u16 *hist, u64 v)
+{
+	/* A word at a time, not a byte at a time - half the loads: */
+	for (unsigned i = 0; i < 8; i++, v >>= 8)
+		hist[v & 0xff]++;
+}
+
+static enum compress_hint compress_heuristic(const void *src, size_t len)
+{
+	unsigned nr_chunks = min_t(size_t, len, COMPRESS_SAMPLE_MAX) / COMPRESS_SAMPLE_CHUNK;
+	size_t stride = round_down(len / nr_chunks, sizeof(u64));
+	unsigned nr = nr_chunks * COMPRESS_SAMPLE_CHUNK;
+	u64 nr_log = ilog2((u64) nr * nr * nr * nr);
+	u64 sum = 0;
+	u16 hist[256] = { 0 };
+	const u8 *p;
+	unsigned i;
+
+	for (i = 1, p = src + stride; i < nr_chunks; i++, p += stride)
+		if (memcmp(src, p, COMPRESS_SAMPLE_CHUNK))
+			break;
+	if (i == nr_chunks)
+		return COMPRESS_HINT_COMPRESSIBLE;
+
+	for (i = 0, p = src; i < nr_chunks; i++, p += stride) {
+		compress_sample_u64(hist, get_unaligned((u64 *) p));
+		compress_sample_u64(hist, get_unaligned((u64 *) p + 1));
+	}
+
+	for (i = 0; i < ARRAY_SIZE(hist); i++)
+		if (hist[i]) {
+			u64 n = hist[i];
+
+			sum += n * (nr_log - ilog2(n * n * n * n));
+		}
+
+	/* sum / nr is quarter bits per byte: */
+	sum = div_u64(sum * 100, nr * 4 * 8);
+
+	return    sum < COMPRESS_ENTROPY_LOW	? COMPRESS_HINT_COMPRESSIBLE
+		: sum < COMPRESS_ENTROPY_HIGH	? COMPRESS_HINT_UNSURE
+		:				  COMPRESS_HINT_INCOMPRESSIBLE;
+}
+
+/*
+ * Recent outcomes at a write point, most recent in bit 0 - set if incompressible;
+ * write pipeline workers compress extents for the same write point in parallel:
+ */
+static inline void compress_history_add(struct write_point *wp, bool incompressible)
+{
+	u8 old, new;
+
+	if (!wp)
+		return;
+
+	old = READ_ONCE(wp->compress_history);
+	do {
+		new = (old << 1)|incompressible;
+	} while (!try_cmpxchg(&wp->compress_history, &old, new));
+}
+
+static bool compress_should_skip(struct write_point *wp, const void *src, size_t len)
+{
+	switch (compress_heuristic(src, len)) {
+	case COMPRESS_HINT_COMPRESSIBLE:
+		return false;
+	case COMPRESS_HINT_UNSURE:
+		/*
+		 * Don't record this in the history: a write point that's seen
+		 * incompressible data would otherwise never try again
+		 */
+		return wp &&
+			hweight8(READ_ONCE(wp->compress_history)) >= COMPRESS_HISTORY_SKIP;
+	case COMPRESS_HINT_INCOMPRESSIBLE:
+		compress_history_add(wp, true);
+		return true;
+	default:
+		BUG();
+	}
+}
+
 static unsigned __bio_compress(struct bch_fs *c,
+			       struct write_point *wp,
 			       struct bio *dst, size_t *dst_len,
 			       struct bio *src, size_t *src_len,
 			       struct bch_compression_opt compression)
 {
 	struct bbuf src_data = { NULL }, dst_data = { NULL };
-	void *workspace;
+	struct compress_ctx *ctx;
 	enum bch_compression_type compression_type =
 		__bch2_compression_opt_to_type[compression.type];
 	unsigned pad;
+	bool audit = false;
 	int ret = 0;
 
 	/* bch2_compression_decode catches unknown compression types: */
@@ -455,14 +744,24 @@ static unsigned __bio_compress(struct bch_fs *c,
 	if (src->bi_iter.bi_size <= c->opts.block_size)
 		return BCH_COMPRESSION_TYPE_incompressible;
 
-	dst_data = bio_map_or_bounce(c, dst, WRITE);
 	src_data = bio_map_or_bounce(c, src, READ);
 
-	workspace = mempool_alloc(workspace_pool, GFP_NOFS);
-
 	*src_len = src->bi_iter.bi_size;
 	*dst_len = dst->bi_iter.bi_size;
 
+	if (compress_should_skip(wp, src_data.b, *src_len)) {
+		audit = !get_random_u32_below(COMPRESS_SKIP_AUDIT);
+		if (!audit) {
+			count_event(c, compress_heuristic_skip);
+			ret = BCH_COMPRESSION_TYPE_incompressible;
+			goto out;
+		}
+	}
+
+	dst_data = bio_map_or_bounce(c, dst, WRITE);
+
+	ctx = compress_ctx_get(c, compression.type, WRITE);
+
 	/*
 	 * XXX: this algorithm sucks when the compression code doesn't tell us
 	 * how much would fit, like LZ4 does:
@@ -473,7 +772,7 @@ static unsigned __bio_compress(struct bch_fs *c,
 			break;
 		}
 
-		ret = attempt_compress(c, workspace,
+		ret = attempt_compress(c, ctx,
 				       dst_data.b,	*dst_len,
 				       src_data.b,	*src_len,
 				       compression);
@@ -501,7 +800,7 @@ static unsigned __bio_compress(struct bch_fs *c,
 		*src_len = round_down(*src_len, block_bytes(c));
 	}
 
-	mempool_free(workspace, workspace_pool);
+	compress_ctx_put(c, ctx);
 
 	if (ret)
 		goto err;
@@ -523,12 +822,19 @@ static unsigned __bio_compress(struct bch_fs *c,
 	BUG_ON(!*src_len || *src_len > src->bi_iter.bi_size);
 	BUG_ON(*dst_len & (block_bytes(c) - 1));
 	BUG_ON(*src_len & (block_bytes(c) - 1));
+
+	if (audit)
+		count_event(c, compress_heuristic_false_negative);
+	compress_history_add(wp, false);
 	ret = compression_type;
 out:
 	bio_unmap_or_unbounce(c, src_data);
 	bio_unmap_or_unbounce(c, dst_data);
 	return ret;
 err:
+	if (!audit)
+		count_event(c, compress_heuristic_miss);
+	compress_history_add(wp, true);
 	ret = BCH_COMPRESSION_TYPE_incompressible;
 	goto out;
 fsck_err:
@@ -537,6 +843,7 @@ fsck_err:
 }
 
 unsigned bch2_bio_compress(struct bch_fs *c,
+			   struct write_point *wp,
 			   struct bio *dst, size_t *dst_len,
 			   struct bio *src, size_t *src_len,
 			   unsigned compression_opt)
@@ -552,7 +859,7 @@ unsigned bch2_bio_compress(struct bch_fs *c,
 	dst->bi_iter.bi_size = min(dst->bi_iter.bi_size, src->bi_iter.bi_size);
 
 	compression_type =
-		__bio_compress(c, dst, dst_len, src, src_len,
+		__bio_compress(c, wp, dst, dst_len, src, src_len,
 			       bch2_compression_decode(compression_opt));
 
 	dst->bi_iter.bi_size = orig_dst;
@@ -616,6 +923,11 @@ void bch2_fs_compress_exit(struct bch_fs *c)
 {
 	unsigned i;
 
+	if (c->compress_ctx_shrink) {
+		shrinker_free(c->compress_ctx_shrink);
+		compress_ctx_free_idle(c, ULONG_MAX);
+	}
+
 	for (i = 0; i < ARRAY_SIZE(c->compress_workspace); i++)
 		mempool_exit(&c->compress_workspace[i]);
 	mempool_exit(&c->compression_bounce[WRITE]);
@@ -674,7 +986,7 @@ static int __bch2_fs_compress_init(struct bch_fs *c, u64 features)
 
 		if (mempool_init_kvmalloc_pool(
 				&c->compress_workspace[i->type],
-				1, i->compress_workspace))
+				1, sizeof(struct compress_ctx) + i->compress_workspace))
 			return -BCH_ERR_ENOMEM_compression_workspace_init;
 	}
 
@@ -690,8 +1002,25 @@ static u64 compression_opt_to_feature(unsigned v)
 
 int bch2_fs_compress_init(struct bch_fs *c)
 {
+	struct shrinker *shrink;
 	u64 f = c->sb.features;
 
+	spin_lock_init(&c->compress_ctx_lock);
+	for (unsigned i = 0; i < BCH_COMPRESSION_OPT_NR; i++) {
+		INIT_LIST_HEAD(&c->compress_ctx_idle[i][READ]);
+		INIT_LIST_HEAD(&c->compress_ctx_idle[i][WRITE]);
+	}
+
+	shrink = shrinker_alloc(0, "%s-compress_ctx", c->name);
+	if (!shrink)
+		return -BCH_ERR_ENOMEM_compress_ctx_init;
+	c->compress_ctx_shrink = shrink;
+	shrink->count_objects	= bch2_compress_ctx_count;
+	shrink->scan_objects	= bch2_compress_ctx_scan;
+	shrink->seeks		= 1;
+	shrink->private_data	= c;
+	shrinker_register(shrink);
+
 	f |= compression_opt_to_feature(c->opts.compression);
 	f |= compression_opt_to_feature(c->opts.background_compression);
 
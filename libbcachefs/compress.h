@@ -51,7 +51,9 @@ struct bch_write_op;
 int bch2_bio_uncompress_inplace(struct bch_write_op *, struct bio *);
 int bch2_bio_uncompress(struct bch_fs *, struct bio *, struct bio *,
 		       struct bvec_iter, struct bch_extent_crc_unpacked);
-unsigned bch2_bio_compress(struct bch_fs *, struct bio *, size_t *,
+struct write_point;
+unsigned bch2_bio_compress(struct bch_fs *, struct write_point *,
+			   struct bio *, size_t *,
 			   struct bio *, size_t *, unsigned);
 
 int bch2_check_set_has_compressed_data(struct bch_fs *, unsigned);
@@ -797,6 +797,12 @@ static void __bch2_read_endio(struct work_struct *work)
 
 	nofs_flags = memalloc_nofs_save();
 
+	if (rbio->transform_time) {
+		bch2_time_stats_update(&c->times[BCH_TIME_data_read_transform_wait],
+				       rbio->transform_time);
+		rbio->transform_time = local_clock();
+	}
+
 	/* Reset iterator for checksumming and copying bounced data: */
 	if (rbio->bounce) {
 		src->bi_iter.bi_size		= crc.compressed_size << 9;
@@ -808,7 +814,32 @@ static void __bch2_read_endio(struct work_struct *work)
 
 	bch2_maybe_corrupt_bio(src, bch2_read_corrupt_ratio);
 
-	csum = bch2_checksum_bio(c, crc.csum_type, nonce, src);
+	/*
+	 * If we'll be decrypting, do it in the same pass as checksumming -
+	 * unless narrow_crcs needs the data still encrypted. If the checksum
+	 * is bad the read is retried or fails, so it doesn't matter that we
+	 * decrypted garbage:
+	 */
+	bool decrypted = bch2_csum_type_is_encryption(crc.csum_type) &&
+		likely(!parent->data_update) &&
+		!rbio->narrow_crcs;
+
+	if (decrypted) {
+		unsigned offset = !crc_is_compressed(crc)
+			? (crc.offset + rbio->offset_into_extent) << 9
+			: 0;
+		unsigned len = !crc_is_compressed(crc)
+			? dst_iter.bi_size
+			: src->bi_iter.bi_size;
+
+		ret = __bch2_crypt_checksum_bio(c, crc.csum_type, nonce, src,
+						false, offset, len, &csum);
+		if (ret)
+			goto decrypt_err;
+	} else {
+		csum = bch2_checksum_bio(c, crc.csum_type, nonce, src);
+	}
+
 	bool csum_good = !bch2_crc_cmp(csum, rbio->pick.crc.csum) || c->opts.no_data_io;
 
 	/*
@@ -844,7 +875,9 @@ static void __bch2_read_endio(struct work_struct *work)
 		crc.live_size	= bvec_iter_sectors(rbio->bvec_iter);
 
 		if (crc_is_compressed(crc)) {
-			ret = bch2_encrypt_bio(c, crc.csum_type, nonce, src);
+			ret = !decrypted
+				? bch2_encrypt_bio(c, crc.csum_type, nonce, src)
+				: 0;
 			if (ret)
 				goto decrypt_err;
 
@@ -859,7 +892,9 @@ static void __bch2_read_endio(struct work_struct *work)
 			BUG_ON(src->bi_iter.bi_size < dst_iter.bi_size);
 			src->bi_iter.bi_size = dst_iter.bi_size;
 
-			ret = bch2_encrypt_bio(c, crc.csum_type, nonce, src);
+			ret = !decrypted
+				? bch2_encrypt_bio(c, crc.csum_type, nonce, src)
+				: 0;
 			if (ret)
 				goto decrypt_err;
 
@@ -890,6 +925,12 @@ static void __bch2_read_endio(struct work_struct *work)
 			goto decrypt_err;
 	}
 
+	if (rbio->transform_time) {
+		bch2_time_stats_update(&c->times[BCH_TIME_data_read_transform],
+				       rbio->transform_time);
+		rbio->transform_time = local_clock();
+	}
+
 	if (likely(!(rbio->flags & BCH_READ_in_retry))) {
 		rbio = bch2_rbio_free(rbio);
 		bch2_rbio_done(rbio);
@@ -943,9 +984,11 @@ static void bch2_read_endio(struct bio *bio)
 	    rbio->promote ||
 	    crc_is_compressed(rbio->pick.crc) ||
 	    bch2_csum_type_is_encryption(rbio->pick.crc.csum_type))
-		context = RBIO_CONTEXT_UNBOUND,	wq = system_unbound_wq;
+		context = RBIO_CONTEXT_UNBOUND,	wq = c->read_transform_wq;
 	else if (rbio->pick.crc.csum_type)
-		context = RBIO_CONTEXT_HIGHPRI,	wq = system_highpri_wq;
+		context = RBIO_CONTEXT_HIGHPRI,	wq = c->read_transform_wq;
+
+	rbio->transform_time = wq ? local_clock() : 0;
 
 	bch2_rbio_punt(rbio, __bch2_read_endio, context, wq);
 }
@@ -1212,6 +1255,7 @@ retry_pick:
 	INIT_WORK(&rbio->work, NULL);
 
 	rbio->bio.bi_opf	= orig->bio.bi_opf;
+	rbio->bio.bi_ioprio	= orig->bio.bi_ioprio;
 	rbio->bio.bi_iter.bi_sector = pick.ptr.offset;
 	rbio->bio.bi_end_io	= bch2_read_endio;
 
@@ -1491,6 +1535,8 @@ void bch2_read_bio_to_text(struct printbuf *out, struct bch_read_bio *rbio)
 
 void bch2_fs_io_read_exit(struct bch_fs *c)
 {
+	if (c->read_transform_wq)
+		destroy_workqueue(c->read_transform_wq);
 	if (c->promote_table.tbl)
 		rhashtable_destroy(&c->promote_table);
 	bioset_exit(&c->bio_read_split);
@@ -1518,5 +1564,10 @@ int bch2_fs_io_read_init(struct bch_fs *c)
 	if (rhashtable_init(&c->promote_table, &bch_promote_params))
 		return -BCH_ERR_ENOMEM_promote_table_init;
 
+	c->read_transform_wq = alloc_workqueue("bcachefs_read_transform",
+				WQ_HIGHPRI|WQ_MEM_RECLAIM|WQ_UNBOUND|WQ_CPU_INTENSIVE, 0);
+	if (!c->read_transform_wq)
+		return -BCH_ERR_ENOMEM_read_transform_init;
+
 	return 0;
 }
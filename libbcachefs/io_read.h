@@ -11,6 +11,8 @@ struct bch_read_bio {
 	struct bch_fs		*c;
 	u64			start_time;
 	u64			submit_time;
+	/* when queued for, then when done with, transforming - for time stats: */
+	u64			transform_time;
 
 	/*
 	 * Reads will often have to be split, and if the extent being read from
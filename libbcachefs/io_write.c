@@ -467,6 +467,7 @@ void bch2_submit_wbio_replicas(struct bch_write_bio *wbio, struct bch_fs *c,
 {
 	struct bkey_ptrs_c ptrs = bch2_bkey_ptrs_c(bkey_i_to_s_c(k));
 	struct bch_write_bio *n;
+	struct blk_plug plug;
 	unsigned ref_rw  = type == BCH_DATA_btree ? READ : WRITE;
 	unsigned ref_idx = type == BCH_DATA_btree
 		? BCH_DEV_READ_REF_btree_node_write
@@ -474,6 +475,8 @@ void bch2_submit_wbio_replicas(struct bch_write_bio *wbio, struct bch_fs *c,
 
 	BUG_ON(c->opts.nochanges);
 
+	blk_start_plug(&plug);
+
 	bkey_for_each_ptr(ptrs, ptr) {
 		/*
 		 * XXX: btree writes should be using io_ref[WRITE], but we
@@ -527,6 +530,8 @@ void bch2_submit_wbio_replicas(struct bch_write_bio *wbio, struct bch_fs *c,
 			bio_endio(&n->bio);
 		}
 	}
+
+	blk_finish_plug(&plug);
 }
 
 static void __bch2_write(struct bch_write_op *);
@@ -820,6 +825,7 @@ static struct bio *bch2_write_bio_alloc(struct bch_fs *c,
 	wbio->put_bio		= true;
 	/* copy WRITE_SYNC flag */
 	wbio->bio.bi_opf	= src->bi_opf;
+	wbio->bio.bi_ioprio	= src->bi_ioprio;
 
 	if (buf) {
 		bch2_bio_map(bio, buf, output_available);
@@ -904,17 +910,25 @@ static noinline int bch2_write_prep_encoded_data(struct bch_write_op *op, struct
 	if (crc_is_compressed(op->crc)) {
 		/* Last point we can still verify checksum: */
 		struct nonce nonce = extent_nonce(op->version, op->crc);
-		csum = bch2_checksum_bio(c, op->crc.csum_type, nonce, bio);
-		if (bch2_crc_cmp(op->crc.csum, csum) && !c->opts.no_data_io)
-			goto csum_err;
 
 		if (bch2_csum_type_is_encryption(op->crc.csum_type)) {
-			ret = bch2_encrypt_bio(c, op->crc.csum_type, nonce, bio);
+			/*
+			 * Decrypting before we know the checksum is good is
+			 * fine: on a checksum error the write fails anyways
+			 */
+			ret = bch2_checksum_decrypt_bio(c, op->crc.csum_type,
+							nonce, bio, &csum);
 			if (ret)
 				return ret;
+			if (bch2_crc_cmp(op->crc.csum, csum) && !c->opts.no_data_io)
+				goto csum_err;
 
 			op->crc.csum_type = 0;
 			op->crc.csum = (struct bch_csum) { 0, 0 };
+		} else {
+			csum = bch2_checksum_bio(c, op->crc.csum_type, nonce, bio);
+			if (bch2_crc_cmp(op->crc.csum, csum) && !c->opts.no_data_io)
+				goto csum_err;
 		}
 
 		ret = bch2_bio_uncompress_inplace(op, bio);
@@ -944,13 +958,13 @@ static noinline int bch2_write_prep_encoded_data(struct bch_write_op *op, struct
 	if (bch2_csum_type_is_encryption(op->crc.csum_type) &&
 	    (op->compression_opt || op->crc.csum_type != op->csum_type)) {
 		struct nonce nonce = extent_nonce(op->version, op->crc);
-		csum = bch2_checksum_bio(c, op->crc.csum_type, nonce, bio);
-		if (bch2_crc_cmp(op->crc.csum, csum) && !c->opts.no_data_io)
-			goto csum_err;
 
-		ret = bch2_encrypt_bio(c, op->crc.csum_type, nonce, bio);
+		ret = bch2_checksum_decrypt_bio(c, op->crc.csum_type,
+						nonce, bio, &csum);
 		if (ret)
 			return ret;
+		if (bch2_crc_cmp(op->crc.csum, csum) && !c->opts.no_data_io)
+			goto csum_err;
 
 		op->crc.csum_type = 0;
 		op->crc.csum = (struct bch_csum) { 0, 0 };
@@ -971,6 +985,417 @@ csum_err:
 	return -BCH_ERR_data_write_csum;
 }
 
+/*
+ * Write pipeline:
+ *
+ * Compressing, checksumming and encrypting a big write one extent at a time,
+ * in the submitting thread, limits it to a single core. So we carve off up to
+ * opts.write_pipeline_depth extents at a time and transform them in parallel,
+ * on c->write_transform_wq with the submitting thread doing its share.
+ *
+ * Everything that has to happen in order - consuming space from the write
+ * point, assigning versions and nonces, appending keys - is still done by the
+ * submitting thread, between the parallel stages:
+ *
+ *  - compress each extent's worth of input into a scratch buffer
+ *  - lay out the results in @dst, in order, up to the first that doesn't fit
+ *  - copy each into @dst, then checksum and encrypt it
+ *
+ * Whatever didn't fit is left for the serial loop in bch2_write_extent(). The
+ * output is what the serial loop would have produced, except that extents are
+ * never longer than encoded_extent_max, and we don't retry compressing a
+ * shorter extent to exactly fill the write point.
+ */
+
+#define WRITE_PIPELINE_MAX_DEPTH	64
+
+struct write_pipeline_extent {
+	struct bvec_iter		src_iter;
+	struct bvec_iter		dst_iter;
+	struct bio			*scratch;
+	size_t				src_len;
+	size_t				dst_len;
+	struct bversion			version;
+	struct bch_extent_crc_unpacked	crc;
+	int				ret;
+};
+
+struct write_pipeline {
+	struct list_head		list;
+	struct bch_write_op		*op;
+	struct write_point		*wp;
+	struct bio			*src;
+	struct bio			*dst;
+
+	struct bch_parallel		parallel;
+
+	/* scratch buffers, of extent_max each, only allocated for compression: */
+	void				*scratch_buf;
+	unsigned			extent_max;
+	unsigned			nr;
+	struct write_pipeline_extent	e[];
+};
+
+static inline struct write_pipeline *to_write_pipeline(struct bch_parallel *p)
+{
+	return container_of(p, struct write_pipeline, parallel);
+}
+
+/* A bio sharing @bio's pages, for just the part of it @iter covers: */
+static void write_pipeline_bio_view(struct bio *view, struct bio *bio,
+				    struct bvec_iter iter)
+{
+	bio_init(view, NULL, bio->bi_io_vec, bio->bi_max_vecs, 0);
+	view->bi_vcnt	= bio->bi_vcnt;
+	view->bi_iter	= iter;
+}
+
+static void write_pipeline_compress(struct bch_parallel *parallel, unsigned i)
+{
+	struct write_pipeline *p = to_write_pipeline(parallel);
+	struct write_pipeline_extent *e = &p->e[i];
+	struct bio src;
+
+	write_pipeline_bio_view(&src, p->src, e->src_iter);
+	e->scratch->bi_iter = (struct bvec_iter) { .bi_size = p->extent_max };
+
+	e->crc.compression_type =
+		bch2_bio_compress(p->op->c, p->wp, e->scratch, &e->dst_len,
+				  &src, &e->src_len, p->op->compression_opt);
+	if (!crc_is_compressed(e->crc))
+		e->src_len = e->dst_len = e->src_iter.bi_size;
+}
+
+static void write_pipeline_encode(struct bch_parallel *parallel, unsigned i)
+{
+	struct write_pipeline *p = to_write_pipeline(parallel);
+	struct write_pipeline_extent *e = &p->e[i];
+	struct bch_write_op *op = p->op;
+	struct bch_fs *c = op->c;
+	struct nonce nonce = extent_nonce(e->version, e->crc);
+	struct bvec_iter dst_iter = e->dst_iter;
+	struct bio dst;
+
+	if (crc_is_compressed(e->crc)) {
+		struct bvec_iter src_iter = e->scratch->bi_iter;
+
+		bio_copy_data_iter(p->dst, &dst_iter, e->scratch, &src_iter);
+	} else if (p->dst != p->src) {
+		struct bvec_iter src_iter = e->src_iter;
+
+		bio_copy_data_iter(p->dst, &dst_iter, p->src, &src_iter);
+	}
+
+	write_pipeline_bio_view(&dst, p->dst, e->dst_iter);
+
+	if (bch2_csum_type_is_encryption(op->csum_type))
+		e->ret = bch2_encrypt_checksum_bio(c, op->csum_type, nonce,
+						   &dst, &e->crc.csum);
+	else
+		e->crc.csum = bch2_checksum_bio(c, op->csum_type, nonce, &dst);
+	e->crc.csum_type = op->csum_type;
+}
+
+/*
+ * Pipelines - and their scratch buffers, a megabyte at the default depth - are
+ * kept between writes: up to one per cpu stays cached, like compression
+ * contexts, and the shrinker frees idle ones.
+ */
+
+static void write_pipeline_free_scratch(struct write_pipeline *p)
+{
+	for (unsigned i = 0; i < p->nr; i++) {
+		kfree(p->e[i].scratch);
+		p->e[i].scratch = NULL;
+	}
+	kvfree(p->scratch_buf);
+	p->scratch_buf = NULL;
+}
+
+static int write_pipeline_alloc_scratch(struct write_pipeline *p)
+{
+	p->scratch_buf = kvmalloc(p->nr * p->extent_max, GFP_NOFS);
+	if (!p->scratch_buf)
+		return -ENOMEM;
+
+	for (unsigned i = 0; i < p->nr; i++) {
+		struct bio *bio = bio_kmalloc(DIV_ROUND_UP(p->extent_max, PAGE_SIZE) + 1,
+					      GFP_NOFS);
+		if (!bio) {
+			write_pipeline_free_scratch(p);
+			return -ENOMEM;
+		}
+
+		bch2_bio_map(bio, p->scratch_buf + i * p->extent_max, p->extent_max);
+		p->e[i].scratch = bio;
+	}
+
+	return 0;
+}
+
+static void write_pipeline_free(struct write_pipeline *p)
+{
+	write_pipeline_free_scratch(p);
+	bch2_parallel_exit(&p->parallel);
+	kfree(p);
+}
+
+static struct write_pipeline *write_pipeline_alloc(struct bch_fs *c, unsigned nr)
+{
+	struct write_pipeline *p = kzalloc(struct_size(p, e, nr), GFP_NOFS);
+
+	if (!p)
+		return NULL;
+
+	p->nr		= nr;
+	p->extent_max	= c->opts.encoded_extent_max;
+
+	if (bch2_parallel_init(&p->parallel, c->write_transform_wq,
+			       min(nr, num_online_cpus()) - 1, GFP_NOFS)) {
+		kfree(p);
+		return NULL;
+	}
+
+	return p;
+}
+
+/* A pipeline @nr deep, with scratch buffers if we're compressing: */
+static struct write_pipeline *write_pipeline_get(struct bch_write_op *op, unsigned nr)
+{
+	struct bch_fs *c = op->c;
+	struct write_pipeline *p;
+
+	spin_lock(&c->write_pipeline_lock);
+	p = list_first_entry_or_null(&c->write_pipelines_idle,
+				     struct write_pipeline, list);
+	if (p) {
+		list_del(&p->list);
+		c->write_pipelines_nr_idle--;
+	}
+	spin_unlock(&c->write_pipeline_lock);
+
+	/* Options changed since it was cached: */
+	if (p &&
+	    (p->nr != nr ||
+	     p->extent_max != c->opts.encoded_extent_max)) {
+		write_pipeline_free(p);
+		p = NULL;
+	}
+
+	if (!p) {
+		p = write_pipeline_alloc(c, nr);
+		if (!p)
+			return NULL;
+	}
+
+	if (op->compression_opt && !p->scratch_buf &&
+	    write_pipeline_alloc_scratch(p)) {
+		write_pipeline_free(p);
+		return NULL;
+	}
+
+	return p;
+}
+
+static void write_pipeline_put(struct bch_fs *c, struct write_pipeline *p)
+{
+	bool cached = false;
+
+	p->op = NULL;
+	p->wp = NULL;
+	p->src = p->dst = NULL;
+
+	spin_lock(&c->write_pipeline_lock);
+	if (c->write_pipelines_nr_idle < num_online_cpus()) {
+		list_add(&p->list, &c->write_pipelines_idle);
+		c->write_pipelines_nr_idle++;
+		cached = true;
+	}
+	spin_unlock(&c->write_pipeline_lock);
+
+	if (!cached)
+		write_pipeline_free(p);
+}
+
+static unsigned long write_pipeline_free_idle(struct bch_fs *c, unsigned long nr)
+{
+	unsigned long freed = 0;
+
+	while (freed < nr) {
+		struct write_pipeline *p;
+
+		spin_lock(&c->write_pipeline_lock);
+		p = list_first_entry_or_null(&c->write_pipelines_idle,
+					     struct write_pipeline, list);
+		if (p) {
+			list_del(&p->list);
+			c->write_pipelines_nr_idle--;
+		}
+		spin_unlock(&c->write_pipeline_lock);
+
+		if (!p)
+			break;
+
+		write_pipeline_free(p);
+		freed++;
+	}
+
+	return freed;
+}
+
+static unsigned long bch2_write_pipeline_count(struct shrinker *shrink,
+					       struct shrink_control *sc)
+{
+	struct bch_fs *c = shrink->private_data;
+
+	return READ_ONCE(c->write_pipelines_nr_idle);
+}
+
+static unsigned long bch2_write_pipeline_scan(struct shrinker *shrink,
+					      struct shrink_control *sc)
+{
+	struct bch_fs *c = shrink->private_data;
+
+	return write_pipeline_free_idle(c, sc->nr_to_scan);
+}
+
+/*
+ * Returns the number of extents to transform at a time, or 0 if this write
+ * should just be done by the serial loop:
+ */
+static unsigned bch2_write_pipeline_nr(struct bch_write_op *op,
+				       struct write_point *wp,
+				       struct bio *src, struct bio *dst)
+{
+	struct bch_fs *c = op->c;
+	unsigned depth = min_t(unsigned, c->opts.write_pipeline_depth,
+			       WRITE_PIPELINE_MAX_DEPTH);
+	/*
+	 * We don't know how big compressed extents will be until they've been
+	 * compressed: only compress as many as would fit uncompressed, so that
+	 * none of that work is thrown away. The serial loop, which compresses
+	 * to fit, fills whatever space is left:
+	 */
+	unsigned bytes = op->compression_opt
+		? min(src->bi_iter.bi_size, wp->sectors_free << 9)
+		: min3(src->bi_iter.bi_size, dst->bi_iter.bi_size,
+		       wp->sectors_free << 9);
+
+	if (depth < 2 ||
+	    num_online_cpus() < 2 ||
+	    (op->flags & BCH_WRITE_data_encoded) ||
+	    !(op->compression_opt || op->csum_type))
+		return 0;
+
+	unsigned nr = min(depth, bytes / c->opts.encoded_extent_max);
+	return nr >= 2 ? nr : 0;
+}
+
+static int bch2_write_extent_pipeline(struct bch_write_op *op,
+				      struct write_point *wp,
+				      struct bio *src, struct bio *dst,
+				      unsigned nr,
+				      unsigned *total_input,
+				      unsigned *total_output)
+{
+	struct bch_fs *c = op->c;
+	struct write_pipeline *p;
+	struct bvec_iter iter;
+	unsigned avail, placed = 0;
+	int ret = 0;
+
+	p = write_pipeline_get(op, min_t(unsigned, c->opts.write_pipeline_depth,
+					 WRITE_PIPELINE_MAX_DEPTH));
+	if (!p)
+		return 0; /* fall back to the serial loop */
+
+	p->op	= op;
+	p->wp	= wp;
+	p->src	= src;
+	p->dst	= dst;
+
+	iter = src->bi_iter;
+	for (unsigned i = 0; i < nr; i++) {
+		struct write_pipeline_extent *e = &p->e[i];
+
+		e->src_iter = iter;
+		e->src_iter.bi_size = min(iter.bi_size, c->opts.encoded_extent_max);
+		e->src_len = e->dst_len = e->src_iter.bi_size;
+		e->crc = (struct bch_extent_crc_unpacked) {
+			.compression_type = op->incompressible
+				? BCH_COMPRESSION_TYPE_incompressible
+				: 0,
+		};
+		e->ret = 0;
+		bio_advance_iter(src, &iter, e->src_iter.bi_size);
+	}
+
+	if (op->compression_opt)
+		bch2_parallel_run(&p->parallel, write_pipeline_compress, nr);
+
+	/* Lay out the output, and do everything that has to be done in order: */
+	avail = min(dst->bi_iter.bi_size, wp->sectors_free << 9);
+	iter = dst->bi_iter;
+	for (unsigned i = 0; i < nr; i++) {
+		struct write_pipeline_extent *e = &p->e[i];
+
+		if (e->dst_len > avail ||
+		    bch2_keylist_realloc(&op->insert_keys,
+					 op->inline_keys,
+					 ARRAY_SIZE(op->inline_keys),
+					 (i + 1) * BKEY_EXTENT_U64s_MAX))
+			break;
+
+		e->dst_iter = dst != src ? iter : e->src_iter;
+		e->dst_iter.bi_size = e->dst_len;
+		bio_advance_iter(dst, &iter, e->dst_len);
+		avail -= e->dst_len;
+
+		e->version = op->version;
+		if (bch2_csum_type_is_encryption(op->csum_type)) {
+			if (bversion_zero(e->version)) {
+				e->version.lo = atomic64_inc_return(&c->key_version);
+			} else {
+				e->crc.nonce = op->nonce;
+				op->nonce += e->src_len >> 9;
+			}
+		}
+
+		e->crc.compressed_size		= e->dst_len >> 9;
+		e->crc.uncompressed_size	= e->src_len >> 9;
+		e->crc.live_size		= e->src_len >> 9;
+		placed++;
+
+		/* The next extent's input doesn't start where this one's ended: */
+		if (e->src_len != e->src_iter.bi_size)
+			break;
+	}
+
+	if (placed)
+		bch2_parallel_run(&p->parallel, write_pipeline_encode, placed);
+
+	for (unsigned i = 0; i < placed; i++) {
+		ret = p->e[i].ret;
+		if (ret)
+			goto out;
+	}
+
+	for (unsigned i = 0; i < placed; i++) {
+		struct write_pipeline_extent *e = &p->e[i];
+
+		init_append_extent(op, wp, e->version, e->crc);
+
+		if (dst != src)
+			bio_advance(dst, e->dst_len);
+		bio_advance(src, e->src_len);
+		*total_output	+= e->dst_len;
+		*total_input	+= e->src_len;
+	}
+out:
+	write_pipeline_put(c, p);
+	return ret;
+}
+
 static int bch2_write_extent(struct bch_write_op *op, struct write_point *wp,
 			     struct bio **_dst)
 {
@@ -1030,7 +1455,27 @@ static int bch2_write_extent(struct bch_write_op *op, struct write_point *wp,
 #endif
 	saved_iter = dst->bi_iter;
 
-	do {
+	unsigned pipeline_nr = !page_alloc_failed
+		? bch2_write_pipeline_nr(op, wp, src, dst)
+		: 0;
+#ifdef CONFIG_BCACHEFS_DEBUG
+	if (write_corrupt_ratio)
+		pipeline_nr = 0;
+#endif
+	if (pipeline_nr) {
+		ret = bch2_write_extent_pipeline(op, wp, src, dst, pipeline_nr,
+						 &total_input, &total_output);
+		if (ret)
+			goto err;
+	}
+
+	while (dst->bi_iter.bi_size &&
+	       src->bi_iter.bi_size &&
+	       wp->sectors_free &&
+	       !bch2_keylist_realloc(&op->insert_keys,
+				     op->inline_keys,
+				     ARRAY_SIZE(op->inline_keys),
+				     BKEY_EXTENT_U64s_MAX)) {
 		struct bch_extent_crc_unpacked crc = { 0 };
 		struct bversion version = op->version;
 		size_t dst_len = 0, src_len = 0;
@@ -1048,7 +1493,7 @@ static int bch2_write_extent(struct bch_write_op *op, struct write_point *wp,
 		crc.compression_type = op->incompressible
 			? BCH_COMPRESSION_TYPE_incompressible
 			: op->compression_opt
-			? bch2_bio_compress(c, dst, &dst_len, src, &src_len,
+			? bch2_bio_compress(c, wp, dst, &dst_len, src, &src_len,
 					    op->compression_opt)
 			: 0;
 		if (!crc_is_compressed(crc)) {
@@ -1125,13 +1570,16 @@ static int bch2_write_extent(struct bch_write_op *op, struct write_point *wp,
 			crc.live_size		= src_len >> 9;
 
 			swap(dst->bi_iter.bi_size, dst_len);
-			ret = bch2_encrypt_bio(c, op->csum_type,
-					       extent_nonce(version, crc), dst);
-			if (ret)
-				goto err;
-
-			crc.csum = bch2_checksum_bio(c, op->csum_type,
-					 extent_nonce(version, crc), dst);
+			if (bch2_csum_type_is_encryption(op->csum_type)) {
+				ret = bch2_encrypt_checksum_bio(c, op->csum_type,
+						extent_nonce(version, crc), dst,
+						&crc.csum);
+				if (ret)
+					goto err;
+			} else {
+				crc.csum = bch2_checksum_bio(c, op->csum_type,
+						 extent_nonce(version, crc), dst);
+			}
 			crc.csum_type = op->csum_type;
 			swap(dst->bi_iter.bi_size, dst_len);
 		}
@@ -1151,13 +1599,7 @@ static int bch2_write_extent(struct bch_write_op *op, struct write_point *wp,
 		bio_advance(src, src_len);
 		total_output	+= dst_len;
 		total_input	+= src_len;
-	} while (dst->bi_iter.bi_size &&
-		 src->bi_iter.bi_size &&
-		 wp->sectors_free &&
-		 !bch2_keylist_realloc(&op->insert_keys,
-				      op->inline_keys,
-				      ARRAY_SIZE(op->inline_keys),
-				      BKEY_EXTENT_U64s_MAX));
+	}
 
 	more = src->bi_iter.bi_size != 0;
 
@@ -1756,6 +2198,10 @@ void bch2_write_op_to_text(struct printbuf *out, struct bch_write_op *op)
 
 void bch2_fs_io_write_exit(struct bch_fs *c)
 {
+	if (c->write_pipeline_shrink) {
+		shrinker_free(c->write_pipeline_shrink);
+		write_pipeline_free_idle(c, ULONG_MAX);
+	}
 	bioset_exit(&c->replica_set);
 	bioset_exit(&c->bio_write);
 }
@@ -1766,5 +2212,18 @@ int bch2_fs_io_write_init(struct bch_fs *c)
 	    bioset_init(&c->replica_set, 4, offsetof(struct bch_write_bio, bio), 0))
 		return -BCH_ERR_ENOMEM_bio_write_init;
 
+	spin_lock_init(&c->write_pipeline_lock);
+	INIT_LIST_HEAD(&c->write_pipelines_idle);
+
+	struct shrinker *shrink = shrinker_alloc(0, "%s-write_pipeline", c->name);
+	if (!shrink)
+		return -BCH_ERR_ENOMEM_write_pipeline_init;
+	c->write_pipeline_shrink = shrink;
+	shrink->count_objects	= bch2_write_pipeline_count;
+	shrink->scan_objects	= bch2_write_pipeline_scan;
+	shrink->seeks		= 1;
+	shrink->private_data	= c;
+	shrinker_register(shrink);
+
 	return 0;
 }
@@ -596,10 +596,12 @@ int bch2_move_data_btree(struct moving_context *ctxt,
 	 * extent):
 	 */
 	bool walk_indirect = start.inode == end.inode;
+	struct blk_plug plug;
 	int ret = 0, ret2;
 
 	per_snapshot_io_opts_init(&snapshot_io_opts, c);
 	bch2_bkey_buf_init(&sk);
+	blk_start_plug(&plug);
 
 	if (ctxt->stats) {
 		ctxt->stats->data_type	= BCH_DATA_user;
@@ -754,6 +756,7 @@ next_nondata:
 			break;
 	}
 out:
+	blk_finish_plug(&plug);
 	bch2_trans_iter_exit(trans, &reflink_iter);
 	bch2_trans_iter_exit(trans, &iter);
 	bch2_bkey_buf_exit(&sk, c);
@@ -825,6 +828,7 @@ static int __bch2_move_data_phys(struct moving_context *ctxt,
 	struct bkey_buf sk;
 	struct bkey_s_c k;
 	struct bkey_buf last_flushed;
+	struct blk_plug plug;
 	int ret = 0;
 
 	struct bch_dev *ca = bch2_dev_tryget(c, dev);
@@ -842,6 +846,9 @@ static int __bch2_move_data_phys(struct moving_context *ctxt,
 	bkey_init(&last_flushed.k->k);
 	bch2_bkey_buf_init(&sk);
 
+	/* Reads of physically adjacent extents can be merged: */
+	blk_start_plug(&plug);
+
 	/*
 	 * We're not run in a context that handles transaction restarts:
 	 */
@@ -950,6 +957,7 @@ next:
 		bch2_btree_iter_advance(trans, &bp_iter);
 	}
 err:
+	blk_finish_plug(&plug);
 	bch2_trans_iter_exit(trans, &bp_iter);
 	bch2_bkey_buf_exit(&sk, c);
 	bch2_bkey_buf_exit(&last_flushed, c);
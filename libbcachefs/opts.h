@@ -496,6 +496,12 @@ enum fsck_err_opts {
 	  BCH2_NO_SB_OPT,		false,				\
 	  NULL,		"Skip submit_bio() for data reads and writes, "	\
 			"for performance testing purposes")		\
+	x(write_pipeline_depth,		u8,				\
+	  OPT_FS|OPT_MOUNT|OPT_RUNTIME,					\
+	  OPT_UINT(0, 64),						\
+	  BCH2_NO_SB_OPT,		8,				\
+	  NULL,		"Number of extents of a write to compress, checksum\n"\
+			"and encrypt in parallel; 0 or 1 does it all inline")\
 	x(state,			u64,				\
 	  OPT_DEVICE|OPT_RUNTIME,					\
 	  OPT_STR(bch2_member_states),					\
@@ -395,6 +395,57 @@ static inline bool six_optimistic_spin(struct six_lock *lock,
 	return false;
 }
 
+#elif !defined(__KERNEL__)
+
+/*
+ * Userspace: we can only see whether the owner is blocked (see schedule()), not
+ * whether it's been preempted, so spinning is bounded by time - and as in the
+ * kernel, a lock we fail to get by spinning isn't spun on again until the next
+ * intent/write unlock. No preempt_disable(): in userspace it takes a lock.
+ *
+ * With one CPU the owner can't be running while we spin, so we never do.
+ */
+bool six_lock_spin = true;
+
+static inline bool six_optimistic_spin(struct six_lock *lock,
+				       struct six_lock_waiter *wait,
+				       enum six_lock_type type)
+{
+	struct task_struct *owner;
+	unsigned loop = 0;
+	u64 end_time;
+
+	if (!six_lock_spin || num_online_cpus() == 1)
+		return false;
+
+	if (type == SIX_LOCK_write)
+		return false;
+
+	if (lock->wait_list.next != &wait->list)
+		return false;
+
+	if (atomic_read(&lock->state) & SIX_LOCK_NOSPIN)
+		return false;
+
+	end_time = ktime_get_mono_fast_ns() + 10 * NSEC_PER_USEC;
+
+	while (!(owner = READ_ONCE(lock->owner)) || owner_on_cpu(owner)) {
+		/* pairs with the smp_store_release in __six_lock_wakeup */
+		if (smp_load_acquire(&wait->lock_acquired))
+			return true;
+
+		if (!(++loop & 0xf) &&
+		    time_after64(ktime_get_mono_fast_ns(), end_time)) {
+			six_set_bitmask(lock, SIX_LOCK_NOSPIN);
+			break;
+		}
+
+		cpu_relax();
+	}
+
+	return false;
+}
+
 #else /* CONFIG_LOCK_SPIN_ON_OWNER */
 
 static inline bool six_optimistic_spin(struct six_lock *lock,
@@ -385,4 +385,9 @@ struct six_lock_count {
 struct six_lock_count six_lock_counts(struct six_lock *);
 void six_lock_readers_add(struct six_lock *, int);
 
+#ifndef __KERNEL__
+/* Spin on the owner before sleeping on contended read/intent locks: */
+extern bool six_lock_spin;
+#endif
+
 #endif /* _LINUX_SIX_H */
@@ -22,6 +22,7 @@
 #include <linux/string.h>
 #include <linux/types.h>
 #include <linux/sched/clock.h>
+#include <linux/sched/mm.h>
 
 #include "eytzinger.h"
 #include "mean_and_variance.h"
@@ -619,6 +620,78 @@ void bch2_pd_controller_debug_to_text(struct printbuf *out, struct bch_pd_contro
 	prt_printf(out, "next io:\t%llims\n", div64_s64(pd->rate.next - local_clock(), NSEC_PER_MSEC));
 }
 
+/* parallel tasks: */
+
+static void bch2_parallel_do_tasks(struct bch_parallel *p)
+{
+	unsigned i;
+
+	while ((i = atomic_inc_return(&p->next_task) - 1) < p->nr_tasks)
+		p->fn(p, i);
+}
+
+static void bch2_parallel_work(struct work_struct *work)
+{
+	struct bch_parallel_worker *w =
+		container_of(work, struct bch_parallel_worker, work);
+	struct bch_parallel *p = w->p;
+	/* we may be working for a thread that's in filesystem context: */
+	unsigned nofs_flags = memalloc_nofs_save();
+
+	bch2_parallel_do_tasks(p);
+	memalloc_nofs_restore(nofs_flags);
+	closure_put(&p->cl);
+}
+
+/* Run @fn on tasks 0..@nr_tasks, in parallel, and wait for them all: */
+void bch2_parallel_run(struct bch_parallel *p,
+		       void (*fn)(struct bch_parallel *, unsigned),
+		       unsigned nr_tasks)
+{
+	if (!nr_tasks)
+		return;
+
+	p->fn		= fn;
+	p->nr_tasks	= nr_tasks;
+	atomic_set(&p->next_task, 0);
+	closure_init_stack(&p->cl);
+
+	for (unsigned i = 0; i < min(p->nr_workers, nr_tasks - 1); i++) {
+		closure_get(&p->cl);
+		queue_work(p->wq, &p->workers[i].work);
+	}
+
+	bch2_parallel_do_tasks(p);
+	closure_sync(&p->cl);
+}
+
+void bch2_parallel_exit(struct bch_parallel *p)
+{
+	kfree(p->workers);
+	p->workers = NULL;
+}
+
+int bch2_parallel_init(struct bch_parallel *p, struct workqueue_struct *wq,
+		       unsigned nr_workers, gfp_t gfp)
+{
+	p->wq		= wq;
+	p->nr_workers	= nr_workers;
+	p->workers	= NULL;
+
+	if (!nr_workers)
+		return 0;
+
+	p->workers = kcalloc(nr_workers, sizeof(p->workers[0]), gfp);
+	if (!p->workers)
+		return -ENOMEM;
+
+	for (unsigned i = 0; i < nr_workers; i++) {
+		INIT_WORK(&p->workers[i].work, bch2_parallel_work);
+		p->workers[i].p = p;
+	}
+	return 0;
+}
+
 /* misc: */
 
 void bch2_bio_map(struct bio *bio, void *base, size_t size)
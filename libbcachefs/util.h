@@ -286,6 +286,35 @@ void bch2_pd_controller_update(struct bch_pd_controller *, s64, s64, int);
 void bch2_pd_controller_init(struct bch_pd_controller *);
 void bch2_pd_controller_debug_to_text(struct printbuf *, struct bch_pd_controller *);
 
+/*
+ * Running a batch of independent tasks in parallel: tasks are numbered, and
+ * claimed in order by up to @nr_workers work items on @wq and by the thread
+ * calling bch2_parallel_run(), which waits for them all - so progress doesn't
+ * depend on the workqueue.
+ */
+struct bch_parallel;
+
+struct bch_parallel_worker {
+	struct work_struct	work;
+	struct bch_parallel	*p;
+};
+
+struct bch_parallel {
+	struct workqueue_struct	*wq;
+	void			(*fn)(struct bch_parallel *, unsigned);
+	unsigned		nr_tasks;
+	atomic_t		next_task;
+	struct closure		cl;
+	unsigned		nr_workers;
+	struct bch_parallel_worker *workers;
+};
+
+void bch2_parallel_run(struct bch_parallel *,
+		       void (*)(struct bch_parallel *, unsigned), unsigned);
+void bch2_parallel_exit(struct bch_parallel *);
+int bch2_parallel_init(struct bch_parallel *, struct workqueue_struct *,
+		       unsigned, gfp_t);
+
 #define sysfs_pd_controller_attribute(name)				\
 	rw_attribute(name##_rate);					\
 	rw_attribute(name##_rate_bytes);				\
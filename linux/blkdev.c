@@ -2,14 +2,21 @@
 #include <alloca.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <sys/ioctl.h>
 #include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
 #include <sys/types.h>
 #include <sys/uio.h>
 #include <unistd.h>
 
 #include <libaio.h>
 
+#ifdef CONFIG_LIBURING
+#include <liburing.h>
+#endif
+
 #ifdef CONFIG_VALGRIND
 #include <valgrind/memcheck.h>
 #endif
@@ -18,54 +25,63 @@
 #include <linux/blkdev.h>
 #include <linux/completion.h>
 #include <linux/fs.h>
+#include <linux/generic-radix-tree.h>
+#include <linux/ioprio.h>
 #include <linux/kthread.h>
+#include <linux/min_heap.h>
+#include <linux/prandom.h>
+#include <linux/random.h>
+#include <linux/sort.h>
 
 #include "tools-util.h"
 
 struct fops {
+	const char *name;
 	void (*init)(void);
 	void (*cleanup)(void);
+	void (*open)(struct block_device *bdev);
+	void (*close)(struct block_device *bdev);
+	int (*register_buffer)(void *buf, size_t len);
+	void (*unregister_buffer)(void *buf);
+	void (*unplug)(void);
+	void (*flush)(struct block_device *bdev);
+	int (*discard)(struct block_device *bdev, enum req_opf op,
+		       sector_t sector, sector_t nr_sects);
 	void (*read)(struct bio *bio, struct iovec * iov, unsigned i);
 	void (*write)(struct bio *bio, struct iovec * iov, unsigned i);
 };
 
 static struct fops *fops;
-static io_context_t aio_ctx;
 static atomic_t running_requests;
 
-void generic_make_request(struct bio *bio)
-{
-	struct iovec *iov;
-	struct bvec_iter iter;
-	struct bio_vec bv;
-	ssize_t ret;
-	unsigned i;
+/* Buffers registered with blkdev_register_buffer(), kept across backend switches: */
+struct blkdev_buf {
+	void			*buf;
+	size_t			len;
+};
 
-	if (bio->bi_opf & REQ_PREFLUSH) {
-		ret = fdatasync(bio->bi_bdev->bd_fd);
-		if (ret) {
-			fprintf(stderr, "fsync error: %m\n");
-			bio->bi_status = BLK_STS_IOERR;
-			bio_endio(bio);
-			return;
-		}
-	}
+static DEFINE_MUTEX(blkdev_bufs_lock);
+static struct blkdev_buf	blkdev_bufs[64];
 
-	i = 0;
-	bio_for_each_segment(bv, bio, iter)
-		i++;
+static void blkdev_merge_endio(struct bio *);
 
-	iov = alloca(sizeof(*iov) * i);
+static unsigned bio_to_iovec(struct bio *bio, struct iovec *iov, unsigned i)
+{
+	struct bvec_iter iter;
+	struct bio_vec bv;
 
-	i = 0;
 	bio_for_each_segment(bv, bio, iter) {
 		void *start = page_address(bv.bv_page) + bv.bv_offset;
 		size_t len = bv.bv_len;
 
-		iov[i++] = (struct iovec) {
-			.iov_base = start,
-			.iov_len = len,
-		};
+		/* Merge segments that are contiguous in memory: */
+		if (i && iov[i - 1].iov_base + iov[i - 1].iov_len == start)
+			iov[i - 1].iov_len += len;
+		else
+			iov[i++] = (struct iovec) {
+				.iov_base = start,
+				.iov_len = len,
+			};
 
 #ifdef CONFIG_VALGRIND
 		/* To be pedantic it should only be on IO completion. */
@@ -74,6 +90,32 @@ void generic_make_request(struct bio *bio)
 #endif
 	}
 
+	return i;
+}
+
+static void blkdev_issue(struct bio *bio)
+{
+	/* Requests merged while plugged carry their bios on bi_private: */
+	bool merged = bio->bi_end_io == blkdev_merge_endio;
+	struct iovec *iov;
+	struct bio *b;
+	unsigned i = 0;
+
+	if (merged)
+		for (b = bio->bi_private; b; b = b->bi_next)
+			i += bio_segments(b);
+	else
+		i = bio_segments(bio);
+
+	iov = alloca(sizeof(*iov) * i);
+
+	i = 0;
+	if (merged)
+		for (b = bio->bi_private; b; b = b->bi_next)
+			i = bio_to_iovec(b, iov, i);
+	else
+		i = bio_to_iovec(bio, iov, i);
+
 	switch (bio_op(bio)) {
 	case REQ_OP_READ:
 		fops->read(bio, iov, i);
@@ -81,354 +123,2575 @@ void generic_make_request(struct bio *bio)
 	case REQ_OP_WRITE:
 		fops->write(bio, iov, i);
 		break;
-	case REQ_OP_FLUSH:
-		ret = fsync(bio->bi_bdev->bd_fd);
-		if (ret)
-			die("fsync error: %m");
-		bio_endio(bio);
-		break;
 	default:
 		BUG();
 	}
 }
 
-static void submit_bio_wait_endio(struct bio *bio)
+/*
+ * IO scheduling:
+ *
+ * Reads and writes are sorted into priority classes, from the bio's ioprio if
+ * set or else its REQ_ flags: journal and btree IO ahead of foreground IO,
+ * ahead of background IO (rebalance, copygc, scrub).
+ *
+ * Each class has a cap on IOs in flight: realtime IO has its own slots, best
+ * effort and idle IO share the device's queue depth, and idle IO only gets
+ * more than a small share of it when nothing else is waiting or in flight.
+ * When a slot frees up the highest priority class with room goes next - except
+ * that an IO that has been queued past its class's deadline goes first, even
+ * over the caps, so background IO can't be starved indefinitely.
+ */
+
+enum io_class {
+	IO_CLASS_RT,
+	IO_CLASS_BE,
+	IO_CLASS_IDLE,
+	IO_CLASS_NR,
+};
+
+static const u64 io_class_deadline_ns[IO_CLASS_NR] = {
+	[IO_CLASS_RT]	= 5 * NSEC_PER_MSEC,
+	[IO_CLASS_BE]	= 50 * NSEC_PER_MSEC,
+	[IO_CLASS_IDLE]	= 500 * NSEC_PER_MSEC,
+};
+
+struct io_sched_entry {
+	struct list_head	list;
+	struct bio		*bio;
+	u64			deadline;
+};
+
+struct io_sched {
+	spinlock_t		lock;
+	unsigned		nr_requests;
+	unsigned		in_flight[IO_CLASS_NR];
+	struct list_head	queued[IO_CLASS_NR];
+};
+
+static enum io_class bio_io_class(struct bio *bio)
 {
-	complete(bio->bi_private);
+	switch (IOPRIO_PRIO_CLASS(bio->bi_ioprio)) {
+	case IOPRIO_CLASS_RT:
+		return IO_CLASS_RT;
+	case IOPRIO_CLASS_BE:
+		return IO_CLASS_BE;
+	case IOPRIO_CLASS_IDLE:
+		return IO_CLASS_IDLE;
+	}
+
+	if (bio->bi_opf & (REQ_META|REQ_PRIO))
+		return IO_CLASS_RT;
+	if (bio->bi_opf & REQ_BACKGROUND)
+		return IO_CLASS_IDLE;
+	return IO_CLASS_BE;
 }
 
-int submit_bio_wait(struct bio *bio)
+static bool io_sched_can_start(struct io_sched *s, enum io_class c)
 {
-	struct completion done;
-
-	init_completion(&done);
-	bio->bi_private = &done;
-	bio->bi_end_io = submit_bio_wait_endio;
-	bio->bi_opf |= REQ_SYNC;
-	submit_bio(bio);
-	wait_for_completion(&done);
+	unsigned shared = s->in_flight[IO_CLASS_BE] + s->in_flight[IO_CLASS_IDLE];
 
-	return blk_status_to_errno(bio->bi_status);
+	switch (c) {
+	case IO_CLASS_RT:
+		return s->in_flight[IO_CLASS_RT] < s->nr_requests;
+	case IO_CLASS_BE:
+		return shared < s->nr_requests;
+	default:
+		if (shared >= s->nr_requests)
+			return false;
+		if (s->in_flight[IO_CLASS_RT] ||
+		    s->in_flight[IO_CLASS_BE] ||
+		    !list_empty(&s->queued[IO_CLASS_RT]) ||
+		    !list_empty(&s->queued[IO_CLASS_BE]))
+			return s->in_flight[IO_CLASS_IDLE] < max(s->nr_requests / 8, 1U);
+		return true;
+	}
 }
 
-int blkdev_issue_discard(struct block_device *bdev,
-			 sector_t sector, sector_t nr_sects,
-			 gfp_t gfp_mask)
+/* Pick the next queued IO to start, with the lock held: */
+static struct io_sched_entry *io_sched_next(struct io_sched *s, u64 now, bool *expired_ok)
 {
-	return 0;
+	struct io_sched_entry *e;
+	int c;
+
+	if (*expired_ok)
+		for (c = IO_CLASS_NR - 1; c >= 0; --c) {
+			e = list_first_entry_or_null(&s->queued[c],
+						     struct io_sched_entry, list);
+			if (e && time_after_eq64(now, e->deadline)) {
+				/* Only one IO past the caps per completion: */
+				*expired_ok = false;
+				goto found;
+			}
+		}
+
+	for (c = 0; c < IO_CLASS_NR; c++) {
+		e = list_first_entry_or_null(&s->queued[c],
+					     struct io_sched_entry, list);
+		if (e && io_sched_can_start(s, c))
+			goto found;
+	}
+
+	return NULL;
+found:
+	list_del(&e->list);
+	s->in_flight[c]++;
+	return e;
 }
 
-int blkdev_issue_zeroout(struct block_device *bdev,
-			 sector_t sector, sector_t nr_sects,
-			 gfp_t gfp_mask, unsigned flags)
+static void io_sched_start_list(struct list_head *list)
 {
-	/* Not yet implemented: */
-	BUG();
+	struct io_sched_entry *e, *n;
+
+	list_for_each_entry_safe(e, n, list, list) {
+		blkdev_issue(e->bio);
+		kfree(e);
+	}
 }
 
-unsigned bdev_logical_block_size(struct block_device *bdev)
+static void blkdev_dispatch(struct bio *bio)
 {
-	struct stat statbuf;
-	unsigned blksize;
-	int ret;
+	struct io_sched *s = bio->bi_bdev->queue.sched;
+	enum io_class c = bio_io_class(bio);
+	struct io_sched_entry *e;
 
-	ret = fstat(bdev->bd_fd, &statbuf);
-	BUG_ON(ret);
+	spin_lock(&s->lock);
+	if (list_empty(&s->queued[c]) && io_sched_can_start(s, c)) {
+		s->in_flight[c]++;
+		spin_unlock(&s->lock);
 
-	if (!S_ISBLK(statbuf.st_mode))
-		return statbuf.st_blksize;
+		blkdev_issue(bio);
+		return;
+	}
 
-	xioctl(bdev->bd_fd, BLKPBSZGET, &blksize);
-	return blksize;
+	e = kmalloc(sizeof(*e), GFP_NOFS|__GFP_NOFAIL);
+	e->bio		= bio;
+	e->deadline	= ktime_get_ns() + io_class_deadline_ns[c];
+	list_add_tail(&e->list, &s->queued[c]);
+	spin_unlock(&s->lock);
 }
 
-sector_t get_capacity(struct gendisk *disk)
+/* Backends complete reads and writes with this, instead of bio_endio(): */
+static void blkdev_endio(struct bio *bio)
 {
-	struct block_device *bdev =
-		container_of(disk, struct block_device, __bd_disk);
-	struct stat statbuf;
-	u64 bytes;
-	int ret;
+	struct io_sched *s = bio->bi_bdev->queue.sched;
+	struct io_sched_entry *e;
+	bool expired_ok = true;
+	u64 now = ktime_get_ns();
+	LIST_HEAD(start);
+
+	/* Before bio_endio(), which may lead to the device being closed: */
+	spin_lock(&s->lock);
+	s->in_flight[bio_io_class(bio)]--;
+	while ((e = io_sched_next(s, now, &expired_ok)))
+		list_add_tail(&e->list, &start);
+	spin_unlock(&s->lock);
 
-	ret = fstat(bdev->bd_fd, &statbuf);
-	BUG_ON(ret);
+	bio_endio(bio);
+	io_sched_start_list(&start);
+}
 
-	if (!S_ISBLK(statbuf.st_mode))
-		return statbuf.st_size >> 9;
+static struct io_sched *io_sched_alloc(struct block_device *bdev)
+{
+	struct io_sched *s = kzalloc(sizeof(*s), GFP_KERNEL);
 
-	ret = ioctl(bdev->bd_fd, BLKGETSIZE64, &bytes);
-	BUG_ON(ret);
+	if (!s)
+		die("error allocating io scheduler");
 
-	return bytes >> 9;
+	spin_lock_init(&s->lock);
+	s->nr_requests = bdev->queue.nr_requests;
+	for (unsigned i = 0; i < IO_CLASS_NR; i++)
+		INIT_LIST_HEAD(&s->queued[i]);
+	return s;
 }
 
-void bdev_fput(struct file *file)
+static void io_sched_free(struct io_sched *s)
 {
-	struct block_device *bdev = file_bdev(file);
-
-	fdatasync(bdev->bd_fd);
-	close(bdev->bd_fd);
-	free(bdev);
-	free(file);
+	for (unsigned i = 0; i < IO_CLASS_NR; i++)
+		BUG_ON(s->in_flight[i] || !list_empty(&s->queued[i]));
+	kfree(s);
 }
 
-struct file *bdev_file_open_by_path(const char *path, blk_mode_t mode,
-				    void *holder, const struct blk_holder_ops *hop)
+/*
+ * Flush sequencing:
+ *
+ * A flush only has to cover writes that completed before it was submitted, so
+ * concurrent flushes to the same device are merged: while a flush is in flight,
+ * new flush requests queue up behind it and are all covered by the next one,
+ * issued when the current one completes. However many flush requests there
+ * are, each device has at most one flush in flight.
+ *
+ * REQ_PREFLUSH writes are held until their flush completes, then dispatched;
+ * REQ_FUA is handled by the backends with RWF_DSYNC.
+ *
+ * Backends issue flushes asynchronously with ->flush() and call
+ * blkdev_flush_done() when they complete: if that returns true, more flush
+ * requests came in meanwhile and the backend must issue another.
+ */
+static bool blkdev_flush_done(struct block_device *bdev, int ret)
 {
-	int fd, flags = 0;
-
-	if ((mode & (BLK_OPEN_READ|BLK_OPEN_WRITE)) == (BLK_OPEN_READ|BLK_OPEN_WRITE))
-		flags = O_RDWR;
-	else if (mode & BLK_OPEN_READ)
-		flags = O_RDONLY;
-	else if (mode & BLK_OPEN_WRITE)
-		flags = O_WRONLY;
+	struct request_queue *q = &bdev->queue;
+	struct bio *bio, *next, *done = NULL;
+	bool again;
+
+	spin_lock(&q->flush_lock);
+	/* Waitlists are LIFO, reverse so we complete in submission order: */
+	for (bio = q->flush_running; bio; bio = next) {
+		next = bio->bi_next;
+		bio->bi_next = done;
+		done = bio;
+	}
 
-	if (!(mode & BLK_OPEN_BUFFERED))
-		flags |= O_DIRECT;
+	q->flush_running	= q->flush_pending;
+	q->flush_pending	= NULL;
+	again = q->flush_in_flight = q->flush_running != NULL;
+	spin_unlock(&q->flush_lock);
 
-	if (mode & BLK_OPEN_EXCL)
-		flags |= O_EXCL;
+	if (ret)
+		fprintf(stderr, "%s: flush error: %s\n", bdev->name, strerror(-ret));
 
-	if (mode & BLK_OPEN_CREAT)
-		flags |= O_CREAT;
+	while ((bio = done)) {
+		done = bio->bi_next;
+		bio->bi_next = NULL;
 
-	fd = open(path, flags, 0600);
-	if (fd < 0)
-		return ERR_PTR(-errno);
+		if (ret) {
+			bio->bi_status = BLK_STS_IOERR;
+			bio_endio(bio);
+		} else if (bio_op(bio) == REQ_OP_FLUSH || !bio->bi_iter.bi_size) {
+			bio_endio(bio);
+		} else {
+			blkdev_dispatch(bio);
+		}
+	}
 
-	struct block_device *bdev = malloc(sizeof(*bdev));
-	memset(bdev, 0, sizeof(*bdev));
+	return again;
+}
 
-	strncpy(bdev->name, path, sizeof(bdev->name));
-	bdev->name[sizeof(bdev->name) - 1] = '\0';
+static void blkdev_flush_submit(struct bio *bio)
+{
+	struct request_queue *q = &bio->bi_bdev->queue;
+	bool issue;
+
+	spin_lock(&q->flush_lock);
+	issue = !q->flush_in_flight;
+	if (issue) {
+		q->flush_in_flight = true;
+		bio->bi_next = q->flush_running;
+		q->flush_running = bio;
+	} else {
+		bio->bi_next = q->flush_pending;
+		q->flush_pending = bio;
+	}
+	spin_unlock(&q->flush_lock);
 
-	bdev->bd_dev		= xfstat(fd).st_rdev;
-	bdev->bd_fd		= fd;
-	bdev->bd_holder		= holder;
-	bdev->bd_disk		= &bdev->__bd_disk;
-	bdev->bd_disk->bdi	= &bdev->bd_disk->__bdi;
-	bdev->queue.backing_dev_info = bdev->bd_disk->bdi;
-	bdev->bd_inode		= &bdev->__bd_inode;
+	if (issue)
+		fops->flush(bio->bi_bdev);
+}
 
-	mutex_init(&bdev->bd_holder_lock);
+/*
+ * Discards and zeroouts:
+ *
+ * These are synchronous ioctls/fallocate calls, so they're handed off to a
+ * thread (started on first use) and completed asynchronously. The thread takes
+ * everything that's queued up, sorts it, and issues one call for each run of
+ * adjacent or overlapping ranges on the same device.
+ */
 
-	struct file *file = calloc(sizeof(*file), 1);
-	file->f_inode = bdev->bd_inode;
+#define DISCARD_BATCH_MAX	256
 
-	return file;
-}
+static DEFINE_SPINLOCK(discard_lock);
+static struct bio		*discard_list;
+static DEFINE_MUTEX(discard_thread_lock);
+static struct task_struct	*discard_thread;
 
-int lookup_bdev(const char *path, dev_t *dev)
+static int discard_bio_cmp(const void *_l, const void *_r)
 {
-	return -EINVAL;
-}
+	const struct bio *l = *((const struct bio **) _l);
+	const struct bio *r = *((const struct bio **) _r);
 
-static void io_fallback(void)
-{
-	fops++;
-	if (fops->init == NULL)
-		die("no fallback possible, something is very wrong");
-	fops->init();
+	return  cmp_int((unsigned long) l->bi_bdev, (unsigned long) r->bi_bdev) ?:
+		cmp_int(bio_op(l), bio_op(r)) ?:
+		cmp_int(l->bi_iter.bi_sector, r->bi_iter.bi_sector);
 }
 
-static void sync_check(struct bio *bio, int ret)
+static int blkdev_zero_write(int fd, u64 start, u64 len)
 {
-	if (ret != bio->bi_iter.bi_size) {
-		die("IO error: %s\n", strerror(-ret));
-	}
+	size_t buf_len = min_t(u64, len, 1 << 20);
+	void *buf = aligned_alloc(PAGE_SIZE, round_up(buf_len, PAGE_SIZE));
+	int ret = 0;
 
-	if (bio->bi_opf & REQ_FUA) {
-		ret = fdatasync(bio->bi_bdev->bd_fd);
-		if (ret)
-			die("fsync error: %s\n", strerror(-ret));
-	}
-	bio_endio(bio);
-}
+	if (!buf)
+		return -ENOMEM;
+	memset(buf, 0, buf_len);
 
-static void sync_init(void) {}
+	while (len) {
+		ssize_t r = pwrite(fd, buf, min_t(u64, len, buf_len), start);
 
-static void sync_cleanup(void)
-{
-	/* not necessary? */
-	sync();
-}
+		if (r < 0 && errno == EINTR)
+			continue;
+		if (r <= 0) {
+			ret = r ? -errno : -EIO;
+			break;
+		}
 
-static void sync_read(struct bio *bio, struct iovec * iov, unsigned i)
-{
+		start	+= r;
+		len	-= r;
+	}
 
-	ssize_t ret = preadv(bio->bi_bdev->bd_fd, iov, i,
-			     bio->bi_iter.bi_sector << 9);
-	sync_check(bio, ret);
+	free(buf);
+	return ret;
 }
 
-static void sync_write(struct bio *bio, struct iovec * iov, unsigned i)
+static int blkdev_discard_range(struct block_device *bdev, enum req_opf op,
+				sector_t sector, sector_t nr_sects)
 {
-	ssize_t ret = pwritev2(bio->bi_bdev->bd_fd, iov, i,
-			       bio->bi_iter.bi_sector << 9,
-			       bio->bi_opf & REQ_FUA ? RWF_SYNC : 0);
-	sync_check(bio, ret);
-}
+	u64 start = sector << 9, len = nr_sects << 9;
+	int fd = bdev->bd_fd, ret;
+
+	if (fops->discard) {
+		ret = fops->discard(bdev, op, sector, nr_sects);
+	} else if (S_ISBLK(xfstat(fd).st_mode)) {
+		u64 range[2] = { start, len };
+
+		ret = ioctl(fd, op == REQ_OP_DISCARD ? BLKDISCARD : BLKZEROOUT, range);
+		ret = ret ? -errno : 0;
+	} else if (op == REQ_OP_DISCARD) {
+		ret = fallocate(fd, FALLOC_FL_PUNCH_HOLE|FALLOC_FL_KEEP_SIZE, start, len);
+		ret = ret ? -errno : 0;
+	} else {
+		ret = fallocate(fd, FALLOC_FL_ZERO_RANGE|FALLOC_FL_KEEP_SIZE, start, len);
+		if (ret && errno == EOPNOTSUPP)
+			ret = fallocate(fd, FALLOC_FL_PUNCH_HOLE|FALLOC_FL_KEEP_SIZE, start, len);
+		ret = ret ? -errno : 0;
 
-static DECLARE_WAIT_QUEUE_HEAD(aio_events_completed);
+		if (ret == -EOPNOTSUPP)
+			ret = blkdev_zero_write(fd, start, len);
+	}
 
-static int aio_completion_thread(void *arg)
-{
-	struct io_event events[8], *ev;
-	int ret;
-	bool stop = false;
+	/* Discards are only a hint: stop sending them if they're not supported */
+	if (op == REQ_OP_DISCARD && ret == -EOPNOTSUPP)
+		WRITE_ONCE(bdev->queue.max_discard_sectors, 0);
 
-	while (!stop) {
-		ret = io_getevents(aio_ctx, 1, ARRAY_SIZE(events),
-				   events, NULL);
+	return ret;
+}
 
-		if (ret < 0 && ret == -EINTR)
-			continue;
-		if (ret < 0)
-			die("io_getevents() error: %s", strerror(-ret));
-		if (ret)
-			wake_up(&aio_events_completed);
+static void blkdev_discard_batch(struct bio **bios, unsigned nr)
+{
+	unsigned i, j;
+
+	sort(bios, nr, sizeof(bios[0]), discard_bio_cmp, NULL);
+
+	for (i = 0; i < nr; i = j) {
+		struct block_device *bdev = bios[i]->bi_bdev;
+		enum req_opf op	= bio_op(bios[i]);
+		sector_t start	= bios[i]->bi_iter.bi_sector;
+		sector_t end	= bio_end_sector(bios[i]);
+		blk_status_t status = BLK_STS_OK;
+		int ret;
+
+		for (j = i + 1;
+		     j < nr &&
+		     bios[j]->bi_bdev == bdev &&
+		     bio_op(bios[j]) == op &&
+		     bios[j]->bi_iter.bi_sector <= end;
+		     j++)
+			end = max(end, bio_end_sector(bios[j]));
+
+		ret = blkdev_discard_range(bdev, op, start, end - start);
+		if (ret == -EOPNOTSUPP)
+			status = BLK_STS_NOTSUPP;
+		else if (ret)
+			status = BLK_STS_IOERR;
+
+		while (i < j) {
+			bios[i]->bi_status = status;
+			bio_endio(bios[i++]);
+		}
+	}
+}
 
-		for (ev = events; ev < events + ret; ev++) {
-			struct bio *bio = (struct bio *) ev->data;
+static int blkdev_discard_thread(void *arg)
+{
+	struct bio *bios[DISCARD_BATCH_MAX], *bio;
+	unsigned nr;
 
-			/* This should only happen during blkdev_cleanup() */
-			if (!bio) {
-				BUG_ON(atomic_read(&running_requests) != 0);
-				stop = true;
-				continue;
-			}
+	while (1) {
+		set_current_state(TASK_INTERRUPTIBLE);
 
-			if (ev->res != bio->bi_iter.bi_size)
-				bio->bi_status = BLK_STS_IOERR;
+		spin_lock(&discard_lock);
+		for (nr = 0; nr < ARRAY_SIZE(bios) && (bio = discard_list); nr++) {
+			discard_list = bio->bi_next;
+			bio->bi_next = NULL;
+			bios[nr] = bio;
+		}
+		spin_unlock(&discard_lock);
 
-			bio_endio(bio);
-			atomic_dec(&running_requests);
+		if (nr) {
+			__set_current_state(TASK_RUNNING);
+			blkdev_discard_batch(bios, nr);
+			continue;
 		}
+
+		if (kthread_should_stop())
+			break;
+		schedule();
 	}
 
+	__set_current_state(TASK_RUNNING);
 	return 0;
 }
 
-static struct task_struct *aio_task = NULL;
-
-static void aio_init(void)
+static void blkdev_discard_submit(struct bio *bio)
 {
-	struct task_struct *p;
-	long err = io_setup(256, &aio_ctx);
-	if (!err) {
-		p = kthread_run(aio_completion_thread, NULL, "aio_completion");
-		BUG_ON(IS_ERR(p));
+	if (unlikely(!READ_ONCE(discard_thread))) {
+		mutex_lock(&discard_thread_lock);
+		if (!discard_thread) {
+			struct task_struct *p =
+				kthread_run(blkdev_discard_thread, NULL, "blkdev_discard");
+			BUG_ON(IS_ERR(p));
+
+			get_task_struct(p);
+			WRITE_ONCE(discard_thread, p);
+		}
+		mutex_unlock(&discard_thread_lock);
+	}
 
-		aio_task = p;
+	spin_lock(&discard_lock);
+	bio->bi_next = discard_list;
+	discard_list = bio;
+	spin_unlock(&discard_lock);
 
-	} else if (err == -ENOSYS) {
-		io_fallback();
-	} else {
-		die("io_setup() error: %s", strerror(err));
-	}
+	wake_up_process(discard_thread);
 }
 
-static void aio_cleanup(void)
+static void blkdev_discard_exit(void)
 {
 	struct task_struct *p = NULL;
-	swap(aio_task, p);
-	get_task_struct(p);
 
-	/* I mean, really?! IO_CMD_NOOP is even defined, but not implemented. */
-	int fds[2];
-	int ret = pipe(fds);
-	if (ret != 0)
-		die("pipe err: %s", strerror(ret));
+	swap(discard_thread, p);
+	if (p) {
+		kthread_stop(p);
+		put_task_struct(p);
+	}
+}
 
-	/* Wake up the completion thread with spurious work. */
-	int junk = 0;
-	struct iocb iocb = {
-		.aio_lio_opcode = IO_CMD_PWRITE,
-		.data = NULL, /* Signal to stop */
-		.aio_fildes = fds[1],
-		.u.c.buf = &junk,
-		.u.c.nbytes = 1,
-	}, *iocbp = &iocb;
-	ret = io_submit(aio_ctx, 1, &iocbp);
-	if (ret != 1)
-		die("io_submit cleanup err: %s", strerror(-ret));
+/*
+ * Plugging:
+ *
+ * While plugged, reads and writes are held on the plug instead of being
+ * dispatched, up to BLK_MAX_REQUEST_COUNT of them. When the plug is flushed
+ * they're sorted, and runs of bios that are contiguous on disk - same device,
+ * direction and priority class - are merged into a single vectored request.
+ */
 
-	ret = kthread_stop(p);
-	BUG_ON(ret);
+#define BLK_MAX_REQUEST_COUNT	32
+#define BLK_MERGE_MAX_SEGS	256
+#define BLK_MERGE_MAX_BYTES	(1U << 20)
 
-	put_task_struct(p);
+static atomic64_t blk_nr_plugged;
+static atomic64_t blk_nr_merged;
 
-	xclose(fds[0]);
-	xclose(fds[1]);
+void blk_plug_stats(struct blk_plug_stats *stats)
+{
+	stats->plugged	= atomic64_read(&blk_nr_plugged);
+	stats->merged	= atomic64_read(&blk_nr_merged);
 }
 
-static void aio_op(struct bio *bio, struct iovec *iov, unsigned i, int opcode)
+static void blkdev_merge_endio(struct bio *rq)
 {
-	ssize_t ret;
-	struct iocb iocb = {
-		.data		= bio,
-		.aio_fildes	= bio->bi_bdev->bd_fd,
-		.aio_rw_flags	= bio->bi_opf & REQ_FUA ? RWF_SYNC : 0,
-		.aio_lio_opcode	= opcode,
-		.u.c.buf        = iov,
-		.u.c.nbytes     = i,
-		.u.c.offset     = bio->bi_iter.bi_sector << 9,
-
-	}, *iocbp = &iocb;
-
-	atomic_inc(&running_requests);
+	struct bio *bio, *next;
 
-	wait_event(aio_events_completed,
-		   (ret = io_submit(aio_ctx, 1, &iocbp)) != -EAGAIN);;
+	for (bio = rq->bi_private; bio; bio = next) {
+		next = bio->bi_next;
+		bio->bi_next	= NULL;
+		bio->bi_status	= rq->bi_status;
+		bio_endio(bio);
+	}
 
-	if (ret != 1)
-		die("io_submit err: %s", strerror(-ret));
+	kfree(rq);
 }
 
-static void aio_read(struct bio *bio, struct iovec *iov, unsigned i)
+static bool blk_plug_mergeable(struct bio *bio)
 {
-	aio_op(bio, iov, i, IO_CMD_PREADV);
+	return (bio_op(bio) == REQ_OP_READ ||
+		bio_op(bio) == REQ_OP_WRITE) &&
+		!(bio->bi_opf & REQ_NOMERGE_FLAGS) &&
+		bio->bi_iter.bi_size;
 }
 
-static void aio_write(struct bio *bio, struct iovec * iov, unsigned i)
+static int blk_plug_cmp(const void *_l, const void *_r)
 {
-	aio_op(bio, iov, i, IO_CMD_PWRITEV);
+	const struct bio *l = *((const struct bio **) _l);
+	const struct bio *r = *((const struct bio **) _r);
+
+	return  cmp_int((unsigned long) l->bi_bdev, (unsigned long) r->bi_bdev) ?:
+		cmp_int(bio_op(l), bio_op(r)) ?:
+		cmp_int(bio_io_class((struct bio *) l), bio_io_class((struct bio *) r)) ?:
+		cmp_int(l->bi_iter.bi_sector, r->bi_iter.bi_sector);
 }
 
+static bool blk_plug_adjacent(struct bio *l, struct bio *r)
+{
+	return  l->bi_bdev == r->bi_bdev &&
+		bio_op(l) == bio_op(r) &&
+		bio_io_class(l) == bio_io_class(r) &&
+		bio_end_sector(l) == r->bi_iter.bi_sector;
+}
+
+static struct bio *blk_plug_merge(struct bio **bios, unsigned nr, unsigned bytes)
+{
+	struct bio *rq = kzalloc(sizeof(*rq), GFP_NOFS|__GFP_NOFAIL);
+
+	bio_init(rq, bios[0]->bi_bdev, NULL, 0, bios[0]->bi_opf);
+	rq->bi_ioprio		= bios[0]->bi_ioprio;
+	rq->bi_iter.bi_sector	= bios[0]->bi_iter.bi_sector;
+	rq->bi_iter.bi_size	= bytes;
+	rq->bi_end_io		= blkdev_merge_endio;
+	rq->bi_private		= bios[0];
+
+	for (unsigned i = 0; i + 1 < nr; i++)
+		bios[i]->bi_next = bios[i + 1];
+	bios[nr - 1]->bi_next = NULL;
+
+	return rq;
+}
+
+static void blk_plug_dispatch(struct blk_plug *plug)
+{
+	struct bio *bios[BLK_MAX_REQUEST_COUNT], *bio;
+	unsigned nr = 0, i, j;
+
+	/* Detach first: dispatching may block, and blocking flushes the plug */
+	while ((bio = plug->bios)) {
+		plug->bios = bio->bi_next;
+		bio->bi_next = NULL;
+		bios[nr++] = bio;
+	}
+	plug->nr_bios = 0;
+
+	if (!nr)
+		return;
+
+	atomic64_add(nr, &blk_nr_plugged);
+	sort(bios, nr, sizeof(bios[0]), blk_plug_cmp, NULL);
+
+	for (i = 0; i < nr; i = j) {
+		unsigned segs	= bio_segments(bios[i]);
+		unsigned bytes	= bios[i]->bi_iter.bi_size;
+
+		for (j = i + 1;
+		     j < nr &&
+		     blk_plug_adjacent(bios[j - 1], bios[j]) &&
+		     segs + bio_segments(bios[j]) <= BLK_MERGE_MAX_SEGS &&
+		     bytes + bios[j]->bi_iter.bi_size <= BLK_MERGE_MAX_BYTES;
+		     j++) {
+			segs	+= bio_segments(bios[j]);
+			bytes	+= bios[j]->bi_iter.bi_size;
+		}
+
+		if (j - i == 1) {
+			blkdev_dispatch(bios[i]);
+		} else {
+			atomic64_add(j - i - 1, &blk_nr_merged);
+			blkdev_dispatch(blk_plug_merge(bios + i, j - i, bytes));
+		}
+	}
+}
+
+static void blk_plug_add(struct blk_plug *plug, struct bio *bio)
+{
+	bio->bi_next = plug->bios;
+	plug->bios = bio;
+
+	if (++plug->nr_bios >= BLK_MAX_REQUEST_COUNT)
+		blk_plug_dispatch(plug);
+}
+
+/*
+ * Tracing:
+ *
+ * With BCACHEFS_IO_TRACE=<file>, every bio submitted is recorded - as
+ * submitted, before merging and scheduling, so that replaying a trace exercises
+ * those too. Records are written on completion; see struct blk_trace_rec.
+ */
+
+static FILE		*blk_trace_file;
+static DEFINE_MUTEX(blk_trace_lock);
+static u64		blk_trace_start_ns;
+static unsigned		blk_trace_nr_devs;
+static __thread u32	blk_trace_tid;
+
+struct blk_trace_bio {
+	bio_end_io_t		*end_io;
+	void			*private;
+	struct blk_trace_rec	r;
+};
+
+static u64 blk_trace_now(void)
+{
+	return ktime_get_mono_fast_ns() - blk_trace_start_ns;
+}
+
+static void blk_trace_write(struct blk_trace_rec *r, const void *payload)
+{
+	mutex_lock(&blk_trace_lock);
+	/* Completions may still be coming in after blk_trace_exit(): */
+	if (blk_trace_file &&
+	    (fwrite(r, sizeof(*r), 1, blk_trace_file) != 1 ||
+	     (r->bytes && payload &&
+	      fwrite(payload, r->bytes, 1, blk_trace_file) != 1)))
+		die("error writing IO trace: %m");
+	mutex_unlock(&blk_trace_lock);
+}
+
+static void blk_trace_endio(struct bio *bio)
+{
+	struct blk_trace_bio *t = bio->bi_private;
+
+	bio->bi_end_io	= t->end_io;
+	bio->bi_private	= t->private;
+
+	t->r.complete_ns	= blk_trace_now();
+	t->r.status		= bio->bi_status;
+	blk_trace_write(&t->r, NULL);
+	kfree(t);
+
+	if (bio->bi_end_io)
+		bio->bi_end_io(bio);
+}
+
+static void blk_trace_submit(struct bio *bio)
+{
+	struct blk_trace_bio *t = kmalloc(sizeof(*t), GFP_NOFS|__GFP_NOFAIL);
+
+	if (unlikely(!blk_trace_tid))
+		blk_trace_tid = syscall(SYS_gettid);
+
+	t->end_io	= bio->bi_end_io;
+	t->private	= bio->bi_private;
+	t->r		= (struct blk_trace_rec) {
+		.type		= BLK_TRACE_IO,
+		.dev		= bio->bi_bdev->bd_trace_idx,
+		.submit_ns	= blk_trace_now(),
+		.sector		= bio->bi_iter.bi_sector,
+		.bytes		= bio->bi_iter.bi_size,
+		.opf		= bio->bi_opf,
+		.tid		= blk_trace_tid,
+	};
+
+	bio->bi_end_io	= blk_trace_endio;
+	bio->bi_private	= t;
+}
+
+static void blk_trace_open(struct block_device *bdev, const char *path)
+{
+	mutex_lock(&blk_trace_lock);
+	bdev->bd_trace_idx = blk_trace_nr_devs++;
+	mutex_unlock(&blk_trace_lock);
+
+	struct blk_trace_rec r = {
+		.type		= BLK_TRACE_DEV,
+		.dev		= bdev->bd_trace_idx,
+		.submit_ns	= blk_trace_now(),
+		.bytes		= strlen(path) + 1,
+	};
+	blk_trace_write(&r, path);
+}
+
+static void blk_trace_init(void)
+{
+	const char *path = getenv("BCACHEFS_IO_TRACE");
+	struct blk_trace_header h = {
+		.magic		= BLK_TRACE_MAGIC,
+		.version	= BLK_TRACE_VERSION,
+		.rec_size	= sizeof(struct blk_trace_rec),
+	};
+
+	if (!path)
+		return;
+
+	blk_trace_file = fopen(path, "w");
+	if (!blk_trace_file)
+		die("error opening IO trace %s: %m", path);
+	setvbuf(blk_trace_file, NULL, _IOFBF, 1 << 20);
+
+	if (fwrite(&h, sizeof(h), 1, blk_trace_file) != 1)
+		die("error writing IO trace: %m");
+
+	blk_trace_start_ns = ktime_get_mono_fast_ns();
+}
+
+static void blk_trace_exit(void)
+{
+	mutex_lock(&blk_trace_lock);
+	if (blk_trace_file && fclose(blk_trace_file))
+		fprintf(stderr, "error writing IO trace: %m\n");
+	blk_trace_file = NULL;
+	mutex_unlock(&blk_trace_lock);
+}
+
+void generic_make_request(struct bio *bio)
+{
+	struct blk_plug *plug = current ? current->plug : NULL;
+
+	if (unlikely(blk_trace_file))
+		blk_trace_submit(bio);
+
+	switch (bio_op(bio)) {
+	case REQ_OP_DISCARD:
+	case REQ_OP_WRITE_ZEROES:
+		blkdev_discard_submit(bio);
+		break;
+	case REQ_OP_FLUSH:
+		blkdev_flush_submit(bio);
+		break;
+	default:
+		if (bio->bi_opf & REQ_PREFLUSH)
+			blkdev_flush_submit(bio);
+		else if (plug && blk_plug_mergeable(bio))
+			blk_plug_add(plug, bio);
+		else
+			blkdev_dispatch(bio);
+	}
+}
+
+void blk_start_plug(struct blk_plug *plug)
+{
+	plug->bios	= NULL;
+	plug->nr_bios	= 0;
+	plug->nr_ios	= 0;
+
+	/* Nested plugs are no-ops, as in the kernel: */
+	if (current && !current->plug)
+		current->plug = plug;
+}
+
+void blk_flush_plug(struct blk_plug *plug, bool from_schedule)
+{
+	unsigned nr_ios;
+
+	blk_plug_dispatch(plug);
+
+	/* Cleared first, so that blocking in ->unplug() doesn't recurse: */
+	nr_ios = plug->nr_ios;
+	plug->nr_ios = 0;
+
+	if (nr_ios && fops->unplug)
+		fops->unplug();
+}
+
+void blk_finish_plug(struct blk_plug *plug)
+{
+	if (current && current->plug == plug) {
+		blk_flush_plug(plug, false);
+		current->plug = NULL;
+	}
+}
+
+static void submit_bio_wait_endio(struct bio *bio)
+{
+	complete(bio->bi_private);
+}
+
+int submit_bio_wait(struct bio *bio)
+{
+	struct completion done;
+
+	init_completion(&done);
+	bio->bi_private = &done;
+	bio->bi_end_io = submit_bio_wait_endio;
+	bio->bi_opf |= REQ_SYNC;
+	submit_bio(bio);
+	wait_for_completion(&done);
+
+	return blk_status_to_errno(bio->bi_status);
+}
+
+static int blkdev_issue_range(struct block_device *bdev, enum req_opf op,
+			      sector_t sector, sector_t nr_sects)
+{
+	struct bio bio;
+
+	bio_init(&bio, bdev, NULL, 0, op);
+	bio.bi_iter.bi_sector	= sector;
+	bio.bi_iter.bi_size	= nr_sects << 9;
+
+	return submit_bio_wait(&bio);
+}
+
+int blkdev_issue_discard(struct block_device *bdev,
+			 sector_t sector, sector_t nr_sects,
+			 gfp_t gfp_mask)
+{
+	if (!bdev_max_discard_sectors(bdev))
+		return -EOPNOTSUPP;
+
+	return blkdev_issue_range(bdev, REQ_OP_DISCARD, sector, nr_sects);
+}
+
+int blkdev_issue_zeroout(struct block_device *bdev,
+			 sector_t sector, sector_t nr_sects,
+			 gfp_t gfp_mask, unsigned flags)
+{
+	return blkdev_issue_range(bdev, REQ_OP_WRITE_ZEROES, sector, nr_sects);
+}
+
+unsigned bdev_logical_block_size(struct block_device *bdev)
+{
+	struct stat statbuf;
+	unsigned blksize;
+	int ret;
+
+	ret = fstat(bdev->bd_fd, &statbuf);
+	BUG_ON(ret);
+
+	if (!S_ISBLK(statbuf.st_mode))
+		return statbuf.st_blksize;
+
+	xioctl(bdev->bd_fd, BLKPBSZGET, &blksize);
+	return blksize;
+}
+
+sector_t get_capacity(struct gendisk *disk)
+{
+	struct block_device *bdev =
+		container_of(disk, struct block_device, __bd_disk);
+	struct stat statbuf;
+	u64 bytes;
+	int ret;
+
+	ret = fstat(bdev->bd_fd, &statbuf);
+	BUG_ON(ret);
+
+	if (!S_ISBLK(statbuf.st_mode))
+		return statbuf.st_size >> 9;
+
+	ret = ioctl(bdev->bd_fd, BLKGETSIZE64, &bytes);
+	BUG_ON(ret);
+
+	return bytes >> 9;
+}
+
+/*
+ * Read a queue limit from sysfs; partitions don't have their own queue
+ * directory, so also try the parent device:
+ */
+static bool bdev_queue_attr(struct block_device *bdev, const char *attr, u64 *v)
+{
+	struct stat st = xfstat(bdev->bd_fd);
+	static const char * const paths[] = {
+		"/sys/dev/block/%u:%u/queue/%s",
+		"/sys/dev/block/%u:%u/../queue/%s",
+	};
+	bool ret = false;
+
+	if (!S_ISBLK(st.st_mode))
+		return false;
+
+	for (unsigned i = 0; i < ARRAY_SIZE(paths) && !ret; i++) {
+		char *path = mprintf(paths[i], major(st.st_rdev), minor(st.st_rdev), attr);
+		FILE *f = fopen(path, "r");
+
+		if (f) {
+			ret = fscanf(f, "%llu", v) == 1;
+			fclose(f);
+		}
+		free(path);
+	}
+
+	return ret;
+}
+
+static unsigned bdev_default_nr_requests(struct block_device *bdev)
+{
+	u64 nr_requests = 0;
+
+	bdev_queue_attr(bdev, "nr_requests", &nr_requests);
+
+	return clamp_t(u64, nr_requests ?: 128, 32, 1024);
+}
+
+static unsigned bdev_default_max_discard_sectors(struct block_device *bdev)
+{
+	u64 bytes;
+
+	/* Image files: hole punching is checked on first use */
+	if (!S_ISBLK(xfstat(bdev->bd_fd).st_mode))
+		return UINT_MAX;
+
+	return bdev_queue_attr(bdev, "discard_max_bytes", &bytes)
+		? min_t(u64, bytes >> 9, UINT_MAX)
+		: 0;
+}
+
+void bdev_fput(struct file *file)
+{
+	struct block_device *bdev = file_bdev(file);
+
+	if (fops->close)
+		fops->close(bdev);
+	io_sched_free(bdev->queue.sched);
+
+	fdatasync(bdev->bd_fd);
+	close(bdev->bd_fd);
+	free(bdev);
+	free(file);
+}
+
+struct file *bdev_file_open_by_path(const char *path, blk_mode_t mode,
+				    void *holder, const struct blk_holder_ops *hop)
+{
+	int fd, flags = 0;
+
+	if ((mode & (BLK_OPEN_READ|BLK_OPEN_WRITE)) == (BLK_OPEN_READ|BLK_OPEN_WRITE))
+		flags = O_RDWR;
+	else if (mode & BLK_OPEN_READ)
+		flags = O_RDONLY;
+	else if (mode & BLK_OPEN_WRITE)
+		flags = O_WRONLY;
+
+	if (!(mode & BLK_OPEN_BUFFERED))
+		flags |= O_DIRECT;
+
+	if (mode & BLK_OPEN_EXCL)
+		flags |= O_EXCL;
+
+	if (mode & BLK_OPEN_CREAT)
+		flags |= O_CREAT;
+
+	fd = open(path, flags, 0600);
+	if (fd < 0)
+		return ERR_PTR(-errno);
+
+	struct block_device *bdev = malloc(sizeof(*bdev));
+	memset(bdev, 0, sizeof(*bdev));
+
+	strncpy(bdev->name, path, sizeof(bdev->name));
+	bdev->name[sizeof(bdev->name) - 1] = '\0';
+
+	bdev->bd_dev		= xfstat(fd).st_rdev;
+	bdev->bd_fd		= fd;
+	bdev->bd_fixed_fd	= -1;
+	bdev->bd_holder		= holder;
+	bdev->bd_disk		= &bdev->__bd_disk;
+	bdev->bd_disk->bdi	= &bdev->bd_disk->__bdi;
+	bdev->queue.backing_dev_info = bdev->bd_disk->bdi;
+	bdev->bd_inode		= &bdev->__bd_inode;
+
+	mutex_init(&bdev->bd_holder_lock);
+	spin_lock_init(&bdev->queue.flush_lock);
+	bdev->queue.nr_requests = bdev_default_nr_requests(bdev);
+	bdev->queue.max_discard_sectors = bdev_default_max_discard_sectors(bdev);
+	bdev->queue.sched	= io_sched_alloc(bdev);
+
+	if (fops->open)
+		fops->open(bdev);
+
+	if (blk_trace_file)
+		blk_trace_open(bdev, path);
+
+	struct file *file = calloc(sizeof(*file), 1);
+	file->f_inode = bdev->bd_inode;
+
+	return file;
+}
+
+int lookup_bdev(const char *path, dev_t *dev)
+{
+	return -EINVAL;
+}
+
+static void io_fallback(void)
+{
+	fops++;
+	if (fops->init == NULL)
+		die("no fallback possible, something is very wrong");
+	fops->init();
+}
+
+static void sync_check(struct bio *bio, int ret)
+{
+	if (ret != bio->bi_iter.bi_size) {
+		die("IO error: %s\n", strerror(-ret));
+	}
+
+	blkdev_endio(bio);
+}
+
+static void sync_init(void) {}
+
+static void sync_cleanup(void)
+{
+	/* not necessary? */
+	sync();
+}
+
+/*
+ * preadv() and pwritev() take at most IOV_MAX iovecs - as do aio and io_uring,
+ * which also send bios with more segments than that here - so do it in chunks:
+ */
+static ssize_t sync_rw(struct bio *bio, struct iovec *iov, unsigned i, bool write)
+{
+	off_t offset = bio->bi_iter.bi_sector << 9;
+	ssize_t done = 0;
+
+	while (i) {
+		unsigned nr = min_t(unsigned, i, IOV_MAX);
+		ssize_t bytes = 0, ret;
+
+		for (unsigned j = 0; j < nr; j++)
+			bytes += iov[j].iov_len;
+
+		ret = write
+			? pwritev2(bio->bi_bdev->bd_fd, iov, nr, offset,
+				   bio->bi_opf & REQ_FUA ? RWF_DSYNC : 0)
+			: preadv(bio->bi_bdev->bd_fd, iov, nr, offset);
+		if (ret < 0)
+			return -errno;
+
+		done += ret;
+		if (ret != bytes)
+			break;
+
+		offset	+= bytes;
+		iov	+= nr;
+		i	-= nr;
+	}
+
+	return done;
+}
+
+static void sync_read(struct bio *bio, struct iovec * iov, unsigned i)
+{
+	sync_check(bio, sync_rw(bio, iov, i, false));
+}
+
+static void sync_write(struct bio *bio, struct iovec * iov, unsigned i)
+{
+	sync_check(bio, sync_rw(bio, iov, i, true));
+}
+
+static void sync_flush(struct block_device *bdev)
+{
+	int ret;
+
+	do {
+		ret = fdatasync(bdev->bd_fd) ? -errno : 0;
+	} while (blkdev_flush_done(bdev, ret));
+}
+
+/*
+ * libaio backend:
+ *
+ * Each block device gets its own aio context, sized to that device's queue
+ * depth, and its own completion threads.
+ *
+ * Submitting threads batch iocbs in a per thread buffer while plugged
+ * (blk_start_plug()), and submit the whole batch with one io_submit() per
+ * device on unplug or when the buffer fills up; unplugged IO is submitted
+ * immediately.
+ */
+
+#define AIO_BATCH_MAX		64
+#define AIO_BATCH_IOVS		1024
+#define AIO_MAX_THREADS		16
+
+struct aio_queue {
+	io_context_t		ctx;
+	unsigned		depth;
+	atomic_t		in_flight;
+	wait_queue_head_t	wait;
+
+	int			stop_pipe[2];
+	atomic_t		nr_stopped;
+	unsigned		nr_threads;
+	struct task_struct	*threads[AIO_MAX_THREADS];
+};
+
+struct aio_batch {
+	unsigned		nr;
+	unsigned		nr_iovs;
+	struct iocb		iocbs[AIO_BATCH_MAX];
+	struct iovec		iovs[AIO_BATCH_IOVS];
+};
+
+/* Flush iocbs carry the block device, tagged with the low bit: */
+#define AIO_FLUSH_TAG		1UL
+
+static pthread_key_t aio_batch_key;
+static __thread struct aio_batch *aio_batch;
+static bool aio_have_fsync = true;
+
+static void aio_flush(struct block_device *bdev);
+
+static unsigned getenv_uint(const char *name, unsigned def)
+{
+	const char *v = getenv(name);
+	unsigned ret;
+
+	if (!v)
+		return def;
+	if (kstrtouint(v, 10, &ret) || !ret)
+		die("invalid %s=%s", name, v);
+	return ret;
+}
+
+static inline struct aio_queue *bio_aio_queue(struct bio *bio)
+{
+	return bio->bi_bdev->queue.queuedata;
+}
+
+static void aio_stop_one(struct aio_queue *q)
+{
+	/* I mean, really?! IO_CMD_NOOP is even defined, but not implemented. */
+	int junk = 0;
+	struct iocb iocb = {
+		.aio_lio_opcode = IO_CMD_PWRITE,
+		.data = NULL, /* Signal to stop */
+		.aio_fildes = q->stop_pipe[1],
+		.u.c.buf = &junk,
+		.u.c.nbytes = 1,
+	}, *iocbp = &iocb;
+	int ret = io_submit(q->ctx, 1, &iocbp);
+	if (ret != 1)
+		die("io_submit cleanup err: %s", strerror(-ret));
+}
+
+/* Returns true if we were told to stop: */
+static bool aio_reap(struct aio_queue *q, long min_nr)
+{
+	struct io_event events[8], *ev;
+	bool stop = false;
+	int ret;
+
+	do {
+		ret = io_getevents(q->ctx, min_nr, ARRAY_SIZE(events),
+				   events, NULL);
+	} while (ret == -EINTR);
+
+	if (ret < 0)
+		die("io_getevents() error: %s", strerror(-ret));
+
+	for (ev = events; ev < events + ret; ev++) {
+		struct bio *bio = (struct bio *) ev->data;
+
+		/* This should only happen when closing the device */
+		if (!bio) {
+			BUG_ON(atomic_read(&q->in_flight) != 0);
+			stop = true;
+
+			/* Pass it on to the next completion thread: */
+			if (atomic_inc_return(&q->nr_stopped) < q->nr_threads)
+				aio_stop_one(q);
+			continue;
+		}
+
+		if ((unsigned long) ev->data & AIO_FLUSH_TAG) {
+			struct block_device *bdev =
+				(void *) ((unsigned long) ev->data & ~AIO_FLUSH_TAG);
+
+			atomic_dec(&q->in_flight);
+			if (blkdev_flush_done(bdev, ev->res))
+				aio_flush(bdev);
+			continue;
+		}
+
+		if (ev->res != bio->bi_iter.bi_size)
+			bio->bi_status = BLK_STS_IOERR;
+
+		blkdev_endio(bio);
+		atomic_dec(&q->in_flight);
+	}
+
+	if (ret)
+		wake_up(&q->wait);
+	return stop;
+}
+
+static int aio_completion_thread(void *arg)
+{
+	struct aio_queue *q = arg;
+
+	while (!aio_reap(q, 1))
+		;
+
+	return 0;
+}
+
+static bool aio_in_completion_thread(struct aio_queue *q)
+{
+	return current &&
+		current->thread_fn == aio_completion_thread &&
+		current->thread_data == q;
+}
+
+static long aio_submit(struct aio_queue *q, struct iocb **iocbs, long nr)
+{
+	while (nr) {
+		long ret = io_submit(q->ctx, nr, iocbs);
+
+		if (ret == -EINTR)
+			continue;
+
+		if (ret == -EAGAIN) {
+			/*
+			 * Only possible when completion threads submit more IO
+			 * from bio_endio() and push us past the queue depth -
+			 * reap some completions ourselves:
+			 */
+			if (aio_in_completion_thread(q))
+				aio_reap(q, 1);
+			else
+				wait_event(q->wait, atomic_read(&q->in_flight) < q->depth);
+			continue;
+		}
+
+		if (ret < 0)
+			return ret;
+
+		iocbs	+= ret;
+		nr	-= ret;
+	}
+
+	return 0;
+}
+
+static void aio_batch_flush(struct aio_batch *b)
+{
+	struct iocb *iocbs[AIO_BATCH_MAX];
+	unsigned i, j, nr;
+	DECLARE_BITMAP(submitted, AIO_BATCH_MAX) = { 0 };
+
+	/* Group the batch by device, one io_submit() per device: */
+	for (i = 0; i < b->nr; i++) {
+		struct aio_queue *q = bio_aio_queue(b->iocbs[i].data);
+
+		if (test_bit(i, submitted))
+			continue;
+
+		nr = 0;
+		for (j = i; j < b->nr; j++)
+			if (!test_bit(j, submitted) &&
+			    bio_aio_queue(b->iocbs[j].data) == q) {
+				__set_bit(j, submitted);
+				iocbs[nr++] = &b->iocbs[j];
+			}
+
+		long ret = aio_submit(q, iocbs, nr);
+		if (ret)
+			die("io_submit err: %s", strerror(-ret));
+	}
+
+	b->nr		= 0;
+	b->nr_iovs	= 0;
+}
+
+static struct aio_batch *aio_batch_get(void)
+{
+	if (unlikely(!aio_batch)) {
+		aio_batch = calloc(1, sizeof(*aio_batch));
+		if (!aio_batch)
+			die("error allocating aio batch");
+		pthread_setspecific(aio_batch_key, aio_batch);
+	}
+
+	return aio_batch;
+}
+
+static void aio_batch_free(void *p)
+{
+	free(p);
+	aio_batch = NULL;
+}
+
+static bool aio_queue_get_slot(struct aio_queue *q)
+{
+	int v = atomic_read(&q->in_flight);
+
+	do {
+		if (v >= q->depth)
+			return false;
+	} while (!atomic_try_cmpxchg(&q->in_flight, &v, v + 1));
+
+	return true;
+}
+
+static void aio_open(struct block_device *bdev)
+{
+	struct aio_queue *q = calloc(1, sizeof(*q));
+	long err;
+
+	if (!q)
+		die("error allocating aio queue");
+
+	q->depth	= getenv_uint("BCACHEFS_AIO_QUEUE_DEPTH",
+				      bdev->queue.nr_requests);
+	/*
+	 * One reaper per two CPUs: completions run bio_endio(), which may
+	 * checksum or decompress, but submitters need CPUs too:
+	 */
+	q->nr_threads	= min(getenv_uint("BCACHEFS_AIO_THREADS",
+					  DIV_ROUND_UP(num_online_cpus(), 2)),
+			      AIO_MAX_THREADS);
+	init_waitqueue_head(&q->wait);
+
+	/*
+	 * Completion threads may go past the queue depth when they submit IO
+	 * from bio_endio(), and we need room for the stop iocb:
+	 */
+	err = io_setup(q->depth * 2 + 1, &q->ctx);
+	if (err)
+		die("io_setup() error: %s", strerror(-err));
+
+	if (pipe(q->stop_pipe))
+		die("pipe err: %m");
+
+	for (unsigned i = 0; i < q->nr_threads; i++) {
+		struct task_struct *p =
+			kthread_run(aio_completion_thread, q, "aio_completion");
+		BUG_ON(IS_ERR(p));
+
+		q->threads[i] = p;
+	}
+
+	bdev->queue.queuedata = q;
+}
+
+static void aio_close(struct block_device *bdev)
+{
+	struct aio_queue *q = bdev->queue.queuedata;
+
+	for (unsigned i = 0; i < q->nr_threads; i++)
+		get_task_struct(q->threads[i]);
+
+	aio_stop_one(q);
+
+	for (unsigned i = 0; i < q->nr_threads; i++) {
+		int ret = kthread_stop(q->threads[i]);
+		BUG_ON(ret);
+
+		put_task_struct(q->threads[i]);
+	}
+
+	xclose(q->stop_pipe[0]);
+	xclose(q->stop_pipe[1]);
+	io_destroy(q->ctx);
+	free(q);
+
+	bdev->queue.queuedata = NULL;
+}
+
+static void aio_init(void)
+{
+	io_context_t ctx = 0;
+	long err = io_setup(1, &ctx);
+
+	if (err == -ENOSYS) {
+		io_fallback();
+		return;
+	}
+	if (err)
+		die("io_setup() error: %s", strerror(-err));
+	io_destroy(ctx);
+
+	err = pthread_key_create(&aio_batch_key, aio_batch_free);
+	if (err)
+		die("pthread_key_create() error: %s", strerror(err));
+}
+
+static void aio_cleanup(void)
+{
+	pthread_key_delete(aio_batch_key);
+}
+
+static void aio_unplug(void)
+{
+	if (aio_batch && aio_batch->nr)
+		aio_batch_flush(aio_batch);
+}
+
+static void aio_op(struct bio *bio, struct iovec *iov, unsigned i, int opcode)
+{
+	struct aio_queue *q = bio_aio_queue(bio);
+	struct aio_batch *b = aio_batch_get();
+	struct blk_plug *plug = current ? current->plug : NULL;
+
+	/* More segments than a batch, or the kernel, takes: */
+	if (unlikely(i > AIO_BATCH_IOVS)) {
+		aio_batch_flush(b);
+		sync_check(bio, sync_rw(bio, iov, i, opcode == IO_CMD_PWRITEV));
+		return;
+	}
+
+	if (b->nr == AIO_BATCH_MAX ||
+	    b->nr_iovs + i > AIO_BATCH_IOVS)
+		aio_batch_flush(b);
+
+	if (!aio_queue_get_slot(q)) {
+		if (aio_in_completion_thread(q)) {
+			atomic_inc(&q->in_flight);
+		} else {
+			/* Don't sit on IOs we've batched while we wait: */
+			aio_batch_flush(b);
+			wait_event(q->wait, aio_queue_get_slot(q));
+		}
+	}
+
+	BUG_ON(b->nr_iovs + i > AIO_BATCH_IOVS);
+	memcpy(b->iovs + b->nr_iovs, iov, sizeof(*iov) * i);
+
+	b->iocbs[b->nr++] = (struct iocb) {
+		.data		= bio,
+		.aio_fildes	= bio->bi_bdev->bd_fd,
+		.aio_rw_flags	= bio->bi_opf & REQ_FUA ? RWF_DSYNC : 0,
+		.aio_lio_opcode	= opcode,
+		.u.c.buf	= b->iovs + b->nr_iovs,
+		.u.c.nbytes	= i,
+		.u.c.offset	= bio->bi_iter.bi_sector << 9,
+	};
+	b->nr_iovs += i;
+
+	if (plug)
+		plug->nr_ios++;
+	else
+		aio_batch_flush(b);
+}
+
+static void aio_flush(struct block_device *bdev)
+{
+	struct aio_queue *q = bdev->queue.queuedata;
+	struct iocb iocb = {
+		.data		= (void *) ((unsigned long) bdev | AIO_FLUSH_TAG),
+		.aio_fildes	= bdev->bd_fd,
+		.aio_lio_opcode	= IO_CMD_FDSYNC,
+	}, *iocbp = &iocb;
+	long ret;
+
+	if (aio_have_fsync) {
+		atomic_inc(&q->in_flight);
+		ret = aio_submit(q, &iocbp, 1);
+		if (!ret)
+			return;
+		atomic_dec(&q->in_flight);
+
+		/* IOCB_CMD_FDSYNC needs Linux 4.18: */
+		if (ret != -EINVAL)
+			die("io_submit err: %s", strerror(-ret));
+		aio_have_fsync = false;
+	}
+
+	do {
+		ret = fdatasync(bdev->bd_fd) ? -errno : 0;
+	} while (blkdev_flush_done(bdev, ret));
+}
+
+static void aio_read(struct bio *bio, struct iovec *iov, unsigned i)
+{
+	aio_op(bio, iov, i, IO_CMD_PREADV);
+}
+
+static void aio_write(struct bio *bio, struct iovec * iov, unsigned i)
+{
+	aio_op(bio, iov, i, IO_CMD_PWRITEV);
+}
+
+#ifdef CONFIG_LIBURING
+
+#define URING_ENTRIES		256
+#define URING_CQ_ENTRIES	(URING_ENTRIES * 4)
+#define URING_SUBMIT_BATCH	32
+#define URING_MAX_FILES		256
+#define URING_MAX_BUFS		64
+
+/*
+ * io_uring backend:
+ *
+ * Submission is serialized by uring_sq_lock, but submitters don't each make a
+ * syscall: a thread only calls io_uring_submit() if nobody else is queued up
+ * behind it on the lock (or the batch is full), so concurrent submitters end up
+ * sharing one io_uring_enter().
+ *
+ * A single completion thread reaps CQEs in batches and calls bio_endio().
+ * Since it's the only thing that frees up CQ space, it never blocks submitting:
+ * IO submitted from its endio callbacks is queued on uring_deferred, and
+ * submitted once it's done with the batch.
+ */
+
+static struct io_uring	uring;
+static DEFINE_MUTEX(uring_sq_lock);
+static atomic_t		uring_submitters;
+static struct task_struct *uring_task;
+static DECLARE_WAIT_QUEUE_HEAD(uring_events_completed);
+static atomic_t		uring_reaped;
+
+struct uring_deferred {
+	struct list_head	list;
+	struct io_uring_sqe	sqe;
+};
+
+/* Only touched by the completion thread: */
+static LIST_HEAD(uring_deferred);
+
+static DEFINE_MUTEX(uring_register_lock);
+static bool		uring_have_files;
+static DECLARE_BITMAP(uring_file_slots, URING_MAX_FILES);
+static bool		uring_have_bufs;
+
+struct uring_buf {
+	void		*start;
+	void		*end;
+};
+
+static struct uring_buf	uring_bufs[URING_MAX_BUFS];
+static unsigned		uring_nr_bufs;
+
+/*
+ * Multi segment bios have their iovec copied here, since the iovec passed to
+ * fops->read/write is on the submitter's stack and the SQE may be submitted by
+ * a different thread; tagged with the low bit in user_data:
+ */
+struct uring_iovec {
+	struct bio	*bio;
+	struct iovec	iov[];
+};
+
+#define URING_IOVEC_TAG		1UL
+
+/* Flushes carry the block device, tagged with the next bit: */
+#define URING_FLUSH_TAG		2UL
+
+static void uring_flush(struct block_device *bdev);
+static void uring_deferred_submit(void);
+
+static int uring_completion_thread(void *arg)
+{
+	struct io_uring_cqe *cqes[16];
+	struct {
+		void	*data;
+		int	res;
+	} done[ARRAY_SIZE(cqes)];
+	bool stop = false;
+
+	while (!stop) {
+		struct io_uring_cqe *cqe;
+		/*
+		 * If submitting got stuck on a full SQ, retry it shortly; without
+		 * IORING_FEAT_EXT_ARG the timeout would need an SQE of its own:
+		 */
+		struct __kernel_timespec ts = { .tv_nsec = NSEC_PER_MSEC };
+		unsigned i, nr, nr_io = 0;
+		int ret;
+
+		ret = !list_empty(&uring_deferred) &&
+			(uring.features & IORING_FEAT_EXT_ARG)
+			? io_uring_wait_cqe_timeout(&uring, &cqe, &ts)
+			: io_uring_wait_cqe(&uring, &cqe);
+		if (ret == -EINTR || ret == -EAGAIN || ret == -ETIME) {
+			uring_deferred_submit();
+			continue;
+		}
+		if (ret < 0)
+			die("io_uring_wait_cqe() error: %s", strerror(-ret));
+
+		nr = io_uring_peek_batch_cqe(&uring, cqes, ARRAY_SIZE(cqes));
+		for (i = 0; i < nr; i++) {
+			done[i].data	= io_uring_cqe_get_data(cqes[i]);
+			done[i].res	= cqes[i]->res;
+			nr_io += done[i].data != NULL;
+		}
+		io_uring_cq_advance(&uring, nr);
+
+		/*
+		 * Free up the CQ slots before waking submitters, so they don't
+		 * wake up to the old count and go back to sleep:
+		 */
+		if (nr) {
+			atomic_sub(nr_io, &running_requests);
+			atomic_inc(&uring_reaped);
+			wake_up(&uring_events_completed);
+		}
+
+		for (i = 0; i < nr; i++) {
+			unsigned long data = (unsigned long) done[i].data;
+			struct bio *bio;
+
+			/* This should only happen during blkdev_cleanup() */
+			if (!data) {
+				BUG_ON(atomic_read(&running_requests) != 0);
+				stop = true;
+				continue;
+			}
+
+			if (data & URING_FLUSH_TAG) {
+				struct block_device *bdev = (void *) (data & ~URING_FLUSH_TAG);
+
+				if (blkdev_flush_done(bdev, done[i].res))
+					uring_flush(bdev);
+				continue;
+			}
+
+			if (data & URING_IOVEC_TAG) {
+				struct uring_iovec *v = (void *) (data & ~URING_IOVEC_TAG);
+
+				bio = v->bio;
+				kfree(v);
+			} else {
+				bio = (void *) data;
+			}
+
+			if (done[i].res != bio->bi_iter.bi_size)
+				bio->bi_status = BLK_STS_IOERR;
+
+			blkdev_endio(bio);
+		}
+
+		uring_deferred_submit();
+	}
+
+	return 0;
+}
+
+static int uring_submit(void)
+{
+	int ret;
+
+	do {
+		ret = io_uring_submit(&uring);
+	} while (ret == -EINTR);
+
+	if (ret < 0 && ret != -EAGAIN && ret != -EBUSY)
+		die("io_uring_submit() error: %s", strerror(-ret));
+	return ret;
+}
+
+/* Called with uring_sq_lock held, which is dropped while waiting: */
+static struct io_uring_sqe *uring_get_sqe(void)
+{
+	struct io_uring_sqe *sqe;
+
+	while (!(sqe = io_uring_get_sqe(&uring))) {
+		unsigned reaped = atomic_read(&uring_reaped);
+
+		/* SQ ring full: kick what we have and wait for the kernel to catch up */
+		if (uring_submit() > 0)
+			continue;
+
+		/*
+		 * The kernel won't take more until completions are reaped, and
+		 * the completion thread may need uring_sq_lock to get there:
+		 */
+		mutex_unlock(&uring_sq_lock);
+		wait_event(uring_events_completed,
+			   atomic_read(&uring_reaped) != reaped ||
+			   io_uring_sq_space_left(&uring));
+		mutex_lock(&uring_sq_lock);
+	}
+
+	return sqe;
+}
+
+/*
+ * Submit the completion thread's deferred SQEs, as many as there's room for;
+ * the rest are retried after the next batch of completions:
+ */
+static void uring_deferred_submit(void)
+{
+	struct uring_deferred *d;
+	struct io_uring_sqe *sqe;
+
+	if (list_empty(&uring_deferred))
+		return;
+
+	mutex_lock(&uring_sq_lock);
+	while ((d = list_first_entry_or_null(&uring_deferred,
+					     struct uring_deferred, list))) {
+		if (!(sqe = io_uring_get_sqe(&uring)) &&
+		    (uring_submit() <= 0 ||
+		     !(sqe = io_uring_get_sqe(&uring))))
+			break;
+
+		*sqe = d->sqe;
+		list_del(&d->list);
+		kfree(d);
+	}
+	uring_submit();
+	mutex_unlock(&uring_sq_lock);
+}
+
+static void uring_queue_sqe(const struct io_uring_sqe *sqe)
+{
+	if (current == uring_task) {
+		struct uring_deferred *d = kmalloc(sizeof(*d), GFP_NOFS|__GFP_NOFAIL);
+
+		d->sqe = *sqe;
+		list_add_tail(&d->list, &uring_deferred);
+		return;
+	}
+
+	atomic_inc(&uring_submitters);
+	mutex_lock(&uring_sq_lock);
+	*uring_get_sqe() = *sqe;
+
+	/* Last one in submits for everyone queued up behind the lock: */
+	if (atomic_dec_return(&uring_submitters) == 0 ||
+	    io_uring_sq_ready(&uring) >= URING_SUBMIT_BATCH)
+		uring_submit();
+	mutex_unlock(&uring_sq_lock);
+}
+
+static int uring_buf_lookup(void *start, size_t len)
+{
+	unsigned i, nr = smp_load_acquire(&uring_nr_bufs);
+
+	for (i = 0; i < nr; i++)
+		if (start >= READ_ONCE(uring_bufs[i].start) &&
+		    start + len <= READ_ONCE(uring_bufs[i].end))
+			return i;
+	return -1;
+}
+
+static int uring_register_buffer(void *buf, size_t len)
+{
+	struct iovec iov = { .iov_base = buf, .iov_len = len };
+	unsigned i, slot = URING_MAX_BUFS;
+	int ret = -ENOSPC;
+
+	if (!uring_have_bufs)
+		return -EOPNOTSUPP;
+
+	mutex_lock(&uring_register_lock);
+	for (i = URING_MAX_BUFS; i--;) {
+		if (uring_bufs[i].start == buf) {
+			ret = 0;
+			goto out;
+		}
+		if (!uring_bufs[i].start)
+			slot = i;
+	}
+
+	i = slot;
+	if (i < URING_MAX_BUFS) {
+		ret = io_uring_register_buffers_update_tag(&uring, i, &iov, NULL, 1);
+		if (ret == 1) {
+			WRITE_ONCE(uring_bufs[i].end, buf + len);
+			WRITE_ONCE(uring_bufs[i].start, buf);
+			if (i >= uring_nr_bufs)
+				smp_store_release(&uring_nr_bufs, i + 1);
+			ret = 0;
+		}
+	}
+out:
+	mutex_unlock(&uring_register_lock);
+
+	return ret;
+}
+
+/*
+ * Nothing may be doing IO to the buffer by now, so racing with
+ * uring_buf_lookup() is harmless:
+ */
+static void uring_unregister_buffer(void *buf)
+{
+	struct iovec iov = {};
+	unsigned i;
+
+	mutex_lock(&uring_register_lock);
+	for (i = 0; i < uring_nr_bufs; i++)
+		if (uring_bufs[i].start == buf) {
+			io_uring_register_buffers_update_tag(&uring, i, &iov, NULL, 1);
+			WRITE_ONCE(uring_bufs[i].start, NULL);
+			WRITE_ONCE(uring_bufs[i].end, NULL);
+			break;
+		}
+	mutex_unlock(&uring_register_lock);
+}
+
+static void uring_open(struct block_device *bdev)
+{
+	unsigned slot;
+
+	if (!uring_have_files)
+		return;
+
+	mutex_lock(&uring_register_lock);
+	slot = find_first_zero_bit(uring_file_slots, URING_MAX_FILES);
+	if (slot < URING_MAX_FILES &&
+	    io_uring_register_files_update(&uring, slot, &bdev->bd_fd, 1) == 1) {
+		__set_bit(slot, uring_file_slots);
+		bdev->bd_fixed_fd = slot;
+	}
+	mutex_unlock(&uring_register_lock);
+}
+
+static void uring_close(struct block_device *bdev)
+{
+	int fd = -1;
+
+	if (bdev->bd_fixed_fd < 0)
+		return;
+
+	mutex_lock(&uring_register_lock);
+	io_uring_register_files_update(&uring, bdev->bd_fixed_fd, &fd, 1);
+	__clear_bit(bdev->bd_fixed_fd, uring_file_slots);
+	bdev->bd_fixed_fd = -1;
+	mutex_unlock(&uring_register_lock);
+}
+
+static void uring_init(void)
+{
+	struct io_uring_params p = {
+		.flags		= IORING_SETUP_CQSIZE,
+		.cq_entries	= URING_CQ_ENTRIES,
+	};
+	struct io_uring_probe *probe;
+	struct task_struct *t;
+	int ret;
+
+	ret = io_uring_queue_init_params(URING_ENTRIES, &uring, &p);
+	if (ret) {
+		/* ENOSYS, or disabled via kernel.io_uring_disabled: */
+		io_fallback();
+		return;
+	}
+
+	/* We need IORING_OP_READ/WRITE (5.6) and stable submission semantics: */
+	probe = io_uring_get_probe_ring(&uring);
+	if (!probe ||
+	    !(p.features & IORING_FEAT_SUBMIT_STABLE) ||
+	    !(p.features & IORING_FEAT_NODROP) ||
+	    !io_uring_opcode_supported(probe, IORING_OP_READ) ||
+	    !io_uring_opcode_supported(probe, IORING_OP_WRITE)) {
+		io_uring_free_probe(probe);
+		io_uring_queue_exit(&uring);
+		io_fallback();
+		return;
+	}
+	io_uring_free_probe(probe);
+
+	uring_have_files = !io_uring_register_files_sparse(&uring, URING_MAX_FILES);
+	uring_have_bufs	 = !io_uring_register_buffers_sparse(&uring, URING_MAX_BUFS);
+
+	t = kthread_run(uring_completion_thread, NULL, "uring_completion");
+	BUG_ON(IS_ERR(t));
+
+	uring_task = t;
+}
+
+static void uring_cleanup(void)
+{
+	struct task_struct *p = NULL;
+	struct io_uring_sqe *sqe;
+	int ret;
+
+	swap(uring_task, p);
+	get_task_struct(p);
+
+	/* Wake up the completion thread with a NULL completion: */
+	mutex_lock(&uring_sq_lock);
+	sqe = uring_get_sqe();
+	io_uring_prep_nop(sqe);
+	io_uring_sqe_set_data(sqe, NULL);
+	uring_submit();
+	mutex_unlock(&uring_sq_lock);
+
+	ret = kthread_stop(p);
+	BUG_ON(ret);
+
+	put_task_struct(p);
+
+	if (uring_have_bufs)
+		io_uring_unregister_buffers(&uring);
+	io_uring_queue_exit(&uring);
+	memset(uring_file_slots, 0, sizeof(uring_file_slots));
+	memset(uring_bufs, 0, sizeof(uring_bufs));
+	uring_nr_bufs = 0;
+}
+
+static void uring_op(struct bio *bio, struct iovec *iov, unsigned i, bool write)
+{
+	struct block_device *bdev = bio->bi_bdev;
+	struct io_uring_sqe sqe = {};
+	u64 offset = bio->bi_iter.bi_sector << 9;
+	int fd = bdev->bd_fixed_fd >= 0 ? bdev->bd_fixed_fd : bdev->bd_fd;
+	void *data = bio;
+	int buf_idx = -1;
+
+	if (unlikely(i > IOV_MAX)) {
+		sync_check(bio, sync_rw(bio, iov, i, write));
+		return;
+	}
+
+	if (current != uring_task)
+		wait_event(uring_events_completed,
+			   atomic_read(&running_requests) < URING_CQ_ENTRIES);
+	atomic_inc(&running_requests);
+
+	if (i > 1) {
+		struct uring_iovec *v = kmalloc(struct_size(v, iov, i), GFP_NOFS|__GFP_NOFAIL);
+
+		v->bio = bio;
+		memcpy(v->iov, iov, sizeof(*iov) * i);
+		iov = v->iov;
+		data = (void *) ((unsigned long) v | URING_IOVEC_TAG);
+	} else {
+		buf_idx = uring_buf_lookup(iov[0].iov_base, iov[0].iov_len);
+	}
 
-/* not implemented */
-static void uring_init(void) {
+	if (i > 1 && write)
+		io_uring_prep_writev(&sqe, fd, iov, i, offset);
+	else if (i > 1)
+		io_uring_prep_readv(&sqe, fd, iov, i, offset);
+	else if (buf_idx >= 0 && write)
+		io_uring_prep_write_fixed(&sqe, fd, iov[0].iov_base,
+					  iov[0].iov_len, offset, buf_idx);
+	else if (buf_idx >= 0)
+		io_uring_prep_read_fixed(&sqe, fd, iov[0].iov_base,
+					 iov[0].iov_len, offset, buf_idx);
+	else if (write)
+		io_uring_prep_write(&sqe, fd, iov[0].iov_base,
+				    iov[0].iov_len, offset);
+	else
+		io_uring_prep_read(&sqe, fd, iov[0].iov_base,
+				   iov[0].iov_len, offset);
+
+	if (bdev->bd_fixed_fd >= 0)
+		sqe.flags |= IOSQE_FIXED_FILE;
+	if (write && (bio->bi_opf & REQ_FUA))
+		sqe.rw_flags = RWF_DSYNC;
+	io_uring_sqe_set_data(&sqe, data);
+	uring_queue_sqe(&sqe);
+}
+
+static void uring_flush(struct block_device *bdev)
+{
+	struct io_uring_sqe sqe = {};
+
+	/* At most one flush in flight per device, so no need to wait: */
+	atomic_inc(&running_requests);
+
+	if (bdev->bd_fixed_fd >= 0) {
+		io_uring_prep_fsync(&sqe, bdev->bd_fixed_fd, IORING_FSYNC_DATASYNC);
+		sqe.flags |= IOSQE_FIXED_FILE;
+	} else {
+		io_uring_prep_fsync(&sqe, bdev->bd_fd, IORING_FSYNC_DATASYNC);
+	}
+	io_uring_sqe_set_data(&sqe, (void *) ((unsigned long) bdev | URING_FLUSH_TAG));
+	uring_queue_sqe(&sqe);
+}
+
+static void uring_read(struct bio *bio, struct iovec *iov, unsigned i)
+{
+	uring_op(bio, iov, i, false);
+}
+
+static void uring_write(struct bio *bio, struct iovec *iov, unsigned i)
+{
+	uring_op(bio, iov, i, true);
+}
+
+#else /* CONFIG_LIBURING */
+
+static void uring_init(void)
+{
 	io_fallback();
 }
 
-struct fops fops_list[] = {
+#define uring_cleanup		NULL
+#define uring_open		NULL
+#define uring_close		NULL
+#define uring_register_buffer	NULL
+#define uring_unregister_buffer	NULL
+#define uring_flush		NULL
+#define uring_read		NULL
+#define uring_write		NULL
+
+#endif /* CONFIG_LIBURING */
+
+/*
+ * RAM backend, for benchmarking and reproducing bugs without real devices:
+ *
+ * Data lives in a sparse in-memory store, in 64k chunks that are read in from
+ * the underlying device or image on first access, and never written back - so
+ * a formatted image can be used as the starting point, and is left untouched.
+ *
+ * IO can optionally be given a latency, bandwidth and queue depth with
+ * BCACHEFS_RAM_PROFILE and friends, see bcachefs(8): each device has
+ * queue_depth slots, an IO occupies the first free slot for its service time
+ * (latency plus transfer time, plus seek time for the hdd profile), and is
+ * completed by the device's completion thread when that's done. Without a
+ * profile IO completes inline.
+ */
+
+#define RAM_CHUNK_SHIFT		16
+#define RAM_CHUNK_SIZE		(1U << RAM_CHUNK_SHIFT)
+/* Chunk that has been discarded or zeroed: reads as zeroes */
+#define RAM_ZERO_CHUNK		((void *) 1UL)
+
+struct ram_profile {
+	const char		*name;
+	u64			read_ns;
+	u64			write_ns;
+	u64			stddev_ns;
+	u64			seek_ns;	/* full stroke, scaled by distance */
+	u64			bytes_per_sec;
+	unsigned		queue_depth;
+};
+
+static const struct ram_profile ram_profiles[] = {
+	{ .name = "none" },
+	{
+		.name		= "nvme",
+		.read_ns	= 80 * NSEC_PER_USEC,
+		.write_ns	= 20 * NSEC_PER_USEC,
+		.stddev_ns	= 10 * NSEC_PER_USEC,
+		.bytes_per_sec	= 3000ULL << 20,
+		.queue_depth	= 256,
+	}, {
+		.name		= "hdd",
+		.read_ns	= 4 * NSEC_PER_MSEC,
+		.write_ns	= 4 * NSEC_PER_MSEC,
+		.stddev_ns	= 1 * NSEC_PER_MSEC,
+		.seek_ns	= 8 * NSEC_PER_MSEC,
+		.bytes_per_sec	= 180ULL << 20,
+		.queue_depth	= 1,
+	},
+};
+
+struct ram_io {
+	u64			done_at;
+	struct bio		*bio;
+};
+
+DEFINE_MIN_HEAP(struct ram_io, ram_io_heap);
+
+struct ram_dev {
+	GENRADIX(void *)	chunks;
+	struct ram_profile	p;
+	u64			nr_sectors;
+
+	pthread_mutex_t		lock;
+	pthread_cond_t		wait;
+	u64			*slot_busy_until;
+	u64			last_sector;
+	struct rnd_state	rand;
+	struct ram_io_heap	pending;
+	bool			stop;
+	struct task_struct	*thread;
+};
+
+/* Normally distributed, approximated by the sum of 12 uniform samples: */
+static u64 ram_rand_normal(struct ram_dev *d, u64 mean, u64 stddev)
+{
+	s64 sum = 0;
+
+	for (unsigned i = 0; i < 12; i++)
+		sum += prandom_u32_state(&d->rand) >> 16;
+	sum -= 6LL << 16;
+
+	return max_t(s64, (s64) mean + ((sum * (s64) stddev) >> 16), 0);
+}
+
+static void ram_profile_parse(struct ram_profile *p, const char *str)
+{
+	unsigned long long mean, stddev;
+
+	for (unsigned i = 0; i < ARRAY_SIZE(ram_profiles); i++)
+		if (!strcmp(str, ram_profiles[i].name)) {
+			*p = ram_profiles[i];
+			return;
+		}
+
+	if (sscanf(str, "fixed:%llu", &mean) == 1) {
+		*p = (struct ram_profile) {
+			.name		= "fixed",
+			.read_ns	= mean * NSEC_PER_USEC,
+			.write_ns	= mean * NSEC_PER_USEC,
+		};
+	} else if (sscanf(str, "normal:%llu:%llu", &mean, &stddev) == 2) {
+		*p = (struct ram_profile) {
+			.name		= "normal",
+			.read_ns	= mean * NSEC_PER_USEC,
+			.write_ns	= mean * NSEC_PER_USEC,
+			.stddev_ns	= stddev * NSEC_PER_USEC,
+		};
+	} else {
+		die("invalid BCACHEFS_RAM_PROFILE=%s", str);
+	}
+}
+
+static bool ram_io_less(const void *l, const void *r, void *args)
+{
+	return ((struct ram_io *) l)->done_at < ((struct ram_io *) r)->done_at;
+}
+
+static void ram_io_swap(void *l, void *r, void *args)
+{
+	swap(*((struct ram_io *) l), *((struct ram_io *) r));
+}
+
+static const struct min_heap_callbacks ram_io_heap_callbacks = {
+	.less	= ram_io_less,
+	.swp	= ram_io_swap,
+};
+
+static void *ram_chunk_alloc(void)
+{
+	void *p = aligned_alloc(PAGE_SIZE, RAM_CHUNK_SIZE);
+
+	if (!p)
+		die("error allocating ram backend memory");
+	return p;
+}
+
+/*
+ * Returns the chunk at @idx, reading it in from the device if we haven't seen
+ * it yet; NULL if it reads as zeroes and we're not writing to it:
+ */
+static void *ram_chunk_get(struct block_device *bdev, u64 idx, bool write)
+{
+	struct ram_dev *d = bdev->queue.queuedata;
+	void **slot = genradix_ptr_alloc(&d->chunks, idx, GFP_KERNEL);
+	void *old, *new;
+
+	if (!slot)
+		die("error allocating ram backend memory");
+
+	while (1) {
+		old = READ_ONCE(*slot);
+		if (old && old != RAM_ZERO_CHUNK)
+			return old;
+		if (old == RAM_ZERO_CHUNK && !write)
+			return NULL;
+
+		new = ram_chunk_alloc();
+		if (old == RAM_ZERO_CHUNK) {
+			memset(new, 0, RAM_CHUNK_SIZE);
+		} else {
+			ssize_t ret = pread(bdev->bd_fd, new, RAM_CHUNK_SIZE,
+					    idx << RAM_CHUNK_SHIFT);
+			ret = max_t(ssize_t, ret, 0);
+			memset(new + ret, 0, RAM_CHUNK_SIZE - ret);
+		}
+
+		if (cmpxchg(slot, old, new) == old)
+			return new;
+		free(new);
+	}
+}
+
+static void ram_copy(struct bio *bio, struct iovec *iov, unsigned nr, bool write)
+{
+	struct block_device *bdev = bio->bi_bdev;
+	u64 pos = bio->bi_iter.bi_sector << 9;
+
+	for (unsigned i = 0; i < nr; i++) {
+		void *buf = iov[i].iov_base;
+		size_t len = iov[i].iov_len;
+
+		while (len) {
+			unsigned offset = pos & (RAM_CHUNK_SIZE - 1);
+			unsigned n = min_t(size_t, len, RAM_CHUNK_SIZE - offset);
+			void *chunk = ram_chunk_get(bdev, pos >> RAM_CHUNK_SHIFT, write);
+
+			if (write)
+				memcpy(chunk + offset, buf, n);
+			else if (chunk)
+				memcpy(buf, chunk + offset, n);
+			else
+				memset(buf, 0, n);
+
+			buf += n;
+			pos += n;
+			len -= n;
+		}
+	}
+}
+
+static u64 ram_service_ns(struct ram_dev *d, struct bio *bio)
+{
+	const struct ram_profile *p = &d->p;
+	u64 ns = bio_op(bio) == REQ_OP_WRITE ? p->write_ns : p->read_ns;
+
+	if (p->stddev_ns)
+		ns = ram_rand_normal(d, ns, p->stddev_ns);
+
+	if (p->seek_ns) {
+		u64 sector	= bio->bi_iter.bi_sector;
+		u64 distance	= sector > d->last_sector
+			? sector - d->last_sector
+			: d->last_sector - sector;
+
+		/* Sequential IO doesn't pay for seeks or rotational latency: */
+		if (distance)
+			ns += div64_u64(p->seek_ns * distance, max(d->nr_sectors, 1ULL));
+		else
+			ns = 0;
+		d->last_sector = bio_end_sector(bio);
+	}
+
+	if (p->bytes_per_sec)
+		ns += div64_u64((u64) bio->bi_iter.bi_size * NSEC_PER_SEC,
+				p->bytes_per_sec);
+	return ns;
+}
+
+static int ram_completion_thread(void *arg)
+{
+	struct ram_dev *d = arg;
+
+	pthread_mutex_lock(&d->lock);
+	while (1) {
+		struct ram_io *io = min_heap_peek(&d->pending);
+
+		if (!io) {
+			if (d->stop)
+				break;
+			pthread_cond_wait(&d->wait, &d->lock);
+			continue;
+		}
+
+		if (io->done_at <= ktime_get_mono_fast_ns()) {
+			struct bio *bio = io->bio;
+
+			min_heap_pop(&d->pending, &ram_io_heap_callbacks, NULL);
+			pthread_mutex_unlock(&d->lock);
+			blkdev_endio(bio);
+			pthread_mutex_lock(&d->lock);
+			continue;
+		}
+
+		struct timespec ts = {
+			.tv_sec		= io->done_at / NSEC_PER_SEC,
+			.tv_nsec	= io->done_at % NSEC_PER_SEC,
+		};
+		pthread_cond_timedwait(&d->wait, &d->lock, &ts);
+	}
+	pthread_mutex_unlock(&d->lock);
+
+	return 0;
+}
+
+static void ram_op(struct bio *bio, struct iovec *iov, unsigned nr, bool write)
+{
+	struct ram_dev *d = bio->bi_bdev->queue.queuedata;
+	unsigned i, slot = 0;
+	u64 now, start;
+
+	ram_copy(bio, iov, nr, write);
+
+	if (!d->thread) {
+		blkdev_endio(bio);
+		return;
+	}
+
+	now = ktime_get_mono_fast_ns();
+
+	pthread_mutex_lock(&d->lock);
+	for (i = 1; i < d->p.queue_depth; i++)
+		if (d->slot_busy_until[i] < d->slot_busy_until[slot])
+			slot = i;
+
+	start = max(now, d->slot_busy_until[slot]);
+	d->slot_busy_until[slot] = start + ram_service_ns(d, bio);
+
+	if (min_heap_full(&d->pending)) {
+		size_t size = max(d->pending.size * 2, 64UL);
+
+		d->pending.data = krealloc_array(d->pending.data, size,
+						 sizeof(d->pending.data[0]),
+						 GFP_KERNEL|__GFP_NOFAIL);
+		d->pending.size = size;
+	}
+
+	struct ram_io io = {
+		.done_at	= d->slot_busy_until[slot],
+		.bio		= bio,
+	};
+	min_heap_push(&d->pending, &io, &ram_io_heap_callbacks, NULL);
+
+	/* Only need to wake the completion thread if it's sleeping too long: */
+	if (min_heap_peek(&d->pending)->bio == bio)
+		pthread_cond_signal(&d->wait);
+	pthread_mutex_unlock(&d->lock);
+}
+
+static void ram_read(struct bio *bio, struct iovec *iov, unsigned i)
+{
+	ram_op(bio, iov, i, false);
+}
+
+static void ram_write(struct bio *bio, struct iovec *iov, unsigned i)
+{
+	ram_op(bio, iov, i, true);
+}
+
+static void ram_flush(struct block_device *bdev)
+{
+	while (blkdev_flush_done(bdev, 0))
+		;
+}
+
+static int ram_discard(struct block_device *bdev, enum req_opf op,
+		       sector_t sector, sector_t nr_sects)
+{
+	struct ram_dev *d = bdev->queue.queuedata;
+	u64 pos = sector << 9, end = (sector + nr_sects) << 9;
+
+	/* Discarded data reads back as zeroes, same as zeroout: */
+	while (pos < end) {
+		u64 idx = pos >> RAM_CHUNK_SHIFT;
+		unsigned offset = pos & (RAM_CHUNK_SIZE - 1);
+		unsigned n = min_t(u64, end - pos, RAM_CHUNK_SIZE - offset);
+
+		if (n == RAM_CHUNK_SIZE) {
+			void **slot = genradix_ptr_alloc(&d->chunks, idx, GFP_KERNEL);
+			void *old;
+
+			if (!slot)
+				die("error allocating ram backend memory");
+
+			old = xchg(slot, RAM_ZERO_CHUNK);
+			if (old != RAM_ZERO_CHUNK)
+				free(old);
+		} else {
+			memset(ram_chunk_get(bdev, idx, true) + offset, 0, n);
+		}
+
+		pos += n;
+	}
+
+	return 0;
+}
+
+static void ram_open(struct block_device *bdev)
+{
+	struct ram_dev *d = kzalloc(sizeof(*d), GFP_KERNEL);
+	const char *profile = getenv("BCACHEFS_RAM_PROFILE");
+	pthread_condattr_t attr;
+
+	if (!d)
+		die("error allocating ram backend");
+
+	genradix_init(&d->chunks);
+	d->nr_sectors	= get_capacity(bdev->bd_disk);
+	prandom_seed_state(&d->rand, get_random_u64());
+
+	if (profile)
+		ram_profile_parse(&d->p, profile);
+	d->p.bytes_per_sec = (u64) getenv_uint("BCACHEFS_RAM_BANDWIDTH_MB",
+					       d->p.bytes_per_sec >> 20) << 20;
+	d->p.queue_depth = getenv_uint("BCACHEFS_RAM_QUEUE_DEPTH", d->p.queue_depth);
+
+	pthread_mutex_init(&d->lock, NULL);
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&d->wait, &attr);
+	pthread_condattr_destroy(&attr);
+
+	bdev->queue.queuedata = d;
+
+	if (d->p.read_ns || d->p.write_ns || d->p.bytes_per_sec) {
+		d->p.queue_depth = d->p.queue_depth ?: 32;
+		d->slot_busy_until = kcalloc(d->p.queue_depth,
+					     sizeof(d->slot_busy_until[0]),
+					     GFP_KERNEL|__GFP_NOFAIL);
+
+		struct task_struct *p =
+			kthread_run(ram_completion_thread, d, "ram_completion");
+		BUG_ON(IS_ERR(p));
+
+		get_task_struct(p);
+		d->thread = p;
+	}
+}
+
+static void ram_close(struct block_device *bdev)
+{
+	struct ram_dev *d = bdev->queue.queuedata;
+	struct genradix_iter iter;
+	void **chunk;
+
+	if (d->thread) {
+		pthread_mutex_lock(&d->lock);
+		d->stop = true;
+		pthread_cond_signal(&d->wait);
+		pthread_mutex_unlock(&d->lock);
+
+		kthread_stop(d->thread);
+		put_task_struct(d->thread);
+	}
+
+	genradix_for_each(&d->chunks, iter, chunk)
+		if (*chunk != RAM_ZERO_CHUNK)
+			free(*chunk);
+	genradix_free(&d->chunks);
+
+	pthread_cond_destroy(&d->wait);
+	pthread_mutex_destroy(&d->lock);
+	kfree(d->pending.data);
+	kfree(d->slot_busy_until);
+	kfree(d);
+
+	bdev->queue.queuedata = NULL;
+}
+
+static void ram_init(void) {}
+static void ram_cleanup(void) {}
+
+static struct fops fops_list[] = {
 	{
+		.name		= "uring",
 		.init		= uring_init,
+		.cleanup	= uring_cleanup,
+		.open		= uring_open,
+		.close		= uring_close,
+		.register_buffer = uring_register_buffer,
+		.unregister_buffer = uring_unregister_buffer,
+		.flush		= uring_flush,
+		.read		= uring_read,
+		.write		= uring_write,
 	}, {
+		.name		= "aio",
 		.init		= aio_init,
 		.cleanup	= aio_cleanup,
+		.open		= aio_open,
+		.close		= aio_close,
+		.unplug		= aio_unplug,
+		.flush		= aio_flush,
 		.read		= aio_read,
 		.write		= aio_write,
 	}, {
+		.name		= "sync",
 		.init		= sync_init,
 		.cleanup	= sync_cleanup,
+		.flush		= sync_flush,
 		.read		= sync_read,
 		.write		= sync_write,
+	}, {
+		/* Never a fallback, only used if asked for: */
+		.name		= "ram",
+		.init		= ram_init,
+		.cleanup	= ram_cleanup,
+		.open		= ram_open,
+		.close		= ram_close,
+		.flush		= ram_flush,
+		.discard	= ram_discard,
+		.read		= ram_read,
+		.write		= ram_write,
 	}, {
 		/* NULL */
 	}
 };
 
+static struct fops *fops_lookup(const char *name)
+{
+	struct fops *f;
+
+	for (f = fops_list; f->init; f++)
+		if (!strcmp(f->name, name))
+			return f;
+	return NULL;
+}
+
+/*
+ * Switch to a different backend; only valid while no block devices are open
+ * and no IO is in flight. If the requested backend isn't available we fall
+ * back to the next one in fops_list.
+ */
+int blkdev_set_backend(const char *name)
+{
+	struct fops *f = fops_lookup(name);
+
+	if (!f)
+		return -EINVAL;
+
+	if (f != fops) {
+		fops->cleanup();
+		fops = f;
+		fops->init();
+
+		/*
+		 * Buffers stay registered with us if the new backend doesn't
+		 * take them, so that switching back picks them up again; not
+		 * locked across init, which may allocate and register buffers:
+		 */
+		mutex_lock(&blkdev_bufs_lock);
+		if (fops->register_buffer)
+			for (unsigned i = 0; i < ARRAY_SIZE(blkdev_bufs); i++)
+				if (blkdev_bufs[i].buf)
+					fops->register_buffer(blkdev_bufs[i].buf,
+							      blkdev_bufs[i].len);
+		mutex_unlock(&blkdev_bufs_lock);
+	}
+	return 0;
+}
+
+const char *blkdev_backend_name(void)
+{
+	return fops->name;
+}
+
+/*
+ * Register a buffer that will be used for IO with the backend, so that it
+ * doesn't have to be mapped for every IO: the memory must stay mapped until
+ * blkdev_unregister_buffer().
+ */
+int blkdev_register_buffer(void *buf, size_t len)
+{
+	unsigned i;
+	int ret = -ENOSPC;
+
+	/* May be called from allocators before blkdev_init(): */
+	if (!fops || !fops->register_buffer)
+		return -EOPNOTSUPP;
+
+	mutex_lock(&blkdev_bufs_lock);
+	for (i = 0; i < ARRAY_SIZE(blkdev_bufs); i++)
+		if (!blkdev_bufs[i].buf) {
+			ret = fops->register_buffer(buf, len);
+			if (!ret)
+				blkdev_bufs[i] = (struct blkdev_buf) { buf, len };
+			break;
+		}
+	mutex_unlock(&blkdev_bufs_lock);
+
+	return ret;
+}
+
+void blkdev_unregister_buffer(void *buf)
+{
+	mutex_lock(&blkdev_bufs_lock);
+	for (unsigned i = 0; i < ARRAY_SIZE(blkdev_bufs); i++)
+		if (blkdev_bufs[i].buf == buf) {
+			if (fops->unregister_buffer)
+				fops->unregister_buffer(buf);
+			blkdev_bufs[i] = (struct blkdev_buf) {};
+			break;
+		}
+	mutex_unlock(&blkdev_bufs_lock);
+}
+
 __attribute__((constructor(103)))
 static void blkdev_init(void)
 {
+	const char *backend = getenv("BCACHEFS_IO_BACKEND");
+
 	fops = fops_list;
+
+	if (backend) {
+		fops = fops_lookup(backend);
+		if (!fops)
+			die("unknown IO backend %s", backend);
+	}
+
 	fops->init();
+	blk_trace_init();
 }
 
 __attribute__((destructor(103)))
 static void blkdev_cleanup(void)
 {
+	blkdev_discard_exit();
 	fops->cleanup();
+	blk_trace_exit();
 }
@@ -12,9 +12,9 @@
  * from,
  * http://www.ross.net/crc/download/crc_v3.txt
  *
- * crc64table[256] is the lookup table of a table-driven 64-bit CRC
- * calculation, which is generated by gen_crc64table.c in kernel build
- * time. The polynomial of crc64 arithmetic is from ECMA-182 specification
+ * crc64table[0] is the lookup table of a table-driven 64-bit CRC
+ * calculation, which is generated along with the slicing-by-8 tables by
+ * scripts/gen-crc-tables.py. The polynomial of crc64 arithmetic is from ECMA-182 specification
  * as well, which is defined as,
  *
  * x^64 + x^62 + x^57 + x^55 + x^54 + x^53 + x^52 + x^47 + x^46 + x^45 +
@@ -26,13 +26,208 @@
  *   Author: Coly Li <colyli@suse.de>
  */
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <linux/compiler.h>
+#include <linux/crc64.h>
+#include <linux/kernel.h>
 #include <linux/module.h>
 #include <linux/types.h>
+#include <linux/unaligned.h>
 #include "crc64table.h"
 
 MODULE_DESCRIPTION("CRC64 calculations");
 MODULE_LICENSE("GPL v2");
 
+static u64 crc64_be_bytewise(u64 crc, const void *p, size_t len)
+{
+	size_t i, t;
+
+	const unsigned char *_p = p;
+
+	for (i = 0; i < len; i++) {
+		t = ((crc >> 56) ^ (*_p++)) & 0xFF;
+		crc = crc64table[0][t] ^ (crc << 8);
+	}
+
+	return crc;
+}
+
+/* Slicing-by-8: eight independent table lookups per 8 bytes: */
+static u64 crc64_be_slice8(u64 crc, const void *p, size_t len)
+{
+	const u8 *_p = p;
+
+	for (; len >= 8; _p += 8, len -= 8) {
+		u64 v = get_unaligned_be64(_p) ^ crc;
+
+		crc =	crc64table[7][v >> 56] ^
+			crc64table[6][(v >> 48) & 0xff] ^
+			crc64table[5][(v >> 40) & 0xff] ^
+			crc64table[4][(v >> 32) & 0xff] ^
+			crc64table[3][(v >> 24) & 0xff] ^
+			crc64table[2][(v >> 16) & 0xff] ^
+			crc64table[1][(v >>  8) & 0xff] ^
+			crc64table[0][v & 0xff];
+	}
+
+	return crc64_be_bytewise(crc, _p, len);
+}
+
+#ifdef __x86_64__
+
+#include <immintrin.h>
+
+#define CRC64_PCLMUL	__attribute__((target("sse4.1,pclmul")))
+
+/*
+ * Folding with carry-less multiplies, as in Intel's "Fast CRC Computation for
+ * Generic Polynomials Using PCLMULQDQ Instruction".
+ *
+ * We keep a 128 bit polynomial X = H * x^64 + L, big endian like the data,
+ * with the crc so far xored into the first 64 bits. To append the next block
+ * B, which is d bits further on, we need X * x^d + B: and X * x^d is congruent
+ * mod P to H * (x^(d + 64) mod P) + L * (x^d mod P), two 64x64 bit multiplies.
+ * So we never reduce mod P until the end, when the crc is just the crc of the
+ * 16 bytes of X.
+ *
+ * Four accumulators, folded 512 bits at a time, keep the multiplier busy; they
+ * are then folded into one, and any remaining 16 byte blocks folded into that.
+ */
+#define CRC64_FOLD(d_lo, d_hi)	_mm_set_epi64x(d_hi, d_lo)
+#define CRC64_FOLD_128		CRC64_FOLD(0x05f5c3c7eb52fab6ULL, 0x4eb938a7d257740eULL)
+#define CRC64_FOLD_256		CRC64_FOLD(0x571bee0a227ef92bULL, 0x44bef2a201b5200cULL)
+#define CRC64_FOLD_384		CRC64_FOLD(0x54819d8713758b2cULL, 0x4a6b90073eb0af5aULL)
+#define CRC64_FOLD_512		CRC64_FOLD(0x5f6843ca540df020ULL, 0xddf4b6981205b83fULL)
+
+static inline CRC64_PCLMUL __m128i crc64_load(const u8 *p)
+{
+	const __m128i bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7,
+					   8, 9, 10, 11, 12, 13, 14, 15);
+
+	return _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) p), bswap);
+}
+
+static inline CRC64_PCLMUL __m128i crc64_fold(__m128i x, __m128i k)
+{
+	return _mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x11),
+			     _mm_clmulepi64_si128(x, k, 0x00));
+}
+
+static CRC64_PCLMUL u64 crc64_be_pclmul(u64 crc, const void *p, size_t len)
+{
+	const u8 *_p = p;
+	__m128i x0, x1, x2, x3;
+	u8 buf[16];
+
+	if (len < 64)
+		return crc64_be_slice8(crc, p, len);
+
+	x0 = _mm_xor_si128(crc64_load(_p), _mm_set_epi64x(crc, 0));
+	x1 = crc64_load(_p + 16);
+	x2 = crc64_load(_p + 32);
+	x3 = crc64_load(_p + 48);
+	_p += 64;
+	len -= 64;
+
+	for (; len >= 64; _p += 64, len -= 64) {
+		x0 = _mm_xor_si128(crc64_fold(x0, CRC64_FOLD_512), crc64_load(_p));
+		x1 = _mm_xor_si128(crc64_fold(x1, CRC64_FOLD_512), crc64_load(_p + 16));
+		x2 = _mm_xor_si128(crc64_fold(x2, CRC64_FOLD_512), crc64_load(_p + 32));
+		x3 = _mm_xor_si128(crc64_fold(x3, CRC64_FOLD_512), crc64_load(_p + 48));
+	}
+
+	x0 = _mm_xor_si128(_mm_xor_si128(crc64_fold(x0, CRC64_FOLD_384),
+					 crc64_fold(x1, CRC64_FOLD_256)),
+			   _mm_xor_si128(crc64_fold(x2, CRC64_FOLD_128), x3));
+
+	for (; len >= 16; _p += 16, len -= 16)
+		x0 = _mm_xor_si128(crc64_fold(x0, CRC64_FOLD_128), crc64_load(_p));
+
+	put_unaligned_be64(_mm_extract_epi64(x0, 1), buf);
+	put_unaligned_be64(_mm_extract_epi64(x0, 0), buf + 8);
+
+	crc = crc64_be_slice8(0, buf, sizeof(buf));
+	return crc64_be_slice8(crc, _p, len);
+}
+
+static bool crc64_pclmul_supported(void)
+{
+	__builtin_cpu_init();
+
+	return  __builtin_cpu_supports("pclmul") &&
+		__builtin_cpu_supports("sse4.1");
+}
+
+#endif
+
+const struct crc64_impl crc64_impls[] = {
+	{ "bytewise",	crc64_be_bytewise },
+	{ "slice8",	crc64_be_slice8 },
+#ifdef __x86_64__
+	{ "pclmul",	crc64_be_pclmul, crc64_pclmul_supported },
+#endif
+	{ NULL }
+};
+
+/*
+ * Check every implementation we can run against the byte at a time version,
+ * for lengths around the block sizes of each, at each alignment:
+ */
+int crc64_selftest(void)
+{
+	static const size_t lens[] = {
+		0, 1, 7, 8, 9, 15, 16, 17, 63, 64, 65, 79, 80, 127, 128, 129,
+		191, 192, 255, 256, 1000, 4096, 4097, 65536 + 37,
+	};
+	size_t max_len = 65536 + 37 + 16;
+	u8 *buf = malloc(max_len);
+	int ret = 0;
+
+	if (!buf)
+		return -ENOMEM;
+
+	for (size_t i = 0; i < max_len; i++)
+		buf[i] = i * 131 + (i >> 8) * 7;
+
+	for (const struct crc64_impl *i = crc64_impls + 1; i->name; i++) {
+		if (!crc64_impl_supported(i))
+			continue;
+
+		for (unsigned l = 0; l < ARRAY_SIZE(lens); l++)
+			for (unsigned offset = 0; offset < 16; offset++) {
+				u64 seed = 0x0123456789abcdefULL * (l + offset);
+
+				if (i->fn(seed, buf + offset, lens[l]) !=
+				    crc64_be_bytewise(seed, buf + offset, lens[l])) {
+					fprintf(stderr, "crc64 %s: wrong crc for len %zu offset %u\n",
+						i->name, lens[l], offset);
+					ret = -EINVAL;
+					goto out;
+				}
+			}
+	}
+out:
+	free(buf);
+	return ret;
+}
+
+static u64 (*crc64_be_fn)(u64, const void *, size_t);
+
+/* The last supported implementation is the fastest: */
+static void crc64_resolve(void)
+{
+	const struct crc64_impl *i, *best = crc64_impls;
+
+	for (i = crc64_impls; i->name; i++)
+		if (crc64_impl_supported(i))
+			best = i;
+
+	WRITE_ONCE(crc64_be_fn, best->fn);
+}
+
 /**
  * crc64_be - Calculate bitwise big-endian ECMA-182 CRC64
  * @crc: seed value for computation. 0 or (u64)~0 for a new CRC calculation,
@@ -42,15 +237,13 @@ MODULE_LICENSE("GPL v2");
  */
 u64 __pure crc64_be(u64 crc, const void *p, size_t len)
 {
-	size_t i, t;
+	u64 (*fn)(u64, const void *, size_t) = READ_ONCE(crc64_be_fn);
 
-	const unsigned char *_p = p;
-
-	for (i = 0; i < len; i++) {
-		t = ((crc >> 56) ^ (*_p++)) & 0xFF;
-		crc = crc64table[t] ^ (crc << 8);
+	if (unlikely(!fn)) {
+		crc64_resolve();
+		fn = READ_ONCE(crc64_be_fn);
 	}
 
-	return crc;
+	return fn(crc, p, len);
 }
 EXPORT_SYMBOL_GPL(crc64_be);
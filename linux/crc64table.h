@@ -1,135 +1,1052 @@
-/* this file is generated - do not edit */
+/* this file is generated by scripts/gen-crc-tables.py - do not edit */
+
+/*
+ * crc64table[k][i] is the crc of byte i followed by k zero bytes: slicing-by-8
+ * tables, the first of which is the usual byte at a time table.
+ */
 
 #include <linux/types.h>
 #include <linux/cache.h>
 
-static const u64 ____cacheline_aligned crc64table[256] = {
-	0x0000000000000000ULL, 	0x42f0e1eba9ea3693ULL,
-	0x85e1c3d753d46d26ULL, 	0xc711223cfa3e5bb5ULL,
-	0x493366450e42ecdfULL, 	0x0bc387aea7a8da4cULL,
-	0xccd2a5925d9681f9ULL, 	0x8e224479f47cb76aULL,
-	0x9266cc8a1c85d9beULL, 	0xd0962d61b56fef2dULL,
-	0x17870f5d4f51b498ULL, 	0x5577eeb6e6bb820bULL,
-	0xdb55aacf12c73561ULL, 	0x99a54b24bb2d03f2ULL,
-	0x5eb4691841135847ULL, 	0x1c4488f3e8f96ed4ULL,
-	0x663d78ff90e185efULL, 	0x24cd9914390bb37cULL,
-	0xe3dcbb28c335e8c9ULL, 	0xa12c5ac36adfde5aULL,
-	0x2f0e1eba9ea36930ULL, 	0x6dfeff5137495fa3ULL,
-	0xaaefdd6dcd770416ULL, 	0xe81f3c86649d3285ULL,
-	0xf45bb4758c645c51ULL, 	0xb6ab559e258e6ac2ULL,
-	0x71ba77a2dfb03177ULL, 	0x334a9649765a07e4ULL,
-	0xbd68d2308226b08eULL, 	0xff9833db2bcc861dULL,
-	0x388911e7d1f2dda8ULL, 	0x7a79f00c7818eb3bULL,
-	0xcc7af1ff21c30bdeULL, 	0x8e8a101488293d4dULL,
-	0x499b3228721766f8ULL, 	0x0b6bd3c3dbfd506bULL,
-	0x854997ba2f81e701ULL, 	0xc7b97651866bd192ULL,
-	0x00a8546d7c558a27ULL, 	0x4258b586d5bfbcb4ULL,
-	0x5e1c3d753d46d260ULL, 	0x1cecdc9e94ace4f3ULL,
-	0xdbfdfea26e92bf46ULL, 	0x990d1f49c77889d5ULL,
-	0x172f5b3033043ebfULL, 	0x55dfbadb9aee082cULL,
-	0x92ce98e760d05399ULL, 	0xd03e790cc93a650aULL,
-	0xaa478900b1228e31ULL, 	0xe8b768eb18c8b8a2ULL,
-	0x2fa64ad7e2f6e317ULL, 	0x6d56ab3c4b1cd584ULL,
-	0xe374ef45bf6062eeULL, 	0xa1840eae168a547dULL,
-	0x66952c92ecb40fc8ULL, 	0x2465cd79455e395bULL,
-	0x3821458aada7578fULL, 	0x7ad1a461044d611cULL,
-	0xbdc0865dfe733aa9ULL, 	0xff3067b657990c3aULL,
-	0x711223cfa3e5bb50ULL, 	0x33e2c2240a0f8dc3ULL,
-	0xf4f3e018f031d676ULL, 	0xb60301f359dbe0e5ULL,
-	0xda050215ea6c212fULL, 	0x98f5e3fe438617bcULL,
-	0x5fe4c1c2b9b84c09ULL, 	0x1d14202910527a9aULL,
-	0x93366450e42ecdf0ULL, 	0xd1c685bb4dc4fb63ULL,
-	0x16d7a787b7faa0d6ULL, 	0x5427466c1e109645ULL,
-	0x4863ce9ff6e9f891ULL, 	0x0a932f745f03ce02ULL,
-	0xcd820d48a53d95b7ULL, 	0x8f72eca30cd7a324ULL,
-	0x0150a8daf8ab144eULL, 	0x43a04931514122ddULL,
-	0x84b16b0dab7f7968ULL, 	0xc6418ae602954ffbULL,
-	0xbc387aea7a8da4c0ULL, 	0xfec89b01d3679253ULL,
-	0x39d9b93d2959c9e6ULL, 	0x7b2958d680b3ff75ULL,
-	0xf50b1caf74cf481fULL, 	0xb7fbfd44dd257e8cULL,
-	0x70eadf78271b2539ULL, 	0x321a3e938ef113aaULL,
-	0x2e5eb66066087d7eULL, 	0x6cae578bcfe24bedULL,
-	0xabbf75b735dc1058ULL, 	0xe94f945c9c3626cbULL,
-	0x676dd025684a91a1ULL, 	0x259d31cec1a0a732ULL,
-	0xe28c13f23b9efc87ULL, 	0xa07cf2199274ca14ULL,
-	0x167ff3eacbaf2af1ULL, 	0x548f120162451c62ULL,
-	0x939e303d987b47d7ULL, 	0xd16ed1d631917144ULL,
-	0x5f4c95afc5edc62eULL, 	0x1dbc74446c07f0bdULL,
-	0xdaad56789639ab08ULL, 	0x985db7933fd39d9bULL,
-	0x84193f60d72af34fULL, 	0xc6e9de8b7ec0c5dcULL,
-	0x01f8fcb784fe9e69ULL, 	0x43081d5c2d14a8faULL,
-	0xcd2a5925d9681f90ULL, 	0x8fdab8ce70822903ULL,
-	0x48cb9af28abc72b6ULL, 	0x0a3b7b1923564425ULL,
-	0x70428b155b4eaf1eULL, 	0x32b26afef2a4998dULL,
-	0xf5a348c2089ac238ULL, 	0xb753a929a170f4abULL,
-	0x3971ed50550c43c1ULL, 	0x7b810cbbfce67552ULL,
-	0xbc902e8706d82ee7ULL, 	0xfe60cf6caf321874ULL,
-	0xe224479f47cb76a0ULL, 	0xa0d4a674ee214033ULL,
-	0x67c58448141f1b86ULL, 	0x253565a3bdf52d15ULL,
-	0xab1721da49899a7fULL, 	0xe9e7c031e063acecULL,
-	0x2ef6e20d1a5df759ULL, 	0x6c0603e6b3b7c1caULL,
-	0xf6fae5c07d3274cdULL, 	0xb40a042bd4d8425eULL,
-	0x731b26172ee619ebULL, 	0x31ebc7fc870c2f78ULL,
-	0xbfc9838573709812ULL, 	0xfd39626eda9aae81ULL,
-	0x3a28405220a4f534ULL, 	0x78d8a1b9894ec3a7ULL,
-	0x649c294a61b7ad73ULL, 	0x266cc8a1c85d9be0ULL,
-	0xe17dea9d3263c055ULL, 	0xa38d0b769b89f6c6ULL,
-	0x2daf4f0f6ff541acULL, 	0x6f5faee4c61f773fULL,
-	0xa84e8cd83c212c8aULL, 	0xeabe6d3395cb1a19ULL,
-	0x90c79d3fedd3f122ULL, 	0xd2377cd44439c7b1ULL,
-	0x15265ee8be079c04ULL, 	0x57d6bf0317edaa97ULL,
-	0xd9f4fb7ae3911dfdULL, 	0x9b041a914a7b2b6eULL,
-	0x5c1538adb04570dbULL, 	0x1ee5d94619af4648ULL,
-	0x02a151b5f156289cULL, 	0x4051b05e58bc1e0fULL,
-	0x87409262a28245baULL, 	0xc5b073890b687329ULL,
-	0x4b9237f0ff14c443ULL, 	0x0962d61b56fef2d0ULL,
-	0xce73f427acc0a965ULL, 	0x8c8315cc052a9ff6ULL,
-	0x3a80143f5cf17f13ULL, 	0x7870f5d4f51b4980ULL,
-	0xbf61d7e80f251235ULL, 	0xfd913603a6cf24a6ULL,
-	0x73b3727a52b393ccULL, 	0x31439391fb59a55fULL,
-	0xf652b1ad0167feeaULL, 	0xb4a25046a88dc879ULL,
-	0xa8e6d8b54074a6adULL, 	0xea16395ee99e903eULL,
-	0x2d071b6213a0cb8bULL, 	0x6ff7fa89ba4afd18ULL,
-	0xe1d5bef04e364a72ULL, 	0xa3255f1be7dc7ce1ULL,
-	0x64347d271de22754ULL, 	0x26c49cccb40811c7ULL,
-	0x5cbd6cc0cc10fafcULL, 	0x1e4d8d2b65facc6fULL,
-	0xd95caf179fc497daULL, 	0x9bac4efc362ea149ULL,
-	0x158e0a85c2521623ULL, 	0x577eeb6e6bb820b0ULL,
-	0x906fc95291867b05ULL, 	0xd29f28b9386c4d96ULL,
-	0xcedba04ad0952342ULL, 	0x8c2b41a1797f15d1ULL,
-	0x4b3a639d83414e64ULL, 	0x09ca82762aab78f7ULL,
-	0x87e8c60fded7cf9dULL, 	0xc51827e4773df90eULL,
-	0x020905d88d03a2bbULL, 	0x40f9e43324e99428ULL,
-	0x2cffe7d5975e55e2ULL, 	0x6e0f063e3eb46371ULL,
-	0xa91e2402c48a38c4ULL, 	0xebeec5e96d600e57ULL,
-	0x65cc8190991cb93dULL, 	0x273c607b30f68faeULL,
-	0xe02d4247cac8d41bULL, 	0xa2dda3ac6322e288ULL,
-	0xbe992b5f8bdb8c5cULL, 	0xfc69cab42231bacfULL,
-	0x3b78e888d80fe17aULL, 	0x7988096371e5d7e9ULL,
-	0xf7aa4d1a85996083ULL, 	0xb55aacf12c735610ULL,
-	0x724b8ecdd64d0da5ULL, 	0x30bb6f267fa73b36ULL,
-	0x4ac29f2a07bfd00dULL, 	0x08327ec1ae55e69eULL,
-	0xcf235cfd546bbd2bULL, 	0x8dd3bd16fd818bb8ULL,
-	0x03f1f96f09fd3cd2ULL, 	0x41011884a0170a41ULL,
-	0x86103ab85a2951f4ULL, 	0xc4e0db53f3c36767ULL,
-	0xd8a453a01b3a09b3ULL, 	0x9a54b24bb2d03f20ULL,
-	0x5d45907748ee6495ULL, 	0x1fb5719ce1045206ULL,
-	0x919735e51578e56cULL, 	0xd367d40ebc92d3ffULL,
-	0x1476f63246ac884aULL, 	0x568617d9ef46bed9ULL,
-	0xe085162ab69d5e3cULL, 	0xa275f7c11f7768afULL,
-	0x6564d5fde549331aULL, 	0x279434164ca30589ULL,
-	0xa9b6706fb8dfb2e3ULL, 	0xeb46918411358470ULL,
-	0x2c57b3b8eb0bdfc5ULL, 	0x6ea7525342e1e956ULL,
-	0x72e3daa0aa188782ULL, 	0x30133b4b03f2b111ULL,
-	0xf7021977f9cceaa4ULL, 	0xb5f2f89c5026dc37ULL,
-	0x3bd0bce5a45a6b5dULL, 	0x79205d0e0db05dceULL,
-	0xbe317f32f78e067bULL, 	0xfcc19ed95e6430e8ULL,
-	0x86b86ed5267cdbd3ULL, 	0xc4488f3e8f96ed40ULL,
-	0x0359ad0275a8b6f5ULL, 	0x41a94ce9dc428066ULL,
-	0xcf8b0890283e370cULL, 	0x8d7be97b81d4019fULL,
-	0x4a6acb477bea5a2aULL, 	0x089a2aacd2006cb9ULL,
-	0x14dea25f3af9026dULL, 	0x562e43b4931334feULL,
-	0x913f6188692d6f4bULL, 	0xd3cf8063c0c759d8ULL,
-	0x5dedc41a34bbeeb2ULL, 	0x1f1d25f19d51d821ULL,
-	0xd80c07cd676f8394ULL, 	0x9afce626ce85b507ULL,
+static const u64 ____cacheline_aligned crc64table[8][256] = {
+	{
+		0x0000000000000000ULL, 	0x42f0e1eba9ea3693ULL,
+		0x85e1c3d753d46d26ULL, 	0xc711223cfa3e5bb5ULL,
+		0x493366450e42ecdfULL, 	0x0bc387aea7a8da4cULL,
+		0xccd2a5925d9681f9ULL, 	0x8e224479f47cb76aULL,
+		0x9266cc8a1c85d9beULL, 	0xd0962d61b56fef2dULL,
+		0x17870f5d4f51b498ULL, 	0x5577eeb6e6bb820bULL,
+		0xdb55aacf12c73561ULL, 	0x99a54b24bb2d03f2ULL,
+		0x5eb4691841135847ULL, 	0x1c4488f3e8f96ed4ULL,
+		0x663d78ff90e185efULL, 	0x24cd9914390bb37cULL,
+		0xe3dcbb28c335e8c9ULL, 	0xa12c5ac36adfde5aULL,
+		0x2f0e1eba9ea36930ULL, 	0x6dfeff5137495fa3ULL,
+		0xaaefdd6dcd770416ULL, 	0xe81f3c86649d3285ULL,
+		0xf45bb4758c645c51ULL, 	0xb6ab559e258e6ac2ULL,
+		0x71ba77a2dfb03177ULL, 	0x334a9649765a07e4ULL,
+		0xbd68d2308226b08eULL, 	0xff9833db2bcc861dULL,
+		0x388911e7d1f2dda8ULL, 	0x7a79f00c7818eb3bULL,
+		0xcc7af1ff21c30bdeULL, 	0x8e8a101488293d4dULL,
+		0x499b3228721766f8ULL, 	0x0b6bd3c3dbfd506bULL,
+		0x854997ba2f81e701ULL, 	0xc7b97651866bd192ULL,
+		0x00a8546d7c558a27ULL, 	0x4258b586d5bfbcb4ULL,
+		0x5e1c3d753d46d260ULL, 	0x1cecdc9e94ace4f3ULL,
+		0xdbfdfea26e92bf46ULL, 	0x990d1f49c77889d5ULL,
+		0x172f5b3033043ebfULL, 	0x55dfbadb9aee082cULL,
+		0x92ce98e760d05399ULL, 	0xd03e790cc93a650aULL,
+		0xaa478900b1228e31ULL, 	0xe8b768eb18c8b8a2ULL,
+		0x2fa64ad7e2f6e317ULL, 	0x6d56ab3c4b1cd584ULL,
+		0xe374ef45bf6062eeULL, 	0xa1840eae168a547dULL,
+		0x66952c92ecb40fc8ULL, 	0x2465cd79455e395bULL,
+		0x3821458aada7578fULL, 	0x7ad1a461044d611cULL,
+		0xbdc0865dfe733aa9ULL, 	0xff3067b657990c3aULL,
+		0x711223cfa3e5bb50ULL, 	0x33e2c2240a0f8dc3ULL,
+		0xf4f3e018f031d676ULL, 	0xb60301f359dbe0e5ULL,
+		0xda050215ea6c212fULL, 	0x98f5e3fe438617bcULL,
+		0x5fe4c1c2b9b84c09ULL, 	0x1d14202910527a9aULL,
+		0x93366450e42ecdf0ULL, 	0xd1c685bb4dc4fb63ULL,
+		0x16d7a787b7faa0d6ULL, 	0x5427466c1e109645ULL,
+		0x4863ce9ff6e9f891ULL, 	0x0a932f745f03ce02ULL,
+		0xcd820d48a53d95b7ULL, 	0x8f72eca30cd7a324ULL,
+		0x0150a8daf8ab144eULL, 	0x43a04931514122ddULL,
+		0x84b16b0dab7f7968ULL, 	0xc6418ae602954ffbULL,
+		0xbc387aea7a8da4c0ULL, 	0xfec89b01d3679253ULL,
+		0x39d9b93d2959c9e6ULL, 	0x7b2958d680b3ff75ULL,
+		0xf50b1caf74cf481fULL, 	0xb7fbfd44dd257e8cULL,
+		0x70eadf78271b2539ULL, 	0x321a3e938ef113aaULL,
+		0x2e5eb66066087d7eULL, 	0x6cae578bcfe24bedULL,
+		0xabbf75b735dc1058ULL, 	0xe94f945c9c3626cbULL,
+		0x676dd025684a91a1ULL, 	0x259d31cec1a0a732ULL,
+		0xe28c13f23b9efc87ULL, 	0xa07cf2199274ca14ULL,
+		0x167ff3eacbaf2af1ULL, 	0x548f120162451c62ULL,
+		0x939e303d987b47d7ULL, 	0xd16ed1d631917144ULL,
+		0x5f4c95afc5edc62eULL, 	0x1dbc74446c07f0bdULL,
+		0xdaad56789639ab08ULL, 	0x985db7933fd39d9bULL,
+		0x84193f60d72af34fULL, 	0xc6e9de8b7ec0c5dcULL,
+		0x01f8fcb784fe9e69ULL, 	0x43081d5c2d14a8faULL,
+		0xcd2a5925d9681f90ULL, 	0x8fdab8ce70822903ULL,
+		0x48cb9af28abc72b6ULL, 	0x0a3b7b1923564425ULL,
+		0x70428b155b4eaf1eULL, 	0x32b26afef2a4998dULL,
+		0xf5a348c2089ac238ULL, 	0xb753a929a170f4abULL,
+		0x3971ed50550c43c1ULL, 	0x7b810cbbfce67552ULL,
+		0xbc902e8706d82ee7ULL, 	0xfe60cf6caf321874ULL,
+		0xe224479f47cb76a0ULL, 	0xa0d4a674ee214033ULL,
+		0x67c58448141f1b86ULL, 	0x253565a3bdf52d15ULL,
+		0xab1721da49899a7fULL, 	0xe9e7c031e063acecULL,
+		0x2ef6e20d1a5df759ULL, 	0x6c0603e6b3b7c1caULL,
+		0xf6fae5c07d3274cdULL, 	0xb40a042bd4d8425eULL,
+		0x731b26172ee619ebULL, 	0x31ebc7fc870c2f78ULL,
+		0xbfc9838573709812ULL, 	0xfd39626eda9aae81ULL,
+		0x3a28405220a4f534ULL, 	0x78d8a1b9894ec3a7ULL,
+		0x649c294a61b7ad73ULL, 	0x266cc8a1c85d9be0ULL,
+		0xe17dea9d3263c055ULL, 	0xa38d0b769b89f6c6ULL,
+		0x2daf4f0f6ff541acULL, 	0x6f5faee4c61f773fULL,
+		0xa84e8cd83c212c8aULL, 	0xeabe6d3395cb1a19ULL,
+		0x90c79d3fedd3f122ULL, 	0xd2377cd44439c7b1ULL,
+		0x15265ee8be079c04ULL, 	0x57d6bf0317edaa97ULL,
+		0xd9f4fb7ae3911dfdULL, 	0x9b041a914a7b2b6eULL,
+		0x5c1538adb04570dbULL, 	0x1ee5d94619af4648ULL,
+		0x02a151b5f156289cULL, 	0x4051b05e58bc1e0fULL,
+		0x87409262a28245baULL, 	0xc5b073890b687329ULL,
+		0x4b9237f0ff14c443ULL, 	0x0962d61b56fef2d0ULL,
+		0xce73f427acc0a965ULL, 	0x8c8315cc052a9ff6ULL,
+		0x3a80143f5cf17f13ULL, 	0x7870f5d4f51b4980ULL,
+		0xbf61d7e80f251235ULL, 	0xfd913603a6cf24a6ULL,
+		0x73b3727a52b393ccULL, 	0x31439391fb59a55fULL,
+		0xf652b1ad0167feeaULL, 	0xb4a25046a88dc879ULL,
+		0xa8e6d8b54074a6adULL, 	0xea16395ee99e903eULL,
+		0x2d071b6213a0cb8bULL, 	0x6ff7fa89ba4afd18ULL,
+		0xe1d5bef04e364a72ULL, 	0xa3255f1be7dc7ce1ULL,
+		0x64347d271de22754ULL, 	0x26c49cccb40811c7ULL,
+		0x5cbd6cc0cc10fafcULL, 	0x1e4d8d2b65facc6fULL,
+		0xd95caf179fc497daULL, 	0x9bac4efc362ea149ULL,
+		0x158e0a85c2521623ULL, 	0x577eeb6e6bb820b0ULL,
+		0x906fc95291867b05ULL, 	0xd29f28b9386c4d96ULL,
+		0xcedba04ad0952342ULL, 	0x8c2b41a1797f15d1ULL,
+		0x4b3a639d83414e64ULL, 	0x09ca82762aab78f7ULL,
+		0x87e8c60fded7cf9dULL, 	0xc51827e4773df90eULL,
+		0x020905d88d03a2bbULL, 	0x40f9e43324e99428ULL,
+		0x2cffe7d5975e55e2ULL, 	0x6e0f063e3eb46371ULL,
+		0xa91e2402c48a38c4ULL, 	0xebeec5e96d600e57ULL,
+		0x65cc8190991cb93dULL, 	0x273c607b30f68faeULL,
+		0xe02d4247cac8d41bULL, 	0xa2dda3ac6322e288ULL,
+		0xbe992b5f8bdb8c5cULL, 	0xfc69cab42231bacfULL,
+		0x3b78e888d80fe17aULL, 	0x7988096371e5d7e9ULL,
+		0xf7aa4d1a85996083ULL, 	0xb55aacf12c735610ULL,
+		0x724b8ecdd64d0da5ULL, 	0x30bb6f267fa73b36ULL,
+		0x4ac29f2a07bfd00dULL, 	0x08327ec1ae55e69eULL,
+		0xcf235cfd546bbd2bULL, 	0x8dd3bd16fd818bb8ULL,
+		0x03f1f96f09fd3cd2ULL, 	0x41011884a0170a41ULL,
+		0x86103ab85a2951f4ULL, 	0xc4e0db53f3c36767ULL,
+		0xd8a453a01b3a09b3ULL, 	0x9a54b24bb2d03f20ULL,
+		0x5d45907748ee6495ULL, 	0x1fb5719ce1045206ULL,
+		0x919735e51578e56cULL, 	0xd367d40ebc92d3ffULL,
+		0x1476f63246ac884aULL, 	0x568617d9ef46bed9ULL,
+		0xe085162ab69d5e3cULL, 	0xa275f7c11f7768afULL,
+		0x6564d5fde549331aULL, 	0x279434164ca30589ULL,
+		0xa9b6706fb8dfb2e3ULL, 	0xeb46918411358470ULL,
+		0x2c57b3b8eb0bdfc5ULL, 	0x6ea7525342e1e956ULL,
+		0x72e3daa0aa188782ULL, 	0x30133b4b03f2b111ULL,
+		0xf7021977f9cceaa4ULL, 	0xb5f2f89c5026dc37ULL,
+		0x3bd0bce5a45a6b5dULL, 	0x79205d0e0db05dceULL,
+		0xbe317f32f78e067bULL, 	0xfcc19ed95e6430e8ULL,
+		0x86b86ed5267cdbd3ULL, 	0xc4488f3e8f96ed40ULL,
+		0x0359ad0275a8b6f5ULL, 	0x41a94ce9dc428066ULL,
+		0xcf8b0890283e370cULL, 	0x8d7be97b81d4019fULL,
+		0x4a6acb477bea5a2aULL, 	0x089a2aacd2006cb9ULL,
+		0x14dea25f3af9026dULL, 	0x562e43b4931334feULL,
+		0x913f6188692d6f4bULL, 	0xd3cf8063c0c759d8ULL,
+		0x5dedc41a34bbeeb2ULL, 	0x1f1d25f19d51d821ULL,
+		0xd80c07cd676f8394ULL, 	0x9afce626ce85b507ULL,
+	},
+	{
+		0x0000000000000000ULL, 	0xaf052a6b538edf09ULL,
+		0x1cfab53d0ef78881ULL, 	0xb3ff9f565d795788ULL,
+		0x39f56a7a1def1102ULL, 	0x96f040114e61ce0bULL,
+		0x250fdf4713189983ULL, 	0x8a0af52c4096468aULL,
+		0x73ead4f43bde2204ULL, 	0xdceffe9f6850fd0dULL,
+		0x6f1061c93529aa85ULL, 	0xc0154ba266a7758cULL,
+		0x4a1fbe8e26313306ULL, 	0xe51a94e575bfec0fULL,
+		0x56e50bb328c6bb87ULL, 	0xf9e021d87b48648eULL,
+		0xe7d5a9e877bc4408ULL, 	0x48d0838324329b01ULL,
+		0xfb2f1cd5794bcc89ULL, 	0x542a36be2ac51380ULL,
+		0xde20c3926a53550aULL, 	0x7125e9f939dd8a03ULL,
+		0xc2da76af64a4dd8bULL, 	0x6ddf5cc4372a0282ULL,
+		0x943f7d1c4c62660cULL, 	0x3b3a57771fecb905ULL,
+		0x88c5c8214295ee8dULL, 	0x27c0e24a111b3184ULL,
+		0xadca1766518d770eULL, 	0x02cf3d0d0203a807ULL,
+		0xb130a25b5f7aff8fULL, 	0x1e3588300cf42086ULL,
+		0x8d5bb23b4692be83ULL, 	0x225e9850151c618aULL,
+		0x91a1070648653602ULL, 	0x3ea42d6d1bebe90bULL,
+		0xb4aed8415b7daf81ULL, 	0x1babf22a08f37088ULL,
+		0xa8546d7c558a2700ULL, 	0x075147170604f809ULL,
+		0xfeb166cf7d4c9c87ULL, 	0x51b44ca42ec2438eULL,
+		0xe24bd3f273bb1406ULL, 	0x4d4ef9992035cb0fULL,
+		0xc7440cb560a38d85ULL, 	0x684126de332d528cULL,
+		0xdbbeb9886e540504ULL, 	0x74bb93e33ddada0dULL,
+		0x6a8e1bd3312efa8bULL, 	0xc58b31b862a02582ULL,
+		0x7674aeee3fd9720aULL, 	0xd97184856c57ad03ULL,
+		0x537b71a92cc1eb89ULL, 	0xfc7e5bc27f4f3480ULL,
+		0x4f81c49422366308ULL, 	0xe084eeff71b8bc01ULL,
+		0x1964cf270af0d88fULL, 	0xb661e54c597e0786ULL,
+		0x059e7a1a0407500eULL, 	0xaa9b507157898f07ULL,
+		0x2091a55d171fc98dULL, 	0x8f948f3644911684ULL,
+		0x3c6b106019e8410cULL, 	0x936e3a0b4a669e05ULL,
+		0x5847859d24cf4b95ULL, 	0xf742aff67741949cULL,
+		0x44bd30a02a38c314ULL, 	0xebb81acb79b61c1dULL,
+		0x61b2efe739205a97ULL, 	0xceb7c58c6aae859eULL,
+		0x7d485ada37d7d216ULL, 	0xd24d70b164590d1fULL,
+		0x2bad51691f116991ULL, 	0x84a87b024c9fb698ULL,
+		0x3757e45411e6e110ULL, 	0x9852ce3f42683e19ULL,
+		0x12583b1302fe7893ULL, 	0xbd5d11785170a79aULL,
+		0x0ea28e2e0c09f012ULL, 	0xa1a7a4455f872f1bULL,
+		0xbf922c7553730f9dULL, 	0x1097061e00fdd094ULL,
+		0xa36899485d84871cULL, 	0x0c6db3230e0a5815ULL,
+		0x8667460f4e9c1e9fULL, 	0x29626c641d12c196ULL,
+		0x9a9df332406b961eULL, 	0x3598d95913e54917ULL,
+		0xcc78f88168ad2d99ULL, 	0x637dd2ea3b23f290ULL,
+		0xd0824dbc665aa518ULL, 	0x7f8767d735d47a11ULL,
+		0xf58d92fb75423c9bULL, 	0x5a88b89026cce392ULL,
+		0xe97727c67bb5b41aULL, 	0x46720dad283b6b13ULL,
+		0xd51c37a6625df516ULL, 	0x7a191dcd31d32a1fULL,
+		0xc9e6829b6caa7d97ULL, 	0x66e3a8f03f24a29eULL,
+		0xece95ddc7fb2e414ULL, 	0x43ec77b72c3c3b1dULL,
+		0xf013e8e171456c95ULL, 	0x5f16c28a22cbb39cULL,
+		0xa6f6e3525983d712ULL, 	0x09f3c9390a0d081bULL,
+		0xba0c566f57745f93ULL, 	0x15097c0404fa809aULL,
+		0x9f038928446cc610ULL, 	0x3006a34317e21919ULL,
+		0x83f93c154a9b4e91ULL, 	0x2cfc167e19159198ULL,
+		0x32c99e4e15e1b11eULL, 	0x9dccb425466f6e17ULL,
+		0x2e332b731b16399fULL, 	0x813601184898e696ULL,
+		0x0b3cf434080ea01cULL, 	0xa439de5f5b807f15ULL,
+		0x17c6410906f9289dULL, 	0xb8c36b625577f794ULL,
+		0x41234aba2e3f931aULL, 	0xee2660d17db14c13ULL,
+		0x5dd9ff8720c81b9bULL, 	0xf2dcd5ec7346c492ULL,
+		0x78d620c033d08218ULL, 	0xd7d30aab605e5d11ULL,
+		0x642c95fd3d270a99ULL, 	0xcb29bf966ea9d590ULL,
+		0xb08f0b3a499e972aULL, 	0x1f8a21511a104823ULL,
+		0xac75be0747691fabULL, 	0x0370946c14e7c0a2ULL,
+		0x897a614054718628ULL, 	0x267f4b2b07ff5921ULL,
+		0x9580d47d5a860ea9ULL, 	0x3a85fe160908d1a0ULL,
+		0xc365dfce7240b52eULL, 	0x6c60f5a521ce6a27ULL,
+		0xdf9f6af37cb73dafULL, 	0x709a40982f39e2a6ULL,
+		0xfa90b5b46fafa42cULL, 	0x55959fdf3c217b25ULL,
+		0xe66a008961582cadULL, 	0x496f2ae232d6f3a4ULL,
+		0x575aa2d23e22d322ULL, 	0xf85f88b96dac0c2bULL,
+		0x4ba017ef30d55ba3ULL, 	0xe4a53d84635b84aaULL,
+		0x6eafc8a823cdc220ULL, 	0xc1aae2c370431d29ULL,
+		0x72557d952d3a4aa1ULL, 	0xdd5057fe7eb495a8ULL,
+		0x24b0762605fcf126ULL, 	0x8bb55c4d56722e2fULL,
+		0x384ac31b0b0b79a7ULL, 	0x974fe9705885a6aeULL,
+		0x1d451c5c1813e024ULL, 	0xb24036374b9d3f2dULL,
+		0x01bfa96116e468a5ULL, 	0xaeba830a456ab7acULL,
+		0x3dd4b9010f0c29a9ULL, 	0x92d1936a5c82f6a0ULL,
+		0x212e0c3c01fba128ULL, 	0x8e2b265752757e21ULL,
+		0x0421d37b12e338abULL, 	0xab24f910416de7a2ULL,
+		0x18db66461c14b02aULL, 	0xb7de4c2d4f9a6f23ULL,
+		0x4e3e6df534d20badULL, 	0xe13b479e675cd4a4ULL,
+		0x52c4d8c83a25832cULL, 	0xfdc1f2a369ab5c25ULL,
+		0x77cb078f293d1aafULL, 	0xd8ce2de47ab3c5a6ULL,
+		0x6b31b2b227ca922eULL, 	0xc43498d974444d27ULL,
+		0xda0110e978b06da1ULL, 	0x75043a822b3eb2a8ULL,
+		0xc6fba5d47647e520ULL, 	0x69fe8fbf25c93a29ULL,
+		0xe3f47a93655f7ca3ULL, 	0x4cf150f836d1a3aaULL,
+		0xff0ecfae6ba8f422ULL, 	0x500be5c538262b2bULL,
+		0xa9ebc41d436e4fa5ULL, 	0x06eeee7610e090acULL,
+		0xb51171204d99c724ULL, 	0x1a145b4b1e17182dULL,
+		0x901eae675e815ea7ULL, 	0x3f1b840c0d0f81aeULL,
+		0x8ce41b5a5076d626ULL, 	0x23e1313103f8092fULL,
+		0xe8c88ea76d51dcbfULL, 	0x47cda4cc3edf03b6ULL,
+		0xf4323b9a63a6543eULL, 	0x5b3711f130288b37ULL,
+		0xd13de4dd70becdbdULL, 	0x7e38ceb6233012b4ULL,
+		0xcdc751e07e49453cULL, 	0x62c27b8b2dc79a35ULL,
+		0x9b225a53568ffebbULL, 	0x34277038050121b2ULL,
+		0x87d8ef6e5878763aULL, 	0x28ddc5050bf6a933ULL,
+		0xa2d730294b60efb9ULL, 	0x0dd21a4218ee30b0ULL,
+		0xbe2d851445976738ULL, 	0x1128af7f1619b831ULL,
+		0x0f1d274f1aed98b7ULL, 	0xa0180d24496347beULL,
+		0x13e79272141a1036ULL, 	0xbce2b8194794cf3fULL,
+		0x36e84d35070289b5ULL, 	0x99ed675e548c56bcULL,
+		0x2a12f80809f50134ULL, 	0x8517d2635a7bde3dULL,
+		0x7cf7f3bb2133bab3ULL, 	0xd3f2d9d072bd65baULL,
+		0x600d46862fc43232ULL, 	0xcf086ced7c4aed3bULL,
+		0x450299c13cdcabb1ULL, 	0xea07b3aa6f5274b8ULL,
+		0x59f82cfc322b2330ULL, 	0xf6fd069761a5fc39ULL,
+		0x65933c9c2bc3623cULL, 	0xca9616f7784dbd35ULL,
+		0x796989a12534eabdULL, 	0xd66ca3ca76ba35b4ULL,
+		0x5c6656e6362c733eULL, 	0xf3637c8d65a2ac37ULL,
+		0x409ce3db38dbfbbfULL, 	0xef99c9b06b5524b6ULL,
+		0x1679e868101d4038ULL, 	0xb97cc20343939f31ULL,
+		0x0a835d551eeac8b9ULL, 	0xa586773e4d6417b0ULL,
+		0x2f8c82120df2513aULL, 	0x8089a8795e7c8e33ULL,
+		0x3376372f0305d9bbULL, 	0x9c731d44508b06b2ULL,
+		0x824695745c7f2634ULL, 	0x2d43bf1f0ff1f93dULL,
+		0x9ebc20495288aeb5ULL, 	0x31b90a22010671bcULL,
+		0xbbb3ff0e41903736ULL, 	0x14b6d565121ee83fULL,
+		0xa7494a334f67bfb7ULL, 	0x084c60581ce960beULL,
+		0xf1ac418067a10430ULL, 	0x5ea96beb342fdb39ULL,
+		0xed56f4bd69568cb1ULL, 	0x4253ded63ad853b8ULL,
+		0xc8592bfa7a4e1532ULL, 	0x675c019129c0ca3bULL,
+		0xd4a39ec774b99db3ULL, 	0x7ba6b4ac273742baULL,
+	},
+	{
+		0x0000000000000000ULL, 	0x23eef79f3ad718c7ULL,
+		0x47ddef3e75ae318eULL, 	0x643318a14f792949ULL,
+		0x8fbbde7ceb5c631cULL, 	0xac5529e3d18b7bdbULL,
+		0xc86631429ef25292ULL, 	0xeb88c6dda4254a55ULL,
+		0x5d875d127f52f0abULL, 	0x7e69aa8d4585e86cULL,
+		0x1a5ab22c0afcc125ULL, 	0x39b445b3302bd9e2ULL,
+		0xd23c836e940e93b7ULL, 	0xf1d274f1aed98b70ULL,
+		0x95e16c50e1a0a239ULL, 	0xb60f9bcfdb77bafeULL,
+		0xbb0eba24fea5e156ULL, 	0x98e04dbbc472f991ULL,
+		0xfcd3551a8b0bd0d8ULL, 	0xdf3da285b1dcc81fULL,
+		0x34b5645815f9824aULL, 	0x175b93c72f2e9a8dULL,
+		0x73688b666057b3c4ULL, 	0x50867cf95a80ab03ULL,
+		0xe689e73681f711fdULL, 	0xc56710a9bb20093aULL,
+		0xa1540808f4592073ULL, 	0x82baff97ce8e38b4ULL,
+		0x6932394a6aab72e1ULL, 	0x4adcced5507c6a26ULL,
+		0x2eefd6741f05436fULL, 	0x0d0121eb25d25ba8ULL,
+		0x34ed95a254a1f43fULL, 	0x1703623d6e76ecf8ULL,
+		0x73307a9c210fc5b1ULL, 	0x50de8d031bd8dd76ULL,
+		0xbb564bdebffd9723ULL, 	0x98b8bc41852a8fe4ULL,
+		0xfc8ba4e0ca53a6adULL, 	0xdf65537ff084be6aULL,
+		0x696ac8b02bf30494ULL, 	0x4a843f2f11241c53ULL,
+		0x2eb7278e5e5d351aULL, 	0x0d59d011648a2dddULL,
+		0xe6d116ccc0af6788ULL, 	0xc53fe153fa787f4fULL,
+		0xa10cf9f2b5015606ULL, 	0x82e20e6d8fd64ec1ULL,
+		0x8fe32f86aa041569ULL, 	0xac0dd81990d30daeULL,
+		0xc83ec0b8dfaa24e7ULL, 	0xebd03727e57d3c20ULL,
+		0x0058f1fa41587675ULL, 	0x23b606657b8f6eb2ULL,
+		0x47851ec434f647fbULL, 	0x646be95b0e215f3cULL,
+		0xd2647294d556e5c2ULL, 	0xf18a850bef81fd05ULL,
+		0x95b99daaa0f8d44cULL, 	0xb6576a359a2fcc8bULL,
+		0x5ddface83e0a86deULL, 	0x7e315b7704dd9e19ULL,
+		0x1a0243d64ba4b750ULL, 	0x39ecb4497173af97ULL,
+		0x69db2b44a943e87eULL, 	0x4a35dcdb9394f0b9ULL,
+		0x2e06c47adcedd9f0ULL, 	0x0de833e5e63ac137ULL,
+		0xe660f538421f8b62ULL, 	0xc58e02a778c893a5ULL,
+		0xa1bd1a0637b1baecULL, 	0x8253ed990d66a22bULL,
+		0x345c7656d61118d5ULL, 	0x17b281c9ecc60012ULL,
+		0x73819968a3bf295bULL, 	0x506f6ef79968319cULL,
+		0xbbe7a82a3d4d7bc9ULL, 	0x98095fb5079a630eULL,
+		0xfc3a471448e34a47ULL, 	0xdfd4b08b72345280ULL,
+		0xd2d5916057e60928ULL, 	0xf13b66ff6d3111efULL,
+		0x95087e5e224838a6ULL, 	0xb6e689c1189f2061ULL,
+		0x5d6e4f1cbcba6a34ULL, 	0x7e80b883866d72f3ULL,
+		0x1ab3a022c9145bbaULL, 	0x395d57bdf3c3437dULL,
+		0x8f52cc7228b4f983ULL, 	0xacbc3bed1263e144ULL,
+		0xc88f234c5d1ac80dULL, 	0xeb61d4d367cdd0caULL,
+		0x00e9120ec3e89a9fULL, 	0x2307e591f93f8258ULL,
+		0x4734fd30b646ab11ULL, 	0x64da0aaf8c91b3d6ULL,
+		0x5d36bee6fde21c41ULL, 	0x7ed84979c7350486ULL,
+		0x1aeb51d8884c2dcfULL, 	0x3905a647b29b3508ULL,
+		0xd28d609a16be7f5dULL, 	0xf16397052c69679aULL,
+		0x95508fa463104ed3ULL, 	0xb6be783b59c75614ULL,
+		0x00b1e3f482b0eceaULL, 	0x235f146bb867f42dULL,
+		0x476c0ccaf71edd64ULL, 	0x6482fb55cdc9c5a3ULL,
+		0x8f0a3d8869ec8ff6ULL, 	0xace4ca17533b9731ULL,
+		0xc8d7d2b61c42be78ULL, 	0xeb3925292695a6bfULL,
+		0xe63804c20347fd17ULL, 	0xc5d6f35d3990e5d0ULL,
+		0xa1e5ebfc76e9cc99ULL, 	0x820b1c634c3ed45eULL,
+		0x6983dabee81b9e0bULL, 	0x4a6d2d21d2cc86ccULL,
+		0x2e5e35809db5af85ULL, 	0x0db0c21fa762b742ULL,
+		0xbbbf59d07c150dbcULL, 	0x9851ae4f46c2157bULL,
+		0xfc62b6ee09bb3c32ULL, 	0xdf8c4171336c24f5ULL,
+		0x340487ac97496ea0ULL, 	0x17ea7033ad9e7667ULL,
+		0x73d96892e2e75f2eULL, 	0x50379f0dd83047e9ULL,
+		0xd3b656895287d0fcULL, 	0xf058a1166850c83bULL,
+		0x946bb9b72729e172ULL, 	0xb7854e281dfef9b5ULL,
+		0x5c0d88f5b9dbb3e0ULL, 	0x7fe37f6a830cab27ULL,
+		0x1bd067cbcc75826eULL, 	0x383e9054f6a29aa9ULL,
+		0x8e310b9b2dd52057ULL, 	0xaddffc0417023890ULL,
+		0xc9ece4a5587b11d9ULL, 	0xea02133a62ac091eULL,
+		0x018ad5e7c689434bULL, 	0x22642278fc5e5b8cULL,
+		0x46573ad9b32772c5ULL, 	0x65b9cd4689f06a02ULL,
+		0x68b8ecadac2231aaULL, 	0x4b561b3296f5296dULL,
+		0x2f650393d98c0024ULL, 	0x0c8bf40ce35b18e3ULL,
+		0xe70332d1477e52b6ULL, 	0xc4edc54e7da94a71ULL,
+		0xa0deddef32d06338ULL, 	0x83302a7008077bffULL,
+		0x353fb1bfd370c101ULL, 	0x16d14620e9a7d9c6ULL,
+		0x72e25e81a6def08fULL, 	0x510ca91e9c09e848ULL,
+		0xba846fc3382ca21dULL, 	0x996a985c02fbbadaULL,
+		0xfd5980fd4d829393ULL, 	0xdeb7776277558b54ULL,
+		0xe75bc32b062624c3ULL, 	0xc4b534b43cf13c04ULL,
+		0xa0862c157388154dULL, 	0x8368db8a495f0d8aULL,
+		0x68e01d57ed7a47dfULL, 	0x4b0eeac8d7ad5f18ULL,
+		0x2f3df26998d47651ULL, 	0x0cd305f6a2036e96ULL,
+		0xbadc9e397974d468ULL, 	0x993269a643a3ccafULL,
+		0xfd0171070cdae5e6ULL, 	0xdeef8698360dfd21ULL,
+		0x356740459228b774ULL, 	0x1689b7daa8ffafb3ULL,
+		0x72baaf7be78686faULL, 	0x515458e4dd519e3dULL,
+		0x5c55790ff883c595ULL, 	0x7fbb8e90c254dd52ULL,
+		0x1b8896318d2df41bULL, 	0x386661aeb7faecdcULL,
+		0xd3eea77313dfa689ULL, 	0xf00050ec2908be4eULL,
+		0x9433484d66719707ULL, 	0xb7ddbfd25ca68fc0ULL,
+		0x01d2241d87d1353eULL, 	0x223cd382bd062df9ULL,
+		0x460fcb23f27f04b0ULL, 	0x65e13cbcc8a81c77ULL,
+		0x8e69fa616c8d5622ULL, 	0xad870dfe565a4ee5ULL,
+		0xc9b4155f192367acULL, 	0xea5ae2c023f47f6bULL,
+		0xba6d7dcdfbc43882ULL, 	0x99838a52c1132045ULL,
+		0xfdb092f38e6a090cULL, 	0xde5e656cb4bd11cbULL,
+		0x35d6a3b110985b9eULL, 	0x1638542e2a4f4359ULL,
+		0x720b4c8f65366a10ULL, 	0x51e5bb105fe172d7ULL,
+		0xe7ea20df8496c829ULL, 	0xc404d740be41d0eeULL,
+		0xa037cfe1f138f9a7ULL, 	0x83d9387ecbefe160ULL,
+		0x6851fea36fcaab35ULL, 	0x4bbf093c551db3f2ULL,
+		0x2f8c119d1a649abbULL, 	0x0c62e60220b3827cULL,
+		0x0163c7e90561d9d4ULL, 	0x228d30763fb6c113ULL,
+		0x46be28d770cfe85aULL, 	0x6550df484a18f09dULL,
+		0x8ed81995ee3dbac8ULL, 	0xad36ee0ad4eaa20fULL,
+		0xc905f6ab9b938b46ULL, 	0xeaeb0134a1449381ULL,
+		0x5ce49afb7a33297fULL, 	0x7f0a6d6440e431b8ULL,
+		0x1b3975c50f9d18f1ULL, 	0x38d7825a354a0036ULL,
+		0xd35f4487916f4a63ULL, 	0xf0b1b318abb852a4ULL,
+		0x9482abb9e4c17bedULL, 	0xb76c5c26de16632aULL,
+		0x8e80e86faf65ccbdULL, 	0xad6e1ff095b2d47aULL,
+		0xc95d0751dacbfd33ULL, 	0xeab3f0cee01ce5f4ULL,
+		0x013b36134439afa1ULL, 	0x22d5c18c7eeeb766ULL,
+		0x46e6d92d31979e2fULL, 	0x65082eb20b4086e8ULL,
+		0xd307b57dd0373c16ULL, 	0xf0e942e2eae024d1ULL,
+		0x94da5a43a5990d98ULL, 	0xb734addc9f4e155fULL,
+		0x5cbc6b013b6b5f0aULL, 	0x7f529c9e01bc47cdULL,
+		0x1b61843f4ec56e84ULL, 	0x388f73a074127643ULL,
+		0x358e524b51c02debULL, 	0x1660a5d46b17352cULL,
+		0x7253bd75246e1c65ULL, 	0x51bd4aea1eb904a2ULL,
+		0xba358c37ba9c4ef7ULL, 	0x99db7ba8804b5630ULL,
+		0xfde86309cf327f79ULL, 	0xde069496f5e567beULL,
+		0x68090f592e92dd40ULL, 	0x4be7f8c61445c587ULL,
+		0x2fd4e0675b3cecceULL, 	0x0c3a17f861ebf409ULL,
+		0xe7b2d125c5cebe5cULL, 	0xc45c26baff19a69bULL,
+		0xa06f3e1bb0608fd2ULL, 	0x8381c9848ab79715ULL,
+	},
+	{
+		0x0000000000000000ULL, 	0xe59c4cf90ce5976bULL,
+		0x89c87819b0211845ULL, 	0x6c5434e0bcc48f2eULL,
+		0x516011d8c9a80619ULL, 	0xb4fc5d21c54d9172ULL,
+		0xd8a869c179891e5cULL, 	0x3d342538756c8937ULL,
+		0xa2c023b193500c32ULL, 	0x475c6f489fb59b59ULL,
+		0x2b085ba823711477ULL, 	0xce9417512f94831cULL,
+		0xf3a032695af80a2bULL, 	0x163c7e90561d9d40ULL,
+		0x7a684a70ead9126eULL, 	0x9ff40689e63c8505ULL,
+		0x0770a6888f4a2ef7ULL, 	0xe2ecea7183afb99cULL,
+		0x8eb8de913f6b36b2ULL, 	0x6b249268338ea1d9ULL,
+		0x5610b75046e228eeULL, 	0xb38cfba94a07bf85ULL,
+		0xdfd8cf49f6c330abULL, 	0x3a4483b0fa26a7c0ULL,
+		0xa5b085391c1a22c5ULL, 	0x402cc9c010ffb5aeULL,
+		0x2c78fd20ac3b3a80ULL, 	0xc9e4b1d9a0deadebULL,
+		0xf4d094e1d5b224dcULL, 	0x114cd818d957b3b7ULL,
+		0x7d18ecf865933c99ULL, 	0x9884a0016976abf2ULL,
+		0x0ee14d111e945deeULL, 	0xeb7d01e81271ca85ULL,
+		0x87293508aeb545abULL, 	0x62b579f1a250d2c0ULL,
+		0x5f815cc9d73c5bf7ULL, 	0xba1d1030dbd9cc9cULL,
+		0xd64924d0671d43b2ULL, 	0x33d568296bf8d4d9ULL,
+		0xac216ea08dc451dcULL, 	0x49bd22598121c6b7ULL,
+		0x25e916b93de54999ULL, 	0xc0755a403100def2ULL,
+		0xfd417f78446c57c5ULL, 	0x18dd33814889c0aeULL,
+		0x74890761f44d4f80ULL, 	0x91154b98f8a8d8ebULL,
+		0x0991eb9991de7319ULL, 	0xec0da7609d3be472ULL,
+		0x8059938021ff6b5cULL, 	0x65c5df792d1afc37ULL,
+		0x58f1fa4158767500ULL, 	0xbd6db6b85493e26bULL,
+		0xd1398258e8576d45ULL, 	0x34a5cea1e4b2fa2eULL,
+		0xab51c828028e7f2bULL, 	0x4ecd84d10e6be840ULL,
+		0x2299b031b2af676eULL, 	0xc705fcc8be4af005ULL,
+		0xfa31d9f0cb267932ULL, 	0x1fad9509c7c3ee59ULL,
+		0x73f9a1e97b076177ULL, 	0x9665ed1077e2f61cULL,
+		0x1dc29a223d28bbdcULL, 	0xf85ed6db31cd2cb7ULL,
+		0x940ae23b8d09a399ULL, 	0x7196aec281ec34f2ULL,
+		0x4ca28bfaf480bdc5ULL, 	0xa93ec703f8652aaeULL,
+		0xc56af3e344a1a580ULL, 	0x20f6bf1a484432ebULL,
+		0xbf02b993ae78b7eeULL, 	0x5a9ef56aa29d2085ULL,
+		0x36cac18a1e59afabULL, 	0xd3568d7312bc38c0ULL,
+		0xee62a84b67d0b1f7ULL, 	0x0bfee4b26b35269cULL,
+		0x67aad052d7f1a9b2ULL, 	0x82369cabdb143ed9ULL,
+		0x1ab23caab262952bULL, 	0xff2e7053be870240ULL,
+		0x937a44b302438d6eULL, 	0x76e6084a0ea61a05ULL,
+		0x4bd22d727bca9332ULL, 	0xae4e618b772f0459ULL,
+		0xc21a556bcbeb8b77ULL, 	0x27861992c70e1c1cULL,
+		0xb8721f1b21329919ULL, 	0x5dee53e22dd70e72ULL,
+		0x31ba67029113815cULL, 	0xd4262bfb9df61637ULL,
+		0xe9120ec3e89a9f00ULL, 	0x0c8e423ae47f086bULL,
+		0x60da76da58bb8745ULL, 	0x85463a23545e102eULL,
+		0x1323d73323bce632ULL, 	0xf6bf9bca2f597159ULL,
+		0x9aebaf2a939dfe77ULL, 	0x7f77e3d39f78691cULL,
+		0x4243c6ebea14e02bULL, 	0xa7df8a12e6f17740ULL,
+		0xcb8bbef25a35f86eULL, 	0x2e17f20b56d06f05ULL,
+		0xb1e3f482b0ecea00ULL, 	0x547fb87bbc097d6bULL,
+		0x382b8c9b00cdf245ULL, 	0xddb7c0620c28652eULL,
+		0xe083e55a7944ec19ULL, 	0x051fa9a375a17b72ULL,
+		0x694b9d43c965f45cULL, 	0x8cd7d1bac5806337ULL,
+		0x145371bbacf6c8c5ULL, 	0xf1cf3d42a0135faeULL,
+		0x9d9b09a21cd7d080ULL, 	0x7807455b103247ebULL,
+		0x45336063655ecedcULL, 	0xa0af2c9a69bb59b7ULL,
+		0xccfb187ad57fd699ULL, 	0x29675483d99a41f2ULL,
+		0xb693520a3fa6c4f7ULL, 	0x530f1ef33343539cULL,
+		0x3f5b2a138f87dcb2ULL, 	0xdac766ea83624bd9ULL,
+		0xe7f343d2f60ec2eeULL, 	0x026f0f2bfaeb5585ULL,
+		0x6e3b3bcb462fdaabULL, 	0x8ba777324aca4dc0ULL,
+		0x3b8534447a5177b8ULL, 	0xde1978bd76b4e0d3ULL,
+		0xb24d4c5dca706ffdULL, 	0x57d100a4c695f896ULL,
+		0x6ae5259cb3f971a1ULL, 	0x8f796965bf1ce6caULL,
+		0xe32d5d8503d869e4ULL, 	0x06b1117c0f3dfe8fULL,
+		0x994517f5e9017b8aULL, 	0x7cd95b0ce5e4ece1ULL,
+		0x108d6fec592063cfULL, 	0xf511231555c5f4a4ULL,
+		0xc825062d20a97d93ULL, 	0x2db94ad42c4ceaf8ULL,
+		0x41ed7e34908865d6ULL, 	0xa47132cd9c6df2bdULL,
+		0x3cf592ccf51b594fULL, 	0xd969de35f9fece24ULL,
+		0xb53dead5453a410aULL, 	0x50a1a62c49dfd661ULL,
+		0x6d9583143cb35f56ULL, 	0x8809cfed3056c83dULL,
+		0xe45dfb0d8c924713ULL, 	0x01c1b7f48077d078ULL,
+		0x9e35b17d664b557dULL, 	0x7ba9fd846aaec216ULL,
+		0x17fdc964d66a4d38ULL, 	0xf261859dda8fda53ULL,
+		0xcf55a0a5afe35364ULL, 	0x2ac9ec5ca306c40fULL,
+		0x469dd8bc1fc24b21ULL, 	0xa30194451327dc4aULL,
+		0x3564795564c52a56ULL, 	0xd0f835ac6820bd3dULL,
+		0xbcac014cd4e43213ULL, 	0x59304db5d801a578ULL,
+		0x6404688dad6d2c4fULL, 	0x81982474a188bb24ULL,
+		0xedcc10941d4c340aULL, 	0x08505c6d11a9a361ULL,
+		0x97a45ae4f7952664ULL, 	0x7238161dfb70b10fULL,
+		0x1e6c22fd47b43e21ULL, 	0xfbf06e044b51a94aULL,
+		0xc6c44b3c3e3d207dULL, 	0x235807c532d8b716ULL,
+		0x4f0c33258e1c3838ULL, 	0xaa907fdc82f9af53ULL,
+		0x3214dfddeb8f04a1ULL, 	0xd7889324e76a93caULL,
+		0xbbdca7c45bae1ce4ULL, 	0x5e40eb3d574b8b8fULL,
+		0x6374ce05222702b8ULL, 	0x86e882fc2ec295d3ULL,
+		0xeabcb61c92061afdULL, 	0x0f20fae59ee38d96ULL,
+		0x90d4fc6c78df0893ULL, 	0x7548b095743a9ff8ULL,
+		0x191c8475c8fe10d6ULL, 	0xfc80c88cc41b87bdULL,
+		0xc1b4edb4b1770e8aULL, 	0x2428a14dbd9299e1ULL,
+		0x487c95ad015616cfULL, 	0xade0d9540db381a4ULL,
+		0x2647ae664779cc64ULL, 	0xc3dbe29f4b9c5b0fULL,
+		0xaf8fd67ff758d421ULL, 	0x4a139a86fbbd434aULL,
+		0x7727bfbe8ed1ca7dULL, 	0x92bbf34782345d16ULL,
+		0xfeefc7a73ef0d238ULL, 	0x1b738b5e32154553ULL,
+		0x84878dd7d429c056ULL, 	0x611bc12ed8cc573dULL,
+		0x0d4ff5ce6408d813ULL, 	0xe8d3b93768ed4f78ULL,
+		0xd5e79c0f1d81c64fULL, 	0x307bd0f611645124ULL,
+		0x5c2fe416ada0de0aULL, 	0xb9b3a8efa1454961ULL,
+		0x213708eec833e293ULL, 	0xc4ab4417c4d675f8ULL,
+		0xa8ff70f77812fad6ULL, 	0x4d633c0e74f76dbdULL,
+		0x70571936019be48aULL, 	0x95cb55cf0d7e73e1ULL,
+		0xf99f612fb1bafccfULL, 	0x1c032dd6bd5f6ba4ULL,
+		0x83f72b5f5b63eea1ULL, 	0x666b67a6578679caULL,
+		0x0a3f5346eb42f6e4ULL, 	0xefa31fbfe7a7618fULL,
+		0xd2973a8792cbe8b8ULL, 	0x370b767e9e2e7fd3ULL,
+		0x5b5f429e22eaf0fdULL, 	0xbec30e672e0f6796ULL,
+		0x28a6e37759ed918aULL, 	0xcd3aaf8e550806e1ULL,
+		0xa16e9b6ee9cc89cfULL, 	0x44f2d797e5291ea4ULL,
+		0x79c6f2af90459793ULL, 	0x9c5abe569ca000f8ULL,
+		0xf00e8ab620648fd6ULL, 	0x1592c64f2c8118bdULL,
+		0x8a66c0c6cabd9db8ULL, 	0x6ffa8c3fc6580ad3ULL,
+		0x03aeb8df7a9c85fdULL, 	0xe632f42676791296ULL,
+		0xdb06d11e03159ba1ULL, 	0x3e9a9de70ff00ccaULL,
+		0x52cea907b33483e4ULL, 	0xb752e5febfd1148fULL,
+		0x2fd645ffd6a7bf7dULL, 	0xca4a0906da422816ULL,
+		0xa61e3de66686a738ULL, 	0x4382711f6a633053ULL,
+		0x7eb654271f0fb964ULL, 	0x9b2a18de13ea2e0fULL,
+		0xf77e2c3eaf2ea121ULL, 	0x12e260c7a3cb364aULL,
+		0x8d16664e45f7b34fULL, 	0x688a2ab749122424ULL,
+		0x04de1e57f5d6ab0aULL, 	0xe14252aef9333c61ULL,
+		0xdc7677968c5fb556ULL, 	0x39ea3b6f80ba223dULL,
+		0x55be0f8f3c7ead13ULL, 	0xb0224376309b3a78ULL,
+	},
+	{
+		0x0000000000000000ULL, 	0x770a6888f4a2ef70ULL,
+		0xee14d111e945dee0ULL, 	0x991eb9991de73190ULL,
+		0x9ed943c87b618b53ULL, 	0xe9d32b408fc36423ULL,
+		0x70cd92d9922455b3ULL, 	0x07c7fa516686bac3ULL,
+		0x7f42667b5f292035ULL, 	0x08480ef3ab8bcf45ULL,
+		0x9156b76ab66cfed5ULL, 	0xe65cdfe242ce11a5ULL,
+		0xe19b25b32448ab66ULL, 	0x96914d3bd0ea4416ULL,
+		0x0f8ff4a2cd0d7586ULL, 	0x78859c2a39af9af6ULL,
+		0xfe84ccf6be52406aULL, 	0x898ea47e4af0af1aULL,
+		0x10901de757179e8aULL, 	0x679a756fa3b571faULL,
+		0x605d8f3ec533cb39ULL, 	0x1757e7b631912449ULL,
+		0x8e495e2f2c7615d9ULL, 	0xf94336a7d8d4faa9ULL,
+		0x81c6aa8de17b605fULL, 	0xf6ccc20515d98f2fULL,
+		0x6fd27b9c083ebebfULL, 	0x18d81314fc9c51cfULL,
+		0x1f1fe9459a1aeb0cULL, 	0x681581cd6eb8047cULL,
+		0xf10b3854735f35ecULL, 	0x860150dc87fdda9cULL,
+		0xbff97806d54eb647ULL, 	0xc8f3108e21ec5937ULL,
+		0x51eda9173c0b68a7ULL, 	0x26e7c19fc8a987d7ULL,
+		0x21203bceae2f3d14ULL, 	0x562a53465a8dd264ULL,
+		0xcf34eadf476ae3f4ULL, 	0xb83e8257b3c80c84ULL,
+		0xc0bb1e7d8a679672ULL, 	0xb7b176f57ec57902ULL,
+		0x2eafcf6c63224892ULL, 	0x59a5a7e49780a7e2ULL,
+		0x5e625db5f1061d21ULL, 	0x2968353d05a4f251ULL,
+		0xb0768ca41843c3c1ULL, 	0xc77ce42cece12cb1ULL,
+		0x417db4f06b1cf62dULL, 	0x3677dc789fbe195dULL,
+		0xaf6965e1825928cdULL, 	0xd8630d6976fbc7bdULL,
+		0xdfa4f738107d7d7eULL, 	0xa8ae9fb0e4df920eULL,
+		0x31b02629f938a39eULL, 	0x46ba4ea10d9a4ceeULL,
+		0x3e3fd28b3435d618ULL, 	0x4935ba03c0973968ULL,
+		0xd02b039add7008f8ULL, 	0xa7216b1229d2e788ULL,
+		0xa0e691434f545d4bULL, 	0xd7ecf9cbbbf6b23bULL,
+		0x4ef24052a61183abULL, 	0x39f828da52b36cdbULL,
+		0x3d0211e603775a1dULL, 	0x4a08796ef7d5b56dULL,
+		0xd316c0f7ea3284fdULL, 	0xa41ca87f1e906b8dULL,
+		0xa3db522e7816d14eULL, 	0xd4d13aa68cb43e3eULL,
+		0x4dcf833f91530faeULL, 	0x3ac5ebb765f1e0deULL,
+		0x4240779d5c5e7a28ULL, 	0x354a1f15a8fc9558ULL,
+		0xac54a68cb51ba4c8ULL, 	0xdb5ece0441b94bb8ULL,
+		0xdc993455273ff17bULL, 	0xab935cddd39d1e0bULL,
+		0x328de544ce7a2f9bULL, 	0x45878dcc3ad8c0ebULL,
+		0xc386dd10bd251a77ULL, 	0xb48cb5984987f507ULL,
+		0x2d920c015460c497ULL, 	0x5a986489a0c22be7ULL,
+		0x5d5f9ed8c6449124ULL, 	0x2a55f65032e67e54ULL,
+		0xb34b4fc92f014fc4ULL, 	0xc4412741dba3a0b4ULL,
+		0xbcc4bb6be20c3a42ULL, 	0xcbced3e316aed532ULL,
+		0x52d06a7a0b49e4a2ULL, 	0x25da02f2ffeb0bd2ULL,
+		0x221df8a3996db111ULL, 	0x5517902b6dcf5e61ULL,
+		0xcc0929b270286ff1ULL, 	0xbb03413a848a8081ULL,
+		0x82fb69e0d639ec5aULL, 	0xf5f10168229b032aULL,
+		0x6cefb8f13f7c32baULL, 	0x1be5d079cbdeddcaULL,
+		0x1c222a28ad586709ULL, 	0x6b2842a059fa8879ULL,
+		0xf236fb39441db9e9ULL, 	0x853c93b1b0bf5699ULL,
+		0xfdb90f9b8910cc6fULL, 	0x8ab367137db2231fULL,
+		0x13adde8a6055128fULL, 	0x64a7b60294f7fdffULL,
+		0x63604c53f271473cULL, 	0x146a24db06d3a84cULL,
+		0x8d749d421b3499dcULL, 	0xfa7ef5caef9676acULL,
+		0x7c7fa516686bac30ULL, 	0x0b75cd9e9cc94340ULL,
+		0x926b7407812e72d0ULL, 	0xe5611c8f758c9da0ULL,
+		0xe2a6e6de130a2763ULL, 	0x95ac8e56e7a8c813ULL,
+		0x0cb237cffa4ff983ULL, 	0x7bb85f470eed16f3ULL,
+		0x033dc36d37428c05ULL, 	0x7437abe5c3e06375ULL,
+		0xed29127cde0752e5ULL, 	0x9a237af42aa5bd95ULL,
+		0x9de480a54c230756ULL, 	0xeaeee82db881e826ULL,
+		0x73f051b4a566d9b6ULL, 	0x04fa393c51c436c6ULL,
+		0x7a0423cc06eeb43aULL, 	0x0d0e4b44f24c5b4aULL,
+		0x9410f2ddefab6adaULL, 	0xe31a9a551b0985aaULL,
+		0xe4dd60047d8f3f69ULL, 	0x93d7088c892dd019ULL,
+		0x0ac9b11594cae189ULL, 	0x7dc3d99d60680ef9ULL,
+		0x054645b759c7940fULL, 	0x724c2d3fad657b7fULL,
+		0xeb5294a6b0824aefULL, 	0x9c58fc2e4420a59fULL,
+		0x9b9f067f22a61f5cULL, 	0xec956ef7d604f02cULL,
+		0x758bd76ecbe3c1bcULL, 	0x0281bfe63f412eccULL,
+		0x8480ef3ab8bcf450ULL, 	0xf38a87b24c1e1b20ULL,
+		0x6a943e2b51f92ab0ULL, 	0x1d9e56a3a55bc5c0ULL,
+		0x1a59acf2c3dd7f03ULL, 	0x6d53c47a377f9073ULL,
+		0xf44d7de32a98a1e3ULL, 	0x8347156bde3a4e93ULL,
+		0xfbc28941e795d465ULL, 	0x8cc8e1c913373b15ULL,
+		0x15d658500ed00a85ULL, 	0x62dc30d8fa72e5f5ULL,
+		0x651bca899cf45f36ULL, 	0x1211a2016856b046ULL,
+		0x8b0f1b9875b181d6ULL, 	0xfc05731081136ea6ULL,
+		0xc5fd5bcad3a0027dULL, 	0xb2f733422702ed0dULL,
+		0x2be98adb3ae5dc9dULL, 	0x5ce3e253ce4733edULL,
+		0x5b241802a8c1892eULL, 	0x2c2e708a5c63665eULL,
+		0xb530c913418457ceULL, 	0xc23aa19bb526b8beULL,
+		0xbabf3db18c892248ULL, 	0xcdb55539782bcd38ULL,
+		0x54abeca065ccfca8ULL, 	0x23a18428916e13d8ULL,
+		0x24667e79f7e8a91bULL, 	0x536c16f1034a466bULL,
+		0xca72af681ead77fbULL, 	0xbd78c7e0ea0f988bULL,
+		0x3b79973c6df24217ULL, 	0x4c73ffb49950ad67ULL,
+		0xd56d462d84b79cf7ULL, 	0xa2672ea570157387ULL,
+		0xa5a0d4f41693c944ULL, 	0xd2aabc7ce2312634ULL,
+		0x4bb405e5ffd617a4ULL, 	0x3cbe6d6d0b74f8d4ULL,
+		0x443bf14732db6222ULL, 	0x333199cfc6798d52ULL,
+		0xaa2f2056db9ebcc2ULL, 	0xdd2548de2f3c53b2ULL,
+		0xdae2b28f49bae971ULL, 	0xade8da07bd180601ULL,
+		0x34f6639ea0ff3791ULL, 	0x43fc0b16545dd8e1ULL,
+		0x4706322a0599ee27ULL, 	0x300c5aa2f13b0157ULL,
+		0xa912e33becdc30c7ULL, 	0xde188bb3187edfb7ULL,
+		0xd9df71e27ef86574ULL, 	0xaed5196a8a5a8a04ULL,
+		0x37cba0f397bdbb94ULL, 	0x40c1c87b631f54e4ULL,
+		0x384454515ab0ce12ULL, 	0x4f4e3cd9ae122162ULL,
+		0xd6508540b3f510f2ULL, 	0xa15aedc84757ff82ULL,
+		0xa69d179921d14541ULL, 	0xd1977f11d573aa31ULL,
+		0x4889c688c8949ba1ULL, 	0x3f83ae003c3674d1ULL,
+		0xb982fedcbbcbae4dULL, 	0xce8896544f69413dULL,
+		0x57962fcd528e70adULL, 	0x209c4745a62c9fddULL,
+		0x275bbd14c0aa251eULL, 	0x5051d59c3408ca6eULL,
+		0xc94f6c0529effbfeULL, 	0xbe45048ddd4d148eULL,
+		0xc6c098a7e4e28e78ULL, 	0xb1caf02f10406108ULL,
+		0x28d449b60da75098ULL, 	0x5fde213ef905bfe8ULL,
+		0x5819db6f9f83052bULL, 	0x2f13b3e76b21ea5bULL,
+		0xb60d0a7e76c6dbcbULL, 	0xc10762f6826434bbULL,
+		0xf8ff4a2cd0d75860ULL, 	0x8ff522a42475b710ULL,
+		0x16eb9b3d39928680ULL, 	0x61e1f3b5cd3069f0ULL,
+		0x662609e4abb6d333ULL, 	0x112c616c5f143c43ULL,
+		0x8832d8f542f30dd3ULL, 	0xff38b07db651e2a3ULL,
+		0x87bd2c578ffe7855ULL, 	0xf0b744df7b5c9725ULL,
+		0x69a9fd4666bba6b5ULL, 	0x1ea395ce921949c5ULL,
+		0x19646f9ff49ff306ULL, 	0x6e6e0717003d1c76ULL,
+		0xf770be8e1dda2de6ULL, 	0x807ad606e978c296ULL,
+		0x067b86da6e85180aULL, 	0x7171ee529a27f77aULL,
+		0xe86f57cb87c0c6eaULL, 	0x9f653f437362299aULL,
+		0x98a2c51215e49359ULL, 	0xefa8ad9ae1467c29ULL,
+		0x76b61403fca14db9ULL, 	0x01bc7c8b0803a2c9ULL,
+		0x7939e0a131ac383fULL, 	0x0e338829c50ed74fULL,
+		0x972d31b0d8e9e6dfULL, 	0xe02759382c4b09afULL,
+		0xe7e0a3694acdb36cULL, 	0x90eacbe1be6f5c1cULL,
+		0x09f47278a3886d8cULL, 	0x7efe1af0572a82fcULL,
+	},
+	{
+		0x0000000000000000ULL, 	0xf40847980ddd6874ULL,
+		0xaae06edbb250e67bULL, 	0x5ee82943bf8d8e0fULL,
+		0x17303c5ccd4bfa65ULL, 	0xe3387bc4c0969211ULL,
+		0xbdd052877f1b1c1eULL, 	0x49d8151f72c6746aULL,
+		0x2e6078b99a97f4caULL, 	0xda683f21974a9cbeULL,
+		0x8480166228c712b1ULL, 	0x708851fa251a7ac5ULL,
+		0x395044e557dc0eafULL, 	0xcd58037d5a0166dbULL,
+		0x93b02a3ee58ce8d4ULL, 	0x67b86da6e85180a0ULL,
+		0x5cc0f173352fe994ULL, 	0xa8c8b6eb38f281e0ULL,
+		0xf6209fa8877f0fefULL, 	0x0228d8308aa2679bULL,
+		0x4bf0cd2ff86413f1ULL, 	0xbff88ab7f5b97b85ULL,
+		0xe110a3f44a34f58aULL, 	0x1518e46c47e99dfeULL,
+		0x72a089caafb81d5eULL, 	0x86a8ce52a265752aULL,
+		0xd840e7111de8fb25ULL, 	0x2c48a08910359351ULL,
+		0x6590b59662f3e73bULL, 	0x9198f20e6f2e8f4fULL,
+		0xcf70db4dd0a30140ULL, 	0x3b789cd5dd7e6934ULL,
+		0xb981e2e66a5fd328ULL, 	0x4d89a57e6782bb5cULL,
+		0x13618c3dd80f3553ULL, 	0xe769cba5d5d25d27ULL,
+		0xaeb1debaa714294dULL, 	0x5ab99922aac94139ULL,
+		0x0451b0611544cf36ULL, 	0xf059f7f91899a742ULL,
+		0x97e19a5ff0c827e2ULL, 	0x63e9ddc7fd154f96ULL,
+		0x3d01f4844298c199ULL, 	0xc909b31c4f45a9edULL,
+		0x80d1a6033d83dd87ULL, 	0x74d9e19b305eb5f3ULL,
+		0x2a31c8d88fd33bfcULL, 	0xde398f40820e5388ULL,
+		0xe54113955f703abcULL, 	0x1149540d52ad52c8ULL,
+		0x4fa17d4eed20dcc7ULL, 	0xbba93ad6e0fdb4b3ULL,
+		0xf2712fc9923bc0d9ULL, 	0x067968519fe6a8adULL,
+		0x58914112206b26a2ULL, 	0xac99068a2db64ed6ULL,
+		0xcb216b2cc5e7ce76ULL, 	0x3f292cb4c83aa602ULL,
+		0x61c105f777b7280dULL, 	0x95c9426f7a6a4079ULL,
+		0xdc11577008ac3413ULL, 	0x281910e805715c67ULL,
+		0x76f139abbafcd268ULL, 	0x82f97e33b721ba1cULL,
+		0x31f324277d5590c3ULL, 	0xc5fb63bf7088f8b7ULL,
+		0x9b134afccf0576b8ULL, 	0x6f1b0d64c2d81eccULL,
+		0x26c3187bb01e6aa6ULL, 	0xd2cb5fe3bdc302d2ULL,
+		0x8c2376a0024e8cddULL, 	0x782b31380f93e4a9ULL,
+		0x1f935c9ee7c26409ULL, 	0xeb9b1b06ea1f0c7dULL,
+		0xb573324555928272ULL, 	0x417b75dd584fea06ULL,
+		0x08a360c22a899e6cULL, 	0xfcab275a2754f618ULL,
+		0xa2430e1998d97817ULL, 	0x564b498195041063ULL,
+		0x6d33d554487a7957ULL, 	0x993b92cc45a71123ULL,
+		0xc7d3bb8ffa2a9f2cULL, 	0x33dbfc17f7f7f758ULL,
+		0x7a03e90885318332ULL, 	0x8e0bae9088eceb46ULL,
+		0xd0e387d337616549ULL, 	0x24ebc04b3abc0d3dULL,
+		0x4353adedd2ed8d9dULL, 	0xb75bea75df30e5e9ULL,
+		0xe9b3c33660bd6be6ULL, 	0x1dbb84ae6d600392ULL,
+		0x546391b11fa677f8ULL, 	0xa06bd629127b1f8cULL,
+		0xfe83ff6aadf69183ULL, 	0x0a8bb8f2a02bf9f7ULL,
+		0x8872c6c1170a43ebULL, 	0x7c7a81591ad72b9fULL,
+		0x2292a81aa55aa590ULL, 	0xd69aef82a887cde4ULL,
+		0x9f42fa9dda41b98eULL, 	0x6b4abd05d79cd1faULL,
+		0x35a2944668115ff5ULL, 	0xc1aad3de65cc3781ULL,
+		0xa612be788d9db721ULL, 	0x521af9e08040df55ULL,
+		0x0cf2d0a33fcd515aULL, 	0xf8fa973b3210392eULL,
+		0xb122822440d64d44ULL, 	0x452ac5bc4d0b2530ULL,
+		0x1bc2ecfff286ab3fULL, 	0xefcaab67ff5bc34bULL,
+		0xd4b237b22225aa7fULL, 	0x20ba702a2ff8c20bULL,
+		0x7e52596990754c04ULL, 	0x8a5a1ef19da82470ULL,
+		0xc3820beeef6e501aULL, 	0x378a4c76e2b3386eULL,
+		0x696265355d3eb661ULL, 	0x9d6a22ad50e3de15ULL,
+		0xfad24f0bb8b25eb5ULL, 	0x0eda0893b56f36c1ULL,
+		0x503221d00ae2b8ceULL, 	0xa43a6648073fd0baULL,
+		0xede2735775f9a4d0ULL, 	0x19ea34cf7824cca4ULL,
+		0x47021d8cc7a942abULL, 	0xb30a5a14ca742adfULL,
+		0x63e6484efaab2186ULL, 	0x97ee0fd6f77649f2ULL,
+		0xc906269548fbc7fdULL, 	0x3d0e610d4526af89ULL,
+		0x74d6741237e0dbe3ULL, 	0x80de338a3a3db397ULL,
+		0xde361ac985b03d98ULL, 	0x2a3e5d51886d55ecULL,
+		0x4d8630f7603cd54cULL, 	0xb98e776f6de1bd38ULL,
+		0xe7665e2cd26c3337ULL, 	0x136e19b4dfb15b43ULL,
+		0x5ab60cabad772f29ULL, 	0xaebe4b33a0aa475dULL,
+		0xf05662701f27c952ULL, 	0x045e25e812faa126ULL,
+		0x3f26b93dcf84c812ULL, 	0xcb2efea5c259a066ULL,
+		0x95c6d7e67dd42e69ULL, 	0x61ce907e7009461dULL,
+		0x2816856102cf3277ULL, 	0xdc1ec2f90f125a03ULL,
+		0x82f6ebbab09fd40cULL, 	0x76feac22bd42bc78ULL,
+		0x1146c18455133cd8ULL, 	0xe54e861c58ce54acULL,
+		0xbba6af5fe743daa3ULL, 	0x4faee8c7ea9eb2d7ULL,
+		0x0676fdd89858c6bdULL, 	0xf27eba409585aec9ULL,
+		0xac9693032a0820c6ULL, 	0x589ed49b27d548b2ULL,
+		0xda67aaa890f4f2aeULL, 	0x2e6fed309d299adaULL,
+		0x7087c47322a414d5ULL, 	0x848f83eb2f797ca1ULL,
+		0xcd5796f45dbf08cbULL, 	0x395fd16c506260bfULL,
+		0x67b7f82fefefeeb0ULL, 	0x93bfbfb7e23286c4ULL,
+		0xf407d2110a630664ULL, 	0x000f958907be6e10ULL,
+		0x5ee7bccab833e01fULL, 	0xaaeffb52b5ee886bULL,
+		0xe337ee4dc728fc01ULL, 	0x173fa9d5caf59475ULL,
+		0x49d7809675781a7aULL, 	0xbddfc70e78a5720eULL,
+		0x86a75bdba5db1b3aULL, 	0x72af1c43a806734eULL,
+		0x2c473500178bfd41ULL, 	0xd84f72981a569535ULL,
+		0x919767876890e15fULL, 	0x659f201f654d892bULL,
+		0x3b77095cdac00724ULL, 	0xcf7f4ec4d71d6f50ULL,
+		0xa8c723623f4ceff0ULL, 	0x5ccf64fa32918784ULL,
+		0x02274db98d1c098bULL, 	0xf62f0a2180c161ffULL,
+		0xbff71f3ef2071595ULL, 	0x4bff58a6ffda7de1ULL,
+		0x151771e54057f3eeULL, 	0xe11f367d4d8a9b9aULL,
+		0x52156c6987feb145ULL, 	0xa61d2bf18a23d931ULL,
+		0xf8f502b235ae573eULL, 	0x0cfd452a38733f4aULL,
+		0x452550354ab54b20ULL, 	0xb12d17ad47682354ULL,
+		0xefc53eeef8e5ad5bULL, 	0x1bcd7976f538c52fULL,
+		0x7c7514d01d69458fULL, 	0x887d534810b42dfbULL,
+		0xd6957a0baf39a3f4ULL, 	0x229d3d93a2e4cb80ULL,
+		0x6b45288cd022bfeaULL, 	0x9f4d6f14ddffd79eULL,
+		0xc1a5465762725991ULL, 	0x35ad01cf6faf31e5ULL,
+		0x0ed59d1ab2d158d1ULL, 	0xfaddda82bf0c30a5ULL,
+		0xa435f3c10081beaaULL, 	0x503db4590d5cd6deULL,
+		0x19e5a1467f9aa2b4ULL, 	0xedede6de7247cac0ULL,
+		0xb305cf9dcdca44cfULL, 	0x470d8805c0172cbbULL,
+		0x20b5e5a32846ac1bULL, 	0xd4bda23b259bc46fULL,
+		0x8a558b789a164a60ULL, 	0x7e5dcce097cb2214ULL,
+		0x3785d9ffe50d567eULL, 	0xc38d9e67e8d03e0aULL,
+		0x9d65b724575db005ULL, 	0x696df0bc5a80d871ULL,
+		0xeb948e8feda1626dULL, 	0x1f9cc917e07c0a19ULL,
+		0x4174e0545ff18416ULL, 	0xb57ca7cc522cec62ULL,
+		0xfca4b2d320ea9808ULL, 	0x08acf54b2d37f07cULL,
+		0x5644dc0892ba7e73ULL, 	0xa24c9b909f671607ULL,
+		0xc5f4f636773696a7ULL, 	0x31fcb1ae7aebfed3ULL,
+		0x6f1498edc56670dcULL, 	0x9b1cdf75c8bb18a8ULL,
+		0xd2c4ca6aba7d6cc2ULL, 	0x26cc8df2b7a004b6ULL,
+		0x7824a4b1082d8ab9ULL, 	0x8c2ce32905f0e2cdULL,
+		0xb7547ffcd88e8bf9ULL, 	0x435c3864d553e38dULL,
+		0x1db411276ade6d82ULL, 	0xe9bc56bf670305f6ULL,
+		0xa06443a015c5719cULL, 	0x546c0438181819e8ULL,
+		0x0a842d7ba79597e7ULL, 	0xfe8c6ae3aa48ff93ULL,
+		0x9934074542197f33ULL, 	0x6d3c40dd4fc41747ULL,
+		0x33d4699ef0499948ULL, 	0xc7dc2e06fd94f13cULL,
+		0x8e043b198f528556ULL, 	0x7a0c7c81828fed22ULL,
+		0x24e455c23d02632dULL, 	0xd0ec125a30df0b59ULL,
+	},
+	{
+		0x0000000000000000ULL, 	0xc7cc909df556430cULL,
+		0xcd69c0d04346b08bULL, 	0x0aa5504db610f387ULL,
+		0xd823604b2f675785ULL, 	0x1feff0d6da311489ULL,
+		0x154aa09b6c21e70eULL, 	0xd28630069977a402ULL,
+		0xf2b6217df7249999ULL, 	0x357ab1e00272da95ULL,
+		0x3fdfe1adb4622912ULL, 	0xf813713041346a1eULL,
+		0x2a954136d843ce1cULL, 	0xed59d1ab2d158d10ULL,
+		0xe7fc81e69b057e97ULL, 	0x2030117b6e533d9bULL,
+		0xa79ca31047a305a1ULL, 	0x6050338db2f546adULL,
+		0x6af563c004e5b52aULL, 	0xad39f35df1b3f626ULL,
+		0x7fbfc35b68c45224ULL, 	0xb87353c69d921128ULL,
+		0xb2d6038b2b82e2afULL, 	0x751a9316ded4a1a3ULL,
+		0x552a826db0879c38ULL, 	0x92e612f045d1df34ULL,
+		0x984342bdf3c12cb3ULL, 	0x5f8fd22006976fbfULL,
+		0x8d09e2269fe0cbbdULL, 	0x4ac572bb6ab688b1ULL,
+		0x406022f6dca67b36ULL, 	0x87acb26b29f0383aULL,
+		0x0dc9a7cb26ac3dd1ULL, 	0xca053756d3fa7eddULL,
+		0xc0a0671b65ea8d5aULL, 	0x076cf78690bcce56ULL,
+		0xd5eac78009cb6a54ULL, 	0x1226571dfc9d2958ULL,
+		0x188307504a8ddadfULL, 	0xdf4f97cdbfdb99d3ULL,
+		0xff7f86b6d188a448ULL, 	0x38b3162b24dee744ULL,
+		0x3216466692ce14c3ULL, 	0xf5dad6fb679857cfULL,
+		0x275ce6fdfeeff3cdULL, 	0xe09076600bb9b0c1ULL,
+		0xea35262dbda94346ULL, 	0x2df9b6b048ff004aULL,
+		0xaa5504db610f3870ULL, 	0x6d99944694597b7cULL,
+		0x673cc40b224988fbULL, 	0xa0f05496d71fcbf7ULL,
+		0x727664904e686ff5ULL, 	0xb5baf40dbb3e2cf9ULL,
+		0xbf1fa4400d2edf7eULL, 	0x78d334ddf8789c72ULL,
+		0x58e325a6962ba1e9ULL, 	0x9f2fb53b637de2e5ULL,
+		0x958ae576d56d1162ULL, 	0x524675eb203b526eULL,
+		0x80c045edb94cf66cULL, 	0x470cd5704c1ab560ULL,
+		0x4da9853dfa0a46e7ULL, 	0x8a6515a00f5c05ebULL,
+		0x1b934f964d587ba2ULL, 	0xdc5fdf0bb80e38aeULL,
+		0xd6fa8f460e1ecb29ULL, 	0x11361fdbfb488825ULL,
+		0xc3b02fdd623f2c27ULL, 	0x047cbf4097696f2bULL,
+		0x0ed9ef0d21799cacULL, 	0xc9157f90d42fdfa0ULL,
+		0xe9256eebba7ce23bULL, 	0x2ee9fe764f2aa137ULL,
+		0x244cae3bf93a52b0ULL, 	0xe3803ea60c6c11bcULL,
+		0x31060ea0951bb5beULL, 	0xf6ca9e3d604df6b2ULL,
+		0xfc6fce70d65d0535ULL, 	0x3ba35eed230b4639ULL,
+		0xbc0fec860afb7e03ULL, 	0x7bc37c1bffad3d0fULL,
+		0x71662c5649bdce88ULL, 	0xb6aabccbbceb8d84ULL,
+		0x642c8ccd259c2986ULL, 	0xa3e01c50d0ca6a8aULL,
+		0xa9454c1d66da990dULL, 	0x6e89dc80938cda01ULL,
+		0x4eb9cdfbfddfe79aULL, 	0x89755d660889a496ULL,
+		0x83d00d2bbe995711ULL, 	0x441c9db64bcf141dULL,
+		0x969aadb0d2b8b01fULL, 	0x51563d2d27eef313ULL,
+		0x5bf36d6091fe0094ULL, 	0x9c3ffdfd64a84398ULL,
+		0x165ae85d6bf44673ULL, 	0xd19678c09ea2057fULL,
+		0xdb33288d28b2f6f8ULL, 	0x1cffb810dde4b5f4ULL,
+		0xce798816449311f6ULL, 	0x09b5188bb1c552faULL,
+		0x031048c607d5a17dULL, 	0xc4dcd85bf283e271ULL,
+		0xe4ecc9209cd0dfeaULL, 	0x232059bd69869ce6ULL,
+		0x298509f0df966f61ULL, 	0xee49996d2ac02c6dULL,
+		0x3ccfa96bb3b7886fULL, 	0xfb0339f646e1cb63ULL,
+		0xf1a669bbf0f138e4ULL, 	0x366af92605a77be8ULL,
+		0xb1c64b4d2c5743d2ULL, 	0x760adbd0d90100deULL,
+		0x7caf8b9d6f11f359ULL, 	0xbb631b009a47b055ULL,
+		0x69e52b0603301457ULL, 	0xae29bb9bf666575bULL,
+		0xa48cebd64076a4dcULL, 	0x63407b4bb520e7d0ULL,
+		0x43706a30db73da4bULL, 	0x84bcfaad2e259947ULL,
+		0x8e19aae098356ac0ULL, 	0x49d53a7d6d6329ccULL,
+		0x9b530a7bf4148dceULL, 	0x5c9f9ae60142cec2ULL,
+		0x563acaabb7523d45ULL, 	0x91f65a3642047e49ULL,
+		0x37269f2c9ab0f744ULL, 	0xf0ea0fb16fe6b448ULL,
+		0xfa4f5ffcd9f647cfULL, 	0x3d83cf612ca004c3ULL,
+		0xef05ff67b5d7a0c1ULL, 	0x28c96ffa4081e3cdULL,
+		0x226c3fb7f691104aULL, 	0xe5a0af2a03c75346ULL,
+		0xc590be516d946eddULL, 	0x025c2ecc98c22dd1ULL,
+		0x08f97e812ed2de56ULL, 	0xcf35ee1cdb849d5aULL,
+		0x1db3de1a42f33958ULL, 	0xda7f4e87b7a57a54ULL,
+		0xd0da1eca01b589d3ULL, 	0x17168e57f4e3cadfULL,
+		0x90ba3c3cdd13f2e5ULL, 	0x5776aca12845b1e9ULL,
+		0x5dd3fcec9e55426eULL, 	0x9a1f6c716b030162ULL,
+		0x48995c77f274a560ULL, 	0x8f55ccea0722e66cULL,
+		0x85f09ca7b13215ebULL, 	0x423c0c3a446456e7ULL,
+		0x620c1d412a376b7cULL, 	0xa5c08ddcdf612870ULL,
+		0xaf65dd916971dbf7ULL, 	0x68a94d0c9c2798fbULL,
+		0xba2f7d0a05503cf9ULL, 	0x7de3ed97f0067ff5ULL,
+		0x7746bdda46168c72ULL, 	0xb08a2d47b340cf7eULL,
+		0x3aef38e7bc1cca95ULL, 	0xfd23a87a494a8999ULL,
+		0xf786f837ff5a7a1eULL, 	0x304a68aa0a0c3912ULL,
+		0xe2cc58ac937b9d10ULL, 	0x2500c831662dde1cULL,
+		0x2fa5987cd03d2d9bULL, 	0xe86908e1256b6e97ULL,
+		0xc859199a4b38530cULL, 	0x0f958907be6e1000ULL,
+		0x0530d94a087ee387ULL, 	0xc2fc49d7fd28a08bULL,
+		0x107a79d1645f0489ULL, 	0xd7b6e94c91094785ULL,
+		0xdd13b9012719b402ULL, 	0x1adf299cd24ff70eULL,
+		0x9d739bf7fbbfcf34ULL, 	0x5abf0b6a0ee98c38ULL,
+		0x501a5b27b8f97fbfULL, 	0x97d6cbba4daf3cb3ULL,
+		0x4550fbbcd4d898b1ULL, 	0x829c6b21218edbbdULL,
+		0x88393b6c979e283aULL, 	0x4ff5abf162c86b36ULL,
+		0x6fc5ba8a0c9b56adULL, 	0xa8092a17f9cd15a1ULL,
+		0xa2ac7a5a4fdde626ULL, 	0x6560eac7ba8ba52aULL,
+		0xb7e6dac123fc0128ULL, 	0x702a4a5cd6aa4224ULL,
+		0x7a8f1a1160bab1a3ULL, 	0xbd438a8c95ecf2afULL,
+		0x2cb5d0bad7e88ce6ULL, 	0xeb79402722becfeaULL,
+		0xe1dc106a94ae3c6dULL, 	0x261080f761f87f61ULL,
+		0xf496b0f1f88fdb63ULL, 	0x335a206c0dd9986fULL,
+		0x39ff7021bbc96be8ULL, 	0xfe33e0bc4e9f28e4ULL,
+		0xde03f1c720cc157fULL, 	0x19cf615ad59a5673ULL,
+		0x136a3117638aa5f4ULL, 	0xd4a6a18a96dce6f8ULL,
+		0x0620918c0fab42faULL, 	0xc1ec0111fafd01f6ULL,
+		0xcb49515c4cedf271ULL, 	0x0c85c1c1b9bbb17dULL,
+		0x8b2973aa904b8947ULL, 	0x4ce5e337651dca4bULL,
+		0x4640b37ad30d39ccULL, 	0x818c23e7265b7ac0ULL,
+		0x530a13e1bf2cdec2ULL, 	0x94c6837c4a7a9dceULL,
+		0x9e63d331fc6a6e49ULL, 	0x59af43ac093c2d45ULL,
+		0x799f52d7676f10deULL, 	0xbe53c24a923953d2ULL,
+		0xb4f692072429a055ULL, 	0x733a029ad17fe359ULL,
+		0xa1bc329c4808475bULL, 	0x6670a201bd5e0457ULL,
+		0x6cd5f24c0b4ef7d0ULL, 	0xab1962d1fe18b4dcULL,
+		0x217c7771f144b137ULL, 	0xe6b0e7ec0412f23bULL,
+		0xec15b7a1b20201bcULL, 	0x2bd9273c475442b0ULL,
+		0xf95f173ade23e6b2ULL, 	0x3e9387a72b75a5beULL,
+		0x3436d7ea9d655639ULL, 	0xf3fa477768331535ULL,
+		0xd3ca560c066028aeULL, 	0x1406c691f3366ba2ULL,
+		0x1ea396dc45269825ULL, 	0xd96f0641b070db29ULL,
+		0x0be9364729077f2bULL, 	0xcc25a6dadc513c27ULL,
+		0xc680f6976a41cfa0ULL, 	0x014c660a9f178cacULL,
+		0x86e0d461b6e7b496ULL, 	0x412c44fc43b1f79aULL,
+		0x4b8914b1f5a1041dULL, 	0x8c45842c00f74711ULL,
+		0x5ec3b42a9980e313ULL, 	0x990f24b76cd6a01fULL,
+		0x93aa74fadac65398ULL, 	0x5466e4672f901094ULL,
+		0x7456f51c41c32d0fULL, 	0xb39a6581b4956e03ULL,
+		0xb93f35cc02859d84ULL, 	0x7ef3a551f7d3de88ULL,
+		0xac7595576ea47a8aULL, 	0x6bb905ca9bf23986ULL,
+		0x611c55872de2ca01ULL, 	0xa6d0c51ad8b4890dULL,
+	},
+	{
+		0x0000000000000000ULL, 	0x6e4d3e593561ee88ULL,
+		0xdc9a7cb26ac3dd10ULL, 	0xb2d742eb5fa23398ULL,
+		0xfbc4188f7c6d8cb3ULL, 	0x958926d6490c623bULL,
+		0x275e643d16ae51a3ULL, 	0x49135a6423cfbf2bULL,
+		0xb578d0f551312ff5ULL, 	0xdb35eeac6450c17dULL,
+		0x69e2ac473bf2f2e5ULL, 	0x07af921e0e931c6dULL,
+		0x4ebcc87a2d5ca346ULL, 	0x20f1f623183d4dceULL,
+		0x9226b4c8479f7e56ULL, 	0xfc6b8a9172fe90deULL,
+		0x280140010b886979ULL, 	0x464c7e583ee987f1ULL,
+		0xf49b3cb3614bb469ULL, 	0x9ad602ea542a5ae1ULL,
+		0xd3c5588e77e5e5caULL, 	0xbd8866d742840b42ULL,
+		0x0f5f243c1d2638daULL, 	0x61121a652847d652ULL,
+		0x9d7990f45ab9468cULL, 	0xf334aead6fd8a804ULL,
+		0x41e3ec46307a9b9cULL, 	0x2faed21f051b7514ULL,
+		0x66bd887b26d4ca3fULL, 	0x08f0b62213b524b7ULL,
+		0xba27f4c94c17172fULL, 	0xd46aca907976f9a7ULL,
+		0x500280021710d2f2ULL, 	0x3e4fbe5b22713c7aULL,
+		0x8c98fcb07dd30fe2ULL, 	0xe2d5c2e948b2e16aULL,
+		0xabc6988d6b7d5e41ULL, 	0xc58ba6d45e1cb0c9ULL,
+		0x775ce43f01be8351ULL, 	0x1911da6634df6dd9ULL,
+		0xe57a50f74621fd07ULL, 	0x8b376eae7340138fULL,
+		0x39e02c452ce22017ULL, 	0x57ad121c1983ce9fULL,
+		0x1ebe48783a4c71b4ULL, 	0x70f376210f2d9f3cULL,
+		0xc22434ca508faca4ULL, 	0xac690a9365ee422cULL,
+		0x7803c0031c98bb8bULL, 	0x164efe5a29f95503ULL,
+		0xa499bcb1765b669bULL, 	0xcad482e8433a8813ULL,
+		0x83c7d88c60f53738ULL, 	0xed8ae6d55594d9b0ULL,
+		0x5f5da43e0a36ea28ULL, 	0x31109a673f5704a0ULL,
+		0xcd7b10f64da9947eULL, 	0xa3362eaf78c87af6ULL,
+		0x11e16c44276a496eULL, 	0x7fac521d120ba7e6ULL,
+		0x36bf087931c418cdULL, 	0x58f2362004a5f645ULL,
+		0xea2574cb5b07c5ddULL, 	0x84684a926e662b55ULL,
+		0xa00500042e21a5e4ULL, 	0xce483e5d1b404b6cULL,
+		0x7c9f7cb644e278f4ULL, 	0x12d242ef7183967cULL,
+		0x5bc1188b524c2957ULL, 	0x358c26d2672dc7dfULL,
+		0x875b6439388ff447ULL, 	0xe9165a600dee1acfULL,
+		0x157dd0f17f108a11ULL, 	0x7b30eea84a716499ULL,
+		0xc9e7ac4315d35701ULL, 	0xa7aa921a20b2b989ULL,
+		0xeeb9c87e037d06a2ULL, 	0x80f4f627361ce82aULL,
+		0x3223b4cc69bedbb2ULL, 	0x5c6e8a955cdf353aULL,
+		0x8804400525a9cc9dULL, 	0xe6497e5c10c82215ULL,
+		0x549e3cb74f6a118dULL, 	0x3ad302ee7a0bff05ULL,
+		0x73c0588a59c4402eULL, 	0x1d8d66d36ca5aea6ULL,
+		0xaf5a243833079d3eULL, 	0xc1171a61066673b6ULL,
+		0x3d7c90f07498e368ULL, 	0x5331aea941f90de0ULL,
+		0xe1e6ec421e5b3e78ULL, 	0x8fabd21b2b3ad0f0ULL,
+		0xc6b8887f08f56fdbULL, 	0xa8f5b6263d948153ULL,
+		0x1a22f4cd6236b2cbULL, 	0x746fca9457575c43ULL,
+		0xf007800639317716ULL, 	0x9e4abe5f0c50999eULL,
+		0x2c9dfcb453f2aa06ULL, 	0x42d0c2ed6693448eULL,
+		0x0bc39889455cfba5ULL, 	0x658ea6d0703d152dULL,
+		0xd759e43b2f9f26b5ULL, 	0xb914da621afec83dULL,
+		0x457f50f3680058e3ULL, 	0x2b326eaa5d61b66bULL,
+		0x99e52c4102c385f3ULL, 	0xf7a8121837a26b7bULL,
+		0xbebb487c146dd450ULL, 	0xd0f67625210c3ad8ULL,
+		0x622134ce7eae0940ULL, 	0x0c6c0a974bcfe7c8ULL,
+		0xd806c00732b91e6fULL, 	0xb64bfe5e07d8f0e7ULL,
+		0x049cbcb5587ac37fULL, 	0x6ad182ec6d1b2df7ULL,
+		0x23c2d8884ed492dcULL, 	0x4d8fe6d17bb57c54ULL,
+		0xff58a43a24174fccULL, 	0x91159a631176a144ULL,
+		0x6d7e10f26388319aULL, 	0x03332eab56e9df12ULL,
+		0xb1e46c40094bec8aULL, 	0xdfa952193c2a0202ULL,
+		0x96ba087d1fe5bd29ULL, 	0xf8f736242a8453a1ULL,
+		0x4a2074cf75266039ULL, 	0x246d4a9640478eb1ULL,
+		0x02fae1e3f5a97d5bULL, 	0x6cb7dfbac0c893d3ULL,
+		0xde609d519f6aa04bULL, 	0xb02da308aa0b4ec3ULL,
+		0xf93ef96c89c4f1e8ULL, 	0x9773c735bca51f60ULL,
+		0x25a485dee3072cf8ULL, 	0x4be9bb87d666c270ULL,
+		0xb7823116a49852aeULL, 	0xd9cf0f4f91f9bc26ULL,
+		0x6b184da4ce5b8fbeULL, 	0x055573fdfb3a6136ULL,
+		0x4c462999d8f5de1dULL, 	0x220b17c0ed943095ULL,
+		0x90dc552bb236030dULL, 	0xfe916b728757ed85ULL,
+		0x2afba1e2fe211422ULL, 	0x44b69fbbcb40faaaULL,
+		0xf661dd5094e2c932ULL, 	0x982ce309a18327baULL,
+		0xd13fb96d824c9891ULL, 	0xbf728734b72d7619ULL,
+		0x0da5c5dfe88f4581ULL, 	0x63e8fb86ddeeab09ULL,
+		0x9f837117af103bd7ULL, 	0xf1ce4f4e9a71d55fULL,
+		0x43190da5c5d3e6c7ULL, 	0x2d5433fcf0b2084fULL,
+		0x64476998d37db764ULL, 	0x0a0a57c1e61c59ecULL,
+		0xb8dd152ab9be6a74ULL, 	0xd6902b738cdf84fcULL,
+		0x52f861e1e2b9afa9ULL, 	0x3cb55fb8d7d84121ULL,
+		0x8e621d53887a72b9ULL, 	0xe02f230abd1b9c31ULL,
+		0xa93c796e9ed4231aULL, 	0xc7714737abb5cd92ULL,
+		0x75a605dcf417fe0aULL, 	0x1beb3b85c1761082ULL,
+		0xe780b114b388805cULL, 	0x89cd8f4d86e96ed4ULL,
+		0x3b1acda6d94b5d4cULL, 	0x5557f3ffec2ab3c4ULL,
+		0x1c44a99bcfe50cefULL, 	0x720997c2fa84e267ULL,
+		0xc0ded529a526d1ffULL, 	0xae93eb7090473f77ULL,
+		0x7af921e0e931c6d0ULL, 	0x14b41fb9dc502858ULL,
+		0xa6635d5283f21bc0ULL, 	0xc82e630bb693f548ULL,
+		0x813d396f955c4a63ULL, 	0xef700736a03da4ebULL,
+		0x5da745ddff9f9773ULL, 	0x33ea7b84cafe79fbULL,
+		0xcf81f115b800e925ULL, 	0xa1cccf4c8d6107adULL,
+		0x131b8da7d2c33435ULL, 	0x7d56b3fee7a2dabdULL,
+		0x3445e99ac46d6596ULL, 	0x5a08d7c3f10c8b1eULL,
+		0xe8df9528aeaeb886ULL, 	0x8692ab719bcf560eULL,
+		0xa2ffe1e7db88d8bfULL, 	0xccb2dfbeeee93637ULL,
+		0x7e659d55b14b05afULL, 	0x1028a30c842aeb27ULL,
+		0x593bf968a7e5540cULL, 	0x3776c7319284ba84ULL,
+		0x85a185dacd26891cULL, 	0xebecbb83f8476794ULL,
+		0x178731128ab9f74aULL, 	0x79ca0f4bbfd819c2ULL,
+		0xcb1d4da0e07a2a5aULL, 	0xa55073f9d51bc4d2ULL,
+		0xec43299df6d47bf9ULL, 	0x820e17c4c3b59571ULL,
+		0x30d9552f9c17a6e9ULL, 	0x5e946b76a9764861ULL,
+		0x8afea1e6d000b1c6ULL, 	0xe4b39fbfe5615f4eULL,
+		0x5664dd54bac36cd6ULL, 	0x3829e30d8fa2825eULL,
+		0x713ab969ac6d3d75ULL, 	0x1f778730990cd3fdULL,
+		0xada0c5dbc6aee065ULL, 	0xc3edfb82f3cf0eedULL,
+		0x3f86711381319e33ULL, 	0x51cb4f4ab45070bbULL,
+		0xe31c0da1ebf24323ULL, 	0x8d5133f8de93adabULL,
+		0xc442699cfd5c1280ULL, 	0xaa0f57c5c83dfc08ULL,
+		0x18d8152e979fcf90ULL, 	0x76952b77a2fe2118ULL,
+		0xf2fd61e5cc980a4dULL, 	0x9cb05fbcf9f9e4c5ULL,
+		0x2e671d57a65bd75dULL, 	0x402a230e933a39d5ULL,
+		0x0939796ab0f586feULL, 	0x6774473385946876ULL,
+		0xd5a305d8da365beeULL, 	0xbbee3b81ef57b566ULL,
+		0x4785b1109da925b8ULL, 	0x29c88f49a8c8cb30ULL,
+		0x9b1fcda2f76af8a8ULL, 	0xf552f3fbc20b1620ULL,
+		0xbc41a99fe1c4a90bULL, 	0xd20c97c6d4a54783ULL,
+		0x60dbd52d8b07741bULL, 	0x0e96eb74be669a93ULL,
+		0xdafc21e4c7106334ULL, 	0xb4b11fbdf2718dbcULL,
+		0x06665d56add3be24ULL, 	0x682b630f98b250acULL,
+		0x2138396bbb7def87ULL, 	0x4f7507328e1c010fULL,
+		0xfda245d9d1be3297ULL, 	0x93ef7b80e4dfdc1fULL,
+		0x6f84f11196214cc1ULL, 	0x01c9cf48a340a249ULL,
+		0xb31e8da3fce291d1ULL, 	0xdd53b3fac9837f59ULL,
+		0x9440e99eea4cc072ULL, 	0xfa0dd7c7df2d2efaULL,
+		0x48da952c808f1d62ULL, 	0x2697ab75b5eef3eaULL,
+	},
 };
@@ -0,0 +1,128 @@
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <linux/bug.h>
+#include <linux/execmem.h>
+#include <linux/kernel.h>
+#include <linux/log2.h>
+#include <linux/mutex.h>
+#include <linux/page.h>
+
+/*
+ * The arena is a sparse memfd, mapped twice: read/execute for running code,
+ * and read/write for text_poke_copy(). Flipping page protections with
+ * mprotect() instead would mean a TLB shootdown for every allocation, and code
+ * sharing a page with one being written couldn't run meanwhile.
+ *
+ * Allocations are power of two sized, from 64 bytes to a page; each size has
+ * its own region of the arena, so execmem_free() can tell an allocation's size
+ * from its address. Freed memory goes on a per size freelist, linked through
+ * the writable mapping. Pages are only touched as they're used.
+ */
+
+#define EXECMEM_MIN_SHIFT	6
+#define EXECMEM_NR_SIZES	(PAGE_SHIFT - EXECMEM_MIN_SHIFT + 1)
+#define EXECMEM_REGION_SIZE	(32UL << 20)
+#define EXECMEM_ARENA_SIZE	(EXECMEM_NR_SIZES * EXECMEM_REGION_SIZE)
+
+static DEFINE_MUTEX(execmem_lock);
+static bool	execmem_initialized;
+static u8	*execmem_rx;
+static u8	*execmem_rw;
+
+static struct execmem_region {
+	size_t		used;
+	void		*freelist;
+} execmem_regions[EXECMEM_NR_SIZES];
+
+static void execmem_init(void)
+{
+	void *rx = MAP_FAILED, *rw = MAP_FAILED;
+	int fd = memfd_create("bcachefs-execmem", MFD_CLOEXEC);
+
+	if (fd < 0)
+		return;
+
+	if (ftruncate(fd, EXECMEM_ARENA_SIZE))
+		goto err;
+
+	rw = mmap(NULL, EXECMEM_ARENA_SIZE, PROT_READ|PROT_WRITE,
+		  MAP_SHARED, fd, 0);
+	if (rw == MAP_FAILED)
+		goto err;
+
+	rx = mmap(NULL, EXECMEM_ARENA_SIZE, PROT_READ|PROT_EXEC,
+		  MAP_SHARED, fd, 0);
+	if (rx == MAP_FAILED)
+		goto err;
+
+	execmem_rx = rx;
+	execmem_rw = rw;
+	close(fd);
+	return;
+err:
+	if (rw != MAP_FAILED)
+		munmap(rw, EXECMEM_ARENA_SIZE);
+	close(fd);
+}
+
+static inline void *execmem_rw_addr(void *p)
+{
+	BUG_ON((u8 *) p <  execmem_rx ||
+	       (u8 *) p >= execmem_rx + EXECMEM_ARENA_SIZE);
+
+	return execmem_rw + ((u8 *) p - execmem_rx);
+}
+
+void *execmem_alloc(enum execmem_type type, size_t size)
+{
+	unsigned shift = max_t(unsigned, order_base_2(size), EXECMEM_MIN_SHIFT);
+	unsigned idx = shift - EXECMEM_MIN_SHIFT;
+	struct execmem_region *r = &execmem_regions[idx];
+	void *p = NULL;
+
+	if (!size || shift > PAGE_SHIFT)
+		return NULL;
+
+	mutex_lock(&execmem_lock);
+	if (unlikely(!execmem_initialized)) {
+		execmem_init();
+		execmem_initialized = true;
+	}
+
+	if (!execmem_rx)
+		goto out;
+
+	if (r->freelist) {
+		p = r->freelist;
+		r->freelist = *((void **) execmem_rw_addr(p));
+	} else if (r->used + (1UL << shift) <= EXECMEM_REGION_SIZE) {
+		p = execmem_rx + idx * EXECMEM_REGION_SIZE + r->used;
+		r->used += 1UL << shift;
+	}
+out:
+	mutex_unlock(&execmem_lock);
+	return p;
+}
+
+void execmem_free(void *p)
+{
+	struct execmem_region *r;
+
+	if (!p)
+		return;
+
+	mutex_lock(&execmem_lock);
+	r = &execmem_regions[((u8 *) p - execmem_rx) / EXECMEM_REGION_SIZE];
+	*((void **) execmem_rw_addr(p)) = r->freelist;
+	r->freelist = p;
+	mutex_unlock(&execmem_lock);
+}
+
+void *text_poke_copy(void *addr, const void *src, size_t len)
+{
+	memcpy(execmem_rw_addr(addr), src, len);
+	__builtin___clear_cache(addr, addr + len);
+	return addr;
+}
@@ -0,0 +1,449 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include <linux/kernel.h>
+#include <linux/blkdev.h>
+#include <linux/shrinker.h>
+#include <linux/slab.h>
+
+#include "tools-util.h"
+
+/*
+ * Page allocator for alloc_pages() and large kvmalloc() allocations:
+ *
+ * Pages come out of one big reserved arena, mapped in PP_CHUNK_SIZE chunks
+ * with transparent hugepages, and handed out by a buddy allocator for orders
+ * 0..MAX_PAGE_ORDER. Block metadata lives out of line, in a struct pp_page per
+ * page, so free pages are never touched by the allocator and can be given back
+ * to the kernel.
+ *
+ * Each thread keeps a small cache of free blocks for the low orders, refilled
+ * from and flushed to the buddy allocator in batches, so bio page churn takes
+ * no locks.
+ *
+ * Freed memory stays resident until the shrinker asks for it back: it's then
+ * released with MADV_DONTNEED, largest blocks first. The first few chunks are
+ * registered with the block device backend as fixed IO buffers; those are only
+ * released once the whole chunk is free, and unregistered first.
+ *
+ * If the arena can't be reserved or is exhausted we fall back to
+ * aligned_alloc(); page_pool_owns() tells the two apart at free time.
+ */
+
+#define PP_ARENA_SIZE		(1ULL << 36)
+#define PP_CHUNK_SHIFT		24
+#define PP_CHUNK_SIZE		(1UL << PP_CHUNK_SHIFT)
+#define PP_CHUNK_PAGES		(PP_CHUNK_SIZE >> PAGE_SHIFT)
+#define PP_NR_CHUNKS		(PP_ARENA_SIZE >> PP_CHUNK_SHIFT)
+#define PP_MAX_REGISTERED	8	/* chunks registered as IO buffers */
+
+#define PP_PCP_ORDERS		4
+#define PP_PCP_MAX		64
+#define PP_PCP_HIGH(order)	(PP_PCP_MAX >> (order))
+#define PP_PCP_BATCH(order)	(PP_PCP_HIGH(order) / 2)
+
+#define PP_NONE			U32_MAX
+
+enum {
+	PP_FREE			= 1 << 0,
+	PP_RELEASED		= 1 << 1,	/* free, and given back with MADV_DONTNEED */
+};
+
+/* Only meaningful for the first page of a block: */
+struct pp_page {
+	u32			next;
+	u32			prev;
+	u8			order;
+	u8			flags;
+};
+
+struct pp_chunk {
+	bool			registered;
+	struct pp_page		pages[PP_CHUNK_PAGES];
+};
+
+struct pp_pcp {
+	bool			registered;
+	unsigned		nr[PP_PCP_ORDERS];
+	void			*pages[PP_PCP_ORDERS][PP_PCP_MAX];
+};
+
+void			*page_pool_base;
+size_t			page_pool_size;
+
+static pthread_mutex_t	pp_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct pp_chunk	*pp_chunks[PP_NR_CHUNKS];
+static unsigned		pp_nr_chunks;
+static unsigned		pp_nr_registered;
+static u32		pp_free_head[MAX_PAGE_ORDER + 1];
+/* free pages that are resident and not in registered chunks: */
+static unsigned long	pp_nr_resident;
+/* free pages in registered chunks: */
+static unsigned long	pp_nr_registered_free;
+
+static pthread_once_t	pp_once = PTHREAD_ONCE_INIT;
+static pthread_key_t	pp_pcp_key;
+static __thread struct pp_pcp pp_pcp;
+static struct shrinker	*pp_shrinker;
+
+static inline struct pp_page *pp_page(u32 idx)
+{
+	return &pp_chunks[idx / PP_CHUNK_PAGES]->pages[idx % PP_CHUNK_PAGES];
+}
+
+static inline bool pp_registered(u32 idx)
+{
+	return pp_chunks[idx / PP_CHUNK_PAGES]->registered;
+}
+
+/* Which count a resident free block at idx goes in: */
+static inline unsigned long *pp_nr_free(u32 idx)
+{
+	return pp_registered(idx) ? &pp_nr_registered_free : &pp_nr_resident;
+}
+
+static inline void *pp_addr(u32 idx)
+{
+	return page_pool_base + ((size_t) idx << PAGE_SHIFT);
+}
+
+static inline u32 pp_idx(const void *p)
+{
+	return ((const char *) p - (const char *) page_pool_base) >> PAGE_SHIFT;
+}
+
+static void pp_add_free(u32 idx, unsigned order, bool released)
+{
+	struct pp_page *p = pp_page(idx);
+
+	p->order	= order;
+	p->flags	= PP_FREE|(released ? PP_RELEASED : 0);
+	p->prev		= PP_NONE;
+	p->next		= pp_free_head[order];
+	if (p->next != PP_NONE)
+		pp_page(p->next)->prev = idx;
+	pp_free_head[order] = idx;
+
+	if (!released)
+		*pp_nr_free(idx) += 1U << order;
+}
+
+static void pp_del_free(u32 idx)
+{
+	struct pp_page *p = pp_page(idx);
+
+	if (p->prev != PP_NONE)
+		pp_page(p->prev)->next = p->next;
+	else
+		pp_free_head[p->order] = p->next;
+	if (p->next != PP_NONE)
+		pp_page(p->next)->prev = p->prev;
+
+	if (!(p->flags & PP_RELEASED))
+		*pp_nr_free(idx) -= 1U << p->order;
+	p->flags = 0;
+}
+
+static int pp_map_chunk(void)
+{
+	struct pp_chunk *c;
+	void *addr;
+	unsigned i;
+
+	if (pp_nr_chunks == PP_NR_CHUNKS)
+		return -ENOMEM;
+
+	c = calloc(1, sizeof(*c));
+	if (!c)
+		return -ENOMEM;
+
+	addr = page_pool_base + ((size_t) pp_nr_chunks << PP_CHUNK_SHIFT);
+	if (mprotect(addr, PP_CHUNK_SIZE, PROT_READ|PROT_WRITE)) {
+		free(c);
+		return -ENOMEM;
+	}
+	madvise(addr, PP_CHUNK_SIZE, MADV_HUGEPAGE);
+
+	c->registered = pp_nr_registered < PP_MAX_REGISTERED &&
+		!blkdev_register_buffer(addr, PP_CHUNK_SIZE);
+	pp_nr_registered += c->registered;
+
+	pp_chunks[pp_nr_chunks] = c;
+
+	/* Not faulted in yet, so it starts out as released: */
+	for (i = 0; i < PP_CHUNK_PAGES; i += 1U << MAX_PAGE_ORDER)
+		pp_add_free(pp_nr_chunks * PP_CHUNK_PAGES + i, MAX_PAGE_ORDER,
+			    !c->registered);
+	pp_nr_chunks++;
+	return 0;
+}
+
+static u32 __pp_alloc(unsigned order)
+{
+	unsigned o = order;
+	bool released;
+	u32 idx;
+
+	while (o <= MAX_PAGE_ORDER && pp_free_head[o] == PP_NONE)
+		o++;
+
+	if (o > MAX_PAGE_ORDER) {
+		if (pp_map_chunk())
+			return PP_NONE;
+		o = MAX_PAGE_ORDER;
+	}
+
+	idx = pp_free_head[o];
+	released = pp_page(idx)->flags & PP_RELEASED;
+	pp_del_free(idx);
+
+	while (o > order) {
+		o--;
+		pp_add_free(idx + (1U << o), o, released);
+	}
+
+	pp_page(idx)->order = order;
+	return idx;
+}
+
+static void __pp_free(u32 idx, unsigned order)
+{
+	while (order < MAX_PAGE_ORDER) {
+		u32 buddy = idx ^ (1U << order);
+		struct pp_page *b = pp_page(buddy);
+
+		if (!(b->flags & PP_FREE) || b->order != order)
+			break;
+
+		/* The merged block counts as resident: */
+		pp_del_free(buddy);
+		idx = min(idx, buddy);
+		order++;
+	}
+
+	pp_add_free(idx, order, false);
+}
+
+/*
+ * Threads may only ever free pages to their cache (e.g. bio completions), so
+ * register for the exit flush on first use from either side; the pool has been
+ * initialized by then, and the key created:
+ */
+static inline struct pp_pcp *pp_pcp_get(void)
+{
+	struct pp_pcp *pcp = &pp_pcp;
+
+	if (unlikely(!pcp->registered)) {
+		pthread_setspecific(pp_pcp_key, pcp);
+		pcp->registered = true;
+	}
+	return pcp;
+}
+
+static void pp_pcp_flush(unsigned order, unsigned nr)
+{
+	struct pp_pcp *pcp = &pp_pcp;
+
+	pthread_mutex_lock(&pp_lock);
+	while (nr--)
+		__pp_free(pp_idx(pcp->pages[order][--pcp->nr[order]]), order);
+	pthread_mutex_unlock(&pp_lock);
+}
+
+static void pp_pcp_exit(void *p)
+{
+	unsigned order;
+
+	for (order = 0; order < PP_PCP_ORDERS; order++)
+		pp_pcp_flush(order, pp_pcp.nr[order]);
+}
+
+/*
+ * A registered chunk can be released once it's entirely free: if so, unregister
+ * it, after which its pages count as ordinary resident free pages:
+ */
+static bool pp_chunk_unregister(u32 idx)
+{
+	unsigned nr = idx / PP_CHUNK_PAGES;
+	u32 first = nr * PP_CHUNK_PAGES, i;
+
+	for (i = 0; i < PP_CHUNK_PAGES; i += 1U << MAX_PAGE_ORDER) {
+		struct pp_page *p = pp_page(first + i);
+
+		if (!(p->flags & PP_FREE) || p->order != MAX_PAGE_ORDER)
+			return false;
+	}
+
+	blkdev_unregister_buffer(pp_addr(first));
+
+	pp_chunks[nr]->registered = false;
+	pp_nr_registered--;
+	pp_nr_registered_free	-= PP_CHUNK_PAGES;
+	pp_nr_resident		+= PP_CHUNK_PAGES;
+	return true;
+}
+
+static unsigned long pp_shrinker_count(struct shrinker *shrink,
+				       struct shrink_control *sc)
+{
+	return READ_ONCE(pp_nr_resident) + READ_ONCE(pp_nr_registered_free);
+}
+
+static unsigned long pp_shrinker_scan(struct shrinker *shrink,
+				      struct shrink_control *sc)
+{
+	unsigned long freed = 0;
+	int order;
+
+	pthread_mutex_lock(&pp_lock);
+	for (order = MAX_PAGE_ORDER; order >= 0 && freed < sc->nr_to_scan; --order) {
+		u32 idx;
+
+		for (idx = pp_free_head[order];
+		     idx != PP_NONE && freed < sc->nr_to_scan;
+		     idx = pp_page(idx)->next) {
+			struct pp_page *p = pp_page(idx);
+
+			if (p->flags & PP_RELEASED)
+				continue;
+
+			if (pp_registered(idx) &&
+			    (order != MAX_PAGE_ORDER || !pp_chunk_unregister(idx)))
+				continue;
+
+			madvise(pp_addr(idx), PAGE_SIZE << order, MADV_DONTNEED);
+			p->flags |= PP_RELEASED;
+			pp_nr_resident	-= 1U << order;
+			freed		+= 1U << order;
+		}
+	}
+	pthread_mutex_unlock(&pp_lock);
+
+	return freed;
+}
+
+static void pp_init_once(void)
+{
+	unsigned i;
+	void *p;
+
+	BUG_ON(pthread_key_create(&pp_pcp_key, pp_pcp_exit));
+
+	for (i = 0; i <= MAX_PAGE_ORDER; i++)
+		pp_free_head[i] = PP_NONE;
+
+	/* Over-reserve so the arena can be aligned to a hugepage: */
+	p = mmap(NULL, PP_ARENA_SIZE + PP_CHUNK_SIZE, PROT_NONE,
+		 MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+	if (p == MAP_FAILED)
+		return;
+
+	page_pool_base = PTR_ALIGN(p, PP_CHUNK_SIZE);
+
+	pp_shrinker = shrinker_alloc(0, "page_pool");
+	if (pp_shrinker) {
+		pp_shrinker->count_objects	= pp_shrinker_count;
+		pp_shrinker->scan_objects	= pp_shrinker_scan;
+		shrinker_register(pp_shrinker);
+	}
+
+	smp_store_release(&page_pool_size, PP_ARENA_SIZE);
+}
+
+static void *pp_alloc_fallback(gfp_t gfp, unsigned order)
+{
+	unsigned i;
+	void *p;
+
+	for (i = 0; i < 10; i++) {
+		p = aligned_alloc(PAGE_SIZE, PAGE_SIZE << order);
+		if (p)
+			break;
+
+		run_shrinkers(gfp, true);
+	}
+
+	return p;
+}
+
+static noinline void *pp_alloc_slowpath(gfp_t gfp, unsigned order)
+{
+	struct pp_pcp *pcp;
+	u32 idx;
+
+	pthread_once(&pp_once, pp_init_once);
+	if (!page_pool_size || order > MAX_PAGE_ORDER)
+		return pp_alloc_fallback(gfp, order);
+
+	pcp = pp_pcp_get();
+
+	pthread_mutex_lock(&pp_lock);
+	if (order < PP_PCP_ORDERS) {
+		while (pcp->nr[order] < PP_PCP_BATCH(order) &&
+		       (idx = __pp_alloc(order)) != PP_NONE)
+			pcp->pages[order][pcp->nr[order]++] = pp_addr(idx);
+
+		idx = pcp->nr[order]
+			? pp_idx(pcp->pages[order][--pcp->nr[order]])
+			: PP_NONE;
+	} else {
+		idx = __pp_alloc(order);
+	}
+	pthread_mutex_unlock(&pp_lock);
+
+	return idx != PP_NONE
+		? pp_addr(idx)
+		: pp_alloc_fallback(gfp, order);
+}
+
+struct page *alloc_pages_noprof(gfp_t gfp, unsigned int order)
+{
+	struct pp_pcp *pcp = &pp_pcp;
+	void *p;
+
+	if (order < PP_PCP_ORDERS && likely(pcp->nr[order]))
+		p = pcp->pages[order][--pcp->nr[order]];
+	else
+		p = pp_alloc_slowpath(gfp, order);
+
+	if (p && (gfp & __GFP_ZERO))
+		memset(p, 0, PAGE_SIZE << order);
+
+	return p;
+}
+
+void __free_pages(struct page *page, unsigned int order)
+{
+	struct pp_pcp *pcp;
+
+	if (!page_pool_owns(page)) {
+		free(page);
+		return;
+	}
+
+	pcp = pp_pcp_get();
+
+	BUG_ON(pp_page(pp_idx(page))->order != order);
+
+	if (order < PP_PCP_ORDERS) {
+		if (unlikely(pcp->nr[order] == PP_PCP_HIGH(order)))
+			pp_pcp_flush(order, PP_PCP_BATCH(order));
+		pcp->pages[order][pcp->nr[order]++] = page;
+	} else {
+		pthread_mutex_lock(&pp_lock);
+		__pp_free(pp_idx(page), order);
+		pthread_mutex_unlock(&pp_lock);
+	}
+}
+
+size_t page_pool_alloc_size(const void *p)
+{
+	return PAGE_SIZE << pp_page(pp_idx(p))->order;
+}
+
+void page_pool_free(const void *p)
+{
+	__free_pages((void *) p, pp_page(pp_idx(p))->order);
+}
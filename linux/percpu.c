@@ -0,0 +1,185 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <linux/cpumask.h>
+#include <linux/kernel.h>
+#include <linux/list.h>
+#include <linux/percpu.h>
+
+#include "tools-util.h"
+
+unsigned nr_cpu_ids = 1;
+unsigned __num_online_cpus = 1;
+
+/*
+ * The per CPU areas (see percpu.h) are reserved up front, and made accessible
+ * as they're used. Allocation is first fit from a sorted list of free extents,
+ * falling back to the top of the used space; free space is kept zeroed.
+ *
+ * Each allocation is preceded by a header with its size, in CPU 0's area.
+ */
+
+#define PCPU_MIN_ALIGN		16
+#define PCPU_COMMIT_SIZE	(64UL << 10)
+
+struct pcpu_extent {
+	struct list_head	list;
+	size_t			start;
+	size_t			end;
+};
+
+static pthread_mutex_t	pcpu_lock = PTHREAD_MUTEX_INITIALIZER;
+static void		*pcpu_base;
+static size_t		pcpu_top;
+static size_t		pcpu_committed;
+static LIST_HEAD(pcpu_free_list);
+
+static int pcpu_commit(size_t end)
+{
+	unsigned cpu;
+
+	if (end <= pcpu_committed)
+		return 0;
+	if (end > PCPU_UNIT_SIZE)
+		return -ENOMEM;
+
+	end = min(round_up(end, PCPU_COMMIT_SIZE), PCPU_UNIT_SIZE);
+
+	for_each_possible_cpu(cpu)
+		if (mprotect(per_cpu_ptr(pcpu_base, cpu) + pcpu_committed,
+			     end - pcpu_committed, PROT_READ|PROT_WRITE))
+			return -ENOMEM;
+
+	pcpu_committed = end;
+	return 0;
+}
+
+static void pcpu_free_range(size_t start, size_t end)
+{
+	struct pcpu_extent *e, *prev = NULL, *next = NULL;
+
+	list_for_each_entry(e, &pcpu_free_list, list) {
+		if (e->start > start) {
+			next = e;
+			break;
+		}
+		prev = e;
+	}
+
+	if (prev && prev->end == start) {
+		prev->end = end;
+		e = prev;
+	} else {
+		e = malloc(sizeof(*e));
+		if (!e)
+			return; /* leaked, but still zeroed */
+
+		e->start	= start;
+		e->end		= end;
+		if (prev)
+			list_add(&e->list, &prev->list);
+		else
+			list_add(&e->list, &pcpu_free_list);
+	}
+
+	if (next && next->start == e->end) {
+		e->end = next->end;
+		list_del(&next->list);
+		free(next);
+	}
+
+	if (e->end == pcpu_top) {
+		pcpu_top = e->start;
+		list_del(&e->list);
+		free(e);
+	}
+}
+
+void __percpu *__alloc_percpu_gfp(size_t size, size_t align, gfp_t gfp)
+{
+	struct pcpu_extent *e;
+	void *ret = NULL;
+	size_t p, old_top;
+
+	size	= round_up(max_t(size_t, size, 1), PCPU_MIN_ALIGN);
+	align	= max_t(size_t, align, PCPU_MIN_ALIGN);
+
+	pthread_mutex_lock(&pcpu_lock);
+	if (!pcpu_base)
+		goto out;
+
+	list_for_each_entry(e, &pcpu_free_list, list) {
+		p = round_up(e->start + PCPU_MIN_ALIGN, align);
+
+		if (p + size <= e->end) {
+			size_t start = e->start, end = e->end;
+
+			list_del(&e->list);
+			free(e);
+
+			/* give back the alignment padding and the tail: */
+			if (start < p - PCPU_MIN_ALIGN)
+				pcpu_free_range(start, p - PCPU_MIN_ALIGN);
+			if (p + size < end)
+				pcpu_free_range(p + size, end);
+			goto found;
+		}
+	}
+
+	p = round_up(pcpu_top + PCPU_MIN_ALIGN, align);
+	if (pcpu_commit(p + size))
+		goto out;
+
+	old_top		= pcpu_top;
+	pcpu_top	= p + size;
+
+	if (old_top < p - PCPU_MIN_ALIGN)
+		pcpu_free_range(old_top, p - PCPU_MIN_ALIGN);
+found:
+	*((size_t *) (pcpu_base + p) - 1) = size;
+	ret = pcpu_base + p;
+out:
+	pthread_mutex_unlock(&pcpu_lock);
+	return ret;
+}
+
+void free_percpu(void __percpu *ptr)
+{
+	size_t p, size;
+	unsigned cpu;
+
+	if (!ptr)
+		return;
+
+	p	= ptr - pcpu_base;
+	size	= *((size_t *) ptr - 1);
+
+	BUG_ON(p >= pcpu_top || p + size > pcpu_top);
+
+	for_each_possible_cpu(cpu)
+		memset(per_cpu_ptr(ptr, cpu) - PCPU_MIN_ALIGN, 0,
+		       size + PCPU_MIN_ALIGN);
+
+	pthread_mutex_lock(&pcpu_lock);
+	pcpu_free_range(p - PCPU_MIN_ALIGN, p + size);
+	pthread_mutex_unlock(&pcpu_lock);
+}
+
+__attribute__((constructor(101)))
+static void percpu_init(void)
+{
+	long possible	= sysconf(_SC_NPROCESSORS_CONF);
+	long online	= sysconf(_SC_NPROCESSORS_ONLN);
+
+	nr_cpu_ids		= max(possible, 1L);
+	__num_online_cpus	= clamp(online, 1L, (long) nr_cpu_ids);
+
+	/* Address space only, until pcpu_commit(): */
+	pcpu_base = mmap(NULL, (size_t) nr_cpu_ids << PCPU_UNIT_SHIFT, PROT_NONE,
+			 MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+	if (pcpu_base == MAP_FAILED)
+		die("error reserving percpu memory for %u cpus", nr_cpu_ids);
+}
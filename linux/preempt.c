@@ -1,6 +1,8 @@
 #include <pthread.h>
 
-#include "linux/preempt.h"
+#include <linux/cache.h>
+#include <linux/cpumask.h>
+#include <linux/preempt.h>
 
 /*
  * In userspace, pthreads are preemptible and can migrate CPUs at any time.
@@ -10,28 +12,39 @@
  * various code paths, critically including the percpu system as it allows for
  * non-atomic reads and writes to CPU-local data structures.
  *
- * The high performance userspace equivalent would be to use thread local
- * storage to replace percpu data, but that would be complicated. It should be
- * correct to instead guarantee mutual exclusion for the critical sections.
+ * We emulate that with a lock per CPU: preempt_disable() takes the lock for
+ * the CPU we're on, and pins us to that CPU's percpu data (see
+ * raw_smp_processor_id()) until preempt_enable(), even if we migrate. Critical
+ * sections on different CPUs run in parallel.
  */
 
-static pthread_mutex_t preempt_lock;
+#define PREEMPT_NR_LOCKS	256
 
-__attribute__((constructor))
-static void preempt_init(void) {
-	pthread_mutexattr_t attr;
-	pthread_mutexattr_init(&attr);
-	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
-	pthread_mutex_init(&preempt_lock, &attr);
-	pthread_mutexattr_destroy(&attr);
-}
+static struct {
+	pthread_mutex_t		lock;
+} ____cacheline_aligned preempt_locks[PREEMPT_NR_LOCKS] = {
+	[0 ... PREEMPT_NR_LOCKS - 1] = { PTHREAD_MUTEX_INITIALIZER },
+};
+
+__thread int __preempt_cpu = -1;
+static __thread unsigned preempt_count;
 
 void preempt_disable(void)
 {
-	pthread_mutex_lock(&preempt_lock);
+	if (!preempt_count++) {
+		unsigned cpu = raw_smp_processor_id();
+
+		pthread_mutex_lock(&preempt_locks[cpu % PREEMPT_NR_LOCKS].lock);
+		__preempt_cpu = cpu;
+	}
 }
 
 void preempt_enable(void)
 {
-	pthread_mutex_unlock(&preempt_lock);
+	if (!--preempt_count) {
+		unsigned cpu = __preempt_cpu;
+
+		__preempt_cpu = -1;
+		pthread_mutex_unlock(&preempt_locks[cpu % PREEMPT_NR_LOCKS].lock);
+	}
 }
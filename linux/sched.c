@@ -8,6 +8,7 @@
 #define CONFIG_RCU_HAVE_FUTEX 1
 #include <urcu/futex.h>
 
+#include <linux/blkdev.h>
 #include <linux/rcupdate.h>
 #include <linux/sched.h>
 #include <linux/timer.h>
@@ -31,15 +32,65 @@ int wake_up_process(struct task_struct *p)
 	return ret;
 }
 
+/* Don't go to sleep sitting on IO we haven't submitted: */
+void sched_flush_plug(void)
+{
+	if (current && current->plug)
+		blk_flush_plug(current->plug, true);
+}
+
+/*
+ * on_cpu is cleared while we're blocked, so that threads waiting on locks we
+ * hold know not to spin (see owner_on_cpu()):
+ */
+static inline void sched_set_on_cpu(bool on_cpu)
+{
+	if (current)
+		WRITE_ONCE(current->on_cpu, on_cpu);
+}
+
+/*
+ * Sleeping locks: whoever holds the lock may be waiting on IO we have plugged,
+ * so flush it before blocking - as the kernel does, since there blocking goes
+ * through schedule():
+ */
+void __mutex_lock_slowpath(struct mutex *lock)
+{
+	sched_flush_plug();
+	sched_set_on_cpu(false);
+	pthread_mutex_lock(&lock->lock);
+	sched_set_on_cpu(true);
+}
+
+void __down_read_slowpath(struct rw_semaphore *sem)
+{
+	sched_flush_plug();
+	sched_set_on_cpu(false);
+	pthread_rwlock_rdlock(&sem->lock);
+	sched_set_on_cpu(true);
+}
+
+void __down_write_slowpath(struct rw_semaphore *sem)
+{
+	sched_flush_plug();
+	sched_set_on_cpu(false);
+	pthread_rwlock_wrlock(&sem->lock);
+	sched_set_on_cpu(true);
+}
+
 void schedule(void)
 {
 	int v;
 
+	sched_flush_plug();
+
 	rcu_quiescent_state();
 
+	sched_set_on_cpu(false);
 	while ((v = READ_ONCE(current->state)) != TASK_RUNNING)
 		futex(&current->state, FUTEX_WAIT|FUTEX_PRIVATE_FLAG,
 		      v, NULL, NULL, 0);
+	sched_set_on_cpu(true);
 }
 
 struct process_timer {
@@ -109,6 +160,7 @@ static void sched_init(void)
 	memset(p, 0, sizeof(*p));
 
 	p->state	= TASK_RUNNING;
+	p->on_cpu	= true;
 	atomic_set(&p->usage, 1);
 	init_completion(&p->exited);
 
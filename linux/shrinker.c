@@ -1,4 +1,7 @@
-
+#include <ctype.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <unistd.h>
 
@@ -6,6 +9,7 @@
 #include <linux/list.h>
 #include <linux/mm.h>
 #include <linux/mutex.h>
+#include <linux/seq_buf.h>
 #include <linux/shrinker.h>
 
 #include "tools-util.h"
@@ -13,6 +17,27 @@
 static LIST_HEAD(shrinker_list);
 static DEFINE_MUTEX(shrinker_lock);
 
+/*
+ * Memory limits, besides physical RAM: the tightest memory.max/memory.high of
+ * our cgroup and its ancestors, and an explicit limit on our own RSS from
+ * set_memory_limit() or $BCACHEFS_MEMORY_LIMIT.
+ *
+ * We aim to keep 1/16th of whichever limit is tightest free; a PSI memory
+ * stall trigger wakes up the shrinker thread early, and makes it shrink even
+ * if we're under the limits.
+ */
+static u64	memory_limit;
+static u64	cgroup_limit;
+static int	cgroup_current_fd	= -1;
+static int	cgroup_stat_fd		= -1;
+static int	psi_fd			= -1;
+
+/* 150ms of stalls in a 2s window - unprivileged triggers need a 2s multiple: */
+#define PSI_TRIGGER		"some 150000 2000000"
+
+#define DEFAULT_SEEKS		2
+#define SHRINK_BATCH		128
+
 void shrinker_free(struct shrinker *s)
 {
 	if (s->list.next) {
@@ -25,7 +50,15 @@ void shrinker_free(struct shrinker *s)
 
 struct shrinker *shrinker_alloc(unsigned int flags, const char *fmt, ...)
 {
-	return calloc(sizeof(struct shrinker), 1);
+	struct shrinker *s = calloc(sizeof(struct shrinker), 1);
+	va_list args;
+
+	if (s) {
+		va_start(args, fmt);
+		vsnprintf(s->name, sizeof(s->name), fmt, args);
+		va_end(args);
+	}
+	return s;
 }
 
 int shrinker_register(struct shrinker *shrinker)
@@ -36,28 +69,264 @@ int shrinker_register(struct shrinker *shrinker)
 	return 0;
 }
 
-static void run_shrinkers_allocation_failed(gfp_t gfp_mask)
+void set_memory_limit(u64 bytes)
+{
+	WRITE_ONCE(memory_limit, bytes);
+}
+
+static u64 read_u64_fd(int fd)
+{
+	char buf[32];
+	ssize_t r = pread(fd, buf, sizeof(buf) - 1, 0);
+
+	if (r <= 0)
+		return 0;
+	buf[r] = '\0';
+	return strtoull(buf, NULL, 10);
+}
+
+static u64 cgroup_inactive_file(void)
+{
+	char buf[4096], *p;
+	ssize_t r = pread(cgroup_stat_fd, buf, sizeof(buf) - 1, 0);
+
+	if (r <= 0)
+		return 0;
+	buf[r] = '\0';
+
+	p = strstr(buf, "\ninactive_file ");
+	return p ? strtoull(p + strlen("\ninactive_file "), NULL, 10) : 0;
+}
+
+/* Memory the kernel can't just drop: page cache we aren't using doesn't count */
+static u64 cgroup_used(void)
+{
+	u64 current = read_u64_fd(cgroup_current_fd);
+	u64 inactive = cgroup_stat_fd >= 0 ? cgroup_inactive_file() : 0;
+
+	return current - min(current, inactive);
+}
+
+static u64 rss_bytes(void)
+{
+	unsigned long size, resident;
+	FILE *f = fopen("/proc/self/statm", "r");
+	int ret;
+
+	if (!f)
+		return 0;
+	ret = fscanf(f, "%lu %lu", &size, &resident);
+	fclose(f);
+
+	return ret == 2 ? (u64) resident << PAGE_SHIFT : 0;
+}
+
+static u64 cgroup_read_limit(const char *dir, const char *file)
+{
+	char *path = mprintf("%s/%s", dir, file);
+	char buf[32];
+	u64 v = U64_MAX;
+	int fd = open(path, O_RDONLY|O_CLOEXEC);
+
+	free(path);
+	if (fd < 0)
+		return v;
+
+	ssize_t r = read(fd, buf, sizeof(buf) - 1);
+	if (r > 0 && isdigit(buf[0])) {
+		buf[r] = '\0';
+		v = strtoull(buf, NULL, 10);
+	}
+	close(fd);
+	return v;
+}
+
+static void cgroup_init(void)
+{
+	char *line = NULL, *dir = NULL, *limit_dir = NULL, *path;
+	size_t n = 0;
+	FILE *f = fopen("/proc/self/cgroup", "r");
+
+	if (!f)
+		return;
+
+	/* cgroup v2 only: */
+	while (getline(&line, &n, f) > 0)
+		if (!strncmp(line, "0::", 3)) {
+			strim(line);
+			dir = mprintf("/sys/fs/cgroup%s", line + 3);
+			break;
+		}
+	fclose(f);
+	free(line);
+
+	if (!dir)
+		return;
+
+	/* The tightest limit may be set on an ancestor: */
+	cgroup_limit = U64_MAX;
+	while (strcmp(dir, "/sys/fs/cgroup")) {
+		u64 limit = min(cgroup_read_limit(dir, "memory.max"),
+				cgroup_read_limit(dir, "memory.high"));
+		char *p;
+
+		if (limit < cgroup_limit) {
+			cgroup_limit = limit;
+			free(limit_dir);
+			limit_dir = strdup(dir);
+		}
+
+		p = strrchr(dir, '/');
+		if (!p)
+			break;
+		*p = '\0';
+	}
+
+	if (limit_dir) {
+		path = mprintf("%s/memory.current", limit_dir);
+		cgroup_current_fd = open(path, O_RDONLY|O_CLOEXEC);
+		free(path);
+
+		path = mprintf("%s/memory.stat", limit_dir);
+		cgroup_stat_fd = open(path, O_RDONLY|O_CLOEXEC);
+		free(path);
+
+		if (cgroup_current_fd < 0)
+			cgroup_limit = 0;
+
+		path = mprintf("%s/memory.pressure", limit_dir);
+		psi_fd = open(path, O_RDWR|O_NONBLOCK|O_CLOEXEC);
+		free(path);
+		free(limit_dir);
+	} else {
+		cgroup_limit = 0;
+	}
+	free(dir);
+}
+
+static void psi_init(void)
+{
+	if (psi_fd < 0)
+		psi_fd = open("/proc/pressure/memory", O_RDWR|O_NONBLOCK|O_CLOEXEC);
+
+	/* PSI may be disabled, or we may not be allowed to create triggers: */
+	if (psi_fd >= 0 &&
+	    write(psi_fd, PSI_TRIGGER, strlen(PSI_TRIGGER) + 1) < 0) {
+		close(psi_fd);
+		psi_fd = -1;
+	}
+}
+
+struct mem_pressure {
+	u64		want;		/* bytes to free */
+	u64		used;		/* against the limit we're shrinking for */
+	u64		limit;		/* tightest limit */
+	u64		limit_used;
+};
+
+static void mem_pressure_add(struct mem_pressure *p, u64 used, u64 limit)
+{
+	u64 target = limit - (limit >> 4);
+	u64 want = used > target ? used - target : 0;
+
+	if (want > p->want) {
+		p->want		= want;
+		p->used		= used;
+	}
+
+	if (!p->limit || limit < p->limit) {
+		p->limit	= limit;
+		p->limit_used	= used;
+	}
+}
+
+static void mem_pressure_get(struct mem_pressure *p)
+{
+	struct sysinfo info;
+	u64 limit;
+
+	memset(p, 0, sizeof(*p));
+
+	BUG_ON(syscall(SYS_sysinfo, &info));
+
+	/* Aim for 6% of physical RAM free without anything in swap */
+	mem_pressure_add(p,
+		(u64) (info.totalram - info.freeram +
+		       info.totalswap - info.freeswap) * info.mem_unit,
+		(u64) info.totalram * info.mem_unit);
+
+	if (cgroup_limit)
+		mem_pressure_add(p, cgroup_used(), cgroup_limit);
+
+	limit = READ_ONCE(memory_limit);
+	if (limit)
+		mem_pressure_add(p, rss_bytes(), limit);
+}
+
+/* Like the kernel's, but reports the tightest limit we're running under: */
+void si_meminfo(struct sysinfo *val)
+{
+	struct mem_pressure p;
+	u64 free;
+
+	BUG_ON(syscall(SYS_sysinfo, val));
+
+	mem_pressure_get(&p);
+
+	if (p.limit < (u64) val->totalram * val->mem_unit) {
+		free = p.limit - min(p.limit, p.limit_used);
+
+		val->totalram	= p.limit / val->mem_unit;
+		val->freeram	= min_t(u64, val->freeram, free / val->mem_unit);
+	}
+}
+
+static void shrinker_scan(struct shrinker *shrinker, struct shrink_control *sc)
+{
+	unsigned long freed = shrinker->scan_objects(shrinker, sc);
+
+	shrinker->nr_runs++;
+	shrinker->nr_scanned += sc->nr_to_scan;
+	if (freed != SHRINK_STOP)
+		shrinker->nr_freed += freed;
+}
+
+/*
+ * Each shrinker scans the same fraction of its objects, the fraction of memory
+ * we need to free - so big caches give back more, and shrinkers that aren't
+ * holding anything aren't asked for anything. Objects that are more expensive
+ * to recreate (higher seeks) are scanned less aggressively, as in the kernel.
+ *
+ * @frac is in units of 1/1024th.
+ */
+static void run_shrinkers_frac(gfp_t gfp_mask, u64 frac)
 {
 	struct shrinker *shrinker;
 
+	frac = min(frac, 1024ULL);
+
 	mutex_lock(&shrinker_lock);
 	list_for_each_entry(shrinker, &shrinker_list, list) {
 		struct shrink_control sc = { .gfp_mask	= gfp_mask, };
-
 		unsigned long have = shrinker->count_objects(shrinker, &sc);
+		unsigned seeks = shrinker->seeks ?: 1;
+		u64 nr;
 
-		sc.nr_to_scan = have / 8;
+		if (!have)
+			continue;
 
-		shrinker->scan_objects(shrinker, &sc);
+		nr = div_u64((u64) have * frac * DEFAULT_SEEKS, 1024 * seeks);
+		nr = clamp_t(u64, nr, min_t(u64, have, shrinker->batch ?: SHRINK_BATCH), have);
+
+		sc.nr_to_scan = nr;
+		shrinker_scan(shrinker, &sc);
 	}
 	mutex_unlock(&shrinker_lock);
 }
 
 void run_shrinkers(gfp_t gfp_mask, bool allocation_failed)
 {
-	struct shrinker *shrinker;
-	struct sysinfo info;
-	s64 want_shrink;
+	struct mem_pressure p;
 
 	if (!(gfp_mask & GFP_KERNEL))
 		return;
@@ -67,49 +336,85 @@ void run_shrinkers(gfp_t gfp_mask, bool allocation_failed)
 		return;
 
 	if (allocation_failed) {
-		run_shrinkers_allocation_failed(gfp_mask);
+		run_shrinkers_frac(gfp_mask, 1024 / 8);
 		return;
 	}
 
-	si_meminfo(&info);
-
-	/* Aim for 6% of physical RAM free without anything in swap */
-	want_shrink = (info.totalram >> 4) - info.freeram
-			+ info.totalswap - info.freeswap;
-	if (want_shrink <= 0)
+	mem_pressure_get(&p);
+	if (!p.want)
 		return;
 
+	run_shrinkers_frac(gfp_mask, div64_u64(p.want * 1024, max(p.used, 1ULL)));
+}
+
+void shrinkers_to_text(struct seq_buf *out)
+{
+	struct shrinker *shrinker;
+
+	seq_buf_printf(out, "%-32s %12s %12s %12s %12s\n",
+		       "shrinker", "objects", "runs", "scanned", "freed");
+
 	mutex_lock(&shrinker_lock);
 	list_for_each_entry(shrinker, &shrinker_list, list) {
-		struct shrink_control sc = {
-			.gfp_mask	= gfp_mask,
-			.nr_to_scan	= want_shrink >> PAGE_SHIFT
-		};
+		struct shrink_control sc = { .gfp_mask = GFP_KERNEL, };
+
+		seq_buf_printf(out, "%-32s %12lu %12llu %12llu %12llu\n",
+			       shrinker->name,
+			       shrinker->count_objects(shrinker, &sc),
+			       shrinker->nr_runs,
+			       shrinker->nr_scanned,
+			       shrinker->nr_freed);
 
-		shrinker->scan_objects(shrinker, &sc);
+		if (shrinker->to_text)
+			shrinker->to_text(out, shrinker);
 	}
 	mutex_unlock(&shrinker_lock);
 }
 
+/* Returns true if woken by a PSI event */
+static bool shrinker_wait(void)
+{
+	struct timespec to;
+	int v;
+
+	if (psi_fd >= 0) {
+		struct pollfd fds = { .fd = psi_fd, .events = POLLPRI };
+
+		return poll(&fds, 1, 1000) > 0 && (fds.revents & POLLPRI);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &to);
+	to.tv_sec += 1;
+	__set_current_state(TASK_INTERRUPTIBLE);
+	errno = 0;
+	while ((v = READ_ONCE(current->state)) != TASK_RUNNING &&
+	       errno != ETIMEDOUT)
+		futex(&current->state, FUTEX_WAIT_BITSET|FUTEX_PRIVATE_FLAG,
+		      v, &to, NULL, (uint32_t)~0);
+	if (v != TASK_RUNNING)
+		__set_current_state(TASK_RUNNING);
+	return false;
+}
+
 static int shrinker_thread(void *arg)
 {
 	while (!kthread_should_stop()) {
-		struct timespec to;
-		int v;
-
-		clock_gettime(CLOCK_MONOTONIC, &to);
-		to.tv_sec += 1;
-		__set_current_state(TASK_INTERRUPTIBLE);
-		errno = 0;
-		while ((v = READ_ONCE(current->state)) != TASK_RUNNING &&
-		       errno != ETIMEDOUT)
-			futex(&current->state, FUTEX_WAIT_BITSET|FUTEX_PRIVATE_FLAG,
-			      v, &to, NULL, (uint32_t)~0);
+		bool stalled = shrinker_wait();
+
 		if (kthread_should_stop())
 			break;
-		if (v != TASK_RUNNING)
-			__set_current_state(TASK_RUNNING);
-		run_shrinkers(GFP_KERNEL, false);
+
+		if (stalled && !list_empty(&shrinker_list)) {
+			struct mem_pressure p;
+
+			/* Stalling on memory: shrink even if we're under our limits */
+			mem_pressure_get(&p);
+			run_shrinkers_frac(GFP_KERNEL,
+				max(div64_u64(p.want * 1024, max(p.used, 1ULL)),
+				    1024ULL / 16));
+		} else {
+			run_shrinkers(GFP_KERNEL, false);
+		}
 	}
 
 	return 0;
@@ -117,9 +422,32 @@ static int shrinker_thread(void *arg)
 
 struct task_struct *shrinker_task;
 
+static void shrinker_stats_exit(void)
+{
+	char buf[8192];
+	struct seq_buf s;
+
+	seq_buf_init(&s, buf, sizeof(buf));
+	shrinkers_to_text(&s);
+	seq_buf_terminate(&s);
+	fputs(buf, stderr);
+}
+
 __attribute__((constructor(104)))
 static void shrinker_thread_init(void)
 {
+	const char *limit = getenv("BCACHEFS_MEMORY_LIMIT");
+
+	/* Parsed the same way as fsck --memory-limit: */
+	if (limit && bch2_strtou64_h(limit, &memory_limit))
+		die("invalid BCACHEFS_MEMORY_LIMIT=%s", limit);
+
+	if (getenv("BCACHEFS_SHRINKER_STATS"))
+		atexit(shrinker_stats_exit);
+
+	cgroup_init();
+	psi_init();
+
 	shrinker_task = kthread_run(shrinker_thread, NULL, "shrinkers");
 	BUG_ON(IS_ERR(shrinker_task));
 }
@@ -0,0 +1,560 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <linux/cache.h>
+#include <linux/kernel.h>
+#include <linux/list.h>
+#include <linux/shrinker.h>
+#include <linux/slab.h>
+
+/*
+ * Slab allocator for kmem_cache:
+ *
+ * Objects are carved out of SLAB_SIZE aligned slabs, so freeing an object
+ * finds its slab by masking its address; each slab has its own freelist.
+ *
+ * In front of the slabs, each thread has a magazine per cache - a stack of free
+ * objects - so the common case takes no locks and touches no shared
+ * cachelines. Magazines are refilled from and drained to the slabs in batches.
+ *
+ * Objects bigger than SLAB_MAX_OBJ_SIZE just come from kmalloc().
+ */
+
+#define SLAB_SIZE		(64U << 10)
+#define SLAB_MAX_OBJ_SIZE	(SLAB_SIZE / 8)
+#define SLAB_MAX_EMPTY		2	/* empty slabs kept per cache */
+
+#define SLAB_MAG_SIZE		64
+#define SLAB_MAG_BATCH		(SLAB_MAG_SIZE / 2)
+#define SLAB_MAX_CACHES		64	/* caches with magazines */
+
+struct slab {
+	struct list_head	list;
+	struct kmem_cache	*cache;
+	void			*freelist;
+	unsigned		inuse;
+};
+
+struct kmem_cache_magazine {
+	/* NULL once the cache has been destroyed: */
+	struct kmem_cache	*cache;
+	struct list_head	list;
+	unsigned		nr;
+	u64			alloc_hits;
+	u64			alloc_misses;
+	u64			free_hits;
+	u64			free_misses;
+	void			*objs[SLAB_MAG_SIZE];
+};
+
+struct kmem_cache {
+	const char		*name;
+	unsigned		obj_size;
+	unsigned		size;		/* object stride */
+	unsigned		free_offset;	/* of the freelist pointer */
+	unsigned		first_offset;	/* of the first object in a slab */
+	unsigned		objs_per_slab;
+	void			(*ctor)(void *);
+	int			idx;		/* into slab_mags, or -1 */
+
+	pthread_mutex_t		lock;
+	struct list_head	partial;
+	struct list_head	full;
+	struct list_head	empty;
+	unsigned		nr_slabs;
+	unsigned		nr_empty;
+	u64			inuse;		/* out of slabs, incl. magazines */
+	u64			large_inuse;	/* kmalloc()ed objects */
+
+	/* protected by slab_lock: */
+	struct list_head	magazines;
+	/* stats from magazines of exited threads: */
+	struct kmem_cache_stats	dead;
+};
+
+/* Protects caches' magazine lists and slab_cache_idx: */
+static pthread_mutex_t	slab_lock = PTHREAD_MUTEX_INITIALIZER;
+static u64		slab_cache_idx;
+
+static pthread_once_t	slab_once = PTHREAD_ONCE_INIT;
+static pthread_key_t	slab_mag_key;
+static __thread struct kmem_cache_magazine *slab_mags[SLAB_MAX_CACHES];
+
+static inline void **slab_free_ptr(struct kmem_cache *c, void *obj)
+{
+	return obj + c->free_offset;
+}
+
+static inline struct slab *obj_to_slab(void *obj)
+{
+	return (void *) ((unsigned long) obj & ~((unsigned long) SLAB_SIZE - 1));
+}
+
+static struct slab *slab_new(struct kmem_cache *c, gfp_t gfp)
+{
+	struct slab *s = NULL;
+	unsigned i;
+
+	for (i = 0; i < 10 && !s; i++) {
+		s = aligned_alloc(SLAB_SIZE, SLAB_SIZE);
+		if (!s)
+			run_shrinkers(gfp, true);
+	}
+
+	if (!s)
+		return NULL;
+
+	s->cache	= c;
+	s->freelist	= NULL;
+	s->inuse	= 0;
+
+	for (i = c->objs_per_slab; i--;) {
+		void *obj = (void *) s + c->first_offset + i * c->size;
+
+		/* Constructors run once, when objects are first created: */
+		if (c->ctor)
+			c->ctor(obj);
+
+		*slab_free_ptr(c, obj) = s->freelist;
+		s->freelist = obj;
+	}
+
+	return s;
+}
+
+/* Take up to @nr objects from partial and empty slabs: */
+static unsigned slab_get_objs(struct kmem_cache *c, void **objs, unsigned nr)
+{
+	unsigned got = 0;
+
+	while (got < nr) {
+		struct slab *s = list_first_entry_or_null(&c->partial, struct slab, list);
+
+		if (!s) {
+			s = list_first_entry_or_null(&c->empty, struct slab, list);
+			if (!s)
+				break;
+
+			list_move(&s->list, &c->partial);
+			c->nr_empty--;
+		}
+
+		while (got < nr && s->freelist) {
+			void *obj = s->freelist;
+
+			s->freelist = *slab_free_ptr(c, obj);
+			s->inuse++;
+			objs[got++] = obj;
+		}
+
+		if (!s->freelist)
+			list_move(&s->list, &c->full);
+	}
+
+	c->inuse += got;
+	return got;
+}
+
+/* Allocate at least @min, at most @max objects from the slabs: */
+static unsigned slab_alloc_objs(struct kmem_cache *c, void **objs,
+				unsigned min, unsigned max, gfp_t gfp)
+{
+	unsigned got = 0;
+
+	while (1) {
+		struct slab *s;
+
+		pthread_mutex_lock(&c->lock);
+		got += slab_get_objs(c, objs + got, max - got);
+		pthread_mutex_unlock(&c->lock);
+
+		if (got >= min)
+			break;
+
+		/* Not under the lock: constructors and shrinkers may allocate */
+		s = slab_new(c, gfp);
+		if (!s)
+			break;
+
+		pthread_mutex_lock(&c->lock);
+		list_add(&s->list, &c->empty);
+		c->nr_slabs++;
+		c->nr_empty++;
+		pthread_mutex_unlock(&c->lock);
+	}
+
+	return got;
+}
+
+static void slab_put_objs(struct kmem_cache *c, void **objs, unsigned nr)
+{
+	struct slab *s, *n;
+	LIST_HEAD(to_free);
+	unsigned i;
+
+	pthread_mutex_lock(&c->lock);
+	for (i = 0; i < nr; i++) {
+		void *obj = objs[i];
+
+		s = obj_to_slab(obj);
+		BUG_ON(s->cache != c);
+
+		if (!s->freelist)
+			list_move(&s->list, &c->partial);
+
+		*slab_free_ptr(c, obj) = s->freelist;
+		s->freelist = obj;
+
+		if (!--s->inuse) {
+			if (c->nr_empty < SLAB_MAX_EMPTY) {
+				list_move(&s->list, &c->empty);
+				c->nr_empty++;
+			} else {
+				list_move(&s->list, &to_free);
+				c->nr_slabs--;
+			}
+		}
+	}
+	c->inuse -= nr;
+	pthread_mutex_unlock(&c->lock);
+
+	list_for_each_entry_safe(s, n, &to_free, list)
+		free(s);
+}
+
+/* Return a magazine's objects and stats to its cache; slab_lock held: */
+static void slab_mag_drain(struct kmem_cache_magazine *m)
+{
+	struct kmem_cache *c = m->cache;
+
+	slab_put_objs(c, m->objs, m->nr);
+	m->nr = 0;
+
+	c->dead.alloc_hits	+= m->alloc_hits;
+	c->dead.alloc_misses	+= m->alloc_misses;
+	c->dead.free_hits	+= m->free_hits;
+	c->dead.free_misses	+= m->free_misses;
+
+	list_del_init(&m->list);
+	m->cache = NULL;
+}
+
+static void slab_mags_exit(void *arg)
+{
+	unsigned i;
+
+	for (i = 0; i < SLAB_MAX_CACHES; i++) {
+		struct kmem_cache_magazine *m = slab_mags[i];
+
+		if (!m)
+			continue;
+
+		slab_mags[i] = NULL;
+
+		pthread_mutex_lock(&slab_lock);
+		if (m->cache)
+			slab_mag_drain(m);
+		pthread_mutex_unlock(&slab_lock);
+
+		free(m);
+	}
+}
+
+static void slab_init_once(void)
+{
+	BUG_ON(pthread_key_create(&slab_mag_key, slab_mags_exit));
+}
+
+static noinline struct kmem_cache_magazine *slab_mag_new(struct kmem_cache *c)
+{
+	struct kmem_cache_magazine *m = slab_mags[c->idx];
+
+	/* Left over from a cache that's since been destroyed: */
+	free(m);
+	slab_mags[c->idx] = NULL;
+
+	m = calloc(1, sizeof(*m));
+	if (!m)
+		return NULL;
+
+	m->cache = c;
+
+	pthread_mutex_lock(&slab_lock);
+	list_add(&m->list, &c->magazines);
+	pthread_mutex_unlock(&slab_lock);
+
+	slab_mags[c->idx] = m;
+
+	/* So slab_mags_exit() gets called: */
+	pthread_once(&slab_once, slab_init_once);
+	pthread_setspecific(slab_mag_key, slab_mags);
+	return m;
+}
+
+static inline struct kmem_cache_magazine *slab_mag(struct kmem_cache *c)
+{
+	struct kmem_cache_magazine *m;
+
+	if (unlikely(c->idx < 0))
+		return NULL;
+
+	m = slab_mags[c->idx];
+	if (likely(m && m->cache == c))
+		return m;
+
+	return slab_mag_new(c);
+}
+
+static inline bool kmem_cache_is_large(struct kmem_cache *c)
+{
+	return c->size > SLAB_MAX_OBJ_SIZE;
+}
+
+static void *kmem_cache_alloc_large(struct kmem_cache *c, gfp_t gfp)
+{
+	void *p = kmalloc(c->obj_size, gfp & ~__GFP_ZERO);
+
+	if (p) {
+		if (c->ctor)
+			c->ctor(p);
+		__atomic_add_fetch(&c->large_inuse, 1, __ATOMIC_RELAXED);
+	}
+
+	return p;
+}
+
+static void kmem_cache_free_large(struct kmem_cache *c, void *p)
+{
+	__atomic_sub_fetch(&c->large_inuse, 1, __ATOMIC_RELAXED);
+	kfree(p);
+}
+
+void *kmem_cache_alloc(struct kmem_cache *c, gfp_t gfp)
+{
+	struct kmem_cache_magazine *m;
+	void *p = NULL;
+
+	if (unlikely(kmem_cache_is_large(c))) {
+		p = kmem_cache_alloc_large(c, gfp);
+		goto out;
+	}
+
+	m = slab_mag(c);
+	if (likely(m && m->nr)) {
+		m->alloc_hits++;
+		p = m->objs[--m->nr];
+	} else if (m) {
+		m->alloc_misses++;
+		m->nr = slab_alloc_objs(c, m->objs, 1, SLAB_MAG_BATCH, gfp);
+		if (m->nr)
+			p = m->objs[--m->nr];
+	} else {
+		slab_alloc_objs(c, &p, 1, 1, gfp);
+	}
+out:
+	if (p && (gfp & __GFP_ZERO))
+		memset(p, 0, c->obj_size);
+	return p;
+}
+
+void kmem_cache_free(struct kmem_cache *c, void *p)
+{
+	struct kmem_cache_magazine *m;
+
+	if (!p)
+		return;
+
+	if (unlikely(kmem_cache_is_large(c))) {
+		kmem_cache_free_large(c, p);
+		return;
+	}
+
+	m = slab_mag(c);
+	if (likely(m && m->nr < SLAB_MAG_SIZE)) {
+		m->free_hits++;
+		m->objs[m->nr++] = p;
+	} else if (m) {
+		/* Return the coldest objects, from the bottom of the stack: */
+		m->free_misses++;
+		slab_put_objs(c, m->objs, SLAB_MAG_BATCH);
+		memmove(m->objs, m->objs + SLAB_MAG_BATCH,
+			(SLAB_MAG_SIZE - SLAB_MAG_BATCH) * sizeof(m->objs[0]));
+		m->nr -= SLAB_MAG_BATCH;
+		m->objs[m->nr++] = p;
+	} else {
+		slab_put_objs(c, &p, 1);
+	}
+}
+
+int kmem_cache_alloc_bulk(struct kmem_cache *c, gfp_t gfp, size_t nr, void **p)
+{
+	struct kmem_cache_magazine *m;
+	size_t i = 0;
+
+	if (unlikely(kmem_cache_is_large(c))) {
+		for (i = 0; i < nr; i++)
+			if (!(p[i] = kmem_cache_alloc(c, gfp)))
+				goto err;
+		return nr;
+	}
+
+	m = slab_mag(c);
+	if (m) {
+		i = min_t(size_t, nr, m->nr);
+		m->nr -= i;
+		memcpy(p, m->objs + m->nr, i * sizeof(p[0]));
+		m->alloc_hits += i;
+	}
+
+	if (i < nr) {
+		if (m)
+			m->alloc_misses++;
+
+		i += slab_alloc_objs(c, p + i, nr - i, nr - i, gfp);
+		if (i < nr)
+			goto err;
+	}
+
+	if (gfp & __GFP_ZERO)
+		for (i = 0; i < nr; i++)
+			memset(p[i], 0, c->obj_size);
+	return nr;
+err:
+	kmem_cache_free_bulk(c, i, p);
+	return 0;
+}
+
+void kmem_cache_free_bulk(struct kmem_cache *c, size_t nr, void **p)
+{
+	struct kmem_cache_magazine *m;
+	size_t i = 0;
+
+	if (unlikely(kmem_cache_is_large(c))) {
+		for (i = 0; i < nr; i++)
+			kmem_cache_free_large(c, p[i]);
+		return;
+	}
+
+	m = slab_mag(c);
+	if (m) {
+		i = min_t(size_t, nr, SLAB_MAG_SIZE - m->nr);
+		memcpy(m->objs + m->nr, p, i * sizeof(p[0]));
+		m->nr += i;
+		m->free_hits += i;
+	}
+
+	if (i < nr) {
+		if (m)
+			m->free_misses++;
+		slab_put_objs(c, p + i, nr - i);
+	}
+}
+
+void kmem_cache_stats(struct kmem_cache *c, struct kmem_cache_stats *stats)
+{
+	struct kmem_cache_magazine *m;
+	u64 in_mags = 0;
+
+	pthread_mutex_lock(&slab_lock);
+	*stats = c->dead;
+
+	/* Other threads' counters: racy, but they're only stats */
+	list_for_each_entry(m, &c->magazines, list) {
+		in_mags			+= READ_ONCE(m->nr);
+		stats->alloc_hits	+= READ_ONCE(m->alloc_hits);
+		stats->alloc_misses	+= READ_ONCE(m->alloc_misses);
+		stats->free_hits	+= READ_ONCE(m->free_hits);
+		stats->free_misses	+= READ_ONCE(m->free_misses);
+	}
+
+	pthread_mutex_lock(&c->lock);
+	stats->active_objs	= c->inuse - in_mags;
+	stats->total_objs	= (u64) c->nr_slabs * c->objs_per_slab;
+	stats->slabs		= c->nr_slabs;
+	stats->pages		= (u64) c->nr_slabs * (SLAB_SIZE / PAGE_SIZE);
+	pthread_mutex_unlock(&c->lock);
+	pthread_mutex_unlock(&slab_lock);
+
+	stats->active_objs += __atomic_load_n(&c->large_inuse, __ATOMIC_RELAXED);
+}
+
+struct kmem_cache *kmem_cache_create(const char *name, unsigned obj_size,
+				     unsigned align, slab_flags_t flags,
+				     void (*ctor)(void *))
+{
+	struct kmem_cache *c = kzalloc(sizeof(*c), GFP_KERNEL);
+	if (!c)
+		return NULL;
+
+	align = max_t(unsigned, align, sizeof(void *));
+	if ((flags & SLAB_HWCACHE_ALIGN) && obj_size > L1_CACHE_BYTES / 2)
+		align = max_t(unsigned, align, L1_CACHE_BYTES);
+	align = roundup_pow_of_two(align);
+
+	c->name		= name;
+	c->obj_size	= max_t(unsigned, obj_size, 1);
+	c->ctor		= ctor;
+
+	/*
+	 * Constructed objects have to keep their contents while free, so the
+	 * freelist pointer goes after the object instead of in it:
+	 */
+	c->free_offset	= ctor ? round_up(c->obj_size, sizeof(void *)) : 0;
+	c->size		= round_up(max_t(unsigned, c->obj_size,
+					 c->free_offset + sizeof(void *)), align);
+	c->first_offset	= round_up(sizeof(struct slab), align);
+	c->objs_per_slab = c->size <= SLAB_MAX_OBJ_SIZE
+		? (SLAB_SIZE - c->first_offset) / c->size
+		: 0;
+
+	pthread_mutex_init(&c->lock, NULL);
+	INIT_LIST_HEAD(&c->partial);
+	INIT_LIST_HEAD(&c->full);
+	INIT_LIST_HEAD(&c->empty);
+	INIT_LIST_HEAD(&c->magazines);
+
+	pthread_mutex_lock(&slab_lock);
+	if (~slab_cache_idx) {
+		c->idx = __builtin_ctzll(~slab_cache_idx);
+		slab_cache_idx |= 1ULL << c->idx;
+	} else {
+		/* Out of magazine slots, always go to the slabs: */
+		c->idx = -1;
+	}
+	pthread_mutex_unlock(&slab_lock);
+
+	return c;
+}
+
+void kmem_cache_destroy(struct kmem_cache *c)
+{
+	struct kmem_cache_magazine *m, *n;
+	struct slab *s, *s2;
+	LIST_HEAD(slabs);
+
+	if (!c)
+		return;
+
+	/* The cache must no longer be in use, so we can drain every thread's magazine: */
+	pthread_mutex_lock(&slab_lock);
+	list_for_each_entry_safe(m, n, &c->magazines, list)
+		slab_mag_drain(m);
+
+	if (c->idx >= 0)
+		slab_cache_idx &= ~(1ULL << c->idx);
+	pthread_mutex_unlock(&slab_lock);
+
+	WARN(c->inuse || c->large_inuse,
+	     "kmem_cache %s: %llu objects remaining on destroy",
+	     c->name, c->inuse + c->large_inuse);
+
+	list_splice_init(&c->partial, &slabs);
+	list_splice_init(&c->full, &slabs);
+	list_splice_init(&c->empty, &slabs);
+	list_for_each_entry_safe(s, s2, &slabs, list)
+		free(s);
+
+	pthread_mutex_destroy(&c->lock);
+	kfree(c);
+}
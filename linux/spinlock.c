@@ -0,0 +1,187 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <linux/futex.h>
+#include <urcu/futex.h>
+
+#include <linux/jiffies.h>
+#include <linux/kernel.h>
+#include <linux/sort.h>
+#include <linux/time64.h>
+#include <linux/spinlock.h>
+
+/*
+ * How long to spin on a held lock before sleeping: critical sections under a
+ * spinlock are short, so if the holder is running it'll usually be done before
+ * a futex wait would even get going:
+ */
+#define SPIN_MAX_SPINS		200
+
+void __raw_spin_lock_slowpath(raw_spinlock_t *lock)
+{
+	unsigned spins;
+
+	for (spins = 0; spins < SPIN_MAX_SPINS; spins++) {
+		u32 v = READ_ONCE(lock->v);
+
+		/* Don't spin ahead of threads already asleep: */
+		if (v == SPIN_CONTENDED)
+			break;
+
+		if (v == SPIN_UNLOCKED && __raw_spin_trylock(lock))
+			return;
+
+		cpu_relax();
+	}
+
+	/*
+	 * Mark the lock contended before sleeping, so the unlock knows to wake
+	 * us; having done so, we have to take the lock as contended too, since
+	 * we can't know whether there are other sleepers:
+	 */
+	while (__atomic_exchange_n(&lock->v, SPIN_CONTENDED,
+				   __ATOMIC_ACQUIRE) != SPIN_UNLOCKED)
+		futex((int32_t *) &lock->v, FUTEX_WAIT_PRIVATE, SPIN_CONTENDED,
+		      NULL, NULL, 0);
+}
+
+void __raw_spin_wake(raw_spinlock_t *lock)
+{
+	futex((int32_t *) &lock->v, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+#ifdef CONFIG_SPINLOCK_STATS
+
+/* Locks initialized statically, or by zeroing, have no class of their own: */
+static struct spinlock_class spinlock_class_static = {
+	.name		= "(static)",
+	.file		= "",
+	.registered	= true,
+};
+
+static struct spinlock_class *spinlock_classes = &spinlock_class_static;
+
+void __raw_spin_lock_init(raw_spinlock_t *lock, struct spinlock_class *class)
+{
+	lock->v			= SPIN_UNLOCKED;
+	lock->class		= class;
+	lock->acquired_ns	= 0;
+
+	/* Classes are static, and only ever added to the list: */
+	if (!READ_ONCE(class->registered) &&
+	    !__atomic_exchange_n(&class->registered, true, __ATOMIC_RELAXED)) {
+		struct spinlock_class *old = READ_ONCE(spinlock_classes);
+
+		do {
+			class->next = old;
+		} while (!__atomic_compare_exchange_n(&spinlock_classes, &old, class,
+						      false, __ATOMIC_RELEASE,
+						      __ATOMIC_RELAXED));
+	}
+}
+
+static inline struct spinlock_class *lock_class(raw_spinlock_t *lock)
+{
+	return lock->class ?: &spinlock_class_static;
+}
+
+static inline void lock_acquired(raw_spinlock_t *lock)
+{
+	__atomic_add_fetch(&lock_class(lock)->acquired, 1, __ATOMIC_RELAXED);
+	lock->acquired_ns = ktime_get_mono_fast_ns();
+}
+
+bool raw_spin_trylock(raw_spinlock_t *lock)
+{
+	bool ret = __raw_spin_trylock(lock);
+
+	if (ret)
+		lock_acquired(lock);
+	return ret;
+}
+
+void raw_spin_lock(raw_spinlock_t *lock)
+{
+	if (unlikely(!__raw_spin_trylock(lock))) {
+		struct spinlock_class *class = lock_class(lock);
+		u64 start = ktime_get_mono_fast_ns();
+
+		__raw_spin_lock_slowpath(lock);
+
+		__atomic_add_fetch(&class->contended, 1, __ATOMIC_RELAXED);
+		__atomic_add_fetch(&class->wait_ns, ktime_get_mono_fast_ns() - start,
+				   __ATOMIC_RELAXED);
+	}
+
+	lock_acquired(lock);
+}
+
+void raw_spin_unlock(raw_spinlock_t *lock)
+{
+	struct spinlock_class *class = lock_class(lock);
+	u64 held = ktime_get_mono_fast_ns() - lock->acquired_ns;
+	u64 max = READ_ONCE(class->max_hold_ns);
+
+	__atomic_add_fetch(&class->hold_ns, held, __ATOMIC_RELAXED);
+	while (held > max &&
+	       !__atomic_compare_exchange_n(&class->max_hold_ns, &max, held,
+					    false, __ATOMIC_RELAXED,
+					    __ATOMIC_RELAXED))
+		;
+
+	__raw_spin_unlock(lock);
+}
+
+static int spinlock_class_cmp(const void *_l, const void *_r)
+{
+	const struct spinlock_class *l = *((struct spinlock_class **) _l);
+	const struct spinlock_class *r = *((struct spinlock_class **) _r);
+
+	if (l->contended != r->contended)
+		return l->contended < r->contended ? 1 : -1;
+	if (l->acquired != r->acquired)
+		return l->acquired < r->acquired ? 1 : -1;
+	return 0;
+}
+
+/* Classes that were used, most contended first, to stderr: */
+__attribute__((destructor(105)))
+static void spinlock_stats_exit(void)
+{
+	struct spinlock_class *c, **classes;
+	size_t i, nr = 0;
+
+	for (c = spinlock_classes; c; c = c->next)
+		nr += c->acquired != 0;
+	if (!nr)
+		return;
+
+	classes = malloc(nr * sizeof(*classes));
+	if (!classes)
+		return;
+
+	nr = 0;
+	for (c = spinlock_classes; c; c = c->next)
+		if (c->acquired)
+			classes[nr++] = c;
+
+	sort(classes, nr, sizeof(classes[0]), spinlock_class_cmp, NULL);
+
+	fprintf(stderr, "%12s %12s %12s %12s %12s  %s\n",
+		"acquired", "contended", "wait_ns", "hold_avg_ns", "hold_max_ns",
+		"class");
+	for (i = 0; i < nr; i++) {
+		c = classes[i];
+		fprintf(stderr, "%12llu %12llu %12llu %12llu %12llu  %s",
+			c->acquired, c->contended, c->wait_ns,
+			c->hold_ns / c->acquired, c->max_hold_ns, c->name);
+		if (c->line)
+			fprintf(stderr, " (%s:%u)", c->file, c->line);
+		fputc('\n', stderr);
+	}
+
+	free(classes);
+}
+
+#endif /* CONFIG_SPINLOCK_STATS */
@@ -0,0 +1,698 @@
+#include <ctype.h>
+#include <dlfcn.h>
+#include <fnmatch.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <linux/jiffies.h>
+#include <linux/kernel.h>
+#include <linux/list.h>
+#include <linux/log2.h>
+#include <linux/time64.h>
+#include <linux/tracepoint.h>
+
+#include "tools-util.h"
+
+/*
+ * Userspace trace events:
+ *
+ * Each thread records events to its own ring buffer - single producer, single
+ * consumer, so recording an event is a few plain stores and a store-release of
+ * the head, with no locking or shared cachelines. If the buffer is full the
+ * event is dropped and counted; we never block.
+ *
+ * A flusher thread drains the buffers to the trace file every
+ * TRACE_FLUSH_INTERVAL_MS; the file is read by `bcachefs trace`.
+ *
+ * With BCACHEFS_TRACE=<file> we start tracing at startup, with the events
+ * matching BCACHEFS_TRACE_EVENTS (comma separated globs, default all) enabled.
+ */
+
+#define TRACE_FLUSH_INTERVAL_MS	50
+
+/* Events are found via the __trace_events section - see trace_events.h: */
+extern struct trace_event * const __start___trace_events[] __attribute__((weak));
+extern struct trace_event * const __stop___trace_events[] __attribute__((weak));
+
+#define for_each_trace_event(_e, _i)					\
+	for (_i = __start___trace_events;				\
+	     _i < __stop___trace_events && ((_e = *_i), true);		\
+	     _i++)
+
+struct trace_buf {
+	struct list_head	list;
+	u32			pid;
+	bool			dead;		/* owning thread exited */
+	u64			head;		/* written by the owning thread */
+	u64			tail;		/* written by the flusher */
+	u64			dropped;
+	u64			dropped_written;
+	u8			data[] __aligned(8);
+};
+
+static unsigned		trace_buf_size = 1U << 20;
+static pthread_key_t	trace_buf_key;
+static bool		trace_recording;
+
+/* Protects the list of buffers, the trace file and the flusher: */
+static pthread_mutex_t	trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t	trace_flusher_wait = PTHREAD_COND_INITIALIZER;
+static LIST_HEAD(trace_bufs);
+static FILE		*trace_file;
+static pthread_t	trace_flusher;
+static bool		trace_flusher_stop;
+static bool		trace_write_failed;
+
+static __thread struct trace_buf *trace_buf;
+static __thread u64	trace_reserved_head;
+/* Set while recording an event, and in threads that mustn't record: */
+static __thread bool	trace_recursion;
+
+/* Difference between our text base and the recording process's: */
+static long		trace_text_reloc;
+
+static pthread_once_t	trace_events_once = PTHREAD_ONCE_INIT;
+
+static void trace_buf_exit(void *p)
+{
+	struct trace_buf *b = p;
+
+	/* Later thread-exit destructors mustn't record to a freed buffer: */
+	trace_recursion = true;
+	smp_store_release(&b->dead, true);
+}
+
+static void trace_events_init(void)
+{
+	struct trace_event * const *i;
+	struct trace_event *e;
+
+	for_each_trace_event(e, i)
+		e->id = i - __start___trace_events;
+
+	BUG_ON(pthread_key_create(&trace_buf_key, trace_buf_exit));
+}
+
+static noinline struct trace_buf *trace_buf_alloc(void)
+{
+	struct trace_buf *b;
+
+	trace_recursion = true;
+	b = calloc(1, sizeof(*b) + trace_buf_size);
+	trace_recursion = false;
+	if (!b)
+		return NULL;
+
+	b->pid = syscall(SYS_gettid);
+
+	pthread_mutex_lock(&trace_lock);
+	list_add_tail(&b->list, &trace_bufs);
+	pthread_mutex_unlock(&trace_lock);
+
+	pthread_setspecific(trace_buf_key, b);
+	return trace_buf = b;
+}
+
+void *trace_event_reserve(struct trace_event *event, size_t size)
+{
+	struct trace_buf *b;
+	struct trace_entry *e;
+	u64 head, tail, offset, pad;
+
+	if (!READ_ONCE(trace_recording) || trace_recursion)
+		return NULL;
+
+	b = trace_buf ?: trace_buf_alloc();
+	if (unlikely(!b))
+		return NULL;
+
+	size	= round_up(size, 8);
+	head	= b->head;
+	tail	= smp_load_acquire(&b->tail);
+	offset	= head & (trace_buf_size - 1);
+	/* Entries don't wrap; pad out the end of the buffer if needed: */
+	pad	= offset + size > trace_buf_size ? trace_buf_size - offset : 0;
+
+	if (unlikely(size > U16_MAX ||
+		     head + pad + size - tail > trace_buf_size)) {
+		WRITE_ONCE(b->dropped, b->dropped + 1);
+		return NULL;
+	}
+
+	if (pad) {
+		/* Only id and size are read from padding: */
+		e = (void *) b->data + offset;
+		e->id	= TRACE_ID_PAD;
+		e->size	= pad;
+		head	+= pad;
+		offset	= 0;
+	}
+
+	e = (void *) b->data + offset;
+	e->id	= event->id;
+	e->size	= size;
+	e->pid	= b->pid;
+	e->time	= ktime_get_mono_fast_ns();
+
+	trace_reserved_head	= head + size;
+	trace_recursion		= true;
+	return e;
+}
+
+void trace_event_commit(void *entry)
+{
+	smp_store_release(&trace_buf->head, trace_reserved_head);
+	trace_recursion = false;
+}
+
+/* Flushing: */
+
+/*
+ * A trace is a debugging aid, so failing to write it (e.g. a full disk) mustn't
+ * take down what's being traced: stop recording, and drop what's buffered.
+ */
+static void trace_write_error(void)
+{
+	if (!trace_write_failed) {
+		fprintf(stderr, "error writing trace, tracing stopped: %m\n");
+		trace_write_failed = true;
+		WRITE_ONCE(trace_recording, false);
+	}
+}
+
+static void trace_write(const void *p, size_t size)
+{
+	if (!trace_write_failed &&
+	    fwrite(p, size, 1, trace_file) != 1)
+		trace_write_error();
+}
+
+static void trace_buf_flush(struct trace_buf *b)
+{
+	u64 tail = b->tail, head = smp_load_acquire(&b->head);
+	u64 dropped = READ_ONCE(b->dropped);
+
+	if (unlikely(trace_write_failed)) {
+		smp_store_release(&b->tail, head);
+		b->dropped_written = dropped;
+		return;
+	}
+
+	while (tail != head) {
+		struct trace_entry *e = (void *) b->data + (tail & (trace_buf_size - 1));
+
+		if (e->id != TRACE_ID_PAD)
+			trace_write(e, e->size);
+		tail += e->size;
+	}
+	smp_store_release(&b->tail, tail);
+
+	if (dropped != b->dropped_written) {
+		struct trace_entry_dropped d = {
+			.ent.id		= TRACE_ID_DROPPED,
+			.ent.size	= sizeof(d),
+			.ent.pid	= b->pid,
+			.ent.time	= ktime_get_mono_fast_ns(),
+			.nr		= dropped - b->dropped_written,
+		};
+
+		trace_write(&d, sizeof(d));
+		b->dropped_written = dropped;
+	}
+}
+
+static void trace_flush(void)
+{
+	struct trace_buf *b, *n;
+
+	list_for_each_entry_safe(b, n, &trace_bufs, list) {
+		/* Check before flushing: the thread can't record after exiting */
+		bool dead = smp_load_acquire(&b->dead);
+
+		if (trace_file)
+			trace_buf_flush(b);
+
+		if (dead) {
+			list_del(&b->list);
+			free(b);
+		}
+	}
+
+	if (trace_file && !trace_write_failed && fflush(trace_file))
+		trace_write_error();
+}
+
+static void *trace_flusher_thread(void *arg)
+{
+	trace_recursion = true;
+
+	pthread_mutex_lock(&trace_lock);
+	while (!trace_flusher_stop) {
+		struct timespec to;
+
+		clock_gettime(CLOCK_REALTIME, &to);
+		to.tv_nsec += TRACE_FLUSH_INTERVAL_MS * NSEC_PER_MSEC;
+		if (to.tv_nsec >= NSEC_PER_SEC) {
+			to.tv_sec++;
+			to.tv_nsec -= NSEC_PER_SEC;
+		}
+
+		pthread_cond_timedwait(&trace_flusher_wait, &trace_lock, &to);
+		trace_flush();
+	}
+	pthread_mutex_unlock(&trace_lock);
+
+	return NULL;
+}
+
+int trace_start(const char *path)
+{
+	struct trace_file_header h = {
+		.magic		= TRACE_FILE_MAGIC,
+		.version	= TRACE_FILE_VERSION,
+		.nr_events	= __stop___trace_events - __start___trace_events,
+		.text_base	= (unsigned long) trace_start,
+	};
+	struct trace_event * const *i;
+	struct trace_event *e;
+	struct trace_buf *b;
+	int ret = 0;
+
+	pthread_once(&trace_events_once, trace_events_init);
+
+	pthread_mutex_lock(&trace_lock);
+	if (trace_file) {
+		ret = -EBUSY;
+		goto out;
+	}
+
+	trace_file = fopen(path, "w");
+	if (!trace_file) {
+		ret = -errno;
+		goto out;
+	}
+	setvbuf(trace_file, NULL, _IOFBF, 1 << 20);
+	trace_write_failed = false;
+
+	trace_write(&h, sizeof(h));
+	for_each_trace_event(e, i) {
+		struct trace_file_event fe = {
+			.id	= e->id,
+			.size	= e->size,
+		};
+
+		strscpy(fe.system, e->system, sizeof(fe.system));
+		strscpy(fe.name, e->name, sizeof(fe.name));
+		trace_write(&fe, sizeof(fe));
+	}
+
+	if (trace_write_failed) {
+		ret = -EIO;
+		fclose(trace_file);
+		trace_file = NULL;
+		goto out;
+	}
+
+	/* Don't write out events recorded before a previous trace_stop(): */
+	list_for_each_entry(b, &trace_bufs, list) {
+		b->tail			= smp_load_acquire(&b->head);
+		b->dropped_written	= READ_ONCE(b->dropped);
+	}
+
+	trace_flusher_stop = false;
+	ret = -pthread_create(&trace_flusher, NULL, trace_flusher_thread, NULL);
+	if (ret) {
+		fclose(trace_file);
+		trace_file = NULL;
+		goto out;
+	}
+
+	WRITE_ONCE(trace_recording, true);
+out:
+	pthread_mutex_unlock(&trace_lock);
+	return ret;
+}
+
+void trace_stop(void)
+{
+	pthread_mutex_lock(&trace_lock);
+	if (!trace_file) {
+		pthread_mutex_unlock(&trace_lock);
+		return;
+	}
+
+	WRITE_ONCE(trace_recording, false);
+	trace_flusher_stop = true;
+	pthread_cond_signal(&trace_flusher_wait);
+	pthread_mutex_unlock(&trace_lock);
+
+	pthread_join(trace_flusher, NULL);
+
+	pthread_mutex_lock(&trace_lock);
+	trace_flush();
+	if (fclose(trace_file) && !trace_write_failed)
+		fprintf(stderr, "error writing trace: %m\n");
+	trace_file = NULL;
+	pthread_mutex_unlock(&trace_lock);
+}
+
+/* Events: */
+
+int trace_events_enable(const char *pattern, bool enable)
+{
+	struct trace_event * const *i;
+	struct trace_event *e;
+	const char *name = pattern, *colon = strchr(pattern, ':');
+	char system[32] = "*";
+	unsigned nr = 0;
+
+	pthread_once(&trace_events_once, trace_events_init);
+
+	if (!strcmp(pattern, "all"))
+		name = "*";
+
+	if (colon) {
+		snprintf(system, sizeof(system), "%.*s",
+			 (int) (colon - pattern), pattern);
+		name = colon + 1;
+	}
+
+	for_each_trace_event(e, i)
+		if (!fnmatch(system, e->system, 0) &&
+		    !fnmatch(name, e->name, 0)) {
+			WRITE_ONCE(e->enabled, enable);
+			nr++;
+		}
+
+	return nr ? 0 : -ENOENT;
+}
+
+struct trace_event *trace_event_lookup(const char *system, const char *name)
+{
+	struct trace_event * const *i;
+	struct trace_event *e;
+
+	pthread_once(&trace_events_once, trace_events_init);
+
+	for_each_trace_event(e, i)
+		if (!strcmp(e->system, system) &&
+		    !strcmp(e->name, name))
+			return e;
+	return NULL;
+}
+
+void trace_events_list(struct printbuf *out)
+{
+	struct trace_event * const *i;
+	struct trace_event *e;
+
+	pthread_once(&trace_events_once, trace_events_init);
+
+	for_each_trace_event(e, i)
+		prt_printf(out, "%s:%s%s\n", e->system, e->name,
+			   e->enabled ? " [enabled]" : "");
+}
+
+/* Printing: */
+
+void trace_print_set_text_base(u64 text_base)
+{
+	trace_text_reloc = (unsigned long) trace_start - text_base;
+}
+
+static void prt_symbol(struct printbuf *out, unsigned long ip, bool offset)
+{
+	Dl_info info;
+
+	ip += trace_text_reloc;
+
+	if (!dladdr((void *) ip, &info))
+		prt_printf(out, "0x%lx", ip);
+	else if (info.dli_sname) {
+		prt_printf(out, "%s", info.dli_sname);
+		if (offset)
+			prt_printf(out, "+0x%lx", ip - (unsigned long) info.dli_saddr);
+	} else {
+		/* Not exported - good enough for addr2line: */
+		const char *file = strrchr(info.dli_fname, '/');
+
+		prt_printf(out, "%s+0x%lx", file ? file + 1 : info.dli_fname,
+			   ip - (unsigned long) info.dli_fbase);
+	}
+}
+
+#define prt_spec(_out, _spec, _star, _nr_star, _v)			\
+do {									\
+	switch (_nr_star) {						\
+	case 0:								\
+		prt_printf(_out, _spec, _v);				\
+		break;							\
+	case 1:								\
+		prt_printf(_out, _spec, _star[0], _v);			\
+		break;							\
+	default:							\
+		prt_printf(_out, _spec, _star[0], _star[1], _v);	\
+		break;							\
+	}								\
+} while (0)
+
+/*
+ * The printbuf printf is vsnprintf(), which doesn't know the kernel's %p
+ * extensions, so we go one conversion at a time:
+ */
+void trace_event_printf(struct printbuf *out, const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	while (*fmt) {
+		const char *p = strchrnul(fmt, '%');
+		char spec[32], len[3] = "";
+		unsigned n = 0, nr_star = 0;
+		int star[2];
+
+		if (p != fmt)
+			prt_printf(out, "%.*s", (int) (p - fmt), fmt);
+		if (!*p)
+			break;
+
+		spec[n++] = *p++;
+		if (*p == '%') {
+			prt_printf(out, "%%");
+			fmt = p + 1;
+			continue;
+		}
+
+		while (*p && strchr("-+ #0", *p) && n < 8)
+			spec[n++] = *p++;
+
+		for (unsigned j = 0; j < 2; j++) {
+			if (j) {
+				if (*p != '.')
+					break;
+				spec[n++] = *p++;
+			}
+
+			if (*p == '*') {
+				star[nr_star++] = va_arg(args, int);
+				spec[n++] = *p++;
+			} else {
+				while (isdigit(*p) && n < 20)
+					spec[n++] = *p++;
+			}
+		}
+
+		while (*p && strchr("hlzjtL", *p) && strlen(len) < 2) {
+			len[strlen(len)] = *p;
+			spec[n++] = *p++;
+		}
+
+		spec[n++] = *p;
+		spec[n] = '\0';
+
+		switch (*p) {
+		case 'd':
+		case 'i':
+			if (!strcmp(len, "l"))
+				prt_spec(out, spec, star, nr_star, va_arg(args, long));
+			else if (!strcmp(len, "ll"))
+				prt_spec(out, spec, star, nr_star, va_arg(args, long long));
+			else if (!strcmp(len, "z"))
+				prt_spec(out, spec, star, nr_star, va_arg(args, ssize_t));
+			else if (!strcmp(len, "j"))
+				prt_spec(out, spec, star, nr_star, va_arg(args, intmax_t));
+			else if (!strcmp(len, "t"))
+				prt_spec(out, spec, star, nr_star, va_arg(args, ptrdiff_t));
+			else
+				prt_spec(out, spec, star, nr_star, va_arg(args, int));
+			break;
+		case 'u':
+		case 'x':
+		case 'X':
+		case 'o':
+			if (!strcmp(len, "l"))
+				prt_spec(out, spec, star, nr_star, va_arg(args, unsigned long));
+			else if (!strcmp(len, "ll"))
+				prt_spec(out, spec, star, nr_star, va_arg(args, unsigned long long));
+			else if (!strcmp(len, "z"))
+				prt_spec(out, spec, star, nr_star, va_arg(args, size_t));
+			else if (!strcmp(len, "j"))
+				prt_spec(out, spec, star, nr_star, va_arg(args, uintmax_t));
+			else if (!strcmp(len, "t"))
+				prt_spec(out, spec, star, nr_star, va_arg(args, ptrdiff_t));
+			else
+				prt_spec(out, spec, star, nr_star, va_arg(args, unsigned));
+			break;
+		case 'c':
+			prt_spec(out, spec, star, nr_star, va_arg(args, int));
+			break;
+		case 'e':
+		case 'E':
+		case 'f':
+		case 'F':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+			if (!strcmp(len, "L"))
+				prt_spec(out, spec, star, nr_star, va_arg(args, long double));
+			else
+				prt_spec(out, spec, star, nr_star, va_arg(args, double));
+			break;
+		case 's':
+			prt_spec(out, spec, star, nr_star, va_arg(args, const char *));
+			break;
+		case 'p': {
+			void *v = va_arg(args, void *);
+
+			switch (p[1]) {
+			case 'S':
+			case 's':
+			case 'B':
+				prt_symbol(out, (unsigned long) v, p[1] != 's');
+				p++;
+				break;
+			case 'x':
+				prt_printf(out, "%016lx", (unsigned long) v);
+				p++;
+				break;
+			default:
+				prt_spec(out, spec, star, nr_star, v);
+			}
+			break;
+		}
+		case '\0':
+			prt_printf(out, "%s", spec);
+			fmt = p;
+			continue;
+		default:
+			/* Unknown conversion - print it, and give up on the rest: */
+			prt_printf(out, "%s%s", spec, p + 1);
+			va_end(args);
+			return;
+		}
+
+		fmt = p + 1;
+	}
+	va_end(args);
+}
+
+const char *trace_print_flags_seq(char *buf, unsigned *used, unsigned size,
+				  const char *delim, unsigned long flags,
+				  const struct trace_print_flags *f)
+{
+	char *ret = buf + *used;
+	unsigned n = *used;
+	bool first = true;
+
+	if (n >= size)
+		return "";
+	buf[n] = '\0';
+
+	for (; f->name && flags; f++) {
+		if (!f->mask || (flags & f->mask) != f->mask)
+			continue;
+
+		flags &= ~f->mask;
+		n += scnprintf(buf + n, size - n, "%s%s", first ? "" : delim, f->name);
+		first = false;
+	}
+
+	if (flags)
+		n += scnprintf(buf + n, size - n, "%s0x%lx", first ? "" : delim, flags);
+
+	*used = min(n + 1, size);
+	return ret;
+}
+
+const char *trace_print_symbols_seq(char *buf, unsigned *used, unsigned size,
+				    unsigned long val,
+				    const struct trace_print_flags *f)
+{
+	char *ret = buf + *used;
+
+	for (; f->name; f++)
+		if (f->mask == val)
+			return f->name;
+
+	if (*used >= size)
+		return "";
+
+	*used += scnprintf(ret, size - *used, "0x%lx", val) + 1;
+	*used = min(*used, size);
+	return ret;
+}
+
+/* Startup: */
+
+static void trace_enable_list(const char *list)
+{
+	char *s = strdup(list), *p = s, *pattern;
+
+	if (!s)
+		die("%s", strerror(ENOMEM));
+
+	while ((pattern = strsep(&p, ",")))
+		if (*pattern &&
+		    trace_events_enable(pattern, true))
+			fprintf(stderr, "no trace events matching %s\n", pattern);
+	free(s);
+}
+
+__attribute__((constructor))
+static void trace_init(void)
+{
+	const char *path	= getenv("BCACHEFS_TRACE");
+	const char *events	= getenv("BCACHEFS_TRACE_EVENTS");
+	const char *buf_kb	= getenv("BCACHEFS_TRACE_BUFFER_KB");
+	int ret;
+
+	if (!path)
+		return;
+
+	if (buf_kb)
+		trace_buf_size = roundup_pow_of_two(clamp(strtoul(buf_kb, NULL, 10),
+							  64UL, 1UL << 20) << 10);
+
+	trace_enable_list(events ?: "all");
+
+	ret = trace_start(path);
+	if (ret)
+		die("error starting trace %s: %s", path, strerror(-ret));
+}
+
+__attribute__((destructor))
+static void trace_exit(void)
+{
+	trace_stop();
+}
+
+/* The generic lock events, used by six locks: */
+#define CREATE_TRACE_POINTS
+#include <trace/events/lock.h>
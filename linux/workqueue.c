@@ -1,23 +1,55 @@
 #include <pthread.h>
+#include <sched.h>
 
+#include <linux/cpumask.h>
 #include <linux/kthread.h>
+#include <linux/sched.h>
 #include <linux/slab.h>
 #include <linux/workqueue.h>
 
-static pthread_mutex_t	wq_lock = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t	work_finished = PTHREAD_COND_INITIALIZER;
+/*
+ * Each workqueue has its own pool of worker threads, started on demand up to a
+ * limit derived from max_active and the number of CPUs, and its own lock.
+ *
+ * The only global state is the list of workqueues, for finding which workqueue
+ * a work item was queued on or is running on - only needed by the cancel and
+ * flush paths.
+ */
+static pthread_mutex_t	wq_list_lock = PTHREAD_MUTEX_INITIALIZER;
 static LIST_HEAD(wq_list);
 
 struct workqueue_struct {
 	struct list_head	list;
 
-	struct work_struct	*current_work;
+	pthread_mutex_t		lock;
 	struct list_head	pending_work;
 
-	struct task_struct	*worker;
+	struct list_head	workers;
+	struct list_head	idle;
+	struct list_head	busy;
+	unsigned		nr_workers;
+	unsigned		max_workers;
+	bool			dying;
+
+	/* flush_work() and cancel_work_sync() wait here: */
+	pthread_cond_t		work_done;
+	unsigned		nr_flush_waiters;
+
 	char			name[24];
 };
 
+struct worker {
+	struct workqueue_struct	*wq;
+	struct task_struct	*task;
+	struct list_head	list;
+	struct list_head	idle;
+	struct list_head	busy;
+
+	struct work_struct	*current_work;
+	/* work queued while we were running it, so it doesn't run concurrently: */
+	struct list_head	scheduled;
+};
+
 enum {
 	WORK_PENDING_BIT,
 };
@@ -37,26 +69,147 @@ static bool set_work_pending(struct work_struct *work)
 	return !test_and_set_bit(WORK_PENDING_BIT, work_data_bits(work));
 }
 
+/*
+ * Callers flush their plug before taking wq->lock - the work we're waiting on
+ * may be waiting on IO we have plugged, and submitting it may queue work on @wq:
+ */
+static void wq_wait(struct workqueue_struct *wq)
+{
+	wq->nr_flush_waiters++;
+	pthread_cond_wait(&wq->work_done, &wq->lock);
+	wq->nr_flush_waiters--;
+}
+
+static void wq_wake_waiters(struct workqueue_struct *wq)
+{
+	if (wq->nr_flush_waiters)
+		pthread_cond_broadcast(&wq->work_done);
+}
+
+/*
+ * @work->wq is the workqueue @work was last queued on, which may since have
+ * been freed - only trust it if it's still on wq_list:
+ */
+static struct workqueue_struct *lock_work_wq(struct work_struct *work)
+{
+	struct workqueue_struct *wq, *ret = NULL;
+
+	pthread_mutex_lock(&wq_list_lock);
+	list_for_each_entry(wq, &wq_list, list)
+		if (wq == READ_ONCE(work->wq)) {
+			pthread_mutex_lock(&wq->lock);
+			ret = wq;
+			break;
+		}
+	pthread_mutex_unlock(&wq_list_lock);
+
+	return ret;
+}
+
+/*
+ * Flushers check work->wq under the lock of the workqueue they're waiting on,
+ * so moving a work item to a different workqueue has to be done under the old
+ * workqueue's lock:
+ */
+static void work_set_wq(struct work_struct *work, struct workqueue_struct *wq)
+{
+	struct workqueue_struct *old;
+
+	if (likely(READ_ONCE(work->wq) == wq))
+		return;
+
+	old = lock_work_wq(work);
+	WRITE_ONCE(work->wq, wq);
+	if (old) {
+		wq_wake_waiters(old);
+		pthread_mutex_unlock(&old->lock);
+	}
+}
+
+static struct worker *find_worker_executing_work(struct workqueue_struct *wq,
+						 struct work_struct *work)
+{
+	struct worker *worker;
+
+	list_for_each_entry(worker, &wq->busy, busy)
+		if (worker->current_work == work)
+			return worker;
+
+	return NULL;
+}
+
+static int worker_thread(void *arg);
+
+static int create_worker(struct workqueue_struct *wq)
+{
+	struct worker *worker = kzalloc(sizeof(*worker), GFP_KERNEL);
+	if (!worker)
+		return -ENOMEM;
+
+	worker->wq = wq;
+	INIT_LIST_HEAD(&worker->idle);
+	INIT_LIST_HEAD(&worker->busy);
+	INIT_LIST_HEAD(&worker->scheduled);
+
+	worker->task = kthread_create(worker_thread, worker, "%s", wq->name);
+	if (IS_ERR(worker->task)) {
+		int ret = PTR_ERR(worker->task);
+
+		kfree(worker);
+		return ret;
+	}
+
+	pthread_mutex_lock(&wq->lock);
+	list_add(&worker->list, &wq->workers);
+	pthread_mutex_unlock(&wq->lock);
+
+	wake_up_process(worker->task);
+	return 0;
+}
+
 static void __queue_work(struct workqueue_struct *wq,
 			 struct work_struct *work)
 {
+	struct worker *worker;
+	bool create = false;
+
 	BUG_ON(!work_pending(work));
-	BUG_ON(!list_empty(&work->entry));
 
+	work_set_wq(work, wq);
+
+	pthread_mutex_lock(&wq->lock);
+	BUG_ON(!list_empty(&work->entry));
 	list_add_tail(&work->entry, &wq->pending_work);
-	wake_up_process(wq->worker);
+
+	worker = list_first_entry_or_null(&wq->idle, struct worker, idle);
+	if (worker) {
+		list_del_init(&worker->idle);
+		wake_up_process(worker->task);
+	} else if (wq->nr_workers < wq->max_workers && !wq->dying) {
+		/* Everyone's busy, start another worker: */
+		wq->nr_workers++;
+		create = true;
+	}
+	pthread_mutex_unlock(&wq->lock);
+
+	/*
+	 * If we fail to start a worker, the work will still be run by one of
+	 * the existing workers, there's always at least one:
+	 */
+	if (create && create_worker(wq)) {
+		pthread_mutex_lock(&wq->lock);
+		wq->nr_workers--;
+		pthread_mutex_unlock(&wq->lock);
+	}
 }
 
 bool queue_work(struct workqueue_struct *wq, struct work_struct *work)
 {
-	bool ret;
-
-	pthread_mutex_lock(&wq_lock);
-	if ((ret = set_work_pending(work)))
-		__queue_work(wq, work);
-	pthread_mutex_unlock(&wq_lock);
+	if (!set_work_pending(work))
+		return false;
 
-	return ret;
+	__queue_work(wq, work);
+	return true;
 }
 
 void delayed_work_timer_fn(struct timer_list *timer)
@@ -64,9 +217,7 @@ void delayed_work_timer_fn(struct timer_list *timer)
 	struct delayed_work *dwork =
 		container_of(timer, struct delayed_work, timer);
 
-	pthread_mutex_lock(&wq_lock);
 	__queue_work(dwork->wq, &dwork->work);
-	pthread_mutex_unlock(&wq_lock);
 }
 
 static void __queue_delayed_work(struct workqueue_struct *wq,
@@ -83,6 +234,9 @@ static void __queue_delayed_work(struct workqueue_struct *wq,
 	if (!delay) {
 		__queue_work(wq, &dwork->work);
 	} else {
+		/* so flush_work() can find it while it's on the timer: */
+		work_set_wq(work, wq);
+
 		dwork->wq = wq;
 		timer->expires = jiffies + delay;
 		add_timer(timer);
@@ -94,23 +248,24 @@ bool queue_delayed_work(struct workqueue_struct *wq,
 			unsigned long delay)
 {
 	struct work_struct *work = &dwork->work;
-	bool ret;
 
-	pthread_mutex_lock(&wq_lock);
-	if ((ret = set_work_pending(work)))
-		__queue_delayed_work(wq, dwork, delay);
-	pthread_mutex_unlock(&wq_lock);
+	if (!set_work_pending(work))
+		return false;
 
-	return ret;
+	__queue_delayed_work(wq, dwork, delay);
+	return true;
 }
 
+/*
+ * Take ownership of @work's pending bit, removing it from its timer or
+ * workqueue if it was pending: returns true if it was.
+ */
 static bool grab_pending(struct work_struct *work, bool is_dwork)
 {
+	struct workqueue_struct *wq;
 retry:
-	if (set_work_pending(work)) {
-		BUG_ON(!list_empty(&work->entry));
+	if (set_work_pending(work))
 		return false;
-	}
 
 	if (is_dwork) {
 		struct delayed_work *dwork = to_delayed_work(work);
@@ -121,66 +276,105 @@ retry:
 		}
 	}
 
-	if (!list_empty(&work->entry)) {
-		list_del_init(&work->entry);
-		return true;
-	}
+	wq = lock_work_wq(work);
+	if (wq) {
+		bool queued = !list_empty(&work->entry);
+
+		if (queued)
+			list_del_init(&work->entry);
+		pthread_mutex_unlock(&wq->lock);
 
-	BUG_ON(!is_dwork);
+		if (queued)
+			return true;
+	}
 
-	pthread_mutex_unlock(&wq_lock);
-	flush_timers();
-	pthread_mutex_lock(&wq_lock);
+	/*
+	 * Pending, but neither on a timer nor on a workqueue: either the timer
+	 * is running, or we raced with queue_work() and it's about to be
+	 * added to a workqueue:
+	 */
+	if (is_dwork)
+		flush_timers();
+	else
+		sched_yield();
 	goto retry;
 }
 
-static bool work_running(struct work_struct *work)
+/* Release a pending bit we took with grab_pending(): */
+static void release_pending(struct work_struct *work)
+{
+	struct workqueue_struct *wq = lock_work_wq(work);
+
+	clear_work_pending(work);
+
+	if (wq) {
+		wq_wake_waiters(wq);
+		pthread_mutex_unlock(&wq->lock);
+	}
+}
+
+static struct workqueue_struct *lock_wq_executing(struct work_struct *work)
 {
 	struct workqueue_struct *wq;
 
-	list_for_each_entry(wq, &wq_list, list)
-		if (wq->current_work == work)
-			return true;
+	pthread_mutex_lock(&wq_list_lock);
+	list_for_each_entry(wq, &wq_list, list) {
+		pthread_mutex_lock(&wq->lock);
+		if (find_worker_executing_work(wq, work)) {
+			pthread_mutex_unlock(&wq_list_lock);
+			return wq;
+		}
+		pthread_mutex_unlock(&wq->lock);
+	}
+	pthread_mutex_unlock(&wq_list_lock);
 
-	return false;
+	return NULL;
 }
 
-bool flush_work(struct work_struct *work)
+/* Wait for @work to finish executing, on whichever workqueue it's running: */
+static bool wait_on_work_running(struct work_struct *work)
 {
+	struct workqueue_struct *wq;
 	bool ret = false;
 
-	pthread_mutex_lock(&wq_lock);
-	while (work_pending(work) || work_running(work)) {
-		pthread_cond_wait(&work_finished, &wq_lock);
+	sched_flush_plug();
+
+	while ((wq = lock_wq_executing(work))) {
+		do {
+			wq_wait(wq);
+		} while (find_worker_executing_work(wq, work));
+		pthread_mutex_unlock(&wq->lock);
 		ret = true;
 	}
-	pthread_mutex_unlock(&wq_lock);
 
 	return ret;
 }
 
-static bool __flush_work(struct work_struct *work)
+bool flush_work(struct work_struct *work)
 {
+	struct workqueue_struct *wq;
 	bool ret = false;
 
-	while (work_running(work)) {
-		pthread_cond_wait(&work_finished, &wq_lock);
-		ret = true;
+	sched_flush_plug();
+
+	while (work_pending(work) && (wq = lock_work_wq(work))) {
+		while (work_pending(work) && work->wq == wq) {
+			wq_wait(wq);
+			ret = true;
+		}
+		pthread_mutex_unlock(&wq->lock);
 	}
 
+	ret |= wait_on_work_running(work);
 	return ret;
 }
 
 bool cancel_work_sync(struct work_struct *work)
 {
-	bool ret;
-
-	pthread_mutex_lock(&wq_lock);
-	ret = grab_pending(work, false);
+	bool ret = grab_pending(work, false);
 
-	__flush_work(work);
-	clear_work_pending(work);
-	pthread_mutex_unlock(&wq_lock);
+	wait_on_work_running(work);
+	release_pending(work);
 
 	return ret;
 }
@@ -190,13 +384,9 @@ bool mod_delayed_work(struct workqueue_struct *wq,
 		      unsigned long delay)
 {
 	struct work_struct *work = &dwork->work;
-	bool ret;
-
-	pthread_mutex_lock(&wq_lock);
-	ret = grab_pending(work, true);
+	bool ret = grab_pending(work, true);
 
 	__queue_delayed_work(wq, dwork, delay);
-	pthread_mutex_unlock(&wq_lock);
 
 	return ret;
 }
@@ -204,13 +394,9 @@ bool mod_delayed_work(struct workqueue_struct *wq,
 bool cancel_delayed_work(struct delayed_work *dwork)
 {
 	struct work_struct *work = &dwork->work;
-	bool ret;
-
-	pthread_mutex_lock(&wq_lock);
-	ret = grab_pending(work, true);
+	bool ret = grab_pending(work, true);
 
-	clear_work_pending(&dwork->work);
-	pthread_mutex_unlock(&wq_lock);
+	release_pending(work);
 
 	return ret;
 }
@@ -218,68 +404,141 @@ bool cancel_delayed_work(struct delayed_work *dwork)
 bool cancel_delayed_work_sync(struct delayed_work *dwork)
 {
 	struct work_struct *work = &dwork->work;
-	bool ret;
+	bool ret = grab_pending(work, true);
 
-	pthread_mutex_lock(&wq_lock);
-	ret = grab_pending(work, true);
-
-	__flush_work(work);
-	clear_work_pending(work);
-	pthread_mutex_unlock(&wq_lock);
+	wait_on_work_running(work);
+	release_pending(work);
 
 	return ret;
 }
 
+static struct work_struct *worker_next_work(struct worker *worker)
+{
+	struct workqueue_struct *wq = worker->wq;
+	struct work_struct *work;
+
+	while ((work = list_first_entry_or_null(&worker->scheduled,
+					struct work_struct, entry)) ||
+	       (work = list_first_entry_or_null(&wq->pending_work,
+					struct work_struct, entry))) {
+		struct worker *running = find_worker_executing_work(wq, work);
+
+		if (!running)
+			return work;
+
+		/*
+		 * Work items never run concurrently with themselves: hand it
+		 * to the worker that's running it, to run when it's done:
+		 */
+		list_move_tail(&work->entry, &running->scheduled);
+	}
+
+	return NULL;
+}
+
 static int worker_thread(void *arg)
 {
-	struct workqueue_struct *wq = arg;
+	struct worker *worker = arg;
+	struct workqueue_struct *wq = worker->wq;
 	struct work_struct *work;
 
-	pthread_mutex_lock(&wq_lock);
+	pthread_mutex_lock(&wq->lock);
 	while (1) {
 		__set_current_state(TASK_INTERRUPTIBLE);
-		work = list_first_entry_or_null(&wq->pending_work,
-				struct work_struct, entry);
-		wq->current_work = work;
-
-		if (kthread_should_stop()) {
-			BUG_ON(wq->current_work);
-			break;
-		}
+		work = worker_next_work(worker);
 
 		if (!work) {
-			pthread_mutex_unlock(&wq_lock);
+			/* Only stop once the workqueue has been drained: */
+			if (kthread_should_stop())
+				break;
+
+			list_add(&worker->idle, &wq->idle);
+			pthread_mutex_unlock(&wq->lock);
 			schedule();
-			pthread_mutex_lock(&wq_lock);
+			pthread_mutex_lock(&wq->lock);
+			list_del_init(&worker->idle);
 			continue;
 		}
 
+		__set_current_state(TASK_RUNNING);
+
 		BUG_ON(!work_pending(work));
 		list_del_init(&work->entry);
 		clear_work_pending(work);
 
-		pthread_mutex_unlock(&wq_lock);
+		worker->current_work = work;
+		list_add(&worker->busy, &wq->busy);
+		pthread_mutex_unlock(&wq->lock);
+
 		work->func(work);
-		pthread_mutex_lock(&wq_lock);
 
-		pthread_cond_broadcast(&work_finished);
+		pthread_mutex_lock(&wq->lock);
+		worker->current_work = NULL;
+		list_del_init(&worker->busy);
+		wq_wake_waiters(wq);
 	}
-	pthread_mutex_unlock(&wq_lock);
+	__set_current_state(TASK_RUNNING);
+	pthread_mutex_unlock(&wq->lock);
 
 	return 0;
 }
 
 void destroy_workqueue(struct workqueue_struct *wq)
 {
-	kthread_stop(wq->worker);
+	struct worker *worker;
+
+	/* Workers drain the workqueue before exiting: */
+	pthread_mutex_lock(&wq->lock);
+	wq->dying = true;
+	while (wq->nr_workers) {
+		worker = list_first_entry_or_null(&wq->workers, struct worker, list);
+		if (worker) {
+			list_del(&worker->list);
+			wq->nr_workers--;
+		}
+		pthread_mutex_unlock(&wq->lock);
+
+		if (worker) {
+			kthread_stop(worker->task);
+			kfree(worker);
+		} else {
+			/* raced with __queue_work() starting a worker: */
+			sched_yield();
+		}
+
+		pthread_mutex_lock(&wq->lock);
+	}
+	pthread_mutex_unlock(&wq->lock);
+
+	BUG_ON(!list_empty(&wq->pending_work));
 
-	pthread_mutex_lock(&wq_lock);
+	pthread_mutex_lock(&wq_list_lock);
 	list_del(&wq->list);
-	pthread_mutex_unlock(&wq_lock);
+	pthread_mutex_unlock(&wq_list_lock);
 
+	pthread_cond_destroy(&wq->work_done);
+	pthread_mutex_destroy(&wq->lock);
 	kfree(wq);
 }
 
+/*
+ * max_active is per CPU for bound workqueues and total for unbound workqueues
+ * (capped at WQ_MAX_UNBOUND_PER_CPU per CPU): we have no per CPU pools, so
+ * bound workqueues just get one worker per CPU.
+ */
+static unsigned wq_max_workers(unsigned flags, int max_active)
+{
+	unsigned nr_cpus = num_online_cpus();
+
+	if (flags & __WQ_ORDERED)
+		return 1;
+
+	return clamp_t(unsigned, max_active ?: WQ_DFL_ACTIVE, 1,
+		       flags & WQ_UNBOUND
+		       ? WQ_MAX_UNBOUND_PER_CPU * nr_cpus
+		       : nr_cpus);
+}
+
 struct workqueue_struct *alloc_workqueue(const char *fmt,
 					 unsigned flags,
 					 int max_active,
@@ -294,20 +553,29 @@ struct workqueue_struct *alloc_workqueue(const char *fmt,
 
 	INIT_LIST_HEAD(&wq->list);
 	INIT_LIST_HEAD(&wq->pending_work);
+	INIT_LIST_HEAD(&wq->workers);
+	INIT_LIST_HEAD(&wq->idle);
+	INIT_LIST_HEAD(&wq->busy);
+	pthread_mutex_init(&wq->lock, NULL);
+	pthread_cond_init(&wq->work_done, NULL);
+	wq->max_workers = wq_max_workers(flags, max_active);
 
 	va_start(args, max_active);
 	vsnprintf(wq->name, sizeof(wq->name), fmt, args);
 	va_end(args);
 
-	wq->worker = kthread_run(worker_thread, wq, "%s", wq->name);
-	if (IS_ERR(wq->worker)) {
+	/* More workers are started as needed: */
+	wq->nr_workers = 1;
+	if (create_worker(wq)) {
+		pthread_cond_destroy(&wq->work_done);
+		pthread_mutex_destroy(&wq->lock);
 		kfree(wq);
 		return NULL;
 	}
 
-	pthread_mutex_lock(&wq_lock);
+	pthread_mutex_lock(&wq_list_lock);
 	list_add(&wq->list, &wq_list);
-	pthread_mutex_unlock(&wq_lock);
+	pthread_mutex_unlock(&wq_list_lock);
 
 	return wq;
 }
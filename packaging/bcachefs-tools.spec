@@ -16,6 +16,7 @@ BuildRequires:  libaio-devel
 BuildRequires:  libattr-devel
 BuildRequires:  libblkid-devel
 BuildRequires:  libsodium-devel
+BuildRequires:  liburing-devel
 BuildRequires:  libuuid-devel
 BuildRequires:  libzstd-devel
 BuildRequires:  lz4-devel
@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+#
+# Generates the slicing-by-8 crc tables, c_src/crc32ctable.h and
+# linux/crc64table.h - run from the top of the tree after changing this script:
+#
+#   scripts/gen-crc-tables.py
+#
+# Table k holds the crc of byte i followed by k zero bytes, so the first table
+# is the usual byte at a time table.
+
+CRC32C_POLY	= 0x82f63b78		# Castagnoli, reflected
+CRC64_POLY	= 0x42f0e1eba9ea3693	# ECMA-182, not reflected
+NR_TABLES	= 8
+
+def crc32c_tables():
+    t = [[0] * 256 for _ in range(NR_TABLES)]
+
+    for i in range(256):
+        crc = i
+        for _ in range(8):
+            crc = (crc >> 1) ^ (CRC32C_POLY if crc & 1 else 0)
+        t[0][i] = crc
+
+    for k in range(1, NR_TABLES):
+        for i in range(256):
+            crc = t[k - 1][i]
+            t[k][i] = (crc >> 8) ^ t[0][crc & 0xff]
+    return t
+
+def crc64_tables():
+    mask = (1 << 64) - 1
+    t = [[0] * 256 for _ in range(NR_TABLES)]
+
+    for i in range(256):
+        crc = i << 56
+        for _ in range(8):
+            crc = ((crc << 1) ^ (CRC64_POLY if crc >> 63 else 0)) & mask
+        t[0][i] = crc
+
+    for k in range(1, NR_TABLES):
+        for i in range(256):
+            crc = t[k - 1][i]
+            t[k][i] = ((crc << 8) & mask) ^ t[0][crc >> 56]
+    return t
+
+def write_tables(path, comment, decl, tables, fmt, per_line, sep):
+    with open(path, 'w') as f:
+        f.write('/* this file is generated by scripts/gen-crc-tables.py - do not edit */\n\n')
+        f.write(comment)
+        f.write('\n#include <linux/types.h>\n#include <linux/cache.h>\n\n')
+        f.write(decl + ' = {\n')
+        for t in tables:
+            f.write('\t{\n')
+            for i in range(0, 256, per_line):
+                f.write('\t\t' + sep.join(fmt % v for v in t[i:i + per_line]) + ',\n')
+            f.write('\t},\n')
+        f.write('};\n')
+
+write_tables('c_src/crc32ctable.h',
+             '/*\n'
+             ' * Slicing-by-8 tables for crc32c (Castagnoli, reflected polynomial 0x82F63B78):\n'
+             ' * crc32c_table[k][i] is the crc of byte i followed by k zero bytes.\n'
+             ' */\n',
+             'static const u32 ____cacheline_aligned crc32c_table[8][256]',
+             crc32c_tables(), '0x%08x', 4, ', ')
+
+write_tables('linux/crc64table.h',
+             '/*\n'
+             ' * crc64table[k][i] is the crc of byte i followed by k zero bytes: slicing-by-8\n'
+             ' * tables, the first of which is the usual byte at a time table.\n'
+             ' */\n',
+             'static const u64 ____cacheline_aligned crc64table[8][256]',
+             crc64_tables(), '0x%016xULL', 2, ', \t')